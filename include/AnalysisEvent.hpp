@@ -1540,6 +1540,10 @@ class AnalysisEvent
 
     std::vector<double> muonMomentumSF;
     std::vector<double> jetSmearValue;
+    // Every jet's nominal and JER up/down smears, set by Cuts::smearJets
+    std::vector<double> jetSmearValueNominal;
+    std::vector<double> jetSmearValueUp;
+    std::vector<double> jetSmearValueDown;
 
     std::vector<int> electronIndexTight;
     std::vector<int> electronIndexLoose;
@@ -27,6 +27,7 @@ class MvaEvent : public AnalysisEvent
     static constexpr size_t NJETS{15};
     static constexpr size_t NBJETS{10};
     static constexpr size_t NMUONS{2};
+    static constexpr size_t NMETVARIATIONS{4};
 
     bool isMC;
     Double_t eventWeight;
@@ -39,6 +40,11 @@ class MvaEvent : public AnalysisEvent
     Int_t jetInd[NJETS];
     Int_t bJetInd[NBJETS];
     Float_t jetSmearValue[NJETS];
+    // The JES up/down and JER up/down MET, which trees made before they were
+    // stored don't have
+    bool hasMetJetVariations{false};
+    Float_t metJetVariationEt[NMETVARIATIONS];
+    Float_t metJetVariationPhi[NMETVARIATIONS];
 
     // End MVA tree specific
 
@@ -54,11 +60,16 @@ class MvaEvent : public AnalysisEvent
     TBranch* b_jetInd; //!
     TBranch* b_bJetInd; //!
     TBranch* b_jetSmearValue; //!
+    TBranch* b_metJetVariationEt{nullptr}; //!
+    TBranch* b_metJetVariationPhi{nullptr}; //!
 
     MvaEvent(bool isMC = true,
              TTree* tree = nullptr,
              bool is2016 = false);
     virtual ~MvaEvent();
+    // Reads from another tree with the same layout, copying over the branch
+    // addresses rather than setting each one up again.
+    void setTree(TTree* tree);
 };
 
 inline MvaEvent::MvaEvent(bool isMC,
@@ -78,10 +89,31 @@ inline MvaEvent::MvaEvent(bool isMC,
     fChain->SetBranchAddress("jetInd", jetInd, &b_jetInd);
     fChain->SetBranchAddress("bJetInd", bJetInd, &b_bJetInd);
     fChain->SetBranchAddress("jetSmearValue", jetSmearValue, &b_jetSmearValue);
+    if (fChain->GetBranch("metJetVariationEt")
+        && fChain->GetBranch("metJetVariationPhi"))
+    {
+        hasMetJetVariations = true;
+        fChain->SetBranchAddress(
+            "metJetVariationEt", metJetVariationEt, &b_metJetVariationEt);
+        fChain->SetBranchAddress(
+            "metJetVariationPhi", metJetVariationPhi, &b_metJetVariationPhi);
+    }
 }
 
 inline MvaEvent::~MvaEvent()
 {
 }
 
+inline void MvaEvent::setTree(TTree* tree)
+{
+    if (tree == fChain)
+    {
+        return;
+    }
+    tree->SetMakeClass(1);
+    fChain->CopyAddresses(tree);
+    fChain = tree;
+    fCurrent = -1;
+}
+
 #endif
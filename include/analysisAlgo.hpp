@@ -4,9 +4,11 @@
 #include "cutClass.hpp"
 #include "dataset.hpp"
 #include "histogramPlotter.hpp"
+#include "resultCache.hpp"
 
 #include <map>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 class TH1D;
@@ -31,6 +33,19 @@ class AnalysisAlgo
     private:
     // functions
     std::string channelSetup(unsigned);
+    // Everything that can change what a dataset gives in the current channel.
+    std::string cacheKey(Dataset&, const std::string&) const;
+    // MvaRegion flags for an MVA tree entry, from the values stored with it
+    int mvaRegionFlags(const AnalysisEvent&,
+                       const int*,
+                       const float*,
+                       int,
+                       int,
+                       int) const;
+    // The histograms a dataset fills in the current channel, each with the
+    // directory and name it is cached under.
+    std::vector<std::tuple<std::string, std::string, TH1D*>>
+        datasetHistograms(const std::string&);
 
     // variables?
     std::string config;
@@ -41,6 +56,10 @@ class AnalysisAlgo
     long nEvents;
     std::string outFolder;
     std::string histoDir;
+    unsigned plotJobs;
+    std::string cacheDir;
+    std::string cutFlowReportDir;
+    std::unique_ptr<ResultCache> resultCache;
     std::string postfix;
     std::string channel;
     bool invertLepCut; // For z+jets background estimation
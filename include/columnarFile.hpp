@@ -0,0 +1,100 @@
+#ifndef _columnarFile_hpp_
+#define _columnarFile_hpp_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// A flat columnar format for MVA inputs, for tools that read every value of a
+// few columns many times over (e.g. BDT training) and are better served by
+// memory-mapping plain float arrays than by decompressing ROOT baskets.
+//
+// Layout (little endian, as written on x86-64):
+//   header:  magic "TQZCOL1\0", uint32 number of columns, uint32 rows per
+//            group, uint64 number of rows, then for each column a uint32
+//            name length and the name
+//   groups:  starting at the first multiple of alignment after the header.
+//            Each group has one slot per column, in column order, and each
+//            slot holds rowsPerGroup floats padded to a multiple of
+//            alignment bytes. Only the rows actually in the group (all but
+//            possibly the last) are meaningful.
+// So column c of group g starts at dataOffset + (g * nColumns + c) *
+// slotSize, and every column slot is aligned for vector loads.
+namespace Columnar
+{
+constexpr std::uint32_t alignment{64};
+// 16 kB a column slot. A writer holds one group in memory, and makeMVAinputs
+// has one open for every systematic's trees at once.
+constexpr std::uint32_t defaultRowsPerGroup{1 << 12};
+} // namespace Columnar
+
+class ColumnarWriter
+{
+    public:
+    ColumnarWriter(const std::string& path,
+                   std::vector<std::string> columns,
+                   std::uint32_t rowsPerGroup = Columnar::defaultRowsPerGroup);
+    ~ColumnarWriter();
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    // values must hold one value per column, in column order
+    void fill(const float* values);
+    // Writes out the last group and the row count. Called by the destructor
+    // if not called before.
+    void close();
+
+    private:
+    void writeGroup();
+
+    const std::string path_;
+    const std::vector<std::string> columns_;
+    const std::uint32_t rowsPerGroup_;
+    std::ofstream file_;
+    std::uint64_t rows_;
+    std::uint64_t rowsOffset_; // Where the row count is in the header
+    // The current group, column by column, grown as rows are filled
+    std::vector<std::vector<float>> group_;
+    bool closed_;
+};
+
+class ColumnarReader
+{
+    public:
+    explicit ColumnarReader(const std::string& path);
+    ~ColumnarReader();
+    ColumnarReader(const ColumnarReader&) = delete;
+    ColumnarReader& operator=(const ColumnarReader&) = delete;
+
+    const std::vector<std::string>& columns() const
+    {
+        return columns_;
+    }
+    std::uint64_t rows() const
+    {
+        return rows_;
+    }
+    [[gnu::pure]] std::uint64_t groups() const;
+    [[gnu::pure]] std::uint32_t groupRows(std::uint64_t group) const;
+    // The values of one column in one group; groupRows(group) long
+    [[gnu::pure]] const float* column(std::uint64_t group,
+                                      std::uint32_t column) const;
+    // Index of a column by name; throws if there is none
+    std::uint32_t columnIndex(const std::string& name) const;
+
+    private:
+    // Reads and checks the header, throwing if it is malformed
+    void readHeader();
+
+    const std::string path_;
+    std::vector<std::string> columns_;
+    std::uint32_t rowsPerGroup_;
+    std::uint64_t rows_;
+    std::uint64_t dataOffset_;
+    std::uint64_t slotSize_;
+    const char* map_;
+    std::size_t mapSize_;
+};
+
+#endif
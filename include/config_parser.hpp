@@ -5,6 +5,10 @@
 
 #include "TColor.h"
 #include "dataset.hpp"
+#include "genAcceptance.hpp"
+#include "mvaScorer.hpp"
+#include "templateBuilder.hpp"
+#include "triggerEfficiency.hpp"
 
 #include <map>
 #include <string>
@@ -45,6 +49,18 @@ namespace Parser
                      std::vector<std::string>&,
                      std::vector<std::string>&,
                      std::vector<int>&);
+    std::vector<std::string> parse_mva_variables(const std::string varConf);
+    void parse_mva_scoring(const std::string scoringConf,
+                           std::vector<std::string>& variables,
+                           std::vector<std::string>& spectators,
+                           std::vector<MvaMethod>& methods);
+    void parse_mva_templates(const std::string templatesConf,
+                             std::vector<TemplateObservable>& observables);
+    void parse_efficiency_binnings(const std::string binningsConf,
+                                   std::vector<EfficiencyBinning>& binnings);
+    void parse_acceptance_thresholds(
+        const std::string thresholdsConf,
+        std::vector<AcceptanceThresholds>& thresholds);
 } // namespace Parser
 
 #endif
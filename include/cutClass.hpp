@@ -3,12 +3,16 @@
 
 #include "AnalysisEvent.hpp"
 #include "RoccoR.h"
+#include "cutFlowCounter.hpp"
+#include "metPropagation.hpp"
+#include "objectSelection.hpp"
 #include "plots.hpp"
 
 #include <TH1F.h>
 #include <TH2D.h>
 #include <TH2F.h>
 #include <TLorentzVector.h>
+#include <array>
 #include <fstream>
 #include <map>
 #include <vector>
@@ -16,12 +20,43 @@
 class Cuts
 {
     private:
+    // The selection stages an event has passed, as a bit mask of CutStage
+    // IDs, and its weight at each of them. Plots and cut flows are filled
+    // from this in one go by fillStagePlots. When timed, the CPU time each
+    // stage was passed at is kept for the CutFlowCounter too.
+    struct StageRecord
+    {
+        unsigned mask{0};
+        std::array<double, CutStage::numStages> weights{};
+        bool timed{false};
+        std::array<double, CutStage::numStages> cpuTimes{};
+
+        void pass(const unsigned stage, const double weight)
+        {
+            mask |= 1u << stage;
+            weights[stage] = weight;
+            if (timed)
+            {
+                cpuTimes[stage] = CutFlowCounter::cpuSeconds();
+            }
+        }
+    };
+
     bool makeLeptonCuts(AnalysisEvent& event,
                         double& eventWeight,
-                        std::map<std::string, std::shared_ptr<Plots>>& plotMap,
-                        TH1D& cutFlow,
+                        StageRecord& stages,
                         const int syst,
                         const bool skipZCut = false);
+    bool makeJetStageCuts(AnalysisEvent& event,
+                          double& eventWeight,
+                          StageRecord& stages,
+                          const int syst);
+    void fillStagePlots(const AnalysisEvent& event,
+                        const StageRecord& stages,
+                        const StagePlots& plots,
+                        TH1D& cutFlow) const;
+    // Adds the stages in stages to cutFlowCounter_
+    void countStages(const StageRecord& stages) const;
     std::pair<std::vector<int>, std::vector<double>>
         makeJetCuts(const AnalysisEvent& event,
                     const int syst,
@@ -31,14 +66,6 @@ class Cuts
                                              const std::vector<int> jets,
                                              const int syst = 0) const;
 
-    [[gnu::pure]] std::vector<int>
-        getTightEles(const AnalysisEvent& event) const;
-    [[gnu::pure]] std::vector<int>
-        getLooseEles(const AnalysisEvent& event) const;
-    [[gnu::pure]] std::vector<int>
-        getTightMuons(const AnalysisEvent& event) const;
-    [[gnu::pure]] std::vector<int>
-        getLooseMuons(const AnalysisEvent& event) const;
     bool getDileptonZCand(AnalysisEvent& event,
                           const std::vector<int> electrons,
                           const std::vector<int> muons) const;
@@ -50,7 +77,6 @@ class Cuts
     bool triggerCuts(const AnalysisEvent& event,
                      double& eventWeight,
                      const int syst = 0) const;
-    [[gnu::const]] bool metFilters(const AnalysisEvent& event) const;
 
     std::vector<double> getRochesterSFs(const AnalysisEvent& event) const;
     // Function to get lepton SF
@@ -61,37 +87,22 @@ class Cuts
     // set to true to fill in histograms/spit out other info
     bool doPlots_;
     bool fillCutFlow_; // Fill cut flows
+    // Per-stage counts and timings, if set
+    CutFlowCounter* cutFlowCounter_;
+    // The event's MET variations, if set
+    const MetPropagation* metPropagation_;
     bool invertLepCut_; // For background estimation
     bool makeEventDump_;
     const bool is2016_;
 
-    // Tight electron cuts
-    unsigned numTightEle_;
-    double tightElePt_;
-    double tightElePtLeading_;
-    double tightEleEta_;
-    double tightEleRelIso_;
+    // Lepton and jet ID thresholds and MET filters
+    ObjectSelection selection_;
 
-    // Loose electron cuts
+    // Number of leptons in each collection
+    unsigned numTightEle_;
     unsigned numLooseEle_;
-    double looseElePt_;
-    double looseElePtLeading_;
-    double looseEleEta_;
-    double looseEleRelIso_;
-
-    // Tight muon cuts
     unsigned numTightMu_;
-    double tightMuonPt_;
-    double tightMuonPtLeading_;
-    double tightMuonEta_;
-    double tightMuonRelIso_;
-
-    // Loose muon cuts
     unsigned numLooseMu_;
-    double looseMuonPt_;
-    double looseMuonPtLeading_;
-    double looseMuonEta_;
-    double looseMuonRelIso_;
 
     // z and w inv cuts
     double invZMassCut_;
@@ -135,6 +146,13 @@ class Cuts
                                                  const int index,
                                                  const int syst,
                                                  const bool initialRun) const;
+    // The JER smear of a jet, varied up or down by syst 16 or 32
+    double getJetSmear(const AnalysisEvent& event,
+                       const int index,
+                       const int syst) const;
+    // The MET variation that goes with syst
+    [[gnu::const]] static MetPropagation::Variation
+        metVariation(const int syst);
     static double
         jet2016PtSimRes(const double pt, const double eta, const double rho);
     static double
@@ -215,7 +233,7 @@ class Cuts
     ~Cuts();
     bool makeCuts(AnalysisEvent& event,
                   double& eventWeight,
-                  std::map<std::string, std::shared_ptr<Plots>>& plotMap,
+                  const StagePlots& plots,
                   TH1D& cutFlow,
                   const int systToRun);
     void setMC(bool isMC)
@@ -289,15 +307,35 @@ class Cuts
     {
         isZplusCR_ = isZplusCR;
     }
+    // Counts the stages passed by every event from here on in counter, which
+    // must outlive its use here. nullptr stops counting.
+    void setCutFlowCounter(CutFlowCounter* counter)
+    {
+        cutFlowCounter_ = counter;
+    }
+    // Works out every jet's nominal and JER up/down smear, once for each
+    // event, for makeCuts and propagateMet to share between the systematics.
+    // Call it after reading each event, before either.
+    void smearJets(AnalysisEvent& event) const;
+    // Propagates the JER up/down smears and the JES uncertainties of every
+    // jet in event to its MET, keeping the stored MET as the nominal
+    [[gnu::pure]] MetPropagation propagateMet(const AnalysisEvent& event) const;
+    // Takes the MET of each systematic from metPropagation, which must
+    // outlive its use here. nullptr uses the event's own MET.
+    void setMetPropagation(const MetPropagation* metPropagation)
+    {
+        metPropagation_ = metPropagation;
+    }
 
     // Simple deltaR function, because the reco namespace doesn't work or
     // something
     [[gnu::const]] static double deltaR(const double eta1,
                                         const double phi1,
                                         const double eta2,
-                                        const double phi2);
-    [[gnu::const]] static double deltaPhi(const double phi1, const double phi2);
-
+                                        const double phi2)
+    {
+        return ObjectSelection::deltaR(eta1, phi1, eta2, phi2);
+    }
 };
 
 #endif
@@ -0,0 +1,78 @@
+#ifndef _cutFlowCounter_hpp_
+#define _cutFlowCounter_hpp_
+
+#include "plots.hpp"
+
+#include <array>
+#include <ostream>
+#include <string>
+
+// Raw and weighted counts of the events reaching each selection stage, and
+// the CPU time spent on each. A stage's time runs from the previous stage
+// being passed until this one is passed or failed. Each thread keeps its own
+// counter, so nothing here is synchronised.
+class CutFlowCounter
+{
+    public:
+    // The trigger and MET filters, followed by the CutStage stages
+    enum : unsigned
+    {
+        trigger,
+        metFilters,
+        firstCutStage,
+        numStages = firstCutStage + CutStage::numStages
+    };
+    static const std::array<std::string, numStages> names;
+
+    CutFlowCounter();
+
+    // The calling thread's CPU time, in seconds
+    static double cpuSeconds();
+
+    // An event enters the selection
+    void start();
+    // ... passes stage, at the given CPU time
+    void pass(unsigned stage, double weight, double cpuTime);
+    void pass(const unsigned stage, const double weight)
+    {
+        pass(stage, weight, cpuSeconds());
+    }
+    // ... fails the stage after the last one it passed
+    void stop();
+    // Leaves the time since the last pass out of every stage, e.g. the time
+    // spent filling plots between stages
+    void resume();
+
+    void merge(const CutFlowCounter& other);
+
+    long entered() const
+    {
+        return entered_;
+    }
+
+    // One JSON object with the counts and timings of every stage. eventsRead
+    // and wallSeconds give the overall event rate.
+    void writeJson(std::ostream& out,
+                   const std::string& dataset,
+                   const std::string& channel,
+                   long eventsRead,
+                   double wallSeconds) const;
+
+    private:
+    struct Stage
+    {
+        long events{0};
+        double weighted{0};
+        double weighted2{0};
+        double cpuSeconds{0};
+    };
+
+    long entered_;
+    std::array<Stage, numStages> stages_;
+    // The stage the current event is being tested against, and the CPU time
+    // since which it has been
+    unsigned next_;
+    double last_;
+};
+
+#endif
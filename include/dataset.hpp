@@ -23,6 +23,8 @@ class Dataset
     std::string plotLabel_;
     std::string plotType_;
     std::string triggerFlag_;
+    // Hash of the dataset's whole configuration, for result cache keys
+    std::string configFingerprint_;
 
     public:
     Dataset(std::string name,
@@ -57,6 +59,10 @@ class Dataset
     {
         return treeName_;
     }
+    std::vector<std::string> getLocations()
+    {
+        return locations_;
+    }
     int getColour()
     {
         return colour_;
@@ -76,6 +82,14 @@ class Dataset
     {
         return triggerFlag_;
     }
+    std::string configFingerprint()
+    {
+        return configFingerprint_;
+    }
+    void setConfigFingerprint(std::string fingerprint)
+    {
+        configFingerprint_ = fingerprint;
+    }
     long long getTotalEvents()
     {
         return totalEvents_;
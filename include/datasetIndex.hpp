@@ -0,0 +1,62 @@
+#ifndef _datasetIndex_hpp_
+#define _datasetIndex_hpp_
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+class TH1I;
+
+// Per-file metadata for one dataset location, cached in a sidecar file
+// (".datasetIndex") in that directory. Building it opens every ROOT file once;
+// afterwards only files whose size or modification time have changed are
+// reopened, so getting a dataset's generator weights no longer means reading
+// the whole dataset at the start of every run.
+class DatasetIndex
+{
+    public:
+    struct FileRecord
+    {
+        std::string name; // File name within the location
+        std::uintmax_t size;
+        std::time_t mtime;
+        std::uint32_t checksum; // adler32 of the file contents
+        long long entries; // Entries in the dataset tree
+        // Contents of sumNumPosMinusNegWeights, including under/overflow
+        std::vector<double> weightBins;
+    };
+
+    DatasetIndex(std::string location, std::string treeName);
+
+    // Brings the index in line with the files on disk and saves it if
+    // anything changed. Returns the number of files that had to be (re)read.
+    unsigned update();
+
+    const std::vector<FileRecord>& files() const
+    {
+        return files_;
+    }
+    long long totalEntries() const;
+    // Sum of sumNumPosMinusNegWeights over all files. The caller owns the
+    // returned histogram, which is nullptr if there are no files.
+    TH1I* generatorWeightHistogram() const;
+
+    static const std::string indexName;
+
+    private:
+    bool read();
+    void write() const;
+    FileRecord scanFile(const std::string& name);
+    static std::uint32_t checksum(const std::string& path);
+
+    const std::string location_;
+    const std::string treeName_;
+    std::vector<FileRecord> files_;
+    // Binning of sumNumPosMinusNegWeights
+    int nBins_;
+    double xMin_;
+    double xMax_;
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef _fnv1a_hpp_
+#define _fnv1a_hpp_
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+// 64 bit FNV-1a. Stable between builds and platforms, unlike std::hash, so
+// fit for anything written to disk.
+class Fnv1a
+{
+    public:
+    void add(const char* data, const size_t size)
+    {
+        for (size_t i{0}; i < size; i++)
+        {
+            hash_ ^= static_cast<unsigned char>(data[i]);
+            hash_ *= 1099511628211ULL;
+        }
+    }
+    void add(const std::string& data)
+    {
+        add(data.data(), data.size());
+    }
+    std::uint64_t value() const
+    {
+        return hash_;
+    }
+    std::string hex() const
+    {
+        std::ostringstream out;
+        out << std::hex << std::setw(16) << std::setfill('0') << hash_;
+        return out.str();
+    }
+
+    private:
+    std::uint64_t hash_{14695981039346656037ULL};
+};
+
+#endif
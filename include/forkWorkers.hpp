@@ -0,0 +1,19 @@
+#ifndef _forkWorkers_hpp_
+#define _forkWorkers_hpp_
+
+#include <functional>
+#include <string>
+
+// Runs work(worker, nWorkers) for each worker from 0 to nWorkers - 1, each in
+// a forked process with its own copy of the caller's memory, and waits for
+// them all. work returns whether it succeeded; an exception from it is
+// printed and counts as a failure. Returns whether every worker succeeded.
+//
+// If a worker can't be forked, the ones already started are waited for
+// before a std::runtime_error naming what is thrown, so none outlive the
+// caller's handling of it.
+bool forkWorkers(unsigned nWorkers,
+                 const std::function<bool(unsigned, unsigned)>& work,
+                 const std::string& what);
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef _genAcceptance_hpp_
+#define _genAcceptance_hpp_
+
+#include <string>
+#include <vector>
+
+class AnalysisEvent;
+
+// Gen-level dilepton thresholds for one flavour: at least two leptons within
+// eta, the leading above leadingPt and the subleading above subleadingPt.
+struct LeptonAcceptance
+{
+    double leadingPt;
+    double subleadingPt;
+    double eta;
+};
+
+// One named set of acceptance thresholds. An event is accepted if it passes
+// either the electron or the muon thresholds.
+struct AcceptanceThresholds
+{
+    std::string name;
+    LeptonAcceptance electrons;
+    LeptonAcceptance muons;
+};
+
+// Events passing each step of one set of thresholds
+struct AcceptanceCounts
+{
+    long twoElectrons{0};
+    long electronEta{0};
+    long electronPt{0};
+    long twoMuons{0};
+    long muonEta{0};
+    long muonPt{0};
+    long accepted{0};
+    // Accepted by the first set of thresholds, but not by this one
+    long lostFromFirst{0};
+
+    AcceptanceCounts& operator+=(const AcceptanceCounts& other);
+};
+
+// Evaluates several sets of thresholds on the generator leptons of each
+// event in one pass. The lepton buffers are reused from event to event, so
+// each thread needs its own, merged once they are done.
+class GenAcceptance
+{
+    public:
+    explicit GenAcceptance(std::vector<AcceptanceThresholds> thresholds);
+
+    void fill(const AnalysisEvent& event);
+    void merge(const GenAcceptance& other);
+
+    const std::vector<AcceptanceThresholds>& thresholds() const
+    {
+        return thresholds_;
+    }
+    const std::vector<AcceptanceCounts>& counts() const
+    {
+        return counts_;
+    }
+    long events() const
+    {
+        return events_;
+    }
+
+    private:
+    struct GenLepton
+    {
+        float pt;
+        float absEta;
+    };
+
+    // Adds one to each of two, eta and pt that leptons pass, returning
+    // whether they pass all three
+    static bool passes(const std::vector<GenLepton>& leptons,
+                       const LeptonAcceptance& acceptance,
+                       long& two,
+                       long& eta,
+                       long& pt);
+
+    std::vector<AcceptanceThresholds> thresholds_;
+    std::vector<AcceptanceCounts> counts_;
+    long events_;
+
+    std::vector<GenLepton> electrons_;
+    std::vector<GenLepton> muons_;
+};
+
+#endif
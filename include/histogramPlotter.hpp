@@ -2,6 +2,7 @@
 #define _histogramPlotter_hpp_
 
 #include "TPaveText.h"
+#include "histogramStore.hpp"
 #include "plots.hpp"
 
 #include <map>
@@ -27,6 +28,12 @@ class HistogramPlotter
                           // to aPostfix. Set with setter.
     const bool is2016_; // Era
     bool loadHistos_;
+    unsigned plotJobs_; // Number of worker processes used to draw plots.
+    // Every saved histogram lives in the one store file in histogramDirectory_,
+    // named after the channel postfix so channels can share the directory.
+    // Opened on first use, and reopened when a different mode is asked for.
+    std::string histogramStoreName_;
+    std::unique_ptr<HistogramStore> histogramStore_;
 
     // Orders of various things and information regarding plotting.
     std::vector<std::string> plotOrder_;
@@ -46,6 +53,18 @@ class HistogramPlotter
     // writes the lumi information and the CMS "logo" in the FigGuidelines style
     void CMS_lumi(TPad*, int = 10);
     void setTDRStyle();
+    HistogramStore& histogramStore(HistogramStore::Mode);
+
+    // Everything makePlot needs to draw one plot, so plots can be collected
+    // first and then handed out to the workers.
+    struct PlotJob
+    {
+        std::map<std::string, TH1D*> plotMap;
+        std::string title;
+        std::string name;
+        std::vector<std::string> xAxisLabels;
+    };
+    void renderPlots(const std::vector<PlotJob>&);
 
     public:
     // Constructor
@@ -78,14 +97,23 @@ class HistogramPlotter
     {
         postfix_ = postfix;
     }
+    void setPlotJobs(unsigned plotJobs)
+    {
+        plotJobs_ = plotJobs > 0 ? plotJobs : 1;
+    }
     void setOutputFolder(std::string output);
-    void setHistogramFolder(std::string histoDir);
+    // The store is histoDir/histogramStore_<channel>.root, or
+    // histoDir/histogramStore.root if channel is empty
+    void setHistogramFolder(std::string histoDir, std::string channel);
     void changeExtensions(std::vector<std::string> extentions)
     {
         extensions_ = extentions;
     }
-    // Actual plotting commands
+    // Actual plotting commands. The first argument of plotHistos/saveHistos is
+    // the systematic+channel the plots were made under, and is used as the
+    // top level directory in the histogram store.
     void plotHistos(
+        std::string,
         std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>);
     void loadHistos()
     {
@@ -94,7 +122,10 @@ class HistogramPlotter
     std::map<std::string, TH1D*> loadCutFlowMap(std::string, std::string);
     void saveHistos(std::map<std::string, TH1D*>, std::string, std::string);
     void saveHistos(
+        std::string,
         std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>);
+    // Commits everything saved so far to disk. Also done on destruction.
+    void closeHistogramStore();
     void plotCutFlows(std::map<std::string, TH1D*>);
     void makePlot(std::map<std::string, TH1D*>, std::string, std::string);
     void makePlot(std::map<std::string, TH1D*>,
@@ -0,0 +1,75 @@
+#ifndef _histogramStore_hpp_
+#define _histogramStore_hpp_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TDirectory;
+class TFile;
+class TH1;
+class TH1D;
+
+// A single ROOT file holding every histogram from a run. Histograms are kept
+// in a directory per systematic/channel/stage, e.g. "__JES__plus_ee/bTag", so
+// any one of them can be read back by key without touching the rest.
+//
+// When writing, everything goes to "<path>.tmp" and is flushed to disk (one
+// fsync) and renamed into place on close, so an interrupted job never leaves
+// a half written store behind for a later --useHistos run to pick up.
+class HistogramStore
+{
+    public:
+    enum class Mode
+    {
+        Read,
+        Write
+    };
+
+    HistogramStore(std::string path, Mode mode);
+    ~HistogramStore();
+
+    HistogramStore(const HistogramStore&) = delete;
+    HistogramStore& operator=(const HistogramStore&) = delete;
+
+    // Writes hist into directory dir (created as needed) under the key name.
+    void put(const std::string& dir, const std::string& name, const TH1& hist);
+    // Returns a detached copy of the histogram at dir/name. The caller owns
+    // it. Throws if no such histogram is in the store.
+    TH1D* get(const std::string& dir, const std::string& name) const;
+    bool contains(const std::string& dir, const std::string& name) const;
+    // Full "dir/name" keys of every histogram in the store.
+    std::vector<std::string> keys() const;
+    // Flushes, syncs and renames a store being written. Called by the
+    // destructor if not done explicitly.
+    void close();
+
+    const std::string& path() const
+    {
+        return path_;
+    }
+    Mode mode() const
+    {
+        return mode_;
+    }
+
+    // Adds together the stores in inputs (e.g. one per batch job) key by key
+    // and writes the result as a new store at output. Keys only present in
+    // some of the inputs are copied as they are.
+    static void merge(const std::vector<std::string>& inputs,
+                      const std::string& output);
+
+    private:
+    TDirectory* getOrMakeDirectory(const std::string& dir);
+    static void collect(TDirectory* dir,
+                        const std::string& prefix,
+                        std::map<std::string, std::unique_ptr<TH1>>& histos);
+
+    const std::string path_;
+    const Mode mode_;
+    std::unique_ptr<TFile> file_;
+    std::map<std::string, TDirectory*> directories_;
+};
+
+#endif
@@ -19,10 +19,6 @@ class JetCorrectionUncertainty
     double getUncertainty(const double pt,
                           const double eta,
                           const int jesUD) const;
-    std::pair<double, double> getMetAfterJESUnc(double metPx,
-                                                double metPy,
-                                                const MvaEvent& tree,
-                                                const int jesUD) const;
 
     private:
     std::vector<double> ptMinJEC_;
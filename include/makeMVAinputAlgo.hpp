@@ -1,15 +1,26 @@
 #ifndef _makeMVAinputAlgo_hpp
 #define _makeMVAinputAlgo_hpp_
 
+#include "columnarFile.hpp"
 #include "jetCorrectionUncertainty.hpp"
+#include "metPropagation.hpp"
+#include "mvaInputVars.hpp"
 
+#include <functional>
 #include <map>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+class TEntryList;
+class MvaScorer;
+class TFile;
+class TH1D;
 class TTree;
 class MvaEvent;
 class TLorentzVector;
+class TemplateBuilder;
 
 class MakeMvaInputs
 {
@@ -28,6 +39,17 @@ class MakeMvaInputs
                           const bool useSidebandRegion);
     void dataAnalysis(const std::vector<std::string>& channels,
                       const bool useSidebandRegion);
+    // Fills the output trees for each systematic of a sample in outFile,
+    // returning the yields indexed by systematic, then channel.
+    std::vector<std::vector<long double>>
+        fillSampleTrees(const std::string& sample,
+                        const std::string& outSample,
+                        const std::vector<std::string>& systs,
+                        const std::vector<std::string>& channels,
+                        TFile* outFile);
+    // The entries of an mvaOut tree in the regions being made, from its
+    // regionFlags, or nullptr if every entry should be read
+    std::unique_ptr<TEntryList> selectEntries(TTree* tree) const;
     void sameSignAnalysis(const std::map<std::string, std::string>& listOfMCs,
                           const std::vector<std::string>& channels,
                           const bool useSidebandRegion);
@@ -36,37 +58,52 @@ class MakeMvaInputs
     std::pair<TLorentzVector, TLorentzVector>
         sortOutHadronicW(const MvaEvent* tree,
                          const int syst,
-                         TLorentzVector met,
                          const std::vector<int>& jets) const;
-        std::pair<std::vector<int>, std::vector<TLorentzVector>> getJets(
-            const MvaEvent* tree, const int syst, TLorentzVector met) const;
+    std::pair<std::vector<int>, std::vector<TLorentzVector>>
+        getJets(const MvaEvent* tree, const int syst) const;
     std::pair<std::vector<int>, std::vector<TLorentzVector>>
         getBjets(const MvaEvent* tree,
                  const int syst,
-                 TLorentzVector met,
                  const std::vector<int>& jets) const;
     TLorentzVector getJetVec(const MvaEvent* tree,
                              const int index,
                              const float smearValue,
-                             TLorentzVector& metVec,
-                             const int syst,
-                             const bool doMetSmear) const;
-    TLorentzVector doUncMet(TLorentzVector met,
-                            const TLorentzVector& zLep1,
-                            const TLorentzVector& zLep2,
-                            const std::vector<TLorentzVector>& jetVecs,
-                            const unsigned syst) const;
+                             const int syst) const;
     void setupBranches(TTree* tree);
+    void setupOutputFile(TFile* file) const;
+    // Hands a filled output tree over to file, which writes and deletes it
+    void writeTree(TTree* tree, TFile* file) const;
+    // Writes the current inputVars to a tree and/or its columnar file, and
+    // fills the limit setting templates of category (see TemplateBuilder)
+    void fillOutput(TTree* tree, const std::string& category);
+    // The template category of the events fillTree is given label and
+    // channel for, before any region prefix
+    static std::string templateCategory(const std::string& label,
+                                        const std::string& channel);
+    // Books the templates fillTree could fill for label and channel, so that
+    // they are written even if no event passes
+    void bookTemplates(const std::string& label, const std::string& channel);
+    // Closes the columnar files, writes the score histograms to outFile and
+    // the templates to templates_<outName>.root
+    void closeOutputs(TFile* outFile, const std::string& outName);
+    // The MET of the current event: the stored one, the JES and JER
+    // variations stored in the skim and the unclustered variations
+    MetPropagation propagateMet(const MvaEvent* tree,
+                                const std::string& channel) const;
+    // Fills the MET of the systematic in label from metPropagation
     void fillTree(TTree* outTreeSig,
                   TTree* outTreeSdBnd,
                   MvaEvent* tree,
                   const std::string& label,
                   const std::string& channel,
-                  const bool SameSignMC = false);
+                  const MetPropagation& metPropagation);
 
     // variables?
 
-    std::unordered_map<std::string, float> inputVars;
+    // Values of the variables for the current event, and the slots of those
+    // written out, in branch order
+    MvaInput::Values inputVars;
+    std::vector<unsigned> outputVars;
     bool oldMetFlag;
     bool ttbarControlRegion;
     bool useSidebandRegion;
@@ -78,6 +115,37 @@ class MakeMvaInputs
     std::string inputDir;
     std::string outputDir;
     std::string era;
+    unsigned jobs;
+    std::string variablesConf;
+    std::string outputFormat;
+    bool writeRoot;
+    bool writeColumnar;
+    std::string compression;
+    int compressionSettings; // -1 for ROOT's default
+    int basketSize; // 0 for ROOT's default
+    long long autoFlush; // 0 for ROOT's default
+    // Columnar output of each output tree, when writing it, by tree name, as
+    // writeTree can delete the trees before the outputs are closed
+    std::map<std::string, std::unique_ptr<ColumnarWriter>, std::less<>>
+        columnarOutputs;
+    std::vector<float> columnarRow;
+    std::string scoringConf;
+    std::unique_ptr<MvaScorer> scorer;
+    // Template histograms of each method's response, by output tree name
+    std::map<std::string, std::vector<std::unique_ptr<TH1D>>, std::less<>>
+        scoreHistograms;
+    std::string templatesConf;
+    std::unique_ptr<TemplateBuilder> templates;
+    // While set, fillOutput holds events in bufferedRows instead of writing
+    // them, e.g. until a weight they need is known
+    struct BufferedRow
+    {
+        TTree* tree;
+        std::string category;
+        MvaInput::Values values;
+    };
+    bool bufferOutput;
+    std::vector<BufferedRow> bufferedRows;
 };
 
 #endif
@@ -0,0 +1,97 @@
+#ifndef _metPropagation_hpp_
+#define _metPropagation_hpp_
+
+#include "TLorentzVector.h"
+
+#include <array>
+
+// Propagates jet corrections and the unclustered energy variation to the MET
+// of one event. The jets and leptons are added once, accumulating the
+// transverse sums each variation needs, after which every variation is a
+// closed form in those sums; nothing has to be looped over again per
+// systematic.
+//
+// The nominal MET is the stored one, which already has the nominal jet
+// corrections in it. Each jet variation replaces the nominally corrected jets
+// with the varied ones: MET + sum(nominal) - sum(varied). The unclustered
+// variation shifts the nominal MET by unclusteredShift times the unclustered
+// energy, nominal MET + leptons + nominal jets, unless the ntuple's own
+// unclustered variations are given with setUnclusteredEt.
+//
+// Cuts makes one per event from every jet, before the systematics are looped
+// over, and the skims store its jet variations. MakeMvaInputs reads those back
+// with setJetVariation, so both see the same MET.
+class MetPropagation
+{
+    public:
+    enum class Variation
+    {
+        nominal,
+        jesUp,
+        jesDown,
+        jerUp,
+        jerDown,
+        unclusteredUp,
+        unclusteredDown
+    };
+
+    // The jet variations, in the order the skims store them
+    static constexpr std::array<Variation, 4> jetVariations{
+        {Variation::jesUp,
+         Variation::jesDown,
+         Variation::jerUp,
+         Variation::jerDown}};
+
+    static constexpr double unclusteredShift{0.1};
+
+    MetPropagation(double metPx, double metPy);
+
+    void addLepton(const TLorentzVector& lepton);
+    // jet is the uncorrected momentum, the smear factors are the nominal and
+    // JER up/down ones, and the JES uncertainties are the (signed) fractional
+    // shifts of the smeared jet for JES up/down.
+    void addJet(const TLorentzVector& jet,
+                double smear,
+                double smearUp,
+                double smearDown,
+                double jesUncUp,
+                double jesUncDown);
+    // Shorthand for a jet with only a nominal correction
+    void addJet(const TLorentzVector& jet, double smear = 1.);
+
+    // Use these MET magnitudes, along the nominal MET, for the unclustered
+    // variations instead of the closed form
+    void setUnclusteredEt(double up, double down);
+    // Use this MET for a JES or JER variation instead of the one from the
+    // added jets, e.g. the one stored in the skim
+    void setJetVariation(Variation variation, const TLorentzVector& met);
+
+    TLorentzVector met(Variation variation) const;
+
+    private:
+    // Indices of the jet variations' shifts from the nominal MET
+    enum : unsigned
+    {
+        jesUpShift,
+        jesDownShift,
+        jerUpShift,
+        jerDownShift,
+        numJetShifts
+    };
+    static unsigned jetShift(Variation variation);
+
+    double metPx_;
+    double metPy_;
+    double leptonPx_;
+    double leptonPy_;
+    // The nominally corrected jets
+    double jetPx_;
+    double jetPy_;
+    std::array<double, numJetShifts> shiftPx_;
+    std::array<double, numJetShifts> shiftPy_;
+    bool fixedUnclustered_;
+    double unclusteredUpEt_;
+    double unclusteredDownEt_;
+};
+
+#endif
@@ -0,0 +1,325 @@
+#ifndef _mvaInputVars_hpp_
+#define _mvaInputVars_hpp_
+
+#include <array>
+#include <string>
+
+// The variables MakeMvaInputs writes to the MVA input trees. Each has a fixed
+// slot in a dense array, so filling them is plain indexing rather than a
+// string lookup per variable per event. The IDs are also the index into
+// branches, which gives the branch (and leaf) each one is written to.
+namespace MvaInput
+{
+enum : unsigned
+{
+    chan,
+    eventNumber,
+    eventWeight,
+    bEta,
+    bPhi,
+    bPt,
+    bbTag,
+    chi2,
+    j1Eta,
+    j1Phi,
+    j1Pt,
+    j1bDelR,
+    j1bTag,
+    j1j2DelR,
+    j1j3DelR,
+    j1j4DelR,
+    j1l1DelR,
+    j1l2DelR,
+    j1tDelR,
+    j1wDelR,
+    j1wj1DelR,
+    j1wj2DelR,
+    j1zDelR,
+    j2Eta,
+    j2Phi,
+    j2Pt,
+    j2bDelR,
+    j2bTag,
+    j2j3DelR,
+    j2j4DelR,
+    j2l1DelR,
+    j2l2DelR,
+    j2tDelR,
+    j2wDelR,
+    j2wj1DelR,
+    j2wj2DelR,
+    j2zDelR,
+    j3Eta,
+    j3Phi,
+    j3Pt,
+    j3bDelR,
+    j3bTag,
+    j3j4DelR,
+    j3l1DelR,
+    j3l2DelR,
+    j3tDelR,
+    j3wDelR,
+    j3wj1DelR,
+    j3wj2DelR,
+    j3zDelR,
+    j4Eta,
+    j4Phi,
+    j4Pt,
+    j4bDelR,
+    j4bTag,
+    j4l1DelR,
+    j4l2DelR,
+    j4tDelR,
+    j4wDelR,
+    j4wj1DelR,
+    j4wj2DelR,
+    j4zDelR,
+    j5Eta,
+    j5Phi,
+    j5Pt,
+    j5bTag,
+    j6Eta,
+    j6Phi,
+    j6Pt,
+    j6bTag,
+    jetMass,
+    jetMass3,
+    jetMt,
+    jetPt,
+    l1D0,
+    l1Eta,
+    l1Phi,
+    l1Pt,
+    l1RelIso,
+    l1bDelR,
+    l1tDelR,
+    l1wj1DelR,
+    l1wj2DelR,
+    l2D0,
+    l2DelR,
+    l2Eta,
+    l2Phi,
+    l2Pt,
+    l2RelIso,
+    l2bDelR,
+    l2tDelR,
+    l2wj1DelR,
+    l2wj2DelR,
+    met,
+    nBjets,
+    nJets,
+    tEta,
+    tMass,
+    tMt,
+    tPhi,
+    tPt,
+    tbDelR,
+    totMass,
+    totMt,
+    totPt,
+    wEta,
+    wMass,
+    wMt,
+    wPhi,
+    wPt,
+    wbDelR,
+    wj1DelR,
+    wj1Eta,
+    wj1Phi,
+    wj1Pt,
+    wj1bDelR,
+    wj1tDelR,
+    wj2DelR,
+    wj2Eta,
+    wj2Phi,
+    wj2Pt,
+    wj2bDelR,
+    wj2tDelR,
+    wtDelR,
+    w1w2DelR,
+    wZDelR,
+    zEta,
+    zMass,
+    zMt,
+    zPhi,
+    zPt,
+    zbDelR,
+    zjMaxR,
+    zjMinR,
+    ztDelR,
+    zwj1DelR,
+    zwj2DelR,
+    zzDelR,
+    numVars
+};
+
+struct Branch
+{
+    std::string name;
+    std::string leaf;
+};
+
+const std::array<Branch, numVars> branches{{
+      {"Channel", "Channel/F"},
+      {"EvtNumber", "EvtNumber/F"},
+      {"EvtWeight", "EvtWeight/F"},
+      {"bEta", "bEta/F"},
+      {"bPhi", "bPhi/F"},
+      {"bPt", "bPt/F"},
+      {"bbTag", "bbTag/F"},
+      {"chi2", "chi2/F"},
+      {"j1Eta", "j1Eta/F"},
+      {"j1Phi", "j1Phi/F"},
+      {"j1Pt", "j1Pt/F"},
+      {"j1bDelR", "j1bDelR/F"},
+      {"j1bTag", "j1bTag/F"},
+      {"j1j2DelR", "j1j2DelR/F"},
+      {"j1j3DelR", "j1j3DelR/F"},
+      {"j1j4DelR", "j1j4DelR/F"},
+      {"j1l1DelR", "j1l1DelR/F"},
+      {"j1l2DelR", "j1l2DelR/F"},
+      {"j1tDelR", "j1tDelR/F"},
+      {"j1wDelR", "j1wDelR/F"},
+      {"j1wj1DelR", "j1wj1DelR/F"},
+      {"j1wj2DelR", "j1wj2DelR/F"},
+      {"j1zDelR", "j1zDelR/F"},
+      {"j2Eta", "j2Eta/F"},
+      {"j2Phi", "j2Phi/F"},
+      {"j2Pt", "j2Pt/F"},
+      {"j2bDelR", "j2bDelR/F"},
+      {"j2bTag", "j2bTag/F"},
+      {"j2j3DelR", "j2j3DelR/F"},
+      {"j2j4DelR", "j2j4DelR/F"},
+      {"j2l1DelR", "j2l1DelR/F"},
+      {"j2l2DelR", "j2l2DelR/F"},
+      {"j2tDelR", "j2tDelR/F"},
+      {"j2wDelR", "j2wDelR/F"},
+      {"j2wj1DelR", "j2wj1DelR/F"},
+      {"j2wj2DelR", "j2wj2DelR/F"},
+      {"j2zDelR", "j2zDelR/F"},
+      {"j3Eta", "j3Eta/F"},
+      {"j3Phi", "j3Phi/F"},
+      {"j3Pt", "j3Pt/F"},
+      {"j3bDelR", "j3bDelR/F"},
+      {"j3bTag", "j3bTag/F"},
+      {"j3j4DelR", "j3j4DelR/F"},
+      {"j3l1DelR", "j3l1DelR/F"},
+      {"j3l2DelR", "j3l2DelR/F"},
+      {"j3tDelR", "j3tDelR/F"},
+      {"j3wDelR", "j3wDelR/F"},
+      {"j3wj1DelR", "j3wj1DelR/F"},
+      {"j3wj2DelR", "j3wj2DelR/F"},
+      {"j3zDelR", "j3zDelR/F"},
+      {"j4Eta", "j4Eta/F"},
+      {"j4Phi", "j4Phi/F"},
+      {"j4Pt", "j4Pt/F"},
+      {"j4bDelR", "j4bDelR/F"},
+      {"j4bTag", "j4bTag/F"},
+      {"j4l1DelR", "j4l1DelR/F"},
+      {"j4l2DelR", "j4l2DelR/F"},
+      {"j4tDelR", "j4tDelR/F"},
+      {"j4wDelR", "j4wDelR/F"},
+      {"j4wj1DelR", "j4wj1DelR/F"},
+      {"j4wj2DelR", "j4wj2DelR/F"},
+      {"j4zDelR", "j4zDelR/F"},
+      {"j5Eta", "j5Eta/F"},
+      {"j5Phi", "j5Phi/F"},
+      {"j5Pt", "j5Pt/F"},
+      {"j5bTag", "j5bTag/F"},
+      {"j6Eta", "j6Eta/F"},
+      {"j6Phi", "j6Phi/F"},
+      {"j6Pt", "j6Pt/F"},
+      {"j6bTag", "j6bTag/F"},
+      {"jetMass", "jetMass/F"},
+      {"jetMass3", "jetMass3/F"},
+      {"jetMt", "jetMt/F"},
+      {"jetPt", "jetPt/F"},
+      {"l1D0", "l1D0/F"},
+      {"l1Eta", "l1Eta/F"},
+      {"l1Phi", "l1Phi/F"},
+      {"l1Pt", "l1Pt/F"},
+      {"l1RelIso", "l1RelIso/F"},
+      {"l1bDelR", "l1bDelR/F"},
+      {"l1tDelR", "l1tDelR/F"},
+      {"l1wj1DelR", "l1wj1DelR/F"},
+      {"l1wj2DelR", "l1wj2DelR/F"},
+      {"l2D0", "l2D0/F"},
+      {"l2DelR", "l2DelR/F"},
+      {"l2Eta", "l2Eta/F"},
+      {"l2Phi", "l2Phi/F"},
+      {"l2Pt", "l2Pt/F"},
+      {"l2RelIso", "l2RelIso/F"},
+      {"l2bDelR", "l2bDelR/F"},
+      {"l2tDelR", "l2tDelR/F"},
+      {"l2wj1DelR", "l2wj1DelR/F"},
+      {"l2wj2DelR", "l2wj2DelR/F"},
+      {"met", "met/F"},
+      {"nBjets", "nBjets/F"},
+      {"nJets", "nJets/F"},
+      {"tEta", "tEta/F"},
+      {"tMass", "tMass/F"},
+      {"tMt", "tMt/F"},
+      {"tPhi", "tPhi/F"},
+      {"tPt", "tPt/F"},
+      {"tbDelR", "tbDelR/F"},
+      {"totMass", "toMass/F"},
+      {"totMt", "totMt/F"},
+      {"totPt", "totPt/F"},
+      {"wEta", "wEta/F"},
+      {"wMass", "wMass/F"},
+      {"wMt", "wMt/F"},
+      {"wPhi", "wPhi/F"},
+      {"wPt", "wPt/F"},
+      {"wbDelR", "wbDelR/F"},
+      {"wj1DelR", "wj1DelR/F"},
+      {"wj1Eta", "wj1Eta/F"},
+      {"wj1Phi", "wj1Phi/F"},
+      {"wj1Pt", "wj1Pt/F"},
+      {"wj1bDelR", "wj1bDelR/F"},
+      {"wj1tDelR", "wj1tDelR/F"},
+      {"wj2DelR", "wj2DelR/F"},
+      {"wj2Eta", "wj2Eta/F"},
+      {"wj2Phi", "wj2Phi/F"},
+      {"wj2Pt", "wj2Pt/F"},
+      {"wj2bDelR", "wj2bDelR/F"},
+      {"wj2tDelR", "wj2tDelR/F"},
+      {"wtDelR", "wtDelR/F"},
+      {"wwDelR", "wwDelR/F"},
+      {"wzDelR", "wzDelR/F"},
+      {"zEta", "zEta/F"},
+      {"zMass", "zMass/F"},
+      {"zMt", "zMt/F"},
+      {"zPhi", "zPhi/F"},
+      {"zPt", "zPt/F"},
+      {"zbDelR", "zbDelR/F"},
+      {"zjMaxR", "zjMaxR/F"},
+      {"zjMinR", "zjMinR/F"},
+      {"ztDelR", "ztDelR/F"},
+      {"zwj1DelR", "zwj1DelR/F"},
+      {"zwj2DelR", "zwj2DelR/F"},
+      {"zzDelR", "zzDelR/F"}}};
+
+typedef std::array<float, numVars> Values;
+
+// Slots of the per-jet variables for the four leading jets, by jet index. The
+// jet-jet table is only filled above the diagonal.
+const std::array<std::array<unsigned, 4>, 4> jetJetDelR{
+    {{numVars, j1j2DelR, j1j3DelR, j1j4DelR},
+     {numVars, numVars, j2j3DelR, j2j4DelR},
+     {numVars, numVars, numVars, j3j4DelR},
+     {numVars, numVars, numVars, numVars}}};
+const std::array<unsigned, 4> jetBDelR{j1bDelR, j2bDelR, j3bDelR, j4bDelR};
+const std::array<unsigned, 4> jetTDelR{j1tDelR, j2tDelR, j3tDelR, j4tDelR};
+const std::array<unsigned, 4> jetL1DelR{
+    j1l1DelR, j2l1DelR, j3l1DelR, j4l1DelR};
+const std::array<unsigned, 4> jetL2DelR{
+    j1l2DelR, j2l2DelR, j3l2DelR, j4l2DelR};
+const std::array<unsigned, 4> jetZDelR{j1zDelR, j2zDelR, j3zDelR, j4zDelR};
+const std::array<unsigned, 4> jetWj1DelR{
+    j1wj1DelR, j2wj1DelR, j3wj1DelR, j4wj1DelR};
+const std::array<unsigned, 4> jetWj2DelR{
+    j1wj2DelR, j2wj2DelR, j3wj2DelR, j4wj2DelR};
+const std::array<unsigned, 4> jetWDelR{j1wDelR, j2wDelR, j3wDelR, j4wDelR};
+} // namespace MvaInput
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef _mvaRegions_hpp_
+#define _mvaRegions_hpp_
+
+#include <cmath>
+
+// Regions an MVA tree entry can belong to. analysisMain.exe stores them as a
+// bit mask in the regionFlags branch of each entry, so that makeMVAinputMain.exe
+// can pick out the entries it needs before reading the rest of the event.
+namespace MvaRegion
+{
+enum : unsigned
+{
+    signal = 1 << 0, // chi2 below the sideband
+    sideband = 1 << 1, // chi2 in the sideband
+    ttbarCR = 1 << 2, // emu selection
+    zPlusJetsCR = 1 << 3 // Old Z+jets CR (zero b-jets) selection
+};
+
+constexpr double W_MASS{80.385};
+constexpr double TOP_MASS{173.1};
+
+// from scripts/plotMassPeaks.py
+constexpr double W_SIGMA{8};
+constexpr double TOP_SIGMA{30};
+
+constexpr double MIN_SIDEBAND_CHI2{40};
+constexpr double MAX_SIDEBAND_CHI2{150};
+
+inline double chi2(const double wMass, const double topMass)
+{
+    const double wChi2Term{(wMass - W_MASS) / W_SIGMA};
+    const double topChi2Term{(topMass - TOP_MASS) / TOP_SIGMA};
+    return std::pow(wChi2Term, 2) + std::pow(topChi2Term, 2);
+}
+
+// The signal or sideband flag for a chi2, or 0 if it is in neither. Takes the
+// chi2 at the precision it is written to the MVA inputs with, so that both
+// sides agree on entries right at the boundaries.
+inline unsigned chi2Region(const float chi2)
+{
+    if (chi2 < MIN_SIDEBAND_CHI2)
+    {
+        return signal;
+    }
+    if (chi2 < MAX_SIDEBAND_CHI2)
+    {
+        return sideband;
+    }
+    return 0;
+}
+} // namespace MvaRegion
+
+#endif
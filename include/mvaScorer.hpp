@@ -0,0 +1,66 @@
+#ifndef _mvaScorer_hpp_
+#define _mvaScorer_hpp_
+
+#include "mvaInputVars.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TMVA
+{
+class Reader;
+}
+
+// A trained TMVA method to evaluate, the branch its response is written to
+// and the binning of its template histograms.
+struct MvaMethod
+{
+    std::string name; // e.g. BDTG
+    std::string weights; // TMVA .weights.xml file
+    std::string branch;
+    int nBins;
+    double xMin;
+    double xMax;
+};
+
+// Evaluates trained TMVA methods on the MVA input variables of the current
+// event, so makeMVAinputMain can write the responses and their templates
+// itself instead of leaving it to a separate pass over the output trees.
+//
+// The reader is pointed straight at the slots of the given Values array, so
+// evaluating copies nothing; the weight files are read once, here.
+class MvaScorer
+{
+    public:
+    // variables and spectators are MVA input branch names, in the order the
+    // methods were trained with
+    MvaScorer(MvaInput::Values& inputVars,
+              const std::vector<std::string>& variables,
+              const std::vector<std::string>& spectators,
+              std::vector<MvaMethod> methods);
+    ~MvaScorer();
+    MvaScorer(const MvaScorer&) = delete;
+    MvaScorer& operator=(const MvaScorer&) = delete;
+
+    // Evaluates every method on the current contents of inputVars
+    void evaluate();
+
+    const std::vector<MvaMethod>& methods() const
+    {
+        return methods_;
+    }
+    // Response of each method to the last event evaluated, in method order.
+    // The addresses are stable, so can be given to TTree::Branch.
+    std::vector<float>& scores()
+    {
+        return scores_;
+    }
+
+    private:
+    const std::vector<MvaMethod> methods_;
+    std::vector<float> scores_;
+    std::unique_ptr<TMVA::Reader> reader_;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef _nplEstimator_hpp_
+#define _nplEstimator_hpp_
+
+#include <string>
+#include <thread>
+#include <vector>
+
+class MvaEvent;
+
+// Data driven estimate of the non-prompt lepton (NPL) background. The NPL
+// shape is taken from same sign (SS) data, minus the prompt SS MC, and scaled
+// by the transfer factor from SS to opposite sign (OS) non-prompt events,
+// measured in MC with the generator level promptness of the Z leptons.
+namespace Npl
+{
+// Weighted counts of MC events with both Z leptons prompt, and the rest
+struct Counts
+{
+    double promptSumW{0};
+    double promptSumW2{0};
+    double nonPromptSumW{0};
+    double nonPromptSumW2{0};
+
+    void add(bool prompt, double weight);
+    Counts& operator+=(const Counts& other);
+};
+
+struct TransferFactor
+{
+    double value;
+    double error; // Statistical, from the MC
+};
+
+// The MC samples the transfer factor is measured in: the processes with
+// non-prompt leptons in the signal region, as fakeLeptonEstimation.py used.
+// The other same sign MC is still subtracted from the data.
+const std::vector<std::string>& transferFactorSamples(bool is2016);
+// Whether both Z leptons of an MC event are prompt (decayed or final state)
+bool isPrompt(const MvaEvent& event, const std::string& channel);
+// Counts the events in the "tree" of an MVA skim, reading only the branches
+// needed to do so. Safe to run in several threads at once.
+Counts countFile(const std::string& path, const std::string& channel);
+// N(non-prompt OS) / N(non-prompt SS). The SS MC weights are negated in the
+// skims so the prompt part subtracts from the data, so the magnitude is used.
+TransferFactor transferFactor(const Counts& oppositeSign,
+                              const Counts& sameSign);
+
+// Counts a set of skims in background threads, so that they can be read
+// while the caller reads something else.
+class FileCounter
+{
+    public:
+    FileCounter(std::vector<std::string> paths,
+                std::string channel,
+                unsigned nThreads);
+    ~FileCounter();
+    FileCounter(const FileCounter&) = delete;
+    FileCounter& operator=(const FileCounter&) = delete;
+
+    // Waits for the threads and returns the summed counts. Throws if any
+    // file couldn't be read.
+    Counts get();
+
+    private:
+    const std::vector<std::string> paths_;
+    const std::string channel_;
+    std::vector<Counts> counts_;
+    std::vector<std::string> errors_;
+    std::vector<std::thread> threads_;
+};
+} // namespace Npl
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef _objectSelection_hpp_
+#define _objectSelection_hpp_
+
+#include <vector>
+
+class AnalysisEvent;
+namespace YAML
+{
+class Node;
+}
+
+// Thresholds for one lepton collection. The first lepton accepted has to be
+// above ptLeading, and every later one above pt.
+struct LeptonThresholds
+{
+    double pt;
+    double ptLeading;
+    double eta;
+    double relIso;
+};
+
+// The electron, muon and jet identification and MET filters, shared by Cuts
+// and TriggerScaleFactors so that both select objects the same way. Each tool
+// sets its defaults, which the cuts block of its configuration file can then
+// override with configure().
+class ObjectSelection
+{
+    public:
+    enum class JetId
+    {
+        loose, // 2016 recommendation
+        tightLepVeto // 2017 recommendation
+    };
+
+    explicit ObjectSelection(const bool is2016);
+
+    // Reads the thresholds given under tightElectrons, looseElectrons,
+    // tightMuons and looseMuons (pt, ptLeading, eta, relIso), jets (id: loose
+    // or tightLepVeto) and metFilters (eeBadScFilter), keeping the current
+    // value of any left out.
+    void configure(const YAML::Node& cuts);
+
+    [[gnu::pure]] std::vector<int>
+        tightElectrons(const AnalysisEvent& event) const;
+    [[gnu::pure]] std::vector<int>
+        looseElectrons(const AnalysisEvent& event) const;
+    [[gnu::pure]] std::vector<int> tightMuons(const AnalysisEvent& event) const;
+    [[gnu::pure]] std::vector<int> looseMuons(const AnalysisEvent& event) const;
+
+    // Whether jet index, with corrected pseudorapidity eta, passes jetId
+    [[gnu::pure]] bool passesJetId(const AnalysisEvent& event,
+                                   const int index,
+                                   const double eta) const;
+    [[gnu::pure]] bool metFilters(const AnalysisEvent& event,
+                                  const bool isMC) const;
+
+    [[gnu::const]] static double deltaR(const double eta1,
+                                        const double phi1,
+                                        const double eta2,
+                                        const double phi2);
+    [[gnu::const]] static double deltaPhi(const double phi1, const double phi2);
+
+    LeptonThresholds tightElectron;
+    LeptonThresholds looseElectron;
+    LeptonThresholds tightMuon;
+    LeptonThresholds looseMuon;
+    JetId jetId;
+    // Also require Flag_eeBadScFilter in data
+    bool eeBadScFilter;
+
+    private:
+    bool is2016_;
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "AnalysisEvent.hpp"
 
+#include <array>
 #include <functional>
 #include <string>
 #include <unordered_map>
@@ -11,11 +12,37 @@
 typedef struct plot plot;
 
 class TH1D;
+class Plots;
+
+// Integer IDs for the selection stages, in the order Cuts::makeCuts applies
+// them. The IDs double as the cut flow bin (ID + 0.5) and as the bit for the
+// stage in a Cuts::StageRecord mask.
+namespace CutStage
+{
+enum : unsigned
+{
+    lepSel,
+    zMass,
+    jetSel,
+    bTag,
+    wMass,
+    numStages
+};
+
+const std::array<std::string, numStages> names{
+    {"lepSel", "zMass", "jetSel", "bTag", "wMass"}};
+} // namespace CutStage
+
+// The plots for each stage of one dataset/systematic/channel, indexed by
+// CutStage ID.
+typedef std::array<Plots*, CutStage::numStages> StagePlots;
 
 class Plots
 {
     private:
     std::vector<plot> plotPoint;
+    // Indices into plotPoint of the plots that are filled at this stage.
+    std::vector<unsigned> fillIndices_;
 
     public:
     Plots(const std::vector<std::string> titles,
@@ -0,0 +1,37 @@
+#ifndef _progressMeter_hpp_
+#define _progressMeter_hpp_
+
+#include <chrono>
+#include <string>
+
+// A progress line for an event loop, redrawn at most a few times a second
+// however fast the loop is. update() is cheap enough to call for every event:
+// it only looks at the clock every so often and only formats anything when
+// the line is due to be redrawn.
+class ProgressMeter
+{
+    public:
+    ProgressMeter(std::string label, long total);
+
+    void update(const long done, const long found)
+    {
+        if ((done & 0x3ff) == 0 && Clock::now() >= nextDraw_)
+        {
+            draw(done, found);
+        }
+    }
+    // Draws the final state and ends the line
+    void finish(long done, long found);
+
+    private:
+    using Clock = std::chrono::steady_clock;
+
+    void draw(long done, long found);
+
+    std::string label_;
+    long total_;
+    Clock::time_point start_;
+    Clock::time_point nextDraw_;
+};
+
+#endif
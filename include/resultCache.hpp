@@ -0,0 +1,55 @@
+#ifndef _resultCache_hpp_
+#define _resultCache_hpp_
+
+#include "histogramStore.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Keeps the results of processing one dataset in one channel, so that a re-run
+// with the same inputs, configuration and code can pick them up instead of
+// running over the events again.
+//
+// Each entry is a HistogramStore with the dataset's own histograms and cut
+// flows, plus a manifest holding the key the entry was made with and the
+// size/mtime of any other files it produced (e.g. the MVA tree). The key is
+// free text built by the caller from everything that can change the result;
+// an entry is only used if its key matches exactly and its output files are
+// untouched.
+class ResultCache
+{
+    public:
+    explicit ResultCache(std::string cacheDir);
+
+    bool isValid(const std::string& name, const std::string& key) const;
+    std::unique_ptr<HistogramStore> readHistograms(const std::string& name) const;
+    std::unique_ptr<HistogramStore>
+        writeHistograms(const std::string& name) const;
+    // Writes the manifest, making the entry valid. Call after the store from
+    // writeHistograms has been closed and the outputs are complete.
+    void commit(const std::string& name,
+                const std::string& key,
+                const std::vector<std::string>& outputs) const;
+
+    // Fingerprints for use in keys. fileFingerprint uses the size and mtime
+    // of a file, fileSetFingerprint that of all files with the given extension
+    // (any, if empty) in the given directories, and contentFingerprint hashes
+    // a file's contents.
+    static std::string fileFingerprint(const std::string& path);
+    static std::string
+        fileSetFingerprint(const std::vector<std::string>& locations,
+                           const std::string& extension = ".root");
+    static std::string contentFingerprint(const std::string& path);
+    // Hash of the analysis library this is running from, so a rebuild with
+    // different code invalidates every entry.
+    static std::string buildHash();
+
+    private:
+    std::string manifestPath(const std::string& name) const;
+    std::string storePath(const std::string& name) const;
+
+    const std::string cacheDir_;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef _syntheticNtuple_hpp_
+#define _syntheticNtuple_hpp_
+
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+class AnalysisEvent;
+
+// The multiplicities and rates of the events SyntheticNtuple generates. The
+// defaults are roughly those of a dilepton skim.
+struct SyntheticRates
+{
+    // Mean numbers of reco objects and vertices, each Poisson distributed
+    double electrons{0.8};
+    double muons{0.8};
+    double jets{4.5};
+    double vertices{25.};
+    // Events with a Z -> ee or mumu decay, on top of the leptons above
+    double zFraction{0.4};
+    // Jets from b quarks
+    double bFraction{0.15};
+    // Probability of each HLT path (all of its versions together) and each
+    // MET filter firing
+    double triggerRate{0.25};
+    double metFilterRate{0.995};
+};
+
+// Random but plausible events with the branches AnalysisEvent reads in one
+// year's MC or data layout, for benchmarking without the real skims. The
+// layout is recorded from the AnalysisEvent constructor itself, so it follows
+// any branch added there.
+class SyntheticNtuple
+{
+    public:
+    // One branch AnalysisEvent reads. Arrays are sized by their counter
+    // branch, up to capacity.
+    struct Branch
+    {
+        std::string name;
+        void* address;
+        char type; // I, F or D, as in a leaf list
+        std::string counter;
+        size_t capacity;
+    };
+
+    SyntheticNtuple(bool isMC,
+                    bool is2016,
+                    unsigned seed,
+                    const SyntheticRates& rates = {});
+    ~SyntheticNtuple();
+
+    // The event each new one is generated into. It isn't attached to a file,
+    // so only next() changes it.
+    AnalysisEvent& event()
+    {
+        return *event_;
+    }
+    const std::vector<Branch>& branches() const
+    {
+        return branches_;
+    }
+
+    // Fills event() with the next event
+    void next();
+    // Writes numEvents new events to a tree called "tree" in path
+    void write(const std::string& path, long numEvents);
+
+    private:
+    class BranchRecorder;
+
+    struct Particle
+    {
+        float pt;
+        float eta;
+        float phi;
+        int charge;
+        // Jet flavour, or lepton PDG ID
+        int id;
+        bool prompt;
+    };
+
+    void addZ(std::vector<Particle>& electrons, std::vector<Particle>& muons);
+    void addGenParticle(const Particle& particle, float mass, int motherId);
+    void fillElectron(int i, const Particle& electron);
+    void fillMuon(int i, const Particle& muon);
+    void fillJet(int i, const Particle& jet);
+
+    double uniform(double min = 0., double max = 1.);
+    double gaus(double mean, double sigma);
+    double exponential(double mean);
+    int poisson(double mean);
+
+    const bool isMC_;
+    const bool is2016_;
+    const SyntheticRates rates_;
+    std::mt19937 rng_;
+
+    // Declared before event_, which refers to it until it is destroyed
+    std::unique_ptr<BranchRecorder> recorder_;
+    std::unique_ptr<AnalysisEvent> event_;
+    std::vector<Branch> branches_;
+    // The versions of each HLT path, which fire together, and the MET filters
+    std::vector<std::vector<int*>> triggers_;
+    std::vector<int*> metFilters_;
+    long eventNumber_;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef _templateBuilder_hpp_
+#define _templateBuilder_hpp_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TH1D;
+
+// An observable to make limit setting templates of, and its binning.
+// variable is the MVA input branch (or MvaScorer branch) it is filled from.
+struct TemplateObservable
+{
+    std::string name;
+    std::string variable;
+    int nBins;
+    double xMin;
+    double xMax;
+};
+
+// Fills binned templates of a set of observables as events are written, so
+// the limit setting inputs come straight out of makeMVAinputMain rather than
+// from another pass over its trees.
+//
+// Each template is named for combine/theta, "<observable>_<category>", where
+// the caller's category is e.g. "ee__tZq" or "ee__tZq__jes__plus". Values
+// are read through the given pointers, which must stay valid while filling.
+class TemplateBuilder
+{
+    public:
+    TemplateBuilder(std::vector<TemplateObservable> observables,
+                    std::vector<const float*> values);
+    ~TemplateBuilder();
+    TemplateBuilder(const TemplateBuilder&) = delete;
+    TemplateBuilder& operator=(const TemplateBuilder&) = delete;
+
+    // Makes every observable's (empty) template for category, if not already
+    // made, so that it is written even if nothing is filled in it
+    std::vector<std::unique_ptr<TH1D>>& book(const std::string& category);
+    // Fills every observable's template for category with the current values
+    void fill(const std::string& category, double weight);
+    // Writes every template booked since the last write to a new file at path
+    // and starts afresh. Does nothing if none were.
+    void write(const std::string& path);
+
+    private:
+    const std::vector<TemplateObservable> observables_;
+    const std::vector<const float*> values_;
+    std::map<std::string, std::vector<std::unique_ptr<TH1D>>> templates_;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef _traceEvents_hpp_
+#define _traceEvents_hpp_
+
+// Scoped timers for the parts of the event loop that perf can't tell apart,
+// as they are mostly inlined or spent inside ROOT:
+//
+//   TRACE_SCOPE("bTag");
+//
+// times the rest of the enclosing block. The name must be a string literal.
+//
+// They compile to nothing unless TQZ_TRACE is defined, e.g. by building with
+// make TRACE=1. Each thread then records its scopes, which are written at exit
+// as a Chrome trace (chrome://tracing or ui.perfetto.dev) to $TQZ_TRACE_FILE,
+// or trace_<pid>.json, and summed into a flat profile printed to stderr. Only
+// the first $TQZ_TRACE_LIMIT (default 1000000) scopes of each thread go into
+// the trace, but the profile counts all of them. Forked workers leave with
+// _exit, so they write nothing.
+
+#ifdef TQZ_TRACE
+
+#include <cstdint>
+
+namespace trace
+{
+class Scope
+{
+    public:
+    explicit Scope(const char* name);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    private:
+    const char* const name_;
+    const int64_t start_;
+};
+} // namespace trace
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name)                                                      \
+    const trace::Scope TRACE_CONCAT(traceScope_, __LINE__) { name }
+
+#else
+
+#define TRACE_SCOPE(name) static_cast<void>(0)
+
+#endif
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef _triggerEfficiency_hpp_
+#define _triggerEfficiency_hpp_
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TEfficiency;
+class TLorentzVector;
+class TProfile;
+class TProfile2D;
+
+// The mean trigger decision in bins of one or two lepton variables. It is
+// kept as plain per-bin sums, so copies filled on separate threads can be
+// added together, and only becomes a TProfile or TProfile2D once everything
+// has been merged. The result is the profile that filling one directly with
+// the same values would have given.
+class EfficiencyProfile
+{
+    public:
+    EfficiencyProfile(std::string name,
+                      std::string title,
+                      std::vector<double> xEdges,
+                      std::vector<double> yEdges = {});
+
+    void fill(double x, double passed);
+    void fill(double x, double y, double passed);
+    void merge(const EfficiencyProfile& other);
+
+    // With level > 0, each bin's error is set to the largest distance from
+    // its mean to the Clopper-Pearson interval at that level.
+    std::unique_ptr<TProfile> profile(double level = 0) const;
+    std::unique_ptr<TProfile2D> profile2D() const;
+
+    private:
+    struct Bin
+    {
+        double entries{0};
+        double sum{0};
+        double sum2{0};
+    };
+
+    void fillBin(int bin, double passed);
+
+    std::string name_;
+    std::string title_;
+    std::vector<double> xEdges_;
+    std::vector<double> yEdges_;
+    // In ROOT's global bin order, including underflow and overflow
+    std::vector<Bin> bins_;
+};
+
+// A binning of the trigger efficiencies in one event variable, or two if
+// yVariable is set, read from the binnings file named in the configuration.
+struct EfficiencyBinning
+{
+    std::string name;
+    std::string xVariable;
+    std::vector<double> xEdges;
+    std::string yVariable;
+    std::vector<double> yEdges;
+};
+
+// The per-event values an EfficiencyBinning can be in
+struct EfficiencyVariables
+{
+    enum Variable
+    {
+        lepton1Pt,
+        lepton1Eta,
+        lepton2Pt,
+        lepton2Eta,
+        nVtx,
+        nJets,
+        run,
+        numVariables
+    };
+
+    // Throws if name isn't one of the above
+    static Variable find(const std::string& name);
+
+    std::array<double, numVariables> values;
+};
+
+// The weighted numerator and denominator of an efficiency in one binning.
+// Like EfficiencyProfile it only holds per-bin sums, so thread copies can be
+// merged, and becomes a TEfficiency at the end.
+class BinnedEfficiency
+{
+    public:
+    BinnedEfficiency(std::string name, const EfficiencyBinning& binning);
+
+    // passed is the fraction of the event's weight passing the trigger,
+    // capped at one as TEfficiency needs no more passing than total in a bin
+    void fill(const EfficiencyVariables& variables,
+              double weight,
+              double passed);
+    void merge(const BinnedEfficiency& other);
+
+    // Statistics are Clopper-Pearson at the given level, or the normal
+    // approximation if any weight wasn't one
+    std::unique_ptr<TEfficiency> efficiency(double level) const;
+
+    private:
+    struct Bin
+    {
+        double total{0};
+        double total2{0};
+        double passed{0};
+        double passed2{0};
+    };
+
+    std::string name_;
+    std::string title_;
+    EfficiencyVariables::Variable xVariable_;
+    std::vector<double> xEdges_;
+    // numVariables if one dimensional
+    EfficiencyVariables::Variable yVariable_;
+    std::vector<double> yEdges_;
+    // In ROOT's global bin order, including underflow and overflow
+    std::vector<Bin> bins_;
+};
+
+// Weighted event counts for one channel
+struct TriggerCounts
+{
+    // Passing the lepton selection and the MET triggers
+    double passed{0};
+    // ... and the dilepton triggers too
+    double triggered{0};
+    // Passing the lepton selection, and that and the dilepton triggers. Only
+    // filled for MC, for the correlation (alpha) check.
+    double selected{0};
+    double selectedTriggered{0};
+
+    TriggerCounts& operator+=(const TriggerCounts& other);
+};
+
+// Everything TriggerScaleFactors measures for one channel in MC or data: the
+// counts giving the overall efficiency, its turn-on curves against each
+// lepton and both together, and the efficiency in each configured binning.
+struct ChannelEfficiency
+{
+    ChannelEfficiency(const std::string& name,
+                      const std::string& label,
+                      const std::string& sample,
+                      const std::vector<EfficiencyBinning>& binnings);
+
+    // Fills the turn-on curves and binned efficiencies for an event passing
+    // the lepton selection and MET triggers. Only leptons above etaMinPt go
+    // into the eta curves, and the turn-on curves are unweighted.
+    void fill(const TLorentzVector& lepton1,
+              const TLorentzVector& lepton2,
+              double passed,
+              double etaMinPt,
+              const EfficiencyVariables& variables,
+              double weight);
+    void merge(const ChannelEfficiency& other);
+
+    TriggerCounts counts;
+    EfficiencyProfile lepton1Pt;
+    EfficiencyProfile lepton1Eta;
+    EfficiencyProfile lepton2Pt;
+    EfficiencyProfile lepton2Eta;
+    EfficiencyProfile leptonsPt;
+    EfficiencyProfile leptonsEta;
+    std::vector<BinnedEfficiency> binned;
+};
+
+// The trigger efficiencies of all three channels, in MC and data. Each
+// thread fills its own and they are merged at the end.
+class TriggerEfficiencies
+{
+    public:
+    enum Channel
+    {
+        electrons,
+        muons,
+        muonElectrons,
+        numChannels
+    };
+
+    explicit TriggerEfficiencies(
+        const std::vector<EfficiencyBinning>& binnings = {});
+
+    ChannelEfficiency& get(const bool isMC, const Channel channel)
+    {
+        return channels_[isMC ? 0 : 1][channel];
+    }
+    const ChannelEfficiency& get(const bool isMC, const Channel channel) const
+    {
+        return channels_[isMC ? 0 : 1][channel];
+    }
+    void merge(const TriggerEfficiencies& other);
+
+    // Names used for the plots of each channel
+    static const std::array<std::string, numChannels> names;
+
+    private:
+    // MC then data
+    std::array<std::vector<ChannelEfficiency>, 2> channels_;
+};
+
+#endif
@@ -2,8 +2,11 @@
 #define _triggerScaleFactorsAlgo_hpp_
 
 #include "TCanvas.h"
+#include "TLorentzVector.h"
 #include "TPad.h"
 #include "dataset.hpp"
+#include "objectSelection.hpp"
+#include "triggerEfficiency.hpp"
 
 #include <LHAPDF/LHAPDF.h>
 #include <TH1D.h>
@@ -15,9 +18,6 @@ class TTree;
 class TFile;
 class TH1F;
 class TH2F;
-class TProfile;
-class TProfile2D;
-class TLorentzVector;
 
 class TriggerScaleFactors
 {
@@ -33,6 +33,10 @@ class TriggerScaleFactors
     void runMainAnalysis();
     void savePlots();
 
+    // The thresholds the trigger study has always used, which the cuts file
+    // named in the configuration can override
+    static ObjectSelection defaultSelection(const bool is2016);
+
     private:
     std::string config;
     double usePreLumi;
@@ -40,6 +44,7 @@ class TriggerScaleFactors
     std::string outFolder;
     std::string postfix;
     int numFiles;
+    unsigned jobs;
 
     std::vector<Dataset> datasets;
     double totalLumi;
@@ -64,14 +69,25 @@ class TriggerScaleFactors
     std::vector<double> electronCutsVars;
     std::vector<double> muonCutsVars;
 
-    bool makeJetCuts(AnalysisEvent& event, const bool isMC) const;
+    // Applies the selection to one event and fills the result into
+    // efficiencies. Only reads members, so can be called from many threads.
+    void processEvent(AnalysisEvent& event,
+                      const bool isMC,
+                      TriggerEfficiencies& efficiencies) const;
+
+    // A selected jet: its index and its smeared momentum
+    struct Jet
+    {
+        int index;
+        TLorentzVector vec;
+    };
+    // The selected jets, cleaned against the Z pair leptons
+    std::vector<Jet> getJets(AnalysisEvent& event, const bool isMC) const;
+    bool makeJetCuts(const AnalysisEvent& event,
+                     const std::vector<Jet>& jets) const;
     TLorentzVector getJetLVec(AnalysisEvent& event,
                               const int index,
                               const bool isMC) const;
-    double deltaR(const float eta1,
-                  const float phi1,
-                  const float eta2,
-                  const float phi2) const;
 
     // PU reweighting
     TFile* dataPileupFile;
@@ -86,76 +102,20 @@ class TriggerScaleFactors
     TH1D* puSystUp;
     TH1D* puSystDown;
 
-    // lepton selection
-    std::vector<int> getTightElectrons(const AnalysisEvent& event) const;
-    std::vector<int> getTightMuons(const AnalysisEvent& event) const;
+    // lepton selection, with the thresholds from the configuration file's cuts
+    ObjectSelection selection_;
     bool passDileptonSelection(AnalysisEvent& event,
                                const int nElectrons) const;
 
     // trigger cuts
     bool metTriggerCut(const AnalysisEvent& event) const;
-    bool metFilters(const AnalysisEvent& event, const bool isMC) const;
-
-    // Efficiencies
-    double numberPassedElectrons[2];
-    double numberTriggeredDoubleElectrons[2];
-
-    double numberPassedMuons[2];
-    double numberTriggeredDoubleMuons[2];
-
-    double numberPassedMuonElectrons[2];
-    double numberTriggeredMuonElectrons[2];
-
-    // Systematic variables
-    double numberSelectedElectrons[2];
-    double numberSelectedMuons[2];
-    double numberSelectedMuonElectrons[2];
-
-    double numberSelectedDoubleElectronsTriggered[2];
-    double numberSelectedDoubleMuonsTriggered[2];
-    double numberSelectedMuonElectronsTriggered[2]; // Double MuonEG
-
-    // Plots for turn on curve studies
-    TProfile* p_electron1_pT_MC;
-    TProfile* p_electron1_eta_MC;
-    TProfile* p_electron2_pT_MC;
-    TProfile* p_electron2_eta_MC;
-    TProfile* p_muon1_pT_MC;
-    TProfile* p_muon1_eta_MC;
-    TProfile* p_muon2_pT_MC;
-    TProfile* p_muon2_eta_MC;
-    TProfile* p_muonElectron1_pT_MC;
-    TProfile* p_muonElectron1_eta_MC;
-    TProfile* p_muonElectron2_pT_MC;
-    TProfile* p_muonElectron2_eta_MC;
-
-    TProfile* p_electron1_pT_data;
-    TProfile* p_electron1_eta_data;
-    TProfile* p_electron2_pT_data;
-    TProfile* p_electron2_eta_data;
-    TProfile* p_muon1_pT_data;
-    TProfile* p_muon1_eta_data;
-    TProfile* p_muon2_pT_data;
-    TProfile* p_muon2_eta_data;
-    TProfile* p_muonElectron1_pT_data;
-    TProfile* p_muonElectron1_eta_data;
-    TProfile* p_muonElectron2_pT_data;
-    TProfile* p_muonElectron2_eta_data;
-
-    // Plots used to make SFs
-    TProfile2D* p_electrons_pT_MC;
-    TProfile2D* p_electrons_eta_MC;
-    TProfile2D* p_muons_pT_MC;
-    TProfile2D* p_muons_eta_MC;
-    TProfile2D* p_muonElectrons_pT_MC;
-    TProfile2D* p_muonElectrons_eta_MC;
-
-    TProfile2D* p_electrons_pT_data;
-    TProfile2D* p_electrons_eta_data;
-    TProfile2D* p_muons_pT_data;
-    TProfile2D* p_muons_eta_data;
-    TProfile2D* p_muonElectrons_pT_data;
-    TProfile2D* p_muonElectrons_eta_data;
+
+    // Turn-on curves and counts, merged from every thread
+    TriggerEfficiencies efficiencies_;
+    // Extra binnings to measure the efficiencies in, from the binnings file
+    std::vector<EfficiencyBinning> binnings_;
+    // Only count jets for events when a binning needs them
+    bool binnedInNJets_;
 
     TFile* muonHltFile1;
     TFile* muonHltFile2;
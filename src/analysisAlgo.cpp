@@ -5,21 +5,28 @@
 #include "TH1F.h"
 #include "TH1I.h"
 #include "TH2D.h"
-#include "TMVA/Config.h"
-#include "TMVA/Timer.h"
+#include "TLorentzVector.h"
 #include "TPad.h"
 #include "TTree.h"
 #include "analysisAlgo.hpp"
 #include "config_parser.hpp"
+#include "cutFlowCounter.hpp"
+#include "mvaRegions.hpp"
+#include "progressMeter.hpp"
+#include "traceEvents.hpp"
 
 #include <LHAPDF/LHAPDF.h>
 #include <boost/filesystem.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 #include <boost/program_options.hpp>
+#include <chrono>
 #include <cmath>
+#include <fstream>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <sstream>
 #include <string>
 
@@ -73,6 +80,17 @@ void AnalysisAlgo::parseCommandLineArguements(int argc, char* argv[])
         "histoDir",
         po::value<std::string>(&histoDir)->default_value("histos/mz20mw50/"),
         "The output directory for the histos used to make the plots.")(
+        "plotJobs",
+        po::value<unsigned>(&plotJobs)->default_value(1),
+        "Number of processes used to draw the plots.")(
+        "cacheDir",
+        po::value<std::string>(&cacheDir),
+        "Cache each dataset's results here, and reuse them on later runs "
+        "with the same inputs, configuration and build.")(
+        "cutFlowReport",
+        po::value<std::string>(&cutFlowReportDir),
+        "Write a JSON report of each dataset's per-stage raw and weighted "
+        "event counts and timings in each channel to this directory.")(
         "outFolder,o",
         po::value<std::string>(&outFolder)->default_value("plots/"),
         "The output directory for the plots. Overrides the config file.")(
@@ -406,8 +424,6 @@ void AnalysisAlgo::setupPlots()
 
 void AnalysisAlgo::runMainAnalysis()
 {
-    TMVA::gConfig().SetDrawProgressBar(true);
-
     if (totalLumi == 0.)
     {
         totalLumi = usePreLumi;
@@ -420,6 +436,20 @@ void AnalysisAlgo::runMainAnalysis()
         std::string{"/scratch2/data/TopPhysics/postLepSelSkims"}
         + (is2016_ ? "2016" : "2017") + "/"};
 
+    if (!cacheDir.empty())
+    {
+        if (makePostLepTree)
+        {
+            std::cerr << "Not using the result cache while making post lepton "
+                         "selection trees."
+                      << std::endl;
+        }
+        else
+        {
+            resultCache = std::make_unique<ResultCache>(cacheDir);
+        }
+    }
+
     // Begin to loop over all datasets
     for (auto dataset = datasets.begin(); dataset != datasets.end(); ++dataset)
     {
@@ -540,6 +570,32 @@ void AnalysisAlgo::runMainAnalysis()
                 continue;
             }
 
+            // If this dataset has been run before with the same inputs,
+            // configuration and code, take its results from the cache instead.
+            const std::string cacheName{dataset->name() + "_"
+                                        + dataset->getFillHisto() + "_"
+                                        + channel};
+            std::string cacheEntryKey;
+            if (resultCache)
+            {
+                cacheEntryKey = cacheKey(*dataset, postLepSelSkimDir);
+                if (resultCache->isValid(cacheName, cacheEntryKey))
+                {
+                    std::cerr << "Using cached results for " << dataset->name()
+                              << std::endl;
+                    const auto cachedStore{
+                        resultCache->readHistograms(cacheName)};
+                    for (const auto& [dir, name, hist] :
+                         datasetHistograms(dataset->getFillHisto()))
+                    {
+                        const std::unique_ptr<TH1D> cached{
+                            cachedStore->get(dir, name)};
+                        hist->Add(cached.get());
+                    }
+                    continue;
+                }
+            }
+
             // If making either plots, make cut flow object.
             std::cerr << "Processing dataset " << dataset->name() << std::endl;
             if (!usePostLepTree)
@@ -707,10 +763,8 @@ void AnalysisAlgo::runMainAnalysis()
                 }
                 else
                 {
-                    generatorWeightPlot = dynamic_cast<TH1I*>(
-                        dataset->getGeneratorWeightHistogram(numFiles)
-                            ->Clone());
-                    generatorWeightPlot->SetDirectory(nullptr);
+                    generatorWeightPlot =
+                        dataset->getGeneratorWeightHistogram(numFiles);
                 }
             }
 
@@ -767,7 +821,11 @@ void AnalysisAlgo::runMainAnalysis()
             int jetInd[15]; // The index of the selected jets;
             int bJetInd[10]; // Index of selected b-jets;
             float jetSmearValue[15]{};
+            // The JES up/down and JER up/down MET, as Cuts propagates them
+            float metJetVariationEt[4]{};
+            float metJetVariationPhi[4]{};
             float muonMomentumSF[2]{};
+            int regionFlags{0}; // MvaRegion bits
             int isMC{dataset->isMC()}; // isMC flag for debug purposes
             event.isMC_ = (dataset->isMC());
             // Now add in the branches:
@@ -824,11 +882,19 @@ void AnalysisAlgo::runMainAnalysis()
                     mvaTree[systIn]->Branch("jetInd", &jetInd, "jetInd[15]/I");
                     mvaTree[systIn]->Branch(
                         "jetSmearValue", &jetSmearValue, "jetSmearValue[15]/F");
+                    mvaTree[systIn]->Branch("metJetVariationEt",
+                                            &metJetVariationEt,
+                                            "metJetVariationEt[4]/F");
+                    mvaTree[systIn]->Branch("metJetVariationPhi",
+                                            &metJetVariationPhi,
+                                            "metJetVariationPhi[4]/F");
                     mvaTree[systIn]->Branch(
                         "muonMomentumSF", &muonMomentumSF, "muonMomentumSF[2]/F");
                     mvaTree[systIn]->Branch(
                         "bJetInd", &bJetInd, "bJetInd[10]/I");
                     mvaTree[systIn]->Branch("isMC", &isMC, "isMC/I");
+                    mvaTree[systIn]->Branch(
+                        "regionFlags", &regionFlags, "regionFlags/I");
                     if (systIn > 0)
                     {
                         systMask = systMask << 1;
@@ -875,18 +941,73 @@ void AnalysisAlgo::runMainAnalysis()
                 }
             }
 
-            TMVA::Timer* lEventTimer{
-                new TMVA::Timer{boost::numeric_cast<int>(numberOfEvents),
-                                "Running over dataset ...",
-                                false}};
-            lEventTimer->DrawProgressBar(0, "");
+            // Look up the plots and cut flow for each systematic once here,
+            // rather than by name for every event.
+            const std::string histoName{dataset->getFillHisto()};
+            std::vector<StagePlots> stagePlots(systNames.size());
+            std::vector<TH1D*> cutFlows(systNames.size());
+            for (unsigned systInd{0}; systInd < systNames.size(); systInd++)
+            {
+                cutFlows[systInd] = cutFlowMap[histoName + systNames[systInd]];
+                const auto plotsIt{plotsMap.find(systNames[systInd] + channel)};
+                if (plotsIt == plotsMap.end()
+                    || plotsIt->second.find(histoName) == plotsIt->second.end())
+                {
+                    continue;
+                }
+                auto& datasetPlots = plotsIt->second[histoName];
+                for (unsigned stage{0}; stage < CutStage::numStages; stage++)
+                {
+                    const auto stageIt{
+                        datasetPlots.find(CutStage::names[stage])};
+                    stagePlots[systInd][stage] = stageIt != datasetPlots.end()
+                                                     ? stageIt->second.get()
+                                                     : nullptr;
+                }
+            }
+
+            // When caching, this dataset's histograms are filled from empty so
+            // that its own contribution can be saved. What was in them before
+            // is added back once it's done.
+            std::vector<std::tuple<std::string, std::string, TH1D*>>
+                cachedHistograms;
+            std::vector<std::unique_ptr<TH1D>> previousContents;
+            if (resultCache)
+            {
+                cachedHistograms = datasetHistograms(histoName);
+                for (const auto& cachedHistogram : cachedHistograms)
+                {
+                    TH1D* const hist{std::get<2>(cachedHistogram)};
+                    previousContents.emplace_back(
+                        dynamic_cast<TH1D*>(hist->Clone()));
+                    previousContents.back()->SetDirectory(nullptr);
+                    hist->Reset();
+                }
+            }
+
+            // The cut flow report counts the nominal selection only
+            CutFlowCounter cutFlowCounter;
+            const bool reportCutFlow{!cutFlowReportDir.empty()};
+            const auto loopStart{std::chrono::steady_clock::now()};
+            ProgressMeter progress{"Running over dataset ...", numberOfEvents};
             for (int i{0}; i < numberOfEvents; i++)
             {
-                std::stringstream lSStrFoundEvents;
-                lSStrFoundEvents << foundEvents;
-                lEventTimer->DrawProgressBar(
-                    i, ("Found " + lSStrFoundEvents.str() + " events."));
-                event.GetEntry(i);
+                TRACE_SCOPE("event");
+                progress.update(i, foundEvents);
+                {
+                    TRACE_SCOPE("GetEntry");
+                    event.GetEntry(i);
+                }
+                cutObj->smearJets(event);
+                // The MET of every systematic, worked out once for the event
+                std::optional<MetPropagation> metPropagation;
+                if (makeMVATree || doZplusCR_)
+                {
+                    TRACE_SCOPE("propagateMet");
+                    metPropagation.emplace(cutObj->propagateMet(event));
+                }
+                cutObj->setMetPropagation(
+                    metPropagation ? &*metPropagation : nullptr);
                 // Do the systematics indicated by the systematic flag, oooor
                 // just do data if that's your thing. Whatevs.
                 int systMask{1};
@@ -1013,14 +1134,14 @@ void AnalysisAlgo::runMainAnalysis()
                     //          std::endl;
 
                     //	  std::cout << "channel: " << channel << std::endl;
-                    std::string histoName{dataset->getFillHisto()};
-
-                    if (!cutObj->makeCuts(
-                            event,
-                            eventWeight,
-                            plotsMap[systNames[systInd] + channel][histoName],
-                            *cutFlowMap[histoName + systNames[systInd]],
-                            systInd ? systMask : systInd))
+                    cutObj->setCutFlowCounter(
+                        reportCutFlow && systInd == 0 ? &cutFlowCounter
+                                                      : nullptr);
+                    if (!cutObj->makeCuts(event,
+                                          eventWeight,
+                                          stagePlots[systInd],
+                                          *cutFlows[systInd],
+                                          systInd ? systMask : systInd))
                     {
                         if (systInd)
                         {
@@ -1191,6 +1312,15 @@ void AnalysisAlgo::runMainAnalysis()
                                 jetSmearValue[i] = 0.0;
                             }
                         }
+                        for (size_t var{0};
+                             var < MetPropagation::jetVariations.size();
+                             var++)
+                        {
+                            const TLorentzVector met{metPropagation->met(
+                                MetPropagation::jetVariations[var])};
+                            metJetVariationEt[var] = met.Et();
+                            metJetVariationPhi[var] = met.Phi();
+                        }
                         for (unsigned bJetIt{0}; bJetIt < 10; bJetIt++)
                         {
                             if (bJetIt < event.bTagIndex.size())
@@ -1206,6 +1336,13 @@ void AnalysisAlgo::runMainAnalysis()
                         {
                             muonMomentumSF[i] = event.muonMomentumSF[i];
                         }
+                        regionFlags = mvaRegionFlags(event,
+                                                     jetInd,
+                                                     jetSmearValue,
+                                                     wQuark1Index,
+                                                     wQuark2Index,
+                                                     bJetInd[0]);
+                        TRACE_SCOPE("treeFill");
                         mvaTree[systInd]->Fill();
                     }
 
@@ -1217,6 +1354,26 @@ void AnalysisAlgo::runMainAnalysis()
                     }
                 } // End systematics loop.
             } // end event loop
+            progress.finish(numberOfEvents, foundEvents);
+            cutObj->setCutFlowCounter(nullptr);
+            cutObj->setMetPropagation(nullptr);
+            if (reportCutFlow)
+            {
+                const double wallSeconds{
+                    std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - loopStart)
+                        .count()};
+                boost::filesystem::create_directories(cutFlowReportDir);
+                std::ofstream report{cutFlowReportDir + "/cutFlow_"
+                                     + dataset->name() + "_" + channel
+                                     + (invertLepCut ? "invLep" : "")
+                                     + ".json"};
+                cutFlowCounter.writeJson(report,
+                                         dataset->name(),
+                                         channel,
+                                         numberOfEvents,
+                                         wallSeconds);
+            }
 
             // If we're making post lepSel skims save the tree here
             if (makePostLepTree)
@@ -1299,6 +1456,28 @@ void AnalysisAlgo::runMainAnalysis()
                 }
                 mvaOutFile->Close();
             }
+            if (resultCache)
+            {
+                {
+                    const auto cachedStore{
+                        resultCache->writeHistograms(cacheName)};
+                    for (size_t i{0}; i < cachedHistograms.size(); i++)
+                    {
+                        const auto& [dir, name, hist] = cachedHistograms[i];
+                        cachedStore->put(dir, name, *hist);
+                        hist->Add(previousContents[i].get());
+                    }
+                }
+                std::vector<std::string> cacheOutputs;
+                if (makeMVATree)
+                {
+                    cacheOutputs.emplace_back(
+                        mvaDir + dataset->name() + postfix
+                        + (invertLepCut ? "invLep" : "") + "mvaOut.root");
+                }
+                resultCache->commit(cacheName, cacheEntryKey, cacheOutputs);
+            }
+
             std::cerr << "\nFound " << foundEvents << " in " << dataset->name()
                       << std::endl;
             std::cerr << "Found " << foundEventsNorm
@@ -1338,7 +1517,7 @@ void AnalysisAlgo::savePlots()
         // directory
         if ((makeHistos || useHistos) && plots)
         {
-            plotObj.setHistogramFolder(histoDir);
+            plotObj.setHistogramFolder(histoDir, postfix);
         }
 
         // If making histos, save the output!
@@ -1347,12 +1526,13 @@ void AnalysisAlgo::savePlots()
             std::cout << "Saving histograms for later use ..." << std::endl;
             for (unsigned i{0}; i < plotsVec.size(); i++)
             {
-                plotObj.saveHistos(plotsMap[plotsVec[i]]);
+                plotObj.saveHistos(plotsVec[i], plotsMap[plotsVec[i]]);
             }
             plotObj.saveHistos(
                 cutFlowMap,
                 "cutFlow",
                 channel); // Don't forget to save the cutflow too!
+            plotObj.closeHistogramStore();
         }
 
         if (!makeHistos)
@@ -1365,13 +1545,14 @@ void AnalysisAlgo::savePlots()
             plotObj.setLabelTwo("Some amount of lumi");
             plotObj.setPostfix("");
             plotObj.setOutputFolder(outFolder);
+            plotObj.setPlotJobs(plotJobs);
 
             for (unsigned i{0}; i < plotsVec.size(); i++)
             {
                 std::cout << plotsVec[i] << std::endl;
                 if (plots)
                 {
-                    plotObj.plotHistos(plotsMap[plotsVec[i]]);
+                    plotObj.plotHistos(plotsVec[i], plotsMap[plotsVec[i]]);
                 }
             }
 
@@ -1400,6 +1581,145 @@ void AnalysisAlgo::savePlots()
     std::cerr << "But not past it" << std::endl;
 }
 
+std::string AnalysisAlgo::cacheKey(Dataset& dataset,
+                                   const std::string& postLepSelSkimDir) const
+{
+    std::ostringstream key;
+    key << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+    key << "build " << ResultCache::buildHash() << '\n';
+    if (usePostLepTree)
+    {
+        const std::string skim{
+            postLepSelSkimDir + dataset.name() + postfix
+            + (invertLepCut ? "invLep" : "")
+            + (doNPLs_ && dataset.getPlotLabel() == "NPL" ? "invLep" : "")
+            + "SmallSkim.root"};
+        key << "inputs " << skim << ' '
+            << (boost::filesystem::is_regular_file(skim)
+                    ? ResultCache::fileFingerprint(skim)
+                    : "missing")
+            << '\n';
+    }
+    else
+    {
+        key << "inputs "
+            << ResultCache::fileSetFingerprint(dataset.getLocations()) << '\n';
+    }
+    key << "dataset " << dataset.configFingerprint() << '\n';
+    key << "cuts " << ResultCache::contentFingerprint(cutConfName) << '\n';
+    // The scale factor, efficiency and pileup files Cuts and the pileup
+    // reweighting read. Their paths are fixed in the code, not the configs.
+    const std::string year{is2016_ ? "2016/" : "2017/"};
+    key << "scaleFactors "
+        << ResultCache::fileSetFingerprint(
+               {"scaleFactors/" + year, "pileup/" + year}, "")
+        << '\n';
+    if (plots)
+    {
+        key << "plots " << ResultCache::contentFingerprint(plotConfName)
+            << '\n';
+    }
+    key << "syst " << systToRun << '\n';
+    key << "channel " << channel << '\n';
+    key << "weight " << dataset.getDatasetWeight(totalLumi) << '\n';
+    key << "options" << (is2016_ ? " 2016" : " 2017") << " n=" << nEvents
+        << " nFiles=" << numFiles << " postfix=" << postfix
+        << " invert=" << invertLepCut << " bTag=" << usebTagWeight
+        << " u=" << usePostLepTree << " NPLs=" << doNPLs_
+        << " zPlus=" << doZplusCR_ << " skipTrig=" << skipTrig
+        << " mva=" << makeMVATree << " mvaDir=" << mvaDir
+        << " metCut=" << metCut << " mzCut=" << mzCut << " mwCut=" << mwCut
+        << " plots=" << plots;
+    for (const auto jetRegVar : jetRegVars)
+    {
+        key << " jetRegion=" << jetRegVar;
+    }
+    for (const auto eventNumber : eventNumbers)
+    {
+        key << " event=" << eventNumber;
+    }
+    key << '\n';
+
+    return key.str();
+}
+
+int AnalysisAlgo::mvaRegionFlags(const AnalysisEvent& event,
+                                 const int* jetInd,
+                                 const float* jetSmearValue,
+                                 const int wQuark1Index,
+                                 const int wQuark2Index,
+                                 const int bJetIndex) const
+{
+    unsigned flags{0};
+    if (channel == "emu")
+    {
+        flags |= MvaRegion::ttbarCR;
+    }
+    if (doZplusCR_)
+    {
+        flags |= MvaRegion::zPlusJetsCR;
+    }
+
+    // The hadronic W and top are built the same way as in
+    // MakeMvaInputs::fillTree, from the stored jet indices and smear values,
+    // so that the chi2 and so the region are identical there
+    if (wQuark1Index < 0 || wQuark2Index < 0 || bJetIndex < 0)
+    {
+        return static_cast<int>(flags);
+    }
+    const auto jetVec{[&](const int index) {
+        TLorentzVector jet;
+        jet.SetPxPyPzE(event.jetPF2PATPx[jetInd[index]],
+                       event.jetPF2PATPy[jetInd[index]],
+                       event.jetPF2PATPz[jetInd[index]],
+                       event.jetPF2PATE[jetInd[index]]);
+        jet *= jetSmearValue[index];
+        return jet;
+    }};
+    const TLorentzVector wVec{jetVec(wQuark1Index) + jetVec(wQuark2Index)};
+    const TLorentzVector tVec{jetVec(bJetIndex) + wVec};
+    flags |= MvaRegion::chi2Region(
+        static_cast<float>(MvaRegion::chi2(wVec.M(), tVec.M())));
+
+    return static_cast<int>(flags);
+}
+
+std::vector<std::tuple<std::string, std::string, TH1D*>>
+    AnalysisAlgo::datasetHistograms(const std::string& histoName)
+{
+    std::vector<std::tuple<std::string, std::string, TH1D*>> histograms;
+    for (const auto& systName : systNames)
+    {
+        const auto plotsIt{plotsMap.find(systName + channel)};
+        if (plotsIt != plotsMap.end())
+        {
+            const auto datasetIt{plotsIt->second.find(histoName)};
+            if (datasetIt != plotsIt->second.end())
+            {
+                for (const auto& [stageName, stagePlots] : datasetIt->second)
+                {
+                    for (const auto& plotPoint : stagePlots->getPlotPoint())
+                    {
+                        histograms.emplace_back(systName + channel + "/"
+                                                    + stageName,
+                                                plotPoint.name,
+                                                plotPoint.plotHist);
+                    }
+                }
+            }
+        }
+
+        const auto cutFlowIt{cutFlowMap.find(histoName + systName)};
+        if (cutFlowIt != cutFlowMap.end() && cutFlowIt->second)
+        {
+            histograms.emplace_back(
+                "cutFlow", histoName + systName, cutFlowIt->second);
+        }
+    }
+    return histograms;
+}
+
 std::string AnalysisAlgo::channelSetup(unsigned channelInd)
 {
     std::string chanName{};
@@ -0,0 +1,651 @@
+#include "AnalysisEvent.hpp"
+#include "TH1D.h"
+#include "config_parser.hpp"
+#include "cutClass.hpp"
+#include "cutFlowCounter.hpp"
+#include "objectSelection.hpp"
+#include "plots.hpp"
+#include "syntheticNtuple.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// Times the main steps of the analysis on synthetic events (see
+// syntheticNtuple.hpp), so changes to them can be checked for speed without
+// the real skims:
+//
+//   leptonId       the tight and loose electron and muon selections
+//   selection      Cuts::smearJets and makeCuts, nominal only. The time
+//                  spent in each stage of makeCuts is broken down after,
+//                  e.g. the lepton scale factor lookups in lepSel.
+//   selectionSyst  Cuts::smearJets, then makeCuts for the nominal and every
+//                  systematic
+//   plotFill       filling every plot, for the events passing the selection
+//
+// With --synthetic, analysisMain.exe is also run over the ntuples written by
+// makeSyntheticNtuples.exe, without and with every systematic. Each result
+// is given in events a second, heap allocations an event (for those run in
+// this process) and the peak resident set size while it ran, and can be saved
+// as a baseline for later runs to be compared against.
+
+namespace
+{
+std::atomic<unsigned long> allocations{0};
+} // namespace
+
+// Every heap allocation made by this process is counted. The array forms end
+// up in these too.
+void* operator new(const std::size_t size)
+{
+    allocations++;
+    if (void* const pointer{std::malloc(size > 0 ? size : 1)})
+    {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* const pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* const pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment)
+{
+    allocations++;
+    // aligned_alloc needs a whole number of alignments
+    const auto align{static_cast<std::size_t>(alignment)};
+    const std::size_t rounded{(std::max<std::size_t>(size, 1) + align - 1)
+                              / align * align};
+    if (void* const pointer{std::aligned_alloc(align, rounded)})
+    {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* const pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* const pointer,
+                     std::size_t,
+                     std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+struct Result
+{
+    std::string name;
+    long events;
+    double seconds;
+    // Negative if not counted
+    double allocationsPerEvent;
+    double peakMegabytes;
+
+    double eventsPerSecond() const
+    {
+        return seconds > 0 ? events / seconds : 0.;
+    }
+};
+
+// The time and allocations of the calls made through it, leaving out
+// whatever happens in between, e.g. generating the next event
+class Stopwatch
+{
+    public:
+    template <typename Function>
+    auto operator()(Function function)
+    {
+        const unsigned long allocationsBefore{allocations};
+        const auto start{std::chrono::steady_clock::now()};
+        const auto result{function()};
+        seconds_ += std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+        allocations_ += allocations - allocationsBefore;
+        return result;
+    }
+
+    Result result(const std::string& name, const long events) const;
+
+    private:
+    double seconds_{0};
+    unsigned long allocations_{0};
+};
+
+// Resets the peak resident set size of this process to the current one, so
+// that each benchmark's own peak can be read by peakMegabytes()
+void resetPeak()
+{
+    std::ofstream{"/proc/self/clear_refs"} << "5";
+}
+
+// The peak resident set size of this process since the last resetPeak
+double peakMegabytes()
+{
+    std::ifstream status{"/proc/self/status"};
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            // In kilobytes
+            return std::stod(line.substr(6)) / 1024.;
+        }
+    }
+    return 0.;
+}
+
+Result Stopwatch::result(const std::string& name, const long events) const
+{
+    return {name,
+            events,
+            seconds_,
+            events > 0 ? static_cast<double>(allocations_) / events : 0.,
+            peakMegabytes()};
+}
+
+std::unique_ptr<Plots> makePlots(const std::string& plotConf)
+{
+    std::vector<std::string> titles;
+    std::vector<std::string> names;
+    std::vector<float> xMins;
+    std::vector<float> xMaxs;
+    std::vector<int> nBins;
+    std::vector<std::string> fillExps;
+    std::vector<std::string> xAxisLabels;
+    std::vector<int> cutStages;
+    Parser::parse_plots(plotConf,
+                        titles,
+                        names,
+                        xMins,
+                        xMaxs,
+                        nBins,
+                        fillExps,
+                        xAxisLabels,
+                        cutStages);
+    // The last stage fills every plot
+    return std::make_unique<Plots>(titles,
+                                   names,
+                                   xMins,
+                                   xMaxs,
+                                   nBins,
+                                   fillExps,
+                                   xAxisLabels,
+                                   cutStages,
+                                   CutStage::wMass,
+                                   "benchmark");
+}
+
+std::vector<Result> runMicroBenchmarks(const bool is2016,
+                                       const long events,
+                                       const unsigned seed,
+                                       const std::string& cutConf,
+                                       const std::string& plotConf)
+{
+    TH1::AddDirectory(false);
+    Cuts cuts{false, false, false, is2016};
+    cuts.parse_config(cutConf);
+    cuts.setMC(true);
+    const ObjectSelection selection{is2016};
+    const std::unique_ptr<Plots> plots{makePlots(plotConf)};
+    const StagePlots noPlots{};
+    TH1D cutFlow{"cutFlow",
+                 "cutFlow",
+                 CutStage::numStages,
+                 0,
+                 CutStage::numStages};
+
+    std::vector<Result> results;
+    // Each benchmark sees the same events
+    const auto run{[&](const std::string& name, auto benchmark) {
+        resetPeak();
+        SyntheticNtuple ntuple{true, is2016, seed};
+        Stopwatch stopwatch;
+        long done{0};
+        for (long i{0}; i < events; i++)
+        {
+            ntuple.next();
+            done += benchmark(ntuple.event(), stopwatch);
+        }
+        results.emplace_back(stopwatch.result(name, done));
+    }};
+
+    run("leptonId", [&](const AnalysisEvent& event, Stopwatch& stopwatch) {
+        stopwatch([&] {
+            return selection.tightElectrons(event).size()
+                   + selection.looseElectrons(event).size()
+                   + selection.tightMuons(event).size()
+                   + selection.looseMuons(event).size();
+        });
+        return 1;
+    });
+    run("selection", [&](AnalysisEvent& event, Stopwatch& stopwatch) {
+        double eventWeight{1.};
+        stopwatch([&] {
+            cuts.smearJets(event);
+            return cuts.makeCuts(event, eventWeight, noPlots, cutFlow, 0);
+        });
+        return 1;
+    });
+    run("selectionSyst", [&](AnalysisEvent& event, Stopwatch& stopwatch) {
+        // As analysisMain.exe -v 65535 does, one systematic after another
+        stopwatch([&] {
+            cuts.smearJets(event);
+            bool passed{false};
+            for (int syst{0}; syst <= 32768; syst = syst > 0 ? syst << 1 : 1)
+            {
+                double eventWeight{1.};
+                passed |=
+                    cuts.makeCuts(event, eventWeight, noPlots, cutFlow, syst);
+            }
+            return passed;
+        });
+        return 1;
+    });
+    run("plotFill", [&](AnalysisEvent& event, Stopwatch& stopwatch) {
+        double eventWeight{1.};
+        cuts.smearJets(event);
+        if (!cuts.makeCuts(event, eventWeight, noPlots, cutFlow, 0))
+        {
+            return 0;
+        }
+        stopwatch([&] {
+            plots->fillAllPlots(event, eventWeight);
+            return true;
+        });
+        return 1;
+    });
+
+    // Where the nominal selection spends its time
+    CutFlowCounter counter;
+    cuts.setCutFlowCounter(&counter);
+    SyntheticNtuple ntuple{true, is2016, seed};
+    for (long i{0}; i < events; i++)
+    {
+        ntuple.next();
+        double eventWeight{1.};
+        cuts.smearJets(ntuple.event());
+        cuts.makeCuts(ntuple.event(), eventWeight, noPlots, cutFlow, 0);
+    }
+    cuts.setCutFlowCounter(nullptr);
+    std::ostringstream report;
+    counter.writeJson(report, "synthetic", "selection", events, 0.);
+    std::cout << "Selection stages (as --cutFlowReport):\n"
+              << report.str() << std::endl;
+
+    return results;
+}
+
+// The events analysisMain.exe read, from its cut flow reports
+long eventsRead(const boost::filesystem::path& reportDir)
+{
+    long events{0};
+    for (const auto& file : boost::make_iterator_range(
+             boost::filesystem::directory_iterator{reportDir}, {}))
+    {
+        std::ifstream report{file.path().string()};
+        const std::string contents{std::istreambuf_iterator<char>{report},
+                                   std::istreambuf_iterator<char>{}};
+        const std::string key{"\"eventsRead\": "};
+        const size_t position{contents.find(key)};
+        if (position != std::string::npos)
+        {
+            events += std::stol(contents.substr(position + key.size()));
+        }
+    }
+    return events;
+}
+
+Result runAnalysisMain(const std::string& name,
+                       const std::string& analysisMain,
+                       const boost::filesystem::path& yearDir,
+                       const bool is2016,
+                       const long events,
+                       const int syst)
+{
+    const boost::filesystem::path outDir{yearDir / "benchmark" / name};
+    const boost::filesystem::path reportDir{outDir / "cutFlows"};
+    boost::filesystem::remove_all(outDir);
+    boost::filesystem::create_directories(reportDir);
+
+    std::vector<std::string> args{
+        analysisMain,
+        "-c",
+        (yearDir / "ee_synthetic.yaml").string(),
+        "-l",
+        is2016 ? "35858.984" : "41528",
+        "-n",
+        std::to_string(events),
+        "-k",
+        "1",
+        "-v",
+        std::to_string(syst),
+        "-o",
+        outDir.string() + "/",
+        "--cutFlowReport",
+        reportDir.string()};
+    if (is2016)
+    {
+        args.emplace_back("--2016");
+    }
+    std::vector<char*> argv;
+    for (auto& arg : args)
+    {
+        argv.emplace_back(&arg[0]);
+    }
+    argv.emplace_back(nullptr);
+
+    const auto start{std::chrono::steady_clock::now()};
+    const pid_t child{fork()};
+    if (child < 0)
+    {
+        throw std::runtime_error("Could not start " + analysisMain);
+    }
+    if (child == 0)
+    {
+        // Its output would bury the results
+        const int devNull{open("/dev/null", O_WRONLY)};
+        dup2(devNull, STDOUT_FILENO);
+        dup2(devNull, STDERR_FILENO);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    int status;
+    rusage usage;
+    wait4(child, &status, 0, &usage);
+    const double seconds{std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count()};
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        throw std::runtime_error(analysisMain + " failed for " + name);
+    }
+
+    return {name, eventsRead(reportDir), seconds, -1., usage.ru_maxrss / 1024.};
+}
+
+// A result as saved in a baseline. Negative if not counted or not saved.
+struct Saved
+{
+    double eventsPerSecond;
+    double allocationsPerEvent;
+    double peakMegabytes;
+};
+
+// The saved results, by name. Baselines saved with only the events a second
+// have nothing to compare the allocations and memory with.
+std::map<std::string, Saved> readBaseline(const std::string& path)
+{
+    std::ifstream in{path};
+    if (!in)
+    {
+        throw std::runtime_error("Could not read baseline " + path);
+    }
+    std::map<std::string, Saved> baseline;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields{line};
+        std::string name;
+        Saved saved{0., -1., -1.};
+        if (!(fields >> name >> saved.eventsPerSecond))
+        {
+            throw std::runtime_error("Bad line in baseline " + path + ": "
+                                     + line);
+        }
+        if (!(fields >> saved.allocationsPerEvent >> saved.peakMegabytes))
+        {
+            saved.allocationsPerEvent = -1.;
+            saved.peakMegabytes = -1.;
+        }
+        baseline[name] = saved;
+    }
+    return baseline;
+}
+
+void writeBaseline(const std::string& path, const std::vector<Result>& results)
+{
+    std::ofstream out{path};
+    out << "# name eventsPerSecond allocationsPerEvent peakMegabytes\n";
+    for (const auto& result : results)
+    {
+        out << result.name << ' ' << result.eventsPerSecond() << ' '
+            << result.allocationsPerEvent << ' ' << result.peakMegabytes
+            << '\n';
+    }
+    if (!out)
+    {
+        throw std::runtime_error("Could not write baseline " + path);
+    }
+}
+
+// The change from a saved value, or "-" if either wasn't counted
+std::string change(const double value, const double saved)
+{
+    if (value < 0 || saved <= 0)
+    {
+        return "-";
+    }
+    return (boost::format("%+.1f%%") % ((value / saved - 1.) * 100.)).str();
+}
+
+// Prints the results, returning how many are worse than their baseline by
+// more than tolerance: slower, or with more allocations an event or a higher
+// peak memory
+unsigned printResults(const std::vector<Result>& results,
+                      const std::map<std::string, Saved>& baseline,
+                      const double tolerance)
+{
+    unsigned regressions{0};
+    std::cout << boost::format("%-14s %10s %12s %9s %12s %9s %9s %9s  %s")
+                     % "benchmark" % "events" % "events/s" % "change"
+                     % "allocs/event" % "change" % "peak MB" % "change" % ""
+              << std::endl;
+    for (const auto& result : results)
+    {
+        const auto found{baseline.find(result.name)};
+        const Saved saved{found != baseline.end() ? found->second
+                                                  : Saved{0., -1., -1.}};
+        std::vector<std::string> verdicts;
+        if (saved.eventsPerSecond > 0
+            && result.eventsPerSecond()
+                   < saved.eventsPerSecond * (1. - tolerance))
+        {
+            verdicts.emplace_back("SLOWER");
+        }
+        // Any allocations where there were none count as more
+        if (result.allocationsPerEvent >= 0 && saved.allocationsPerEvent >= 0
+            && result.allocationsPerEvent
+                   > saved.allocationsPerEvent * (1. + tolerance))
+        {
+            verdicts.emplace_back("MORE ALLOCATIONS");
+        }
+        if (saved.peakMegabytes > 0
+            && result.peakMegabytes > saved.peakMegabytes * (1. + tolerance))
+        {
+            verdicts.emplace_back("MORE MEMORY");
+        }
+        if (!verdicts.empty())
+        {
+            regressions++;
+        }
+
+        const std::string allocs{
+            result.allocationsPerEvent < 0
+                ? "-"
+                : (boost::format("%.1f") % result.allocationsPerEvent).str()};
+        std::string verdict;
+        for (const auto& each : verdicts)
+        {
+            verdict += (verdict.empty() ? "" : ", ") + each;
+        }
+        std::cout << boost::format("%-14s %10d %12.1f %9s %12s %9s %9.1f "
+                                   "%9s  %s")
+                         % result.name % result.events
+                         % result.eventsPerSecond()
+                         % change(result.eventsPerSecond(),
+                                  saved.eventsPerSecond)
+                         % allocs
+                         % change(result.allocationsPerEvent,
+                                  saved.allocationsPerEvent)
+                         % result.peakMegabytes
+                         % change(result.peakMegabytes, saved.peakMegabytes)
+                         % verdict
+                  << std::endl;
+    }
+    return regressions;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    bool is2016;
+    long events;
+    unsigned seed;
+    std::string cutConf;
+    std::string plotConf;
+    std::string syntheticDir;
+    std::string analysisMain;
+    long macroEvents;
+    std::string baselinePath;
+    std::string saveBaselinePath;
+    double tolerance;
+
+    namespace po = boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()("help,h", "Print this message.")(
+        "2016", po::bool_switch(&is2016), "Use 2016 conditions (SFs, et al.).")(
+        "events,n",
+        po::value<long>(&events)->default_value(20000),
+        "Number of synthetic events for each benchmark.")(
+        "seed",
+        po::value<unsigned>(&seed)->default_value(1),
+        "Random seed of the synthetic events.")(
+        "cutConf,x",
+        po::value<std::string>(&cutConf),
+        "Cut configuration (default configs/<year>/cuts/SRCuts.yaml).")(
+        "plotConf",
+        po::value<std::string>(&plotConf)->default_value(
+            "configs/plots/plotDileptonConf.yaml"),
+        "Plot configuration.")(
+        "synthetic,i",
+        po::value<std::string>(&syntheticDir),
+        "Also time analysisMain.exe on the ntuples in this directory, as "
+        "written by makeSyntheticNtuples.exe.")(
+        "analysisMain",
+        po::value<std::string>(&analysisMain)->default_value(
+            "bin/analysisMain.exe"),
+        "analysisMain executable to time.")(
+        "macroEvents",
+        po::value<long>(&macroEvents)->default_value(0),
+        "Number of events of each dataset for analysisMain.exe to run over. "
+        "All if set to 0.")(
+        "baseline,b",
+        po::value<std::string>(&baselinePath),
+        "Compare with the results saved in this file. Exits with 2 if any "
+        "benchmark is slower, allocates more an event or has a higher peak "
+        "memory than it by more than the tolerance.")(
+        "saveBaseline",
+        po::value<std::string>(&saveBaselinePath),
+        "Save the results to this file, to be compared with later.")(
+        "tolerance",
+        po::value<double>(&tolerance)->default_value(0.1),
+        "Fractional slowdown, or rise in allocations or peak memory, allowed "
+        "before a benchmark counts as worse.");
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (cutConf.empty())
+    {
+        cutConf = std::string{"configs/"} + (is2016 ? "2016" : "2017")
+                  + "/cuts/SRCuts.yaml";
+    }
+
+    unsigned regressions;
+    try
+    {
+        std::vector<Result> results{
+            runMicroBenchmarks(is2016, events, seed, cutConf, plotConf)};
+        if (!syntheticDir.empty())
+        {
+            const boost::filesystem::path yearDir{
+                boost::filesystem::path{syntheticDir}
+                / (is2016 ? "2016" : "2017")};
+            results.emplace_back(runAnalysisMain(
+                "analysisMain", analysisMain, yearDir, is2016, macroEvents, 0));
+            results.emplace_back(runAnalysisMain("analysisMainSyst",
+                                                 analysisMain,
+                                                 yearDir,
+                                                 is2016,
+                                                 macroEvents,
+                                                 65535));
+        }
+
+        regressions = printResults(results,
+                                   baselinePath.empty()
+                                       ? std::map<std::string, Saved>{}
+                                       : readBaseline(baselinePath),
+                                   tolerance);
+        if (!saveBaselinePath.empty())
+        {
+            writeBaseline(saveBaselinePath, results);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return regressions > 0 ? 2 : 0;
+}
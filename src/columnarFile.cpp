@@ -0,0 +1,250 @@
+#include "columnarFile.hpp"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+const char magic[8]{'T', 'Q', 'Z', 'C', 'O', 'L', '1', '\0'};
+
+std::uint64_t alignUp(const std::uint64_t offset)
+{
+    return (offset + Columnar::alignment - 1) / Columnar::alignment
+           * Columnar::alignment;
+}
+
+template <typename T>
+void writeValue(std::ofstream& file, const T value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T readValue(const char* data, const std::uint64_t size, std::uint64_t& offset)
+{
+    if (size < sizeof(T) || offset > size - sizeof(T))
+    {
+        throw std::runtime_error("header is truncated");
+    }
+    T value;
+    std::copy(data + offset,
+              data + offset + sizeof(T),
+              reinterpret_cast<char*>(&value));
+    offset += sizeof(T);
+    return value;
+}
+} // namespace
+
+ColumnarWriter::ColumnarWriter(const std::string& path,
+                               std::vector<std::string> columns,
+                               const std::uint32_t rowsPerGroup)
+    : path_{path}
+    , columns_{std::move(columns)}
+    , rowsPerGroup_{rowsPerGroup}
+    , file_{path, std::ios::binary | std::ios::trunc}
+    , rows_{0}
+    , rowsOffset_{0}
+    , group_(columns_.size())
+    , closed_{false}
+{
+    if (!file_)
+    {
+        throw std::runtime_error("Could not open " + path + " for writing");
+    }
+
+    file_.write(magic, sizeof(magic));
+    writeValue<std::uint32_t>(file_, columns_.size());
+    writeValue<std::uint32_t>(file_, rowsPerGroup_);
+    rowsOffset_ = static_cast<std::uint64_t>(file_.tellp());
+    writeValue<std::uint64_t>(file_, 0); // Filled in by close
+    for (const auto& column : columns_)
+    {
+        writeValue<std::uint32_t>(file_, column.size());
+        file_.write(column.data(), column.size());
+    }
+
+    const std::uint64_t headerSize{static_cast<std::uint64_t>(file_.tellp())};
+    const std::string padding(alignUp(headerSize) - headerSize, '\0');
+    file_.write(padding.data(), padding.size());
+}
+
+ColumnarWriter::~ColumnarWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception&)
+    {
+    }
+}
+
+void ColumnarWriter::fill(const float* values)
+{
+    for (size_t i{0}; i < columns_.size(); i++)
+    {
+        group_[i].push_back(values[i]);
+    }
+    rows_++;
+    if (rows_ % rowsPerGroup_ == 0)
+    {
+        writeGroup();
+    }
+}
+
+void ColumnarWriter::close()
+{
+    if (closed_)
+    {
+        return;
+    }
+    closed_ = true;
+
+    if (rows_ % rowsPerGroup_ != 0)
+    {
+        writeGroup();
+    }
+    file_.seekp(static_cast<std::streamoff>(rowsOffset_));
+    writeValue<std::uint64_t>(file_, rows_);
+    file_.close();
+    if (!file_)
+    {
+        throw std::runtime_error("Could not write " + path_);
+    }
+}
+
+void ColumnarWriter::writeGroup()
+{
+    // Every slot is full size, even in the last group, so that the offset of
+    // any column can be computed without reading the file
+    const std::uint64_t slotBytes{
+        static_cast<std::uint64_t>(rowsPerGroup_) * sizeof(float)};
+    const std::uint64_t groupRows{group_.empty() ? 0 : group_.front().size()};
+    const std::string padding(alignUp(slotBytes) - groupRows * sizeof(float),
+                              '\0');
+    for (auto& column : group_)
+    {
+        file_.write(reinterpret_cast<const char*>(column.data()),
+                    column.size() * sizeof(float));
+        file_.write(padding.data(), padding.size());
+        column.clear();
+    }
+}
+
+ColumnarReader::ColumnarReader(const std::string& path)
+    : path_{path}
+    , columns_{}
+    , rowsPerGroup_{0}
+    , rows_{0}
+    , dataOffset_{0}
+    , slotSize_{0}
+    , map_{nullptr}
+    , mapSize_{0}
+{
+    const int fd{open(path.c_str(), O_RDONLY)};
+    if (fd < 0)
+    {
+        throw std::runtime_error("Could not open " + path);
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Could not stat " + path);
+    }
+    mapSize_ = static_cast<std::size_t>(status.st_size);
+    void* const map{mmap(nullptr, mapSize_, PROT_READ, MAP_SHARED, fd, 0)};
+    ::close(fd);
+    if (map == MAP_FAILED)
+    {
+        throw std::runtime_error("Could not map " + path);
+    }
+    map_ = static_cast<const char*>(map);
+
+    try
+    {
+        readHeader();
+    }
+    catch (const std::runtime_error& e)
+    {
+        munmap(const_cast<char*>(map_), mapSize_);
+        throw std::runtime_error(path + ": " + e.what());
+    }
+}
+
+void ColumnarReader::readHeader()
+{
+    if (mapSize_ < sizeof(magic)
+        || !std::equal(magic, magic + sizeof(magic), map_))
+    {
+        throw std::runtime_error("not a columnar MVA input file");
+    }
+    std::uint64_t offset{sizeof(magic)};
+    const auto nColumns{readValue<std::uint32_t>(map_, mapSize_, offset)};
+    rowsPerGroup_ = readValue<std::uint32_t>(map_, mapSize_, offset);
+    rows_ = readValue<std::uint64_t>(map_, mapSize_, offset);
+    if (rowsPerGroup_ == 0)
+    {
+        throw std::runtime_error("no rows per group");
+    }
+    for (std::uint32_t i{0}; i < nColumns; i++)
+    {
+        const auto length{readValue<std::uint32_t>(map_, mapSize_, offset)};
+        if (length > mapSize_ - offset)
+        {
+            throw std::runtime_error("header is truncated");
+        }
+        columns_.emplace_back(map_ + offset, length);
+        offset += length;
+    }
+    dataOffset_ = alignUp(offset);
+    slotSize_ = alignUp(static_cast<std::uint64_t>(rowsPerGroup_)
+                        * sizeof(float));
+
+    // Every slot is written in full, so this is exactly the file size. It is
+    // divided out rather than multiplied, so a bad row count can't overflow.
+    if (dataOffset_ > mapSize_
+        || (!columns_.empty()
+            && groups()
+                   > (mapSize_ - dataOffset_) / slotSize_ / columns_.size()))
+    {
+        throw std::runtime_error("data is truncated");
+    }
+}
+
+ColumnarReader::~ColumnarReader()
+{
+    munmap(const_cast<char*>(map_), mapSize_);
+}
+
+std::uint64_t ColumnarReader::groups() const
+{
+    return (rows_ + rowsPerGroup_ - 1) / rowsPerGroup_;
+}
+
+std::uint32_t ColumnarReader::groupRows(const std::uint64_t group) const
+{
+    return static_cast<std::uint32_t>(std::min<std::uint64_t>(
+        rowsPerGroup_, rows_ - group * rowsPerGroup_));
+}
+
+const float* ColumnarReader::column(const std::uint64_t group,
+                                    const std::uint32_t column) const
+{
+    return reinterpret_cast<const float*>(
+        map_ + dataOffset_ + (group * columns_.size() + column) * slotSize_);
+}
+
+std::uint32_t ColumnarReader::columnIndex(const std::string& name) const
+{
+    const auto it{std::find(columns_.begin(), columns_.end(), name)};
+    if (it == columns_.end())
+    {
+        throw std::runtime_error("No column " + name + " in " + path_);
+    }
+    return static_cast<std::uint32_t>(it - columns_.begin());
+}
@@ -1,6 +1,8 @@
 // config_parser.cpp
 #include "config_parser.hpp"
 
+#include "fnv1a.hpp"
+
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -111,6 +113,7 @@ void Parser::parse_files(const std::vector<std::string> files,
     {
         const YAML::Node root{YAML::LoadFile(file)};
         const bool isMC{root["mc"].as<bool>()};
+        const size_t firstAdded{datasets.size()};
         datasets.emplace_back(root["name"].as<std::string>(),
                               isMC ? 0 : root["luminosity"].as<double>(),
                               isMC,
@@ -143,6 +146,14 @@ void Parser::parse_files(const std::vector<std::string> files,
                 isMC ? "" : root["trigger_flag"].as<std::string>());
         }
 
+        // Every field can change the result, including any not read here
+        Fnv1a config;
+        config.add(YAML::Dump(root));
+        for (size_t i{firstAdded}; i < datasets.size(); i++)
+        {
+            datasets[i].setConfigFingerprint(config.hex());
+        }
+
         if (root["luminosity"])
         {
             totalLumi += root["luminosity"].as<double>();
@@ -178,3 +189,96 @@ void Parser::parse_plots(const std::string plotConf,
         cutStage.emplace_back((*it)["cutStage"].as<int>());
     }
 }
+
+std::vector<std::string>
+    Parser::parse_mva_variables(const std::string varConf)
+{
+    const YAML::Node root{YAML::LoadFile(varConf)};
+    return root["variables"].as<std::vector<std::string>>();
+}
+
+void Parser::parse_mva_scoring(const std::string scoringConf,
+                               std::vector<std::string>& variables,
+                               std::vector<std::string>& spectators,
+                               std::vector<MvaMethod>& methods)
+{
+    const YAML::Node root{YAML::LoadFile(scoringConf)};
+    variables = root["variables"].as<std::vector<std::string>>();
+    if (root["spectators"])
+    {
+        spectators = root["spectators"].as<std::vector<std::string>>();
+    }
+
+    const YAML::Node methodNodes{root["methods"]};
+    for (YAML::const_iterator it = methodNodes.begin(); it != methodNodes.end();
+         ++it)
+    {
+        methods.push_back({(*it)["name"].as<std::string>(),
+                           (*it)["weights"].as<std::string>(),
+                           (*it)["branch"].as<std::string>(),
+                           (*it)["nBins"].as<int>(),
+                           (*it)["xMin"].as<double>(),
+                           (*it)["xMax"].as<double>()});
+    }
+}
+
+void Parser::parse_mva_templates(const std::string templatesConf,
+                                 std::vector<TemplateObservable>& observables)
+{
+    const YAML::Node root{YAML::LoadFile(templatesConf)};
+    const YAML::Node observableNodes{root["observables"]};
+    for (YAML::const_iterator it = observableNodes.begin();
+         it != observableNodes.end();
+         ++it)
+    {
+        observables.push_back({(*it)["name"].as<std::string>(),
+                               (*it)["variable"].as<std::string>(),
+                               (*it)["nBins"].as<int>(),
+                               (*it)["xMin"].as<double>(),
+                               (*it)["xMax"].as<double>()});
+    }
+}
+
+void Parser::parse_efficiency_binnings(
+    const std::string binningsConf, std::vector<EfficiencyBinning>& binnings)
+{
+    const YAML::Node root{YAML::LoadFile(binningsConf)};
+    const YAML::Node binningNodes{root["binnings"]};
+    for (YAML::const_iterator it = binningNodes.begin();
+         it != binningNodes.end();
+         ++it)
+    {
+        EfficiencyBinning binning{(*it)["name"].as<std::string>(),
+                                  (*it)["x"].as<std::string>(),
+                                  (*it)["xBins"].as<std::vector<double>>(),
+                                  "",
+                                  {}};
+        if ((*it)["y"])
+        {
+            binning.yVariable = (*it)["y"].as<std::string>();
+            binning.yEdges = (*it)["yBins"].as<std::vector<double>>();
+        }
+        binnings.emplace_back(std::move(binning));
+    }
+}
+
+void Parser::parse_acceptance_thresholds(
+    const std::string thresholdsConf,
+    std::vector<AcceptanceThresholds>& thresholds)
+{
+    const auto leptonAcceptance{[](const YAML::Node& node) {
+        return LeptonAcceptance{node["leadingPt"].as<double>(),
+                                node["subleadingPt"].as<double>(),
+                                node["eta"].as<double>()};
+    }};
+    const YAML::Node root{YAML::LoadFile(thresholdsConf)};
+    const YAML::Node thresholdNodes{root["thresholds"]};
+    for (YAML::const_iterator it = thresholdNodes.begin();
+         it != thresholdNodes.end();
+         ++it)
+    {
+        thresholds.push_back({(*it)["name"].as<std::string>(),
+                              leptonAcceptance((*it)["electrons"]),
+                              leptonAcceptance((*it)["muons"])});
+    }
+}
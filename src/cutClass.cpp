@@ -6,6 +6,7 @@
 #include "TLorentzVector.h"
 #include "TRandom.h"
 #include "cutClass.hpp"
+#include "traceEvents.hpp"
 
 #include <boost/functional/hash.hpp>
 #include <cmath>
@@ -15,6 +16,7 @@
 #include <limits>
 #include <random>
 #include <sstream>
+#include <stdexcept>
 #include <yaml-cpp/yaml.h>
 
 Cuts::Cuts(const bool doPlots,
@@ -23,32 +25,17 @@ Cuts::Cuts(const bool doPlots,
            const bool is2016)
     : doPlots_{doPlots}
     , fillCutFlow_{fillCutFlows}
+    , cutFlowCounter_{nullptr}
+    , metPropagation_{nullptr}
     , invertLepCut_{invertLepCut}
     , is2016_{is2016}
 
-    , numTightEle_{3}
-    , tightElePt_{15.}
-    , tightElePtLeading_{35.}
-    , tightEleEta_{2.5}
-    , tightEleRelIso_{0.107587}
+    , selection_{is2016}
 
+    , numTightEle_{3}
     , numLooseEle_{3}
-    , looseElePt_{15.}
-    , looseElePtLeading_{35.}
-    , looseEleEta_{2.5}
-    , looseEleRelIso_{0.15}
-
     , numTightMu_{0}
-    , tightMuonPt_{12.}
-    , tightMuonPtLeading_{27.}
-    , tightMuonEta_{2.4}
-    , tightMuonRelIso_{0.15}
-
     , numLooseMu_{0}
-    , looseMuonPt_{12.}
-    , looseMuonPtLeading_{27.}
-    , looseMuonEta_{2.4}
-    , looseMuonRelIso_{0.25}
 
     , invZMassCut_{20.}
     , invWMassCut_{20.}
@@ -243,33 +230,11 @@ void Cuts::parse_config(const std::string confName)
 
     const YAML::Node cuts{config["cuts"]};
 
-    const YAML::Node tight_eles{cuts["tightElectrons"]};
-    tightElePt_ = tight_eles["pt"].as<double>();
-    tightElePtLeading_ = tight_eles["ptLeading"].as<double>();
-    tightEleEta_ = tight_eles["eta"].as<double>();
-    tightEleRelIso_ = tight_eles["relIso"].as<double>();
-    numTightEle_ = tight_eles["number"].as<unsigned>();
-
-    const YAML::Node loose_eles{cuts["looseElectrons"]};
-    looseElePt_ = loose_eles["pt"].as<double>();
-    looseElePtLeading_ = loose_eles["ptLeading"].as<double>();
-    looseEleEta_ = loose_eles["eta"].as<double>();
-    looseEleRelIso_ = loose_eles["relIso"].as<double>();
-    numLooseEle_ = loose_eles["number"].as<unsigned>();
-
-    const YAML::Node tight_mus{cuts["tightMuons"]};
-    tightMuonPt_ = tight_mus["pt"].as<double>();
-    tightMuonPtLeading_ = tight_mus["ptLeading"].as<double>();
-    tightMuonEta_ = tight_mus["eta"].as<double>();
-    tightMuonRelIso_ = tight_mus["relIso"].as<double>();
-    numTightMu_ = tight_mus["number"].as<unsigned>();
-
-    const YAML::Node loose_mus{cuts["looseMuons"]};
-    looseMuonPt_ = loose_mus["pt"].as<double>();
-    looseMuonPtLeading_ = loose_mus["ptLeading"].as<double>();
-    looseMuonEta_ = loose_mus["eta"].as<double>();
-    looseMuonRelIso_ = loose_mus["relIso"].as<double>();
-    numLooseMu_ = loose_mus["number"].as<unsigned>();
+    selection_.configure(cuts);
+    numTightEle_ = cuts["tightElectrons"]["number"].as<unsigned>();
+    numLooseEle_ = cuts["looseElectrons"]["number"].as<unsigned>();
+    numTightMu_ = cuts["tightMuons"]["number"].as<unsigned>();
+    numLooseMu_ = cuts["looseMuons"]["number"].as<unsigned>();
 
     const YAML::Node jets{cuts["jets"]};
     jetPt_ = jets["pt"].as<double>();
@@ -287,30 +252,87 @@ void Cuts::parse_config(const std::string confName)
 
 bool Cuts::makeCuts(AnalysisEvent& event,
                     double& eventWeight,
-                    std::map<std::string, std::shared_ptr<Plots>>& plotMap,
+                    const StagePlots& plots,
                     TH1D& cutFlow,
                     const int systToRun)
 {
+    TRACE_SCOPE("selection");
+    if (cutFlowCounter_)
+    {
+        cutFlowCounter_->start();
+    }
+
     if (!skipTrigger_)
     {
         if (!triggerCuts(event, eventWeight, systToRun))
         {
+            if (cutFlowCounter_)
+            {
+                cutFlowCounter_->stop();
+            }
             return false; // Do trigger cuts
         }
     }
+    if (cutFlowCounter_)
+    {
+        cutFlowCounter_->pass(CutFlowCounter::trigger, eventWeight);
+    }
 
-    if (!metFilters(event))
+    if (!selection_.metFilters(event, isMC_))
     {
+        if (cutFlowCounter_)
+        {
+            cutFlowCounter_->stop();
+        }
         return false;
     }
+    if (cutFlowCounter_)
+    {
+        cutFlowCounter_->pass(CutFlowCounter::metFilters, eventWeight);
+    }
 
     // Make lepton cuts. If the trigLabel contains d, we are in the ttbar CR
     // so the Z mass cut is skipped
-    if (!makeLeptonCuts(event, eventWeight, plotMap, cutFlow, systToRun))
+    StageRecord leptonStages;
+    leptonStages.timed = cutFlowCounter_ != nullptr;
+    const bool passLeptons{
+        makeLeptonCuts(event, eventWeight, leptonStages, systToRun)};
+    countStages(leptonStages);
+    if (cutFlowCounter_ && !passLeptons)
+    {
+        cutFlowCounter_->stop();
+    }
+    // The lepton stage plots see the jets before jet ID and lepton cleaning,
+    // so they have to be filled before the jet selection replaces them.
+    fillStagePlots(event, leptonStages, plots, cutFlow);
+    if (!passLeptons)
     {
         return false;
     }
+    if (cutFlowCounter_)
+    {
+        cutFlowCounter_->resume();
+    }
 
+    StageRecord jetStages;
+    jetStages.timed = cutFlowCounter_ != nullptr;
+    const bool passJets{
+        makeJetStageCuts(event, eventWeight, jetStages, systToRun)};
+    countStages(jetStages);
+    if (cutFlowCounter_)
+    {
+        cutFlowCounter_->stop();
+    }
+    fillStagePlots(event, jetStages, plots, cutFlow);
+
+    return passJets;
+}
+
+bool Cuts::makeJetStageCuts(AnalysisEvent& event,
+                            double& eventWeight,
+                            StageRecord& stages,
+                            const int systToRun)
+{
     std::tie(event.jetIndex, event.jetSmearValue) =
         makeJetCuts(event, systToRun, eventWeight, true);
 
@@ -323,17 +345,14 @@ bool Cuts::makeCuts(AnalysisEvent& event,
         return false;
     }
 
-    event.bTagIndex = makeBCuts(event, event.jetIndex, systToRun);
-
-    if (doPlots_ || fillCutFlow_)
-    {
-        cutFlow.Fill(2.5, eventWeight);
-    }
-    if (doPlots_)
     {
-        plotMap["jetSel"]->fillAllPlots(event, eventWeight);
+        // Outside makeBCuts, which is pure
+        TRACE_SCOPE("bTag");
+        event.bTagIndex = makeBCuts(event, event.jetIndex, systToRun);
     }
 
+    stages.pass(CutStage::jetSel, eventWeight);
+
     if (event.bTagIndex.size() < numbJets_)
     {
         return false;
@@ -342,14 +361,7 @@ bool Cuts::makeCuts(AnalysisEvent& event,
     {
         return false;
     }
-    if (doPlots_)
-    {
-        plotMap["bTag"]->fillAllPlots(event, eventWeight);
-    }
-    if (doPlots_ || fillCutFlow_)
-    {
-        cutFlow.Fill(3.5, eventWeight);
-    }
+    stages.pass(CutStage::bTag, eventWeight);
 
     // Do wMass stuff
     double invWmass{0.};
@@ -380,22 +392,60 @@ bool Cuts::makeCuts(AnalysisEvent& event,
         {
             return false;
         }
-        if (event.metPF2PATEt >= metDileptonCut_)
+        const double met{
+            metPropagation_
+                ? metPropagation_->met(metVariation(systToRun)).Pt()
+                : event.metPF2PATEt};
+        if (met >= metDileptonCut_)
         {
             return false;
         }
     }
 
-    if (doPlots_)
+    stages.pass(CutStage::wMass, eventWeight);
+
+    return true;
+}
+
+void Cuts::fillStagePlots(const AnalysisEvent& event,
+                          const StageRecord& stages,
+                          const StagePlots& plots,
+                          TH1D& cutFlow) const
+{
+    if (!(doPlots_ || fillCutFlow_))
     {
-        plotMap["wMass"]->fillAllPlots(event, eventWeight);
+        return;
     }
-    if (doPlots_ || fillCutFlow_)
+    TRACE_SCOPE("plots");
+    for (unsigned stage{0}; (stages.mask >> stage) != 0; stage++)
     {
-        cutFlow.Fill(4.5, eventWeight);
+        if (!((stages.mask >> stage) & 1u))
+        {
+            continue;
+        }
+        if (doPlots_)
+        {
+            plots[stage]->fillAllPlots(event, stages.weights[stage]);
+        }
+        cutFlow.Fill(stage + 0.5, stages.weights[stage]);
     }
+}
 
-    return true;
+void Cuts::countStages(const StageRecord& stages) const
+{
+    if (!cutFlowCounter_)
+    {
+        return;
+    }
+    for (unsigned stage{0}; (stages.mask >> stage) != 0; stage++)
+    {
+        if ((stages.mask >> stage) & 1u)
+        {
+            cutFlowCounter_->pass(CutFlowCounter::firstCutStage + stage,
+                                  stages.weights[stage],
+                                  stages.cpuTimes[stage]);
+        }
+    }
 }
 
 std::vector<double> Cuts::getRochesterSFs(const AnalysisEvent& event) const
@@ -461,33 +511,32 @@ std::vector<double> Cuts::getRochesterSFs(const AnalysisEvent& event) const
 }
 
 // Make lepton cuts. Will become customisable in a config later on.
-bool Cuts::makeLeptonCuts(
-    AnalysisEvent& event,
-    double& eventWeight,
-    std::map<std::string, std::shared_ptr<Plots>>& plotMap,
-    TH1D& cutFlow,
-    const int syst,
-    const bool skipZCut)
+bool Cuts::makeLeptonCuts(AnalysisEvent& event,
+                          double& eventWeight,
+                          StageRecord& stages,
+                          const int syst,
+                          const bool skipZCut)
 {
+    TRACE_SCOPE("leptons");
     ////Do lepton selection.
 
-    event.electronIndexTight = getTightEles(event);
+    event.electronIndexTight = selection_.tightElectrons(event);
     if (event.electronIndexTight.size() != numTightEle_)
     {
         return false;
     }
-    event.electronIndexLoose = getLooseEles(event);
+    event.electronIndexLoose = selection_.looseElectrons(event);
     if (event.electronIndexLoose.size() != numLooseEle_)
     {
         return false;
     }
 
-    event.muonIndexTight = getTightMuons(event);
+    event.muonIndexTight = selection_.tightMuons(event);
     if (event.muonIndexTight.size() != numTightMu_)
     {
         return false;
     }
-    event.muonIndexLoose = getLooseMuons(event);
+    event.muonIndexLoose = selection_.looseMuons(event);
     if (event.muonIndexLoose.size() != numLooseMu_)
     {
         return false;
@@ -537,6 +586,7 @@ bool Cuts::makeLeptonCuts(
     // files.
     if (postLepSelTree_)
     {
+        TRACE_SCOPE("treeFill");
         postLepSelTree_->Fill();
     }
 
@@ -550,19 +600,14 @@ bool Cuts::makeLeptonCuts(
 
     eventWeight *= getLeptonWeight(event, syst);
 
+    // The jets used by the lepton stage plots. These don't depend on anything
+    // below, so are only worked out once for both stages.
     if (doPlots_ || fillCutFlow_)
     {
         std::tie(event.jetIndex, event.jetSmearValue) =
             makeJetCuts(event, syst, eventWeight, false);
     }
-    if (doPlots_)
-    {
-        plotMap["lepSel"]->fillAllPlots(event, eventWeight);
-    }
-    if (doPlots_ || fillCutFlow_)
-    {
-        cutFlow.Fill(0.5, eventWeight);
-    }
+    stages.pass(CutStage::lepSel, eventWeight);
 
     if (isNPL_)
     { // if is NPL channel
@@ -617,221 +662,11 @@ bool Cuts::makeLeptonCuts(
         return false;
     }
 
-    if (doPlots_ || fillCutFlow_)
-    {
-        std::tie(event.jetIndex, event.jetSmearValue) =
-            makeJetCuts(event, syst, eventWeight, false);
-    }
-    if (doPlots_)
-    {
-        plotMap["zMass"]->fillAllPlots(event, eventWeight);
-    }
-    if (doPlots_ || fillCutFlow_)
-    {
-        cutFlow.Fill(1.5, eventWeight);
-    }
+    stages.pass(CutStage::zMass, eventWeight);
 
     return true;
 }
 
-std::vector<int> Cuts::getTightEles(const AnalysisEvent& event) const
-{
-    std::vector<int> electrons;
-
-    for (int i{0}; i < event.numElePF2PAT; i++)
-    {
-        if (!event.elePF2PATIsGsf[i])
-            continue;
-
-        if (electrons.size() < 1 && event.elePF2PATPT[i] <= tightElePtLeading_)
-            continue;
-        else if (electrons.size() >= 1 && event.elePF2PATPT[i] <= tightElePt_)
-            continue;
-
-        if (std::abs(event.elePF2PATSCEta[i]) > tightEleEta_)
-            continue;
-
-        // Ensure we aren't in the barrel/endcap gap and below the max safe eta
-        // range
-        if ((std::abs(event.elePF2PATSCEta[i]) > 1.4442
-             && std::abs(event.elePF2PATSCEta[i]) < 1.566)
-            || std::abs(event.elePF2PATSCEta[i]) > 2.50)
-            continue;
-
-        // VID cut
-        if (event.elePF2PATCutIdTight[i] < 1)
-            continue;
-
-        // Cuts not part of the tuned ID
-        if (std::abs(event.elePF2PATSCEta[i]) <= 1.479)
-        {
-            if (std::abs(event.elePF2PATD0PV[i]) >= 0.05)
-                continue;
-            if (std::abs(event.elePF2PATDZPV[i]) >= 0.10)
-                continue;
-        }
-        else if (std::abs(event.elePF2PATSCEta[i]) > 1.479
-                 && std::abs(event.elePF2PATSCEta[i]) < 2.50)
-        {
-            if (std::abs(event.elePF2PATD0PV[i]) >= 0.10)
-                continue;
-            if (std::abs(event.elePF2PATDZPV[i]) >= 0.20)
-                continue;
-        }
-        electrons.emplace_back(i);
-    }
-    return electrons;
-}
-
-std::vector<int> Cuts::getLooseEles(const AnalysisEvent& event) const
-{
-    std::vector<int> electrons;
-    for (int i{0}; i < event.numElePF2PAT; i++)
-    {
-        if (electrons.size() < 1 && event.elePF2PATPT[i] <= looseElePtLeading_)
-            continue;
-        else if (electrons.size() >= 1 && event.elePF2PATPT[i] <= looseElePt_)
-            continue;
-        if (std::abs(event.elePF2PATSCEta[i]) > tightEleEta_)
-            continue;
-
-        // Ensure we aren't in the barrel/endcap gap and below the max safe
-        // eta range
-        if ((std::abs(event.elePF2PATSCEta[i]) > 1.4442
-             && std::abs(event.elePF2PATSCEta[i]) < 1.566)
-            || std::abs(event.elePF2PATSCEta[i]) > 2.50)
-            continue;
-
-        // VID cut
-        if (!event.elePF2PATCutIdVeto[i])
-            continue;
-
-        // Cuts not part of the tuned ID
-        if (std::abs(event.elePF2PATSCEta[i]) <= 1.479)
-        {
-            if (std::abs(event.elePF2PATD0PV[i]) >= 0.05)
-                continue;
-            if (std::abs(event.elePF2PATDZPV[i]) >= 0.10)
-                continue;
-        }
-        else if (std::abs(event.elePF2PATSCEta[i]) > 1.479
-                 && std::abs(event.elePF2PATSCEta[i]) < 2.50)
-        {
-            if (std::abs(event.elePF2PATD0PV[i]) >= 0.10)
-                continue;
-            if (std::abs(event.elePF2PATDZPV[i]) >= 0.20)
-                continue;
-        }
-        electrons.emplace_back(i);
-    }
-    return electrons;
-}
-
-std::vector<int> Cuts::getTightMuons(const AnalysisEvent& event) const
-{
-    std::vector<int> muons;
-    if (is2016_)
-    {
-        for (int i{0}; i < event.numMuonPF2PAT; i++)
-        {
-            if (!event.muonPF2PATIsPFMuon[i])
-                continue;
-
-            if (muons.size() < 1
-                && event.muonPF2PATPt[i] <= tightMuonPtLeading_)
-                continue;
-            else if (muons.size() >= 1 && event.muonPF2PATPt[i] <= tightMuonPt_)
-                continue;
-
-            if (std::abs(event.muonPF2PATEta[i]) >= tightMuonEta_)
-                continue;
-            if (event.muonPF2PATComRelIsodBeta[i] >= tightMuonRelIso_)
-                continue;
-
-            // Tight ID Cut
-            if (!event.muonPF2PATTrackID[i])
-                continue;
-            if (!event.muonPF2PATGlobalID[i])
-                continue;
-            if (event.muonPF2PATGlbTkNormChi2[i] >= 10.)
-                continue;
-            if (event.muonPF2PATMatchedStations[i] < 2)
-                continue; //
-            if (std::abs(event.muonPF2PATDBPV[i]) >= 0.2)
-                continue;
-            if (std::abs(event.muonPF2PATDZPV[i]) >= 0.5)
-                continue;
-            if (event.muonPF2PATMuonNHits[i] < 1)
-                continue;
-            if (event.muonPF2PATVldPixHits[i] < 1)
-                continue;
-            if (event.muonPF2PATTkLysWithMeasurements[i] <= 5)
-                continue;
-            muons.emplace_back(i);
-        }
-    }
-    else
-    {
-        for (int i{0}; i < event.numMuonPF2PAT; i++)
-        {
-            if (event.muonPF2PATIsPFMuon[i] && event.muonPF2PATTightCutId[i]
-                && event.muonPF2PATPfIsoTight[i]
-                && std::abs(event.muonPF2PATEta[i]) <= tightMuonEta_)
-            {
-                if (event.muonPF2PATPt[i]
-                    >= (muons.empty() ? tightMuonPtLeading_ : tightMuonPt_))
-                {
-                    muons.emplace_back(i);
-                }
-            }
-        }
-    }
-    return muons;
-}
-
-std::vector<int> Cuts::getLooseMuons(const AnalysisEvent& event) const
-{
-    std::vector<int> muons;
-    if (is2016_)
-    {
-        for (int i{0}; i < event.numMuonPF2PAT; i++)
-        {
-            if (!event.muonPF2PATIsPFMuon[i])
-                continue;
-
-            if (muons.size() < 1
-                && event.muonPF2PATPt[i] <= looseMuonPtLeading_)
-                continue;
-            else if (muons.size() >= 1 && event.muonPF2PATPt[i] <= looseMuonPt_)
-                continue;
-
-            if (std::abs(event.muonPF2PATEta[i]) >= looseMuonEta_)
-                continue;
-            if (event.muonPF2PATComRelIsodBeta[i] >= looseMuonRelIso_)
-                continue;
-            if (event.muonPF2PATGlobalID[i] || event.muonPF2PATTrackID[i])
-                muons.emplace_back(i);
-        }
-    }
-    else
-    {
-        for (int i{0}; i < event.numMuonPF2PAT; i++)
-        {
-            if (event.muonPF2PATIsPFMuon[i] && event.muonPF2PATLooseCutId[i]
-                && event.muonPF2PATPfIsoLoose[i]
-                && std::abs(event.muonPF2PATEta[i]) < looseMuonEta_)
-            {
-                if (event.muonPF2PATPt[i]
-                    >= (muons.empty() ? looseMuonPtLeading_ : looseMuonPt_))
-                {
-                    muons.emplace_back(i);
-                }
-            }
-        }
-    }
-    return muons;
-}
-
 bool Cuts::getDileptonZCand(AnalysisEvent& event,
                             const std::vector<int> electrons,
                             const std::vector<int> muons) const
@@ -1012,6 +847,7 @@ double Cuts::getWbosonQuarksCand(AnalysisEvent& event,
                                  const std::vector<int> jets,
                                  const int syst) const
 {
+    TRACE_SCOPE("wReco");
     auto closestWmass{std::numeric_limits<double>::infinity()};
     if (jets.size() > 2)
     {
@@ -1080,6 +916,13 @@ std::pair<std::vector<int>, std::vector<double>>
                       double& eventWeight,
                       const bool isProper) const
 {
+    TRACE_SCOPE("jets");
+    if (event.jetSmearValueNominal.size()
+        != static_cast<size_t>(event.numJetPF2PAT))
+    {
+        throw std::logic_error(
+            "Cuts::smearJets must be called for each event before makeCuts");
+    }
     std::vector<int> jets;
     std::vector<double> smears;
 
@@ -1103,165 +946,21 @@ std::pair<std::vector<int>, std::vector<double>>
             continue;
         }
 
-        bool jetId{true};
-
-        if (jetIDDo_ && isProper)
-        {
-            if (is2016_)
-            {
-                // Jet ID == loose
-                if (std::abs(jetVec.Eta()) <= 2.7)
-                { // for cases where jet eta <= 2.7
-
-                    // for all jets with eta <= 2.7
-                    if (event.jetPF2PATNeutralHadronEnergyFraction[i] >= 0.99)
-                    {
-                        jetId = false;
-                    }
-                    if (event.jetPF2PATNeutralEmEnergyFraction[i] >= 0.99)
-                    {
-                        jetId = false;
-                    }
-                    if ((event.jetPF2PATChargedMultiplicity[i]
-                         + event.jetPF2PATNeutralMultiplicity[i])
-                        <= 1)
-                    {
-                        jetId = false;
-                    }
-
-                    // for jets with eta <= 2.40
-                    if (std::abs(jetVec.Eta()) <= 2.40)
-                    {
-                        if (event.jetPF2PATChargedHadronEnergyFraction[i]
-                            <= 0.0)
-                        {
-                            jetId = false;
-                        }
-                        if (event.jetPF2PATChargedMultiplicity[i] <= 0.0)
-                        {
-                            jetId = false;
-                        }
-                        if (event.jetPF2PATChargedEmEnergyFraction[i] >= 0.99)
-                        {
-                            jetId = false;
-                        }
-                    }
-                }
-                else if (std::abs(jetVec.Eta()) <= 3.0
-                         && std::abs(jetVec.Eta()) > 2.70)
-                {
-                    if (event.jetPF2PATNeutralHadronEnergyFraction[i] >= 0.98)
-                    {
-                        jetId = false;
-                    }
-                    if (event.jetPF2PATNeutralEmEnergyFraction[i] <= 0.01)
-                    {
-                        jetId = false;
-                    }
-                    if (event.jetPF2PATNeutralMultiplicity[i] <= 2)
-                    {
-                        jetId = false;
-                    }
-                }
-                else if (std::abs(jetVec.Eta()) > 3.0)
-                { // for cases where jet eta > 3.0 and less than 5.0 (or max).
-                    if (event.jetPF2PATNeutralEmEnergyFraction[i] >= 0.90)
-                    {
-                        jetId = false;
-                    }
-                    if (event.jetPF2PATNeutralMultiplicity[i] <= 10)
-                    {
-                        jetId = false;
-                    }
-                }
-            }
-            else
-            {
-                // Jet ID == tightLepVeto (loose is deprecated)
-                // https://twiki.cern.ch/twiki/bin/view/CMS/JetID13TeVRun2017
-                if (std::abs(jetVec.Eta()) <= 2.7)
-                { // for cases where jet eta <= 2.7
-
-                    // for all jets with eta <= 2.7
-                    if (event.jetPF2PATNeutralHadronEnergyFraction[i] >= 0.90)
-                    {
-                        jetId = false;
-                    }
-                    if (event.jetPF2PATNeutralEmEnergyFraction[i] >= 0.90)
-                    {
-                        jetId = false;
-                    }
-                    if (event.jetPF2PATNConstituents[i] <= 1)
-                    {
-                        jetId = false;
-                    }
-                    if (event.jetPF2PATMuonFraction[i] >= 0.8)
-                    {
-                        jetId = false;
-                    }
-
-                    // for jets with eta <= 2.40
-                    if (std::abs(jetVec.Eta()) <= 2.40)
-                    {
-                        if (event.jetPF2PATChargedHadronEnergyFraction[i]
-                            <= 0.0)
-                        {
-                            jetId = false;
-                        }
-                        if (event.jetPF2PATChargedMultiplicity[i] <= 0.0)
-                        {
-                            jetId = false;
-                        }
-                        if (event.jetPF2PATChargedEmEnergyFraction[i] >= 0.8)
-                        {
-                            jetId = false;
-                        }
-                    }
-                }
-                else if (std::abs(jetVec.Eta()) <= 3.0
-                         && std::abs(jetVec.Eta()) > 2.70)
-                {
-                    if (event.jetPF2PATNeutralEmEnergyFraction[i] <= 0.02
-                        || event.jetPF2PATNeutralEmEnergyFraction[i] >= 0.99)
-                    {
-                        jetId = false;
-                    }
-                    if (event.jetPF2PATNeutralMultiplicity[i] <= 2)
-                    {
-                        jetId = false;
-                    }
-                }
-                else if (std::abs(jetVec.Eta()) > 3.0)
-                { // for cases where jet eta > 3.0 and less than 5.0 (or max).
-                    if (event.jetPF2PATNeutralEmEnergyFraction[i] >= 0.90)
-                    {
-                        jetId = false;
-                    }
-                    if (event.jetPF2PATNeutralHadronEnergyFraction[i] <= 0.02)
-                    {
-                        jetId = false;
-                    }
-                    if (event.jetPF2PATNeutralMultiplicity[i] <= 10)
-                    {
-                        jetId = false;
-                    }
-                }
-            }
-        }
-
-        if (!jetId)
+        if (jetIDDo_ && isProper
+            && !selection_.passesJetId(event, i, jetVec.Eta()))
         {
             continue;
         }
 
-        const double deltaLep{std::min(deltaR(event.zPairLeptons.first.Eta(),
-                                              event.zPairLeptons.first.Phi(),
-                                              jetVec.Eta(),
-                                              jetVec.Phi()),
-                                       deltaR(event.zPairLeptons.second.Eta(),
-                                              event.zPairLeptons.second.Phi(),
-                                              jetVec.Eta(),
-                                              jetVec.Phi()))};
+        const double deltaLep{
+            std::min(ObjectSelection::deltaR(event.zPairLeptons.first.Eta(),
+                                             event.zPairLeptons.first.Phi(),
+                                             jetVec.Eta(),
+                                             jetVec.Phi()),
+                     ObjectSelection::deltaR(event.zPairLeptons.second.Eta(),
+                                             event.zPairLeptons.second.Phi(),
+                                             jetVec.Eta(),
+                                             jetVec.Phi()))};
 
         if (deltaLep < 0.4 && isProper)
         {
@@ -1389,6 +1088,7 @@ bool Cuts::triggerCuts(const AnalysisEvent& event,
                        double& eventWeight,
                        const int syst) const
 {
+    TRACE_SCOPE("trigger");
     if (skipTrigger_)
     {
         return true;
@@ -1600,51 +1300,6 @@ bool Cuts::triggerCuts(const AnalysisEvent& event,
     return false;
 }
 
-// Does event pass MET Filter
-bool Cuts::metFilters(const AnalysisEvent& event) const
-{
-    if (event.Flag_HBHENoiseFilter <= 0 || event.Flag_HBHENoiseIsoFilter <= 0
-        || event.Flag_globalTightHalo2016Filter <= 0
-        || event.Flag_EcalDeadCellTriggerPrimitiveFilter <= 0
-        || event.Flag_goodVertices <= 0)
-    {
-        return false;
-    }
-
-    if (is2016_
-        && (event.Flag_ecalLaserCorrFilter <= 0
-            || event.Flag_chargedHadronTrackResolutionFilter <= 0
-            || event.Flag_muonBadTrackFilter <= 0
-            || (!isMC_ && event.Flag_noBadMuons <= 0)))
-    {
-        return false;
-    }
-
-    if (!is2016_
-        && (event.Flag_BadPFMuonFilter <= 0
-            || event.Flag_BadChargedCandidateFilter <= 0
-            || event.Flag_ecalBadCalibFilter <= 0))
-    {
-        return false;
-    }
-
-    return true;
-}
-
-double Cuts::deltaPhi(const double phi1, const double phi2)
-{
-    return std::atan2(std::sin(phi1 - phi2), std::cos(phi1 - phi2));
-}
-
-double Cuts::deltaR(const double eta1,
-                    const double phi1,
-                    const double eta2,
-                    const double phi2)
-{
-    return std::sqrt(std::pow(eta1 - eta2, 2)
-                     + std::pow(deltaPhi(phi1, phi2), 2));
-}
-
 double Cuts::getLeptonWeight(const AnalysisEvent& event, const int syst) const
 {
     // If number of electrons is > 1  then both z pair are electrons, so get
@@ -1993,40 +1648,55 @@ std::pair<TLorentzVector, double> Cuts::getJetLVec(const AnalysisEvent& event,
                                                    const int syst,
                                                    const bool initialRun) const
 {
-    static constexpr double MIN_JET_ENERGY{1e-2};
-    TLorentzVector returnJet;
-    double newSmearValue{1.0};
-
+    // On the initial run the smear of syst is taken from those smearJets
+    // worked out; after that it is the one stored in the event
+    double newSmearValue;
     if (!initialRun)
     {
         newSmearValue = event.jetSmearValue.at(index);
-        returnJet.SetPxPyPzE(event.jetPF2PATPx[index],
-                             event.jetPF2PATPy[index],
-                             event.jetPF2PATPz[index],
-                             event.jetPF2PATE[index]);
-        returnJet *= newSmearValue;
+    }
+    else if (syst == 16)
+    {
+        newSmearValue = event.jetSmearValueUp.at(index);
+    }
+    else if (syst == 32)
+    {
+        newSmearValue = event.jetSmearValueDown.at(index);
+    }
+    else
+    {
+        newSmearValue = event.jetSmearValueNominal.at(index);
+    }
 
-        if (isMC_)
-        {
-            double jerUncer{
-                getJECUncertainty(returnJet.Pt(), returnJet.Eta(), syst)};
-            returnJet *= 1 + jerUncer;
-        }
+    TLorentzVector returnJet;
+    returnJet.SetPxPyPzE(event.jetPF2PATPx[index],
+                         event.jetPF2PATPy[index],
+                         event.jetPF2PATPz[index],
+                         event.jetPF2PATE[index]);
+    returnJet *= newSmearValue;
 
-        return {returnJet, newSmearValue};
+    if (isMC_)
+    {
+        double jerUncer{
+            getJECUncertainty(returnJet.Pt(), returnJet.Eta(), syst)};
+        returnJet *= 1 + jerUncer;
     }
 
+    return {returnJet, newSmearValue};
+}
+
+double Cuts::getJetSmear(const AnalysisEvent& event,
+                         const int index,
+                         const int syst) const
+{
+    static constexpr double MIN_JET_ENERGY{1e-2};
+    double newSmearValue{1.0};
+
     if (!isMC_)
     {
-        returnJet.SetPxPyPzE(event.jetPF2PATPx[index],
-                             event.jetPF2PATPy[index],
-                             event.jetPF2PATPz[index],
-                             event.jetPF2PATE[index]);
-        return {returnJet, newSmearValue};
+        return newSmearValue;
     }
 
-    // Not initial run, smear must be calculated
-
     // TODO: Check this is correct
     // For now, just leave jets of too large/small pT, large rho, or large η
     // untouched
@@ -2036,11 +1706,7 @@ std::pair<TLorentzVector, double> Cuts::getJetLVec(const AnalysisEvent& event,
         || rho > (is2016_ ? 40.9 : 42.52)
         || std::abs(event.jetPF2PATEta[index]) > 4.7)
     {
-        returnJet.SetPxPyPzE(event.jetPF2PATPx[index],
-                             event.jetPF2PATPy[index],
-                             event.jetPF2PATPz[index],
-                             event.jetPF2PATE[index]);
-        return {returnJet, newSmearValue};
+        return newSmearValue;
     }
 
     // TODO: Should this be gen or reco level?
@@ -2069,7 +1735,11 @@ std::pair<TLorentzVector, double> Cuts::getJetLVec(const AnalysisEvent& event,
     std::optional<size_t> matchingGenIndex{std::nullopt};
     for (size_t genIndex{0}; genIndex < event.NJETSMAX; ++genIndex)
     {
-        const double dR{deltaR(event.genJetPF2PATEta[genIndex], event.genJetPF2PATPhi[genIndex], event.jetPF2PATEta[index], event.jetPF2PATPhi[index])};
+        const double dR{
+            ObjectSelection::deltaR(event.genJetPF2PATEta[genIndex],
+                                    event.genJetPF2PATPhi[genIndex],
+                                    event.jetPF2PATEta[index],
+                                    event.jetPF2PATPhi[index])};
         const double dPt{event.jetPF2PATPtRaw[index] - event.genJetPF2PATPT[genIndex]};
 
         if (event.genJetPF2PATPT[genIndex] > 0 && dR < (0.4 / 2.0)
@@ -2112,20 +1782,70 @@ std::pair<TLorentzVector, double> Cuts::getJetLVec(const AnalysisEvent& event,
         newSmearValue = MIN_JET_ENERGY / event.jetPF2PATE[index];
     }
 
-    returnJet.SetPxPyPzE(event.jetPF2PATPx[index],
-                         event.jetPF2PATPy[index],
-                         event.jetPF2PATPz[index],
-                         event.jetPF2PATE[index]);
-    returnJet *= newSmearValue;
+    return newSmearValue;
+}
 
-    if (isMC_)
+void Cuts::smearJets(AnalysisEvent& event) const
+{
+    TRACE_SCOPE("smearJets");
+    const auto numJets{static_cast<size_t>(event.numJetPF2PAT)};
+    event.jetSmearValueNominal.resize(numJets);
+    event.jetSmearValueUp.resize(numJets);
+    event.jetSmearValueDown.resize(numJets);
+    for (int i{0}; i < event.numJetPF2PAT; i++)
     {
-        double jerUncer{
-            getJECUncertainty(returnJet.Pt(), returnJet.Eta(), syst)};
-        returnJet *= 1 + jerUncer;
+        event.jetSmearValueNominal[i] = getJetSmear(event, i, 0);
+        event.jetSmearValueUp[i] = getJetSmear(event, i, 16);
+        event.jetSmearValueDown[i] = getJetSmear(event, i, 32);
     }
+}
 
-    return {returnJet, newSmearValue};
+MetPropagation Cuts::propagateMet(const AnalysisEvent& event) const
+{
+    MetPropagation metPropagation{
+        event.metPF2PATEt * std::cos(event.metPF2PATPhi),
+        event.metPF2PATEt * std::sin(event.metPF2PATPhi)};
+    if (!isMC_)
+    {
+        return metPropagation;
+    }
+
+    for (int i{0}; i < event.numJetPF2PAT; i++)
+    {
+        TLorentzVector jet;
+        jet.SetPxPyPzE(event.jetPF2PATPx[i],
+                       event.jetPF2PATPy[i],
+                       event.jetPF2PATPz[i],
+                       event.jetPF2PATE[i]);
+        const double smear{event.jetSmearValueNominal.at(i)};
+        const TLorentzVector smeared{jet * smear};
+        metPropagation.addJet(
+            jet,
+            smear,
+            event.jetSmearValueUp.at(i),
+            event.jetSmearValueDown.at(i),
+            getJECUncertainty(smeared.Pt(), smeared.Eta(), 4),
+            getJECUncertainty(smeared.Pt(), smeared.Eta(), 8));
+    }
+
+    return metPropagation;
+}
+
+MetPropagation::Variation Cuts::metVariation(const int syst)
+{
+    switch (syst)
+    {
+        case 4:
+            return MetPropagation::Variation::jesUp;
+        case 8:
+            return MetPropagation::Variation::jesDown;
+        case 16:
+            return MetPropagation::Variation::jerUp;
+        case 32:
+            return MetPropagation::Variation::jerDown;
+        default:
+            return MetPropagation::Variation::nominal;
+    }
 }
 
 double
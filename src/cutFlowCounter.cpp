@@ -0,0 +1,141 @@
+#include "cutFlowCounter.hpp"
+
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+
+namespace
+{
+// Dataset and channel names are plain, but quotes and backslashes would still
+// break the output
+std::string jsonString(const std::string& value)
+{
+    std::string escaped{"\""};
+    for (const char c : value)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped + '"';
+}
+
+std::array<std::string, CutFlowCounter::numStages> stageNames()
+{
+    std::array<std::string, CutFlowCounter::numStages> names{
+        {"trigger", "metFilters"}};
+    for (unsigned stage{0}; stage < CutStage::numStages; stage++)
+    {
+        names[CutFlowCounter::firstCutStage + stage] = CutStage::names[stage];
+    }
+    return names;
+}
+} // namespace
+
+const std::array<std::string, CutFlowCounter::numStages> CutFlowCounter::names{
+    stageNames()};
+
+CutFlowCounter::CutFlowCounter()
+    : entered_{0}
+    , stages_{}
+    , next_{numStages}
+    , last_{0}
+{
+}
+
+double CutFlowCounter::cpuSeconds()
+{
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+void CutFlowCounter::start()
+{
+    entered_++;
+    next_ = 0;
+    last_ = cpuSeconds();
+}
+
+void CutFlowCounter::pass(const unsigned stage,
+                          const double weight,
+                          const double cpuTime)
+{
+    Stage& counts{stages_[stage]};
+    counts.events++;
+    counts.weighted += weight;
+    counts.weighted2 += weight * weight;
+    counts.cpuSeconds += cpuTime - last_;
+    last_ = cpuTime;
+    next_ = stage + 1;
+}
+
+void CutFlowCounter::stop()
+{
+    if (next_ < numStages)
+    {
+        const double now{cpuSeconds()};
+        stages_[next_].cpuSeconds += now - last_;
+        last_ = now;
+    }
+    next_ = numStages;
+}
+
+void CutFlowCounter::resume()
+{
+    last_ = cpuSeconds();
+}
+
+void CutFlowCounter::merge(const CutFlowCounter& other)
+{
+    entered_ += other.entered_;
+    for (unsigned stage{0}; stage < numStages; stage++)
+    {
+        stages_[stage].events += other.stages_[stage].events;
+        stages_[stage].weighted += other.stages_[stage].weighted;
+        stages_[stage].weighted2 += other.stages_[stage].weighted2;
+        stages_[stage].cpuSeconds += other.stages_[stage].cpuSeconds;
+    }
+}
+
+void CutFlowCounter::writeJson(std::ostream& out,
+                               const std::string& dataset,
+                               const std::string& channel,
+                               const long eventsRead,
+                               const double wallSeconds) const
+{
+    const auto flags{out.flags()};
+    const auto precision{out.precision()};
+    out << std::setprecision(10) << std::defaultfloat;
+
+    out << "{\n";
+    out << "  \"dataset\": " << jsonString(dataset) << ",\n";
+    out << "  \"channel\": " << jsonString(channel) << ",\n";
+    out << "  \"eventsRead\": " << eventsRead << ",\n";
+    out << "  \"selectionsRun\": " << entered_ << ",\n";
+    out << "  \"wallSeconds\": " << wallSeconds << ",\n";
+    out << "  \"eventsPerSecond\": "
+        << (wallSeconds > 0 ? eventsRead / wallSeconds : 0.) << ",\n";
+    out << "  \"stages\": [";
+    for (unsigned stage{0}; stage < numStages; stage++)
+    {
+        const Stage& counts{stages_[stage]};
+        // The events tested against this stage, passing or not
+        const long tested{stage == 0 ? entered_ : stages_[stage - 1].events};
+        out << (stage == 0 ? "\n" : ",\n");
+        out << "    {\"name\": " << jsonString(names[stage])
+            << ", \"events\": " << counts.events
+            << ", \"weighted\": " << counts.weighted
+            << ", \"weightedError\": " << std::sqrt(counts.weighted2)
+            << ", \"cpuSeconds\": " << counts.cpuSeconds
+            << ", \"eventsPerSecond\": "
+            << (counts.cpuSeconds > 0 ? tested / counts.cpuSeconds : 0.)
+            << "}";
+    }
+    out << "\n  ]\n}\n";
+
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -4,12 +4,11 @@
 #include "TColor.h"
 #include "TFile.h"
 #include "TH1.h"
+#include "datasetIndex.hpp"
 
 #include <boost/filesystem.hpp>
-#include <boost/range/iterator_range.hpp>
 #include <fstream>
 #include <iostream>
-#include <regex>
 
 namespace fs = boost::filesystem;
 
@@ -91,38 +90,34 @@ float Dataset::getEventWeight()
 }
 
 // Function that constructs a histogram of all the generator level weights from
-// across the entire dataset
+// across the entire dataset. The per-file sums come from each location's
+// DatasetIndex, so only new or changed files are opened.
 TH1I* Dataset::getGeneratorWeightHistogram(int nFiles)
 {
     TH1I* generatorWeightPlot{nullptr};
-    const std::regex mask{R"(\.root$)"};
-    bool firstFile{true};
     for (const auto& location : locations_)
     {
-        for (const auto& file :
-             boost::make_iterator_range(fs::directory_iterator{location}, {}))
+        DatasetIndex index{location, treeName_};
+        const unsigned rescanned{index.update()};
+        if (rescanned > 0)
         {
-            const std::string path{file.path().string()};
-            if (!fs::is_regular_file(file.status())
-                || !std::regex_search(path, mask))
-            {
-                continue;
-            }
+            std::cout << "Indexed " << rescanned << " new or changed files in "
+                      << location << std::endl;
+        }
 
-            TFile* tempFile{new TFile{path.c_str(), "READ"}};
-            if (firstFile)
-            {
-                generatorWeightPlot = dynamic_cast<TH1I*>(
-                    (TH1I*)tempFile->Get("sumNumPosMinusNegWeights")->Clone());
-                firstFile = false;
-            }
-            else
-            {
-                generatorWeightPlot->Add(
-                    (TH1I*)tempFile->Get("sumNumPosMinusNegWeights"));
-                tempFile->Close();
-                delete tempFile;
-            }
+        TH1I* const locationWeights{index.generatorWeightHistogram()};
+        if (!locationWeights)
+        {
+            continue;
+        }
+        if (!generatorWeightPlot)
+        {
+            generatorWeightPlot = locationWeights;
+        }
+        else
+        {
+            generatorWeightPlot->Add(locationWeights);
+            delete locationWeights;
         }
     }
 
@@ -0,0 +1,253 @@
+#include "datasetIndex.hpp"
+
+#include "TFile.h"
+#include "TH1I.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace fs = boost::filesystem;
+
+const std::string DatasetIndex::indexName{".datasetIndex"};
+
+namespace
+{
+const std::string indexHeader{"# datasetIndex v1"};
+}
+
+DatasetIndex::DatasetIndex(std::string location, std::string treeName)
+    : location_{std::move(location)}
+    , treeName_{std::move(treeName)}
+    , nBins_{0}
+    , xMin_{0}
+    , xMax_{0}
+{
+}
+
+unsigned DatasetIndex::update()
+{
+    const bool haveIndex{read()};
+
+    std::map<std::string, FileRecord> previous;
+    for (auto& record : files_)
+    {
+        previous.emplace(record.name, std::move(record));
+    }
+    files_.clear();
+
+    std::vector<std::string> names;
+    for (const auto& file :
+         boost::make_iterator_range(fs::directory_iterator{location_}, {}))
+    {
+        if (fs::is_regular_file(file.status())
+            && file.path().extension() == ".root")
+        {
+            names.emplace_back(file.path().filename().string());
+        }
+    }
+    std::sort(names.begin(), names.end());
+
+    unsigned rescanned{0};
+    for (const auto& name : names)
+    {
+        const fs::path path{location_ + name};
+        const auto cached{previous.find(name)};
+        if (cached != previous.end()
+            && cached->second.size == fs::file_size(path)
+            && cached->second.mtime == fs::last_write_time(path))
+        {
+            files_.emplace_back(std::move(cached->second));
+            previous.erase(cached);
+            continue;
+        }
+        files_.emplace_back(scanFile(name));
+        rescanned++;
+    }
+
+    // Anything left in previous has been deleted since the last update
+    if (!haveIndex || rescanned > 0 || !previous.empty())
+    {
+        write();
+    }
+    return rescanned;
+}
+
+long long DatasetIndex::totalEntries() const
+{
+    long long total{0};
+    for (const auto& record : files_)
+    {
+        total += record.entries;
+    }
+    return total;
+}
+
+TH1I* DatasetIndex::generatorWeightHistogram() const
+{
+    if (files_.empty())
+    {
+        return nullptr;
+    }
+
+    TH1I* generatorWeightPlot{new TH1I{"sumNumPosMinusNegWeights",
+                                       "sumNumPosMinusNegWeights",
+                                       nBins_,
+                                       xMin_,
+                                       xMax_}};
+    generatorWeightPlot->SetDirectory(nullptr);
+    for (int bin{0}; bin <= nBins_ + 1; bin++)
+    {
+        double content{0};
+        for (const auto& record : files_)
+        {
+            content += record.weightBins[bin];
+        }
+        generatorWeightPlot->SetBinContent(bin, content);
+    }
+    return generatorWeightPlot;
+}
+
+// Returns false if there is no usable index yet.
+bool DatasetIndex::read()
+{
+    files_.clear();
+    nBins_ = 0;
+
+    std::ifstream indexFile{location_ + indexName};
+    std::string line;
+    if (!indexFile || !std::getline(indexFile, line) || line != indexHeader)
+    {
+        return false;
+    }
+    if (!std::getline(indexFile, line)
+        || !(std::istringstream{line} >> nBins_ >> xMin_ >> xMax_))
+    {
+        return false;
+    }
+
+    while (std::getline(indexFile, line))
+    {
+        std::istringstream lineStream{line};
+        FileRecord record;
+        lineStream >> std::quoted(record.name) >> record.size >> record.mtime
+            >> record.checksum >> record.entries;
+        record.weightBins.resize(nBins_ + 2);
+        for (auto& bin : record.weightBins)
+        {
+            lineStream >> bin;
+        }
+        if (!lineStream)
+        {
+            std::cerr << "Ignoring corrupt dataset index " << location_
+                      << indexName << std::endl;
+            files_.clear();
+            return false;
+        }
+        files_.emplace_back(std::move(record));
+    }
+    return true;
+}
+
+void DatasetIndex::write() const
+{
+    const std::string indexPath{location_ + indexName};
+    // Jobs indexing the same dataset at once each write their own file, and
+    // the last rename wins
+    const std::string tmpPath{indexPath + "." + std::to_string(getpid())
+                              + ".tmp"};
+    {
+        std::ofstream indexFile{tmpPath};
+        if (!indexFile)
+        {
+            std::cerr << "WARNING: could not write dataset index " << indexPath
+                      << ", it will be rebuilt next time" << std::endl;
+            return;
+        }
+        indexFile << std::setprecision(std::numeric_limits<double>::max_digits10);
+        indexFile << indexHeader << '\n'
+                  << nBins_ << ' ' << xMin_ << ' ' << xMax_ << '\n';
+        for (const auto& record : files_)
+        {
+            indexFile << std::quoted(record.name) << ' ' << record.size << ' '
+                      << record.mtime << ' ' << record.checksum << ' '
+                      << record.entries;
+            for (const double bin : record.weightBins)
+            {
+                indexFile << ' ' << bin;
+            }
+            indexFile << '\n';
+        }
+    }
+    fs::rename(tmpPath, indexPath);
+}
+
+DatasetIndex::FileRecord DatasetIndex::scanFile(const std::string& name)
+{
+    const std::string path{location_ + name};
+    FileRecord record;
+    record.name = name;
+    record.size = fs::file_size(path);
+    record.mtime = fs::last_write_time(path);
+    record.checksum = checksum(path);
+
+    const std::unique_ptr<TFile> file{TFile::Open(path.c_str(), "READ")};
+    if (!file || file->IsZombie())
+    {
+        throw std::runtime_error("Could not open " + path);
+    }
+
+    TTree* const tree{dynamic_cast<TTree*>(file->Get(treeName_.c_str()))};
+    record.entries = tree ? tree->GetEntries() : 0;
+
+    TH1I* const weights{
+        dynamic_cast<TH1I*>(file->Get("sumNumPosMinusNegWeights"))};
+    if (!weights)
+    {
+        throw std::runtime_error("No sumNumPosMinusNegWeights in " + path);
+    }
+    // The binning is fixed by the nTupliser; it is taken from the first file
+    // indexed and every other file must agree with it.
+    if (nBins_ == 0)
+    {
+        nBins_ = weights->GetNbinsX();
+        xMin_ = weights->GetXaxis()->GetXmin();
+        xMax_ = weights->GetXaxis()->GetXmax();
+    }
+    else if (weights->GetNbinsX() != nBins_)
+    {
+        throw std::runtime_error("sumNumPosMinusNegWeights binning in " + path
+                                 + " differs from the rest of the dataset");
+    }
+    for (int bin{0}; bin <= nBins_ + 1; bin++)
+    {
+        record.weightBins.emplace_back(weights->GetBinContent(bin));
+    }
+
+    return record;
+}
+
+std::uint32_t DatasetIndex::checksum(const std::string& path)
+{
+    std::ifstream file{path, std::ios::binary};
+    std::vector<char> buffer(1 << 20);
+    uLong sum{adler32(0L, Z_NULL, 0)};
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0)
+    {
+        sum = adler32(sum,
+                      reinterpret_cast<const Bytef*>(buffer.data()),
+                      static_cast<uInt>(file.gcount()));
+    }
+    return static_cast<std::uint32_t>(sum);
+}
@@ -0,0 +1,70 @@
+#include "TH1I.h"
+#include "config_parser.hpp"
+#include "dataset.hpp"
+
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Builds or refreshes the .datasetIndex sidecar files for every MC dataset in
+// the given configs, so that the first analysis run after new nTuples arrive
+// doesn't have to do it. Only files added or changed since the last index are
+// read.
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> configs;
+
+    namespace po = boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()("help,h", "Print this message.")(
+        "config,c",
+        po::value<std::vector<std::string>>(&configs)->multitoken()->required(),
+        "The configuration file(s) listing the datasets to index.");
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<Dataset> datasets;
+    double totalLumi{0};
+    for (const auto& config : configs)
+    {
+        Parser::parse_config(config, datasets, totalLumi);
+    }
+
+    for (auto& dataset : datasets)
+    {
+        // Generator weights are only ever looked up for MC
+        if (!dataset.isMC())
+        {
+            continue;
+        }
+        TH1I* const generatorWeights{dataset.getGeneratorWeightHistogram(-1)};
+        std::cout << dataset.name() << ": ";
+        if (!generatorWeights)
+        {
+            std::cout << "no files found" << std::endl;
+            continue;
+        }
+        std::cout << "sumNumPosMinusNegWeights integral "
+                  << generatorWeights->Integral() << ", total_events "
+                  << dataset.getTotalEvents() << std::endl;
+        delete generatorWeights;
+    }
+}
@@ -0,0 +1,66 @@
+#include "eventIndex.hpp"
+
+#include <algorithm>
+
+void EventIndex::add(const std::uint32_t run, const std::uint32_t event)
+{
+    pending_.emplace_back(run, event);
+}
+
+void EventIndex::finalise()
+{
+    // Merge in anything already finalised, so add/finalise can be repeated
+    for (std::size_t run{0}; run < runs_.size(); run++)
+    {
+        for (std::size_t i{runStarts_[run]}; i < runStarts_[run + 1]; i++)
+        {
+            pending_.emplace_back(runs_[run], events_[i]);
+        }
+    }
+    std::sort(pending_.begin(), pending_.end());
+    pending_.erase(std::unique(pending_.begin(), pending_.end()),
+                   pending_.end());
+
+    runs_.clear();
+    runStarts_.clear();
+    events_.clear();
+    events_.reserve(pending_.size());
+    for (const auto& key : pending_)
+    {
+        if (runs_.empty() || runs_.back() != key.first)
+        {
+            runs_.emplace_back(key.first);
+            runStarts_.emplace_back(events_.size());
+        }
+        events_.emplace_back(key.second);
+    }
+    runStarts_.emplace_back(events_.size());
+
+    // Release the build buffer, which is twice the size of the index
+    std::vector<std::pair<std::uint32_t, std::uint32_t>>{}.swap(pending_);
+    runs_.shrink_to_fit();
+    runStarts_.shrink_to_fit();
+}
+
+bool EventIndex::contains(const std::uint32_t run,
+                          const std::uint32_t event) const
+{
+    const auto runIt{std::lower_bound(runs_.begin(), runs_.end(), run)};
+    if (runIt == runs_.end() || *runIt != run)
+    {
+        return false;
+    }
+    const auto runIndex{static_cast<std::size_t>(runIt - runs_.begin())};
+    const auto begin{events_.begin()
+                     + static_cast<std::ptrdiff_t>(runStarts_[runIndex])};
+    const auto end{events_.begin()
+                   + static_cast<std::ptrdiff_t>(runStarts_[runIndex + 1])};
+    return std::binary_search(begin, end, event);
+}
+
+std::size_t EventIndex::memoryUsage() const
+{
+    return runs_.capacity() * sizeof(std::uint32_t)
+           + runStarts_.capacity() * sizeof(std::size_t)
+           + events_.capacity() * sizeof(std::uint32_t);
+}
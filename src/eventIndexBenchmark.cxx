@@ -0,0 +1,218 @@
+#include "eventIndex.hpp"
+
+#include <atomic>
+#include <boost/format.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Compares the memory use and lookup rate of the EventIndex used by
+// postTriggerSkimmer.exe for removing events already in the dilepton skims
+// with the std::unordered_set of (run, event) pairs it replaced, on
+// synthetic run and event numbers.
+
+namespace
+{
+typedef std::unordered_set<std::pair<int, int>,
+                           boost::hash<std::pair<int, int>>>
+    PairSet;
+
+// Resident set size in bytes
+double residentBytes()
+{
+    std::ifstream statm{"/proc/self/statm"};
+    double size;
+    double resident;
+    statm >> size >> resident;
+    return resident * static_cast<double>(sysconf(_SC_PAGESIZE));
+}
+
+// Resets the peak resident set size to the current one, so the next peak can
+// be read by peakBytes()
+void resetPeak()
+{
+    std::ofstream{"/proc/self/clear_refs"} << "5";
+}
+
+// Peak resident set size in bytes since the last resetPeak
+double peakBytes()
+{
+    std::ifstream status{"/proc/self/status"};
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return std::stod(line.substr(6)) * 1024;
+        }
+    }
+    return 0;
+}
+
+double seconds(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                         - start)
+        .count();
+}
+
+struct Key
+{
+    std::uint32_t run;
+    std::uint32_t event;
+};
+
+// Looks every query up from nThreads threads at once, returning the lookups
+// per second and the number found
+template <typename Contains>
+std::pair<double, size_t> lookUp(const std::vector<Key>& queries,
+                                 const unsigned nThreads,
+                                 Contains contains)
+{
+    std::atomic<size_t> found{0};
+    const auto start{std::chrono::steady_clock::now()};
+    std::vector<std::thread> threads;
+    for (unsigned thread{0}; thread < nThreads; thread++)
+    {
+        threads.emplace_back([&, thread] {
+            size_t threadFound{0};
+            for (size_t i{thread}; i < queries.size(); i += nThreads)
+            {
+                threadFound += contains(queries[i]);
+            }
+            found += threadFound;
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    return {static_cast<double>(queries.size()) / seconds(start), found};
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    size_t nEvents;
+    unsigned nRuns;
+    size_t nLookups;
+    unsigned nThreads;
+
+    namespace po = boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()("help,h", "Print this message.")(
+        "events,n",
+        po::value<size_t>(&nEvents)->default_value(20000000),
+        "Number of dilepton events to index.")(
+        "runs,r",
+        po::value<unsigned>(&nRuns)->default_value(1000),
+        "Number of runs the events are spread over.")(
+        "lookups,l",
+        po::value<size_t>(&nLookups)->default_value(20000000),
+        "Number of single lepton events to look up, half of them indexed.")(
+        "threads,t",
+        po::value<unsigned>(&nThreads)->default_value(
+            std::thread::hardware_concurrency()),
+        "Number of threads to look events up from.");
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    nRuns = std::max(nRuns, 1u);
+    nThreads = std::max(nThreads, 1u);
+
+    // Event numbers below 2^31, so the old int keys hold them too
+    std::mt19937_64 random{42};
+    std::uniform_int_distribution<std::uint32_t> runDist{273000,
+                                                         273000 + nRuns - 1};
+    std::uniform_int_distribution<std::uint32_t> eventDist{1, (1U << 31) - 1};
+    std::vector<Key> events(nEvents);
+    for (auto& key : events)
+    {
+        key = {runDist(random), eventDist(random)};
+    }
+    std::vector<Key> queries(nLookups);
+    for (size_t i{0}; i < nLookups; i++)
+    {
+        queries[i] = i % 2 == 0 && !events.empty()
+                         ? events[random() % events.size()]
+                         : Key{runDist(random), eventDist(random)};
+    }
+
+    // The memory held once built, and the peak while building, above what
+    // was resident before
+    boost::format line{"%-14s %10.1f MB (%5.1f B/event) peak %10.1f MB  "
+                       "build %7.2f s  lookup %8.2f M/s (%d threads)  "
+                       "found %d"};
+
+    {
+        const double before{residentBytes()};
+        resetPeak();
+        const auto start{std::chrono::steady_clock::now()};
+        EventIndex index;
+        for (const auto& key : events)
+        {
+            index.add(key.run, key.event);
+        }
+        index.finalise();
+        const double build{seconds(start)};
+        const double memory{residentBytes() - before};
+        const double peak{peakBytes() - before};
+        const auto [rate, found]{lookUp(queries, nThreads, [&](const Key& key) {
+            return index.contains(key.run, key.event);
+        })};
+        std::cout << line % "EventIndex" % (memory / (1 << 20))
+                         % (memory / static_cast<double>(index.size()))
+                         % (peak / (1 << 20)) % build
+                         % (rate / 1e6) % nThreads % found
+                  << std::endl;
+    }
+
+    {
+        const double before{residentBytes()};
+        resetPeak();
+        const auto start{std::chrono::steady_clock::now()};
+        PairSet set;
+        for (const auto& key : events)
+        {
+            set.emplace(static_cast<int>(key.run), static_cast<int>(key.event));
+        }
+        const double build{seconds(start)};
+        const double memory{residentBytes() - before};
+        const double peak{peakBytes() - before};
+        const auto [rate, found]{lookUp(queries, nThreads, [&](const Key& key) {
+            return set.count({static_cast<int>(key.run),
+                              static_cast<int>(key.event)})
+                   > 0;
+        })};
+        std::cout << line % "unordered_set" % (memory / (1 << 20))
+                         % (memory / static_cast<double>(set.size()))
+                         % (peak / (1 << 20)) % build
+                         % (rate / 1e6) % nThreads % found
+                  << std::endl;
+    }
+}
@@ -0,0 +1,71 @@
+#include "forkWorkers.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+// Whether the worker exited successfully
+bool waitFor(const pid_t pid)
+{
+    int status{0};
+    pid_t waited;
+    do
+    {
+        waited = waitpid(pid, &status, 0);
+    } while (waited < 0 && errno == EINTR);
+    return waited == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+} // namespace
+
+bool forkWorkers(const unsigned nWorkers,
+                 const std::function<bool(unsigned, unsigned)>& work,
+                 const std::string& what)
+{
+    std::cout.flush();
+    std::cerr.flush();
+
+    std::vector<pid_t> workers;
+    for (unsigned worker{0}; worker < nWorkers; worker++)
+    {
+        const pid_t pid{fork()};
+        if (pid < 0)
+        {
+            const std::string error{std::strerror(errno)};
+            for (const pid_t started : workers)
+            {
+                waitFor(started);
+            }
+            throw std::runtime_error("Could not fork " + what + ": " + error);
+        }
+        if (pid == 0)
+        {
+            int status{1};
+            try
+            {
+                status = work(worker, nWorkers) ? 0 : 1;
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "ERROR: " << e.what() << std::endl;
+            }
+            std::cerr.flush();
+            std::cout.flush();
+            // Skip destructors and atexit handlers, which belong to the parent
+            _exit(status);
+        }
+        workers.emplace_back(pid);
+    }
+
+    bool succeeded{true};
+    for (const pid_t pid : workers)
+    {
+        succeeded &= waitFor(pid);
+    }
+    return succeeded;
+}
@@ -0,0 +1,146 @@
+#include "genAcceptance.hpp"
+
+#include "AnalysisEvent.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+AcceptanceCounts& AcceptanceCounts::operator+=(const AcceptanceCounts& other)
+{
+    twoElectrons += other.twoElectrons;
+    electronEta += other.electronEta;
+    electronPt += other.electronPt;
+    twoMuons += other.twoMuons;
+    muonEta += other.muonEta;
+    muonPt += other.muonPt;
+    accepted += other.accepted;
+    lostFromFirst += other.lostFromFirst;
+    return *this;
+}
+
+GenAcceptance::GenAcceptance(std::vector<AcceptanceThresholds> thresholds)
+    : thresholds_{std::move(thresholds)}
+    , counts_(thresholds_.size())
+    , events_{0}
+{
+    if (thresholds_.empty())
+    {
+        throw std::runtime_error("No acceptance thresholds given");
+    }
+    electrons_.reserve(AnalysisEvent::NGENPARMAX);
+    muons_.reserve(AnalysisEvent::NGENPARMAX);
+}
+
+void GenAcceptance::fill(const AnalysisEvent& event)
+{
+    events_++;
+
+    electrons_.clear();
+    muons_.clear();
+    for (int i{0}; i < event.nGenPar; i++)
+    {
+        switch (std::abs(event.genParId[i]))
+        {
+            case 11: // electron
+                electrons_.push_back(
+                    {event.genParPt[i], std::abs(event.genParEta[i])});
+                break;
+            case 13: // muon
+                muons_.push_back(
+                    {event.genParPt[i], std::abs(event.genParEta[i])});
+                break;
+            default: break;
+        }
+    }
+
+    bool acceptedByFirst{false};
+    for (size_t set{0}; set < thresholds_.size(); set++)
+    {
+        AcceptanceCounts& counts{counts_[set]};
+        // Both evaluated, so that each flavour's steps are always counted
+        const bool electrons{passes(electrons_,
+                                    thresholds_[set].electrons,
+                                    counts.twoElectrons,
+                                    counts.electronEta,
+                                    counts.electronPt)};
+        const bool muons{passes(muons_,
+                                thresholds_[set].muons,
+                                counts.twoMuons,
+                                counts.muonEta,
+                                counts.muonPt)};
+        const bool accepted{electrons || muons};
+        if (set == 0)
+        {
+            acceptedByFirst = accepted;
+        }
+        if (accepted)
+        {
+            counts.accepted++;
+        }
+        else if (acceptedByFirst)
+        {
+            counts.lostFromFirst++;
+        }
+    }
+}
+
+bool GenAcceptance::passes(const std::vector<GenLepton>& leptons,
+                           const LeptonAcceptance& acceptance,
+                           long& two,
+                           long& eta,
+                           long& pt)
+{
+    if (leptons.size() < 2)
+    {
+        return false;
+    }
+    two++;
+
+    // The two hardest leptons within eta, in a single pass
+    int nWithinEta{0};
+    float leading{0};
+    float subleading{0};
+    for (const auto& lepton : leptons)
+    {
+        if (lepton.absEta > acceptance.eta)
+        {
+            continue;
+        }
+        nWithinEta++;
+        if (lepton.pt > leading)
+        {
+            subleading = leading;
+            leading = lepton.pt;
+        }
+        else if (lepton.pt > subleading)
+        {
+            subleading = lepton.pt;
+        }
+    }
+    if (nWithinEta < 2)
+    {
+        return false;
+    }
+    eta++;
+
+    if (leading <= acceptance.leadingPt
+        || subleading <= acceptance.subleadingPt)
+    {
+        return false;
+    }
+    pt++;
+    return true;
+}
+
+void GenAcceptance::merge(const GenAcceptance& other)
+{
+    if (other.counts_.size() != counts_.size())
+    {
+        throw std::logic_error("Merging acceptances of different thresholds");
+    }
+    events_ += other.events_;
+    for (size_t set{0}; set < counts_.size(); set++)
+    {
+        counts_[set] += other.counts_[set];
+    }
+}
@@ -8,12 +8,15 @@
 #include "TMath.h"
 #include "TPad.h"
 #include "TStyle.h"
+#include "forkWorkers.hpp"
 
 // For CMS Guideline styling
 #include "TASImage.h"
 #include "TLatex.h"
 
+#include <algorithm>
 #include <boost/filesystem.hpp>
+#include <stdexcept>
 #include <sys/stat.h>
 
 // For debugging. *sigh*
@@ -33,6 +36,8 @@ HistogramPlotter::HistogramPlotter(std::vector<std::string> legOrder,
     , postfix_{"defaultPostfix"}
     , is2016_{is2016}
     , loadHistos_{false}
+    , plotJobs_{1}
+    , histogramStoreName_{"histogramStore.root"}
     ,
 
     // Some things that actually need to be set. plot order, legend order and
@@ -83,6 +88,7 @@ HistogramPlotter::~HistogramPlotter()
 }
 
 void HistogramPlotter::plotHistos(
+    std::string systChannel,
     std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>
         plotMap)
 {
@@ -99,6 +105,7 @@ void HistogramPlotter::plotHistos(
     // with all datasets in it.
     unsigned long plotNumb{
         firstIt->second.begin()->second->getPlotPoint().size()};
+    std::vector<PlotJob> plotJobs;
     for (unsigned i{0}; i < plotNumb; i++)
     {
         for (auto stageIt = stageNameVec.begin(); stageIt != stageNameVec.end();
@@ -109,23 +116,12 @@ void HistogramPlotter::plotHistos(
             {
                 if (loadHistos_)
                 {
-                    TFile* inputFile = new TFile{
-                        (histogramDirectory_
-                         + firstIt->second[*stageIt]->getPlotPoint()[i].name
-                         + "_Histo.root")
-                            .c_str(),
-                        "READ"};
-                    TH1D* tempHist =
-                        dynamic_cast<TH1D*>(inputFile
-                                                ->Get((firstIt->second[*stageIt]
-                                                           ->getPlotPoint()[i]
-                                                           .name)
-                                                          .c_str())
-                                                ->Clone());
-                    tempHist->SetDirectory(0);
-                    tempPlotMap[mapIt->first] = tempHist;
-                    inputFile->Close();
-                    delete inputFile;
+                    tempPlotMap[mapIt->first] =
+                        histogramStore(HistogramStore::Mode::Read)
+                            .get(systChannel + "/" + *stageIt,
+                                 mapIt->second[*stageIt]
+                                     ->getPlotPoint()[i]
+                                     .name);
                 }
                 else if (!loadHistos_)
                 {
@@ -135,11 +131,50 @@ void HistogramPlotter::plotHistos(
             }
             std::vector<std::string> xAxisLabel = {
                 firstIt->second[*stageIt]->getPlotPoint()[i].xAxisLabel};
-            makePlot(tempPlotMap,
-                     firstIt->second[*stageIt]->getPlotPoint()[i].title,
-                     firstIt->second[*stageIt]->getPlotPoint()[i].name,
-                     xAxisLabel);
+            plotJobs.push_back(
+                {tempPlotMap,
+                 firstIt->second[*stageIt]->getPlotPoint()[i].title,
+                 firstIt->second[*stageIt]->getPlotPoint()[i].name,
+                 xAxisLabel});
+        }
+    }
+    renderPlots(plotJobs);
+}
+
+void HistogramPlotter::renderPlots(const std::vector<PlotJob>& plotJobs)
+{
+    if (plotJobs_ <= 1 || plotJobs.size() <= 1)
+    {
+        for (const auto& job : plotJobs)
+        {
+            makePlot(job.plotMap, job.title, job.name, job.xAxisLabels);
         }
+        return;
+    }
+
+    // ROOT graphics aren't thread safe, so the plots are shared out between
+    // forked workers instead. Each one gets a copy of the histograms and its
+    // own canvases and style, and plot i always goes to worker i % N. Output
+    // file names only depend on the plot, never on the worker.
+    const unsigned nWorkers{std::min<unsigned>(
+        plotJobs_, static_cast<unsigned>(plotJobs.size()))};
+    const bool succeeded{forkWorkers(
+        nWorkers,
+        [&](const unsigned worker, const unsigned workers) {
+            setTDRStyle();
+            for (size_t i{worker}; i < plotJobs.size(); i += workers)
+            {
+                makePlot(plotJobs[i].plotMap,
+                         plotJobs[i].title,
+                         plotJobs[i].name,
+                         plotJobs[i].xAxisLabels);
+            }
+            return true;
+        },
+        "plotting worker")};
+    if (!succeeded)
+    {
+        throw std::runtime_error("One or more plotting workers failed");
     }
 }
 
@@ -151,15 +186,9 @@ std::map<std::string, TH1D*>
     for (auto plot_iter = plotOrder_.rbegin(); plot_iter != plotOrder_.rend();
          plot_iter++)
     {
-        TFile* inputFile =
-            new TFile{(histogramDirectory_ + *plot_iter + "_" + channel + "_"
-                       + plotName + "_Histo.root")
-                          .c_str(),
-                      "READ"};
-        cutFlowMap.emplace(
-            *plot_iter,
-            dynamic_cast<TH1D*>(
-                inputFile->Get((*plot_iter + "cutFlow").c_str())->Clone()));
+        cutFlowMap.emplace(*plot_iter,
+                           histogramStore(HistogramStore::Mode::Read)
+                               .get(plotName + "/" + channel, *plot_iter));
     }
     return cutFlowMap;
 }
@@ -168,73 +197,60 @@ void HistogramPlotter::saveHistos(std::map<std::string, TH1D*> cutFlowMap,
                                   std::string plotName,
                                   std::string channel)
 {
+    HistogramStore& store{histogramStore(HistogramStore::Mode::Write)};
     for (auto plot_iter = plotOrder_.rbegin(); plot_iter != plotOrder_.rend();
          plot_iter++)
     {
-        TFile* outFile = new TFile{(histogramDirectory_ + *plot_iter + "_"
-                                    + channel + "_" + plotName + "_Histo.root")
-                                       .c_str(),
-                                   "RECREATE"};
-        outFile->cd();
-        cutFlowMap[*plot_iter]->Write(); // Write histo to file
-        outFile->Write();
-        outFile->Close();
-        delete outFile;
+        store.put(plotName + "/" + channel, *plot_iter, *cutFlowMap[*plot_iter]);
     }
 }
 
 void HistogramPlotter::saveHistos(
+    std::string systChannel,
     std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>
         plotMap)
 {
-    // Get a list of keys from the map.
-    auto firstIt = plotMap.begin();
-    std::vector<std::string> stageNameVec;
-    for (auto stageNameIt = firstIt->second.begin();
-         stageNameIt != firstIt->second.end();
-         stageNameIt++)
-    {
-        stageNameVec.emplace_back(stageNameIt->first);
-    }
+    HistogramStore& store{histogramStore(HistogramStore::Mode::Write)};
 
-    // Loop over all the plots, for each stage name. Then create a map for each
-    // with all datasets in it.
-    unsigned long plotNumb{
-        firstIt->second.begin()->second->getPlotPoint().size()};
-    for (unsigned i{0}; i < plotNumb; i++)
+    // Plot names already carry the dataset, stage, systematic and channel, so
+    // they are unique within a stage directory.
+    for (auto mapIt = plotMap.begin(); mapIt != plotMap.end(); mapIt++)
     {
-        for (auto stageIt = stageNameVec.begin(); stageIt != stageNameVec.end();
+        for (auto stageIt = mapIt->second.begin();
+             stageIt != mapIt->second.end();
              stageIt++)
         {
-            std::map<std::string, TH1D*> tempPlotMap;
-            for (auto mapIt = plotMap.begin(); mapIt != plotMap.end(); mapIt++)
-            {
-                tempPlotMap[mapIt->first] =
-                    mapIt->second[*stageIt]->getPlotPoint()[i].plotHist;
-            }
-            for (auto plot_iter = plotOrder_.rbegin();
-                 plot_iter != plotOrder_.rend();
-                 plot_iter++)
+            for (const auto& plotPoint : stageIt->second->getPlotPoint())
             {
-                TFile* outFile = new TFile{
-                    (histogramDirectory_
-                     + firstIt->second[*stageIt]->getPlotPoint()[i].name
-                     + "_Histo.root")
-                        .c_str(),
-                    "RECREATE"};
-                outFile->cd();
-                tempPlotMap[*plot_iter]->SetName(
-                    (firstIt->second[*stageIt]->getPlotPoint()[i].name)
-                        .c_str());
-                tempPlotMap[*plot_iter]->Write(); // Write histo to file
-                outFile->Write();
-                outFile->Close();
-                delete outFile;
+                store.put(systChannel + "/" + stageIt->first,
+                          plotPoint.name,
+                          *plotPoint.plotHist);
             }
         }
     }
 }
 
+void HistogramPlotter::closeHistogramStore()
+{
+    histogramStore_.reset();
+}
+
+HistogramStore& HistogramPlotter::histogramStore(const HistogramStore::Mode mode)
+{
+    const std::string path{histogramDirectory_ + histogramStoreName_};
+    // Closing a store being written commits it, so it can be read back
+    if (histogramStore_
+        && (histogramStore_->mode() != mode || histogramStore_->path() != path))
+    {
+        histogramStore_.reset();
+    }
+    if (!histogramStore_)
+    {
+        histogramStore_ = std::make_unique<HistogramStore>(path, mode);
+    }
+    return *histogramStore_;
+}
+
 void HistogramPlotter::makePlot(std::map<std::string, TH1D*> plotMap,
                                 std::string plotTitle,
                                 std::string plotName)
@@ -511,9 +527,13 @@ void HistogramPlotter::setLabelTextSize(float size)
     labelThree_->SetTextSize(size);
 }
 
-void HistogramPlotter::setHistogramFolder(std::string histoDir)
+void HistogramPlotter::setHistogramFolder(std::string histoDir,
+                                          std::string channel)
 {
     histogramDirectory_ = histoDir;
+    histogramStoreName_ = channel.empty()
+                              ? "histogramStore.root"
+                              : "histogramStore_" + channel + ".root";
     boost::filesystem::create_directories(histogramDirectory_.c_str());
 }
 
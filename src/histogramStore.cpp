@@ -0,0 +1,230 @@
+#include "histogramStore.hpp"
+
+#include "TClass.h"
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TH1D.h"
+#include "TKey.h"
+
+#include <boost/filesystem.hpp>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = boost::filesystem;
+
+HistogramStore::HistogramStore(std::string path, const Mode mode)
+    : path_{std::move(path)}
+    , mode_{mode}
+{
+    if (mode_ == Mode::Write)
+    {
+        const fs::path parent{fs::path{path_}.parent_path()};
+        if (!parent.empty())
+        {
+            fs::create_directories(parent);
+        }
+        file_.reset(new TFile{(path_ + ".tmp").c_str(), "RECREATE"});
+    }
+    else
+    {
+        file_.reset(new TFile{path_.c_str(), "READ"});
+    }
+
+    if (file_->IsZombie())
+    {
+        throw std::runtime_error("Could not open histogram store " + path_);
+    }
+}
+
+HistogramStore::~HistogramStore()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+    }
+}
+
+void HistogramStore::put(const std::string& dir,
+                         const std::string& name,
+                         const TH1& hist)
+{
+    if (mode_ != Mode::Write || !file_)
+    {
+        throw std::logic_error("Histogram store " + path_
+                               + " is not open for writing");
+    }
+    getOrMakeDirectory(dir)->WriteTObject(&hist, name.c_str(), "Overwrite");
+}
+
+TH1D* HistogramStore::get(const std::string& dir,
+                          const std::string& name) const
+{
+    const std::string key{dir + "/" + name};
+    TH1D* const storedHist{
+        file_ ? dynamic_cast<TH1D*>(file_->Get(key.c_str())) : nullptr};
+    if (!storedHist)
+    {
+        throw std::runtime_error("No histogram " + key + " in histogram store "
+                                 + path_);
+    }
+    storedHist->SetDirectory(nullptr);
+    return storedHist;
+}
+
+bool HistogramStore::contains(const std::string& dir,
+                              const std::string& name) const
+{
+    if (!file_)
+    {
+        return false;
+    }
+    TDirectory* const directory{file_->GetDirectory(dir.c_str())};
+    return directory && directory->GetKey(name.c_str());
+}
+
+std::vector<std::string> HistogramStore::keys() const
+{
+    std::vector<std::string> keys;
+    std::vector<std::pair<TDirectory*, std::string>> toVisit{{file_.get(), ""}};
+    while (!toVisit.empty() && file_)
+    {
+        const auto [dir, prefix] = toVisit.back();
+        toVisit.pop_back();
+
+        std::set<std::string> seen; // Keys come newest cycle first
+        for (TObject* obj : *dir->GetListOfKeys())
+        {
+            TKey* const key{dynamic_cast<TKey*>(obj)};
+            if (!seen.emplace(key->GetName()).second)
+            {
+                continue;
+            }
+            const TClass* const keyClass{TClass::GetClass(key->GetClassName())};
+            if (keyClass->InheritsFrom(TDirectory::Class()))
+            {
+                toVisit.emplace_back(dir->GetDirectory(key->GetName()),
+                                     prefix + key->GetName() + "/");
+            }
+            else if (keyClass->InheritsFrom(TH1::Class()))
+            {
+                keys.emplace_back(prefix + key->GetName());
+            }
+        }
+    }
+    return keys;
+}
+
+void HistogramStore::close()
+{
+    if (!file_)
+    {
+        return;
+    }
+
+    if (mode_ == Mode::Write)
+    {
+        // TFile::Flush syncs the descriptor, so this is the only fsync paid
+        // for however many histograms went in.
+        file_->Write(nullptr, TObject::kOverwrite);
+        file_->Flush();
+        file_->Close();
+        file_.reset();
+        directories_.clear();
+        fs::rename(path_ + ".tmp", path_);
+    }
+    else
+    {
+        file_->Close();
+        file_.reset();
+    }
+}
+
+void HistogramStore::merge(const std::vector<std::string>& inputs,
+                           const std::string& output)
+{
+    std::map<std::string, std::unique_ptr<TH1>> histos;
+
+    for (const auto& input : inputs)
+    {
+        HistogramStore inStore{input, Mode::Read};
+        collect(inStore.file_.get(), "", histos);
+    }
+
+    HistogramStore outStore{output, Mode::Write};
+    for (const auto& [key, hist] : histos)
+    {
+        const size_t split{key.rfind('/')};
+        outStore.put(split == std::string::npos ? "" : key.substr(0, split),
+                     key.substr(split + 1),
+                     *hist);
+    }
+    outStore.close();
+}
+
+TDirectory* HistogramStore::getOrMakeDirectory(const std::string& dir)
+{
+    const auto cached{directories_.find(dir)};
+    if (cached != directories_.end())
+    {
+        return cached->second;
+    }
+
+    TDirectory* current{file_.get()};
+    std::istringstream dirStream{dir};
+    std::string component;
+    while (std::getline(dirStream, component, '/'))
+    {
+        if (component.empty())
+        {
+            continue;
+        }
+        TDirectory* next{current->GetDirectory(component.c_str())};
+        current = next ? next : current->mkdir(component.c_str());
+    }
+    directories_.emplace(dir, current);
+    return current;
+}
+
+void HistogramStore::collect(
+    TDirectory* dir,
+    const std::string& prefix,
+    std::map<std::string, std::unique_ptr<TH1>>& histos)
+{
+    std::set<std::string> seen;
+    for (TObject* obj : *dir->GetListOfKeys())
+    {
+        TKey* const key{dynamic_cast<TKey*>(obj)};
+        if (!seen.emplace(key->GetName()).second)
+        {
+            continue;
+        }
+        const TClass* const keyClass{TClass::GetClass(key->GetClassName())};
+        if (keyClass->InheritsFrom(TDirectory::Class()))
+        {
+            collect(dir->GetDirectory(key->GetName()),
+                    prefix + key->GetName() + "/",
+                    histos);
+        }
+        else if (keyClass->InheritsFrom(TH1::Class()))
+        {
+            std::unique_ptr<TH1> hist{dynamic_cast<TH1*>(key->ReadObj())};
+            hist->SetDirectory(nullptr);
+            const std::string fullKey{prefix + key->GetName()};
+            const auto existing{histos.find(fullKey)};
+            if (existing == histos.end())
+            {
+                histos.emplace(fullKey, std::move(hist));
+            }
+            else
+            {
+                existing->second->Add(hist.get());
+            }
+        }
+    }
+}
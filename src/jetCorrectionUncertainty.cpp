@@ -114,28 +114,3 @@ double JetCorrectionUncertainty::getUncertainty(const double pt,
 
     return a * pt + b;
 }
-
-std::pair<double, double> JetCorrectionUncertainty::getMetAfterJESUnc(
-    double metPx, double metPy, const MvaEvent& tree, const int jesUD) const
-{
-    for (int i{0}; i != tree.numJetPF2PAT; i++)
-    {
-        metPx += tree.jetPF2PATPx[i];
-        metPy += tree.jetPF2PATPy[i];
-
-        const double uncertainty{
-            getUncertainty(tree.jetPF2PATPt[i], tree.jetPF2PATEta[i], jesUD)};
-
-        if (jesUD == 1)
-        {
-            metPx -= (1 + uncertainty) * tree.jetPF2PATPx[i];
-            metPy -= (1 + uncertainty) * tree.jetPF2PATPy[i];
-        }
-        else
-        {
-            metPx -= (1 - uncertainty) * tree.jetPF2PATPx[i];
-            metPy -= (1 - uncertainty) * tree.jetPF2PATPy[i];
-        }
-    }
-    return {metPx, metPy};
-}
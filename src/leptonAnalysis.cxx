@@ -1,27 +1,205 @@
 #include "AnalysisEvent.hpp"
-#include "TChain.h"
 #include "TFile.h"
 #include "TH1F.h"
 #include "TH2F.h"
-#include "TMVA/Timer.h"
+#include "TROOT.h"
 #include "TTree.h"
+#include "config_parser.hpp"
+#include "genAcceptance.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <boost/filesystem.hpp>
-#include <boost/numeric/conversion/cast.hpp>
 #include <boost/program_options.hpp>
 #include <boost/range/iterator_range.hpp>
-#include <fstream>
 #include <iostream>
-#include <iterator>
 #include <memory>
-#include <sstream>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+namespace
+{
+// The reco and gen lepton distributions. Each thread fills its own, added
+// together at the end.
+struct LeptonHistograms
+{
+    TH1F elePt{
+        "histElePt", "Distribution of reco-electron p_{T}", 500, 0.0, 500.0};
+    TH1F eleEta{
+        "histEleEta", "Distribution of reco-electron #eta", 500, -2.50, 2.5};
+    TH1F eleGenPt{
+        "histEleGenPt", "Distribution of gen-electron p_{T}", 500, 0.0, 500.0};
+    TH1F eleGenEta{
+        "histEleGenEta", "Distribution of gen-electron #eta", 500, -2.5, 2.5};
+
+    TH1F muPt{"histMuPt", "Distribution of reco-muon p_{T}", 500, 0.0, 500.0};
+    TH1F muEta{"histMuEta", "Distribution of reco-muon #eta", 500, -2.50, 2.5};
+    TH1F muGenPt{
+        "histMuGenPt", "Distribution of gen-muon p_{T}", 500, 0.0, 500.0};
+    TH1F muGenEta{
+        "histMuGenEta", "Distribution of gen-muon #eta", 500, -2.5, 2.5};
+
+    TH2F eleGenPtEta{"histEleGenPtEta",
+                     "Distribution of reco-electron p_{T} against #eta",
+                     500,
+                     0,
+                     300,
+                     500,
+                     -3,
+                     3};
+    TH2F muGenPtEta{"histMuGenPtEta",
+                    "Distribution of reco-muon p_{T} against #eta",
+                    500,
+                    0,
+                    300,
+                    500,
+                    -3,
+                    3};
+
+    void fill(const AnalysisEvent& event)
+    {
+        for (Int_t k{0}; k < event.numElePF2PAT; k++)
+        {
+            elePt.Fill(event.elePF2PATPT[k]);
+            eleEta.Fill(event.elePF2PATEta[k]);
+            eleGenPt.Fill(event.genElePF2PATPT[k]);
+            eleGenEta.Fill(event.genElePF2PATEta[k]);
+
+            eleGenPtEta.Fill(event.elePF2PATPT[k], event.elePF2PATEta[k]);
+        }
+        for (Int_t k{0}; k < event.numMuonPF2PAT; k++)
+        {
+            muPt.Fill(event.muonPF2PATPt[k]);
+            muEta.Fill(event.muonPF2PATEta[k]);
+            muGenPt.Fill(event.genMuonPF2PATPT[k]);
+            muGenEta.Fill(event.genMuonPF2PATEta[k]);
+
+            muGenPtEta.Fill(event.muonPF2PATPt[k], event.muonPF2PATEta[k]);
+        }
+    }
+
+    void add(const LeptonHistograms& other)
+    {
+        elePt.Add(&other.elePt);
+        eleEta.Add(&other.eleEta);
+        eleGenPt.Add(&other.eleGenPt);
+        eleGenEta.Add(&other.eleGenEta);
+        muPt.Add(&other.muPt);
+        muEta.Add(&other.muEta);
+        muGenPt.Add(&other.muGenPt);
+        muGenEta.Add(&other.muGenEta);
+        eleGenPtEta.Add(&other.eleGenPtEta);
+        muGenPtEta.Add(&other.muGenPtEta);
+    }
+
+    void write()
+    {
+        elePt.Write();
+        eleEta.Write();
+        eleGenPt.Write();
+        eleGenEta.Write();
+
+        muPt.Write();
+        muEta.Write();
+        muGenPt.Write();
+        muGenEta.Write();
+
+        for (TH2F* hist : {&eleGenPtEta, &muGenPtEta})
+        {
+            hist->SetStats(kFALSE);
+            hist->SetTitle("");
+            hist->GetXaxis()->SetTitle("p_{T}");
+            hist->GetYaxis()->SetTitle("#eta");
+            hist->SetTitleOffset(0.5f, "Y");
+            hist->Write();
+        }
+    }
+};
+
+std::vector<std::string> listRootFiles(const std::string& dir)
+{
+    std::vector<std::string> files;
+    for (const auto& file : boost::make_iterator_range(
+             boost::filesystem::directory_iterator{dir}, {}))
+    {
+        if (boost::filesystem::is_regular_file(file.status())
+            && file.path().extension() == ".root")
+        {
+            files.emplace_back(file.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// Only the lepton kinematics and generator particles are read
+void enableLeptonBranches(TTree* tree)
+{
+    tree->SetBranchStatus("*", false);
+    for (const char* branch : {"numElePF2PAT",
+                               "elePF2PATPT",
+                               "elePF2PATEta",
+                               "genElePF2PATPT",
+                               "genElePF2PATEta",
+                               "numMuonPF2PAT",
+                               "muonPF2PATPt",
+                               "muonPF2PATEta",
+                               "genMuonPF2PATPT",
+                               "genMuonPF2PATEta",
+                               "nGenPar",
+                               "genPar*"})
+    {
+        tree->SetBranchStatus(branch, true);
+    }
+}
+
+void printCounts(const GenAcceptance& acceptance)
+{
+    std::cout << "Total no. of events:\t\t\t" << acceptance.events()
+              << std::endl;
+    const auto& thresholds{acceptance.thresholds()};
+    for (size_t set{0}; set < thresholds.size(); set++)
+    {
+        const AcceptanceThresholds& cuts{thresholds[set]};
+        const AcceptanceCounts& counts{acceptance.counts()[set]};
+        std::cout << std::endl;
+        std::cout << cuts.name << ": electrons " << cuts.electrons.leadingPt
+                  << "/" << cuts.electrons.subleadingPt << " GeV, |eta| < "
+                  << cuts.electrons.eta << "; muons " << cuts.muons.leadingPt
+                  << "/" << cuts.muons.subleadingPt << " GeV, |eta| < "
+                  << cuts.muons.eta << std::endl;
+        std::cout << "Containing at least two electrons:\t"
+                  << counts.twoElectrons << std::endl;
+        std::cout << "...of which pass eta requirements:\t"
+                  << counts.electronEta << std::endl;
+        std::cout << "...of which pass pT requirements:\t" << counts.electronPt
+                  << std::endl;
+        std::cout << "Containing at least two muons:\t\t" << counts.twoMuons
+                  << std::endl;
+        std::cout << "...of which pass eta requirements:\t" << counts.muonEta
+                  << std::endl;
+        std::cout << "...of which pass pT requirements:\t" << counts.muonPt
+                  << std::endl;
+        std::cout << "Total no. of cut events\t\t\t"
+                  << acceptance.events() - counts.accepted << std::endl;
+        if (set > 0)
+        {
+            std::cout << "Newly cut compared with " << thresholds[0].name
+                      << ":\t" << counts.lostFromFirst << std::endl;
+        }
+    }
+}
+} // namespace
+
 int main(int argc, char* argv[])
 {
     std::string inputDir{};
     std::string outFileString{"plots/distributions/output.root"};
+    std::string thresholdsConf{"configs/leptonAcceptance.yaml"};
+    unsigned jobs;
     bool is2016;
 
     namespace po = boost::program_options;
@@ -33,6 +211,13 @@ int main(int argc, char* argv[])
         "outfile,o",
         po::value<std::string>(&outFileString)->default_value(outFileString),
         "Output file for plots.")(
+        "thresholds,t",
+        po::value<std::string>(&thresholdsConf)->default_value(thresholdsConf),
+        "Configuration file of the acceptance thresholds to evaluate.")(
+        "jobs,j",
+        po::value<unsigned>(&jobs)->default_value(
+            std::thread::hardware_concurrency()),
+        "Number of threads to read files with.")(
         "2016", po::bool_switch(&is2016), "Use 2016 conditions (SFs, et al.).");
     po::variables_map vm;
 
@@ -54,317 +239,91 @@ int main(int argc, char* argv[])
         return 1;
     }
 
-    std::vector<TTree*> inputTrees;
-
-    if (boost::filesystem::is_directory(inputDir))
-    {
-        const long int count{
-            std::distance(boost::filesystem::directory_iterator{inputDir},
-                          boost::filesystem::directory_iterator())};
-
-        TMVA::Timer lTimer{
-            boost::numeric_cast<int>(count), "Attaching files to TTree", false};
-        Int_t lCounter{1};
-
-        lTimer.DrawProgressBar(0, "");
-
-        for (const auto& file : boost::make_iterator_range(
-                 boost::filesystem::directory_iterator{inputDir}, {}))
-        {
-            TFile* inputFile{new TFile{file.path().string().c_str()}};
-            TTree* lTempTree{dynamic_cast<TTree*>(inputFile->Get("tree"))};
-            inputTrees.emplace_back(lTempTree);
-
-            lTimer.DrawProgressBar(lCounter++, "");
-        }
-    }
-    else
+    if (!boost::filesystem::is_directory(inputDir))
     {
         std::cout << "ERROR: " << inputDir << "is not a valid directory"
                   << std::endl;
         return 1;
     }
-
-    std::cout << std::endl;
-    std::cout << "Attached all files to TTree!" << std::endl;
-
-    TH1F* histElePt{new TH1F{
-        "histElePt", "Distribution of reco-electron p_{T}", 500, 0.0, 500.0}};
-    TH1F* histEleEta{new TH1F{
-        "histEleEta", "Distribution of reco-electron #eta", 500, -2.50, 2.5}};
-    TH1F* histEleGenPt{new TH1F{
-        "histEleGenPt", "Distribution of gen-electron p_{T}", 500, 0.0, 500.0}};
-    TH1F* histEleGenEta{new TH1F{
-        "histEleGenEta", "Distribution of gen-electron #eta", 500, -2.5, 2.5}};
-
-    TH1F* histMuPt{new TH1F{
-        "histMuPt", "Distribution of reco-muon p_{T}", 500, 0.0, 500.0}};
-    TH1F* histMuEta{new TH1F{
-        "histMuEta", "Distribution of reco-muon #eta", 500, -2.50, 2.5}};
-    TH1F* histMuGenPt{new TH1F{
-        "histMuGenPt", "Distribution of gen-muon p_{T}", 500, 0.0, 500.0}};
-    TH1F* histMuGenEta{new TH1F{
-        "histMuGenEta", "Distribution of gen-muon #eta", 500, -2.5, 2.5}};
-
-    TH2F* histEleGenPtEta{
-        new TH2F{"histEleGenPtEta",
-                 "Distribution of reco-electron p_{T} against #eta",
-                 500,
-                 0,
-                 300,
-                 500,
-                 -3,
-                 3}};
-    TH2F* histMuGenPtEta{
-        new TH2F{"histMuGenPtEta",
-                 "Distribution of reco-muon p_{T} against #eta",
-                 500,
-                 0,
-                 300,
-                 500,
-                 -3,
-                 3}};
-
-    TMVA::Timer* lTimer{
-        new TMVA::Timer{boost::numeric_cast<int>(inputTrees.size()),
-                        "Running over trees",
-                        false}};
-
-    lTimer->DrawProgressBar(0, "");
-
-    Int_t lCounter{1};
-
-    // pT thresholds
-    const Float_t ele1PtThresh{17};
-    const Float_t ele2PtThresh{12};
-    const Float_t mu1PtThresh{17};
-    const Float_t mu2PtThresh{8};
-    const Float_t ele1PtThreshProposed{23};
-    // eta thresholds
-    const Float_t eleEtaThresh{2.5};
-    const Float_t muEtaThresh{2.4};
-    // Event counters
-    int totalEvents{0};
-    int passEleNum{0};
-    int passElePt{0};
-    int passElePtDiff{0};
-    int passEleEta{0};
-    int passMuNum{0};
-    int passMuPt{0};
-    int passMuEta{0};
-
-    int newlyCut{0};
-    int totalCut{0};
-
-    for (std::vector<TTree*>::const_iterator lIt = inputTrees.begin();
-         lIt != inputTrees.end();
-         ++lIt)
+    const std::vector<std::string> files{listRootFiles(inputDir)};
+
+    std::vector<AcceptanceThresholds> thresholds;
+    Parser::parse_acceptance_thresholds(thresholdsConf, thresholds);
+
+    // Files are opened one at a time by each of the workers, which keep their
+    // own histograms and acceptance counts
+    ROOT::EnableThreadSafety();
+    TH1::AddDirectory(false);
+    jobs = std::max(std::min(jobs, static_cast<unsigned>(files.size())), 1u);
+    std::vector<LeptonHistograms> histograms(jobs);
+    std::vector<GenAcceptance> acceptances(jobs, GenAcceptance{thresholds});
+    std::vector<std::string> errors(jobs);
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> finished{0};
+    std::mutex printMutex;
+    std::vector<std::thread> workers;
+    for (unsigned worker{0}; worker < jobs; worker++)
     {
-        AnalysisEvent* lEvent{new AnalysisEvent{true, *lIt, is2016}};
-
-        Long64_t lNumEvents{(*lIt)->GetEntries()};
-        totalEvents += lNumEvents;
-
-        for (Int_t j{0}; j < lNumEvents; j++)
-        {
-            (*lIt)->GetEvent(j);
-
-            for (Int_t k{0}; k < lEvent->numElePF2PAT; k++)
-            {
-                histElePt->Fill(lEvent->elePF2PATPT[k]);
-                histEleEta->Fill(lEvent->elePF2PATEta[k]);
-                histEleGenPt->Fill(lEvent->genElePF2PATPT[k]);
-                histEleGenEta->Fill(lEvent->genElePF2PATEta[k]);
-
-                histEleGenPtEta->Fill(lEvent->elePF2PATPT[k],
-                                      lEvent->elePF2PATEta[k]);
-            }
-            for (Int_t k{0}; k < lEvent->numMuonPF2PAT; k++)
-            {
-                histMuPt->Fill(lEvent->muonPF2PATPt[k]);
-                histMuEta->Fill(lEvent->muonPF2PATEta[k]);
-                histMuGenPt->Fill(lEvent->genMuonPF2PATPT[k]);
-                histMuGenEta->Fill(lEvent->genMuonPF2PATEta[k]);
-
-                histMuGenPtEta->Fill(lEvent->muonPF2PATPt[k],
-                                     lEvent->muonPF2PATEta[k]);
-            }
-
-            // Count the number of events which will be cut
-            struct particle
+        workers.emplace_back([&, worker] {
+            try
             {
-                particle(const Float_t a,
-                         const Float_t b,
-                         const Int_t c,
-                         const Int_t d)
-                    : eta(a), pt(b), Id(c), motherId(d)
+                for (size_t i{next++}; i < files.size(); i = next++)
                 {
-                }
-
-                Float_t eta;
-                Float_t pt;
-                Int_t Id;
-                Int_t motherId;
-            };
-
-            bool cut{true};
-            bool cutDiff{false};
-
-            std::vector<particle> eles;
-            std::vector<particle> mus;
-            for (int k = 0; k < lEvent->nGenPar; k++)
-            {
-                switch (std::abs(lEvent->genParId[k]))
-                {
-                    case 11: // electron
-                        eles.emplace_back(lEvent->genParEta[k],
-                                          lEvent->genParPt[k],
-                                          lEvent->genParId[k],
-                                          lEvent->genParMotherId[k]);
-                        break;
-                    case 13: // muon
-                        mus.emplace_back(lEvent->genParEta[k],
-                                         lEvent->genParPt[k],
-                                         lEvent->genParId[k],
-                                         lEvent->genParMotherId[k]);
-                        break;
-                    default: break;
-                }
-            }
-
-            if (eles.size() >= 2) // electron no. cut
-            {
-                passEleNum++;
-
-                eles.erase(std::remove_if(eles.begin(),
-                                          eles.end(),
-                                          [&](const particle& p) -> bool {
-                                              return std::abs(p.eta)
-                                                     > eleEtaThresh;
-                                          }),
-                           eles.end());
-
-                if (eles.size() >= 2) // electron eta cut
-                {
-                    passEleEta++;
-
-                    std::nth_element(
-                        eles.begin(),
-                        eles.begin() + 1,
-                        eles.end(),
-                        [](const particle& a, const particle& b) -> bool {
-                            return a.pt > b.pt;
-                        });
-
-                    if (eles.at(0).pt > ele1PtThresh
-                        && eles.at(1).pt > ele2PtThresh) // ele pT cut
+                    const std::unique_ptr<TFile> inFile{
+                        TFile::Open(files[i].c_str(), "READ")};
+                    TTree* const tree{
+                        inFile ? dynamic_cast<TTree*>(inFile->Get("tree"))
+                               : nullptr};
+                    if (!tree)
                     {
-                        if (eles.at(0).pt > ele1PtThreshProposed)
-                        {
-                            passElePt++;
-                            cut = false;
-                        }
-                        else
-                        { // fail proposed pT cut
-                            passElePtDiff++;
-                            cutDiff = true;
-                        }
+                        throw std::runtime_error("Could not read " + files[i]);
                     }
-                }
-            }
-
-            if (mus.size() >= 2) // muon no. cut
-            {
-                passMuNum++;
-
-                mus.erase(std::remove_if(mus.begin(),
-                                         mus.end(),
-                                         [&](const particle& p) -> bool {
-                                             return std::abs(p.eta)
-                                                    > muEtaThresh;
-                                         }),
-                          mus.end());
-
-                if (mus.size() >= 2) // muon eta cut
-                {
-                    passMuEta++;
-
-                    std::nth_element(
-                        mus.begin(),
-                        mus.begin() + 1,
-                        mus.end(),
-                        [](const particle& a, const particle& b) -> bool {
-                            return a.pt > b.pt;
-                        });
+                    AnalysisEvent event{true, tree, is2016};
+                    enableLeptonBranches(tree);
 
-                    if (mus.at(0).pt > mu1PtThresh
-                        && mus.at(1).pt > mu2PtThresh) // muon pT cut
+                    const Long64_t numEvents{tree->GetEntries()};
+                    for (Long64_t j{0}; j < numEvents; j++)
                     {
-                        passMuPt++;
-                        cut = false;
-                        cutDiff = false;
+                        tree->GetEntry(j);
+                        histograms[worker].fill(event);
+                        acceptances[worker].fill(event);
                     }
-                }
-            }
 
-            if (cut)
-            {
-                totalCut++;
+                    const std::lock_guard<std::mutex> lock{printMutex};
+                    std::cout << "\rRunning over files: " << ++finished << "/"
+                              << files.size() << std::flush;
+                }
             }
-            if (cutDiff)
+            catch (const std::exception& e)
             {
-                newlyCut++;
+                errors[worker] = e.what();
             }
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    for (const auto& error : errors)
+    {
+        if (!error.empty())
+        {
+            std::cerr << "ERROR: " << error << std::endl;
+            return 1;
         }
-        lTimer->DrawProgressBar(lCounter++, "");
+    }
+    for (unsigned worker{1}; worker < jobs; worker++)
+    {
+        histograms[0].add(histograms[worker]);
+        acceptances[0].merge(acceptances[worker]);
     }
 
     std::cout << std::endl << std::endl;
-    std::cout << "Total no. of events:\t\t\t" << totalEvents << std::endl;
-    std::cout << std::endl;
-    std::cout << "Containing at least two electrons:\t" << passEleNum
-              << std::endl;
-    std::cout << "...of which pass eta requirements:\t" << passEleEta
-              << std::endl;
-    std::cout << "...of which pass pT requirements:\t" << passElePt
-              << std::endl;
-    std::cout << "Change due to new proposals:\t\t" << passElePtDiff
-              << std::endl;
-    std::cout << std::endl;
-    std::cout << "Containing at least two muons:\t\t" << passMuNum << std::endl;
-    std::cout << "...of which pass eta requirements:\t" << passMuEta
-              << std::endl;
-    std::cout << "...of which pass pT requirements:\t" << passMuPt << std::endl;
-    std::cout << std::endl;
-    std::cout << "Total no. of cut events\t\t\t" << totalCut << std::endl;
-    std::cout << "Change due to new proposals:\t\t" << newlyCut << std::endl;
-
-    TFile* outFile{new TFile{outFileString.c_str(), "RECREATE"}};
-
-    histElePt->Write();
-    histEleEta->Write();
-    histEleGenPt->Write();
-    histEleGenEta->Write();
-
-    histMuPt->Write();
-    histMuEta->Write();
-    histMuGenPt->Write();
-    histMuGenEta->Write();
-
-    histEleGenPtEta->SetStats(kFALSE);
-    histEleGenPtEta->SetTitle("");
-    histEleGenPtEta->GetXaxis()->SetTitle("p_{T}");
-    histEleGenPtEta->GetYaxis()->SetTitle("#eta");
-    histEleGenPtEta->SetTitleOffset(0.5f, "Y");
-    histEleGenPtEta->Write();
-
-    histMuGenPtEta->SetStats(kFALSE);
-    histMuGenPtEta->SetTitle("");
-    histMuGenPtEta->GetXaxis()->SetTitle("p_{T}");
-    histMuGenPtEta->GetYaxis()->SetTitle("#eta");
-    histMuGenPtEta->SetTitleOffset(0.5f, "Y");
-    histMuGenPtEta->Write();
+    printCounts(acceptances[0]);
 
+    const std::unique_ptr<TFile> outFile{
+        new TFile{outFileString.c_str(), "RECREATE"}};
+    histograms[0].write();
     outFile->Close();
     std::cout << "\n Finished." << std::endl;
 }
@@ -1,20 +1,53 @@
+#include "Compression.h"
 #include "MvaEvent.hpp"
+#include "TEntryList.h"
+#include "TH1D.h"
+#include "TLeaf.h"
 #include "TLorentzVector.h"
+#include "TROOT.h"
 #include "TMVA/Config.h"
 #include "TMVA/Timer.h"
 #include "TTree.h"
+#include "columnarFile.hpp"
 #include "config_parser.hpp"
+#include "forkWorkers.hpp"
 #include "makeMVAinputAlgo.hpp"
-
+#include "metPropagation.hpp"
+#include "mvaInputVars.hpp"
+#include "mvaRegions.hpp"
+#include "mvaScorer.hpp"
+#include "nplEstimator.hpp"
+#include "templateBuilder.hpp"
+
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 #include <boost/program_options.hpp>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
 #include <limits>
 #include <memory>
+#include <stdexcept>
+
+namespace
+{
+// The JES uncertainties, read the first time they are needed
+const JetCorrectionUncertainty& jetUncertainty(const bool is2016)
+{
+    const static JetCorrectionUncertainty jetUnc{
+        is2016 ? "scaleFactors/2016/"
+                 "Summer16_23Sep2016V4_MC_Uncertainty_AK4PFchs.txt"
+               : "scaleFactors/2017/"
+                 "Fall17_17Nov2017_V32_MC_Uncertainty_AK4PFchs.txt"};
+    return jetUnc;
+}
+} // namespace
 
 MakeMvaInputs::MakeMvaInputs()
     : inputVars{}
+    , outputVars{}
     , oldMetFlag{false}
     , is2016{false}
     , era{}
@@ -26,6 +59,13 @@ MakeMvaInputs::MakeMvaInputs()
     , doFakes{false}
     , inputDir{"mvaTest/"}
     , outputDir{"mvaInputs/"}
+    , jobs{1}
+    , writeRoot{true}
+    , writeColumnar{false}
+    , compressionSettings{-1}
+    , basketSize{0}
+    , autoFlush{0}
+    , bufferOutput{false}
 {
 }
 
@@ -56,7 +96,34 @@ void MakeMvaInputs::parseCommandLineArguements(const int argc, char* argv[])
         po::bool_switch(&doSysts),
         "Run dedicated systematic analysis")(
         "MC,M", po::bool_switch(&doMC), "Run MC analysis")(
-        "fakes,F", po::bool_switch(&doFakes), "Run fakes analysis");
+        "fakes,F", po::bool_switch(&doFakes), "Run fakes analysis")(
+        "jobs,j",
+        po::value<unsigned>(&jobs)->default_value(1),
+        "Number of processes used for the MC and systematic samples")(
+        "variables,v",
+        po::value<std::string>(&variablesConf),
+        "YAML file listing the variables to write (default all)")(
+        "format",
+        po::value<std::string>(&outputFormat)->default_value("root"),
+        "Output format: root, columnar or both")(
+        "compression",
+        po::value<std::string>(&compression),
+        "ROOT output compression, as <zlib|lzma|lz4>[:<level>] (default "
+        "ROOT's own)")("basketSize",
+                       po::value<int>(&basketSize),
+                       "ROOT output basket size in bytes (default ROOT's own)")(
+        "autoFlush",
+        po::value<long long>(&autoFlush),
+        "ROOT output cluster size: entries if positive, bytes if negative "
+        "(default ROOT's own)")(
+        "bdt",
+        po::value<std::string>(&scoringConf),
+        "YAML file listing trained TMVA methods to evaluate on every event, "
+        "writing their responses and template histograms to the output")(
+        "templates",
+        po::value<std::string>(&templatesConf),
+        "YAML file listing observables to write limit setting templates of, "
+        "to templates_<sample>.root");
 
     po::variables_map vm;
 
@@ -79,6 +146,125 @@ void MakeMvaInputs::parseCommandLineArguements(const int argc, char* argv[])
         std::cerr << "Use -h or --help for help." << std::endl;
         std::exit(1);
     }
+
+    if (outputFormat != "root" && outputFormat != "columnar"
+        && outputFormat != "both")
+    {
+        std::cerr << "ERROR: unknown output format " << outputFormat
+                  << std::endl;
+        std::exit(1);
+    }
+    writeRoot = outputFormat != "columnar";
+    writeColumnar = outputFormat != "root";
+
+    if (!compression.empty())
+    {
+        const std::map<std::string, ROOT::ECompressionAlgorithm> algorithms{
+            {"zlib", ROOT::kZLIB}, {"lzma", ROOT::kLZMA}, {"lz4", ROOT::kLZ4}};
+        const auto colon{compression.find(':')};
+        const auto algorithm{algorithms.find(compression.substr(0, colon))};
+        if (algorithm == algorithms.end())
+        {
+            std::cerr << "ERROR: unknown compression algorithm "
+                      << compression.substr(0, colon) << std::endl;
+            std::exit(1);
+        }
+        const int level{colon == std::string::npos
+                            ? 4
+                            : std::stoi(compression.substr(colon + 1))};
+        compressionSettings =
+            ROOT::CompressionSettings(algorithm->second, level);
+    }
+
+    // Resolve the output variables to slots once, here, rather than per event
+    if (variablesConf.empty())
+    {
+        for (unsigned var{0}; var < MvaInput::numVars; var++)
+        {
+            outputVars.emplace_back(var);
+        }
+    }
+    else
+    {
+        for (const auto& name : Parser::parse_mva_variables(variablesConf))
+        {
+            const auto branch{std::find_if(
+                MvaInput::branches.begin(),
+                MvaInput::branches.end(),
+                [&name](const auto& b) { return b.name == name; })};
+            if (branch == MvaInput::branches.end())
+            {
+                std::cerr << "ERROR: unknown MVA input variable " << name
+                          << " in " << variablesConf << std::endl;
+                std::exit(1);
+            }
+            outputVars.emplace_back(boost::numeric_cast<unsigned>(
+                branch - MvaInput::branches.begin()));
+        }
+    }
+
+    if (!scoringConf.empty())
+    {
+        std::vector<std::string> variables;
+        std::vector<std::string> spectators;
+        std::vector<MvaMethod> methods;
+        try
+        {
+            Parser::parse_mva_scoring(
+                scoringConf, variables, spectators, methods);
+            scorer = std::make_unique<MvaScorer>(
+                inputVars, variables, spectators, methods);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+            std::exit(1);
+        }
+    }
+
+    if (!templatesConf.empty())
+    {
+        // Observables are filled from an MVA input variable or, if one has
+        // been evaluated, an MVA response
+        std::vector<TemplateObservable> observables;
+        Parser::parse_mva_templates(templatesConf, observables);
+        std::vector<const float*> values;
+        for (const auto& observable : observables)
+        {
+            const auto branch{std::find_if(
+                MvaInput::branches.begin(),
+                MvaInput::branches.end(),
+                [&observable](const auto& b) {
+                    return b.name == observable.variable;
+                })};
+            if (branch != MvaInput::branches.end())
+            {
+                values.emplace_back(
+                    &inputVars[boost::numeric_cast<size_t>(
+                        branch - MvaInput::branches.begin())]);
+                continue;
+            }
+            const std::vector<MvaMethod> noMethods;
+            const auto& methods{scorer ? scorer->methods() : noMethods};
+            const auto method{std::find_if(
+                methods.begin(),
+                methods.end(),
+                [&observable](const MvaMethod& m) {
+                    return m.branch == observable.variable;
+                })};
+            if (method == methods.end())
+            {
+                std::cerr << "ERROR: unknown template variable "
+                          << observable.variable << " in " << templatesConf
+                          << std::endl;
+                std::exit(1);
+            }
+            values.emplace_back(
+                &scorer->scores()[boost::numeric_cast<size_t>(
+                    method - methods.begin())]);
+        }
+        templates = std::make_unique<TemplateBuilder>(observables, values);
+    }
 }
 
 void MakeMvaInputs::runMainAnalysis()
@@ -262,124 +448,324 @@ void MakeMvaInputs::standardAnalysis(
     const std::vector<std::string>& channels,
     const bool useSidebandRegion)
 {
-    std::string treeNamePostfixSig{""};
-    std::string treeNamePostfixSB{""};
     if (useSidebandRegion)
     {
         std::cout << "Using control region stuff" << std::endl;
-        treeNamePostfixSig = "sig_";
-        treeNamePostfixSB = "ctrl_";
     }
 
-    // loop over nominal samples
-    for (const auto& mc : listOfMCs)
-    {
-        const std::string sample{mc.first};
-        const std::string outSample{mc.second};
-
-        const auto longest_string{[](std::vector<std::string> v) {
-            return std::max_element(v.begin(),
-                                    v.end(),
-                                    [](std::string a, std::string b) {
-                                        return a.size() < b.size();
-                                    })
-                ->size();
+    const auto longest_string{[](std::vector<std::string> v) {
+        return std::max_element(v.begin(),
+                                v.end(),
+                                [](std::string a, std::string b) {
+                                    return a.size() < b.size();
+                                })
+            ->size();
+    }};
+    boost::format systFormat{"%-" + (std::to_string(longest_string(channels)))
+                             + "s    %-" + std::to_string(longest_string(systs))
+                             + "s    %12.2f %+8.2f %+10.2f%%"};
+    // yields[syst][channel], as returned by fillSampleTrees
+    const auto printYields{
+        [&](const std::vector<std::vector<long double>>& yields) {
+            std::unordered_map<std::string, long double> nominalEvents{};
+            for (size_t syst{0}; syst < systs.size(); syst++)
+            {
+                for (size_t i{0}; i < channels.size(); i++)
+                {
+                    const std::string& channel{channels[i]};
+                    const long double nEvents{yields[syst][i]};
+                    if (systs[syst].empty())
+                    {
+                        nominalEvents.emplace(channel, nEvents);
+                    }
+                    std::cout << systFormat % channel % systs[syst] % nEvents
+                                     % (nEvents - nominalEvents[channel])
+                                     % (((nEvents - nominalEvents[channel])
+                                         / nominalEvents[channel])
+                                        * 100)
+                              << std::endl;
+                }
+            }
         }};
-        boost::format systFormat{
-            "%-" + (std::to_string(longest_string(channels))) + "s    %-"
-            + std::to_string(longest_string(systs))
-            + "s    %12.2f %+8.2f %+10.2f%%"};
-
-        std::cout << "Doing " << sample << " : " << std::endl;
-
-        auto outFile{new TFile{
-            (outputDir + "histofile_" + listOfMCs.at(sample) + ".root").c_str(),
-            "RECREATE"}};
 
-        // loop over systematics
-        std::unordered_map<std::string, long double> nominalEvents{};
-        for (const auto& syst : systs)
+    if (jobs <= 1)
+    {
+        // loop over nominal samples
+        for (const auto& mc : listOfMCs)
         {
-            auto outTreeSig{new TTree{
-                ("Ttree_" + treeNamePostfixSig + outSample + syst).c_str(),
-                ("Ttree_" + treeNamePostfixSig + outSample + syst).c_str()}};
-            TTree* outTreeSdBnd{};
-            setupBranches(outTreeSig);
+            const std::string sample{mc.first};
+            const std::string outSample{mc.second};
+
+            std::cout << "Doing " << sample << " : " << std::endl;
+
+            auto outFile{new TFile{
+                (outputDir + "histofile_" + outSample + ".root").c_str(),
+                "RECREATE"}};
+            setupOutputFile(outFile);
+            printYields(
+                fillSampleTrees(sample, outSample, systs, channels, outFile));
+            outFile->Write();
+            outFile->Close();
+        } // end sample loop
+        return;
+    }
 
-            if (useSidebandRegion)
-            {
-                outTreeSdBnd = new TTree{
-                    ("Ttree_" + treeNamePostfixSB + outSample + syst).c_str(),
-                    ("Ttree_" + treeNamePostfixSB + outSample + syst).c_str()};
-                setupBranches(outTreeSdBnd);
-            }
+    // Each sample reads its own input files and writes its own output file,
+    // so the samples are shared out between forked workers; fillTree works
+    // through member variables, which each worker gets its own copy of.
+    // Sample i always goes to worker i % N. The yields are passed back in a
+    // file next to the output, so they can be printed in the usual order.
+    const std::vector<std::pair<std::string, std::string>> samples(
+        listOfMCs.begin(), listOfMCs.end());
+    const auto yieldsPath{[this](const std::string& outSample) {
+        return outputDir + "histofile_" + outSample + ".yields";
+    }};
 
-            // loop over channels
-            for (const auto& channel : channels)
+    const unsigned nWorkers{
+        std::min<unsigned>(jobs, static_cast<unsigned>(samples.size()))};
+    std::cout << "Running " << samples.size() << " samples in " << nWorkers
+              << " processes" << std::endl;
+    const bool succeeded{forkWorkers(
+        nWorkers,
+        [&](const unsigned worker, const unsigned workers) {
+            for (size_t i{worker}; i < samples.size(); i += workers)
             {
-                auto inFile{new TFile{
-                    (inputDir + sample + channel + "mvaOut.root").c_str(),
-                    "READ"}};
-                TTree* tree;
-                if (syst == "__met__plus" || syst == "__met__minus")
+                const auto& [sample, outSample] = samples[i];
+                TFile outFile{
+                    (outputDir + "histofile_" + outSample + ".root").c_str(),
+                    "RECREATE"};
+                setupOutputFile(&outFile);
+                const auto yields{fillSampleTrees(
+                    sample, outSample, systs, channels, &outFile)};
+                outFile.Write();
+                outFile.Close();
+
+                std::ofstream yieldFile{yieldsPath(outSample)};
+                yieldFile << std::setprecision(
+                    std::numeric_limits<long double>::max_digits10);
+                for (const auto& systYields : yields)
                 {
-                    tree = dynamic_cast<TTree*>(inFile->Get("tree"));
+                    for (const long double yield : systYields)
+                    {
+                        yieldFile << yield << '\n';
+                    }
                 }
-                else
+            }
+            return true;
+        },
+        "MVA input worker")};
+    if (!succeeded)
+    {
+        throw std::runtime_error("One or more MVA input workers failed");
+    }
+
+    for (const auto& [sample, outSample] : samples)
+    {
+        std::cout << "Doing " << sample << " : " << std::endl;
+
+        std::ifstream yieldFile{yieldsPath(outSample)};
+        std::vector<std::vector<long double>> yields(
+            systs.size(), std::vector<long double>(channels.size()));
+        for (auto& systYields : yields)
+        {
+            for (auto& yield : systYields)
+            {
+                if (!(yieldFile >> yield))
                 {
-                    tree = dynamic_cast<TTree*>(
-                        inFile->Get(("tree" + syst).c_str()));
+                    throw std::runtime_error("Incomplete yields in "
+                                             + yieldsPath(outSample));
                 }
+            }
+        }
+        printYields(yields);
+        yieldFile.close();
+        boost::filesystem::remove(yieldsPath(outSample));
+    }
+}
 
-                //        TChain* tree;
-                //        if ( syst == "__met__plus" || syst ==
-                //        "__met__minus" ) tree = new TChain("tree"); else
-                //        tree = new TChain(("tree"+syst).c_str());
-                //        tree->Add((inputDir+sample+channel+"mvaOut.root").c_str());
-                const long long numberOfEvents{tree->GetEntries()};
-                auto event{new MvaEvent{true, tree, is2016}};
-
-                // loop over events
-                long double nEvents{0};
-                for (long long i{0}; i < numberOfEvents; i++)
-                {
-                    event->GetEntry(i);
+std::vector<std::vector<long double>>
+    MakeMvaInputs::fillSampleTrees(const std::string& sample,
+                                   const std::string& outSample,
+                                   const std::vector<std::string>& systs,
+                                   const std::vector<std::string>& channels,
+                                   TFile* outFile)
+{
+    std::string treeNamePostfixSig{""};
+    std::string treeNamePostfixSB{""};
+    if (useSidebandRegion)
+    {
+        treeNamePostfixSig = "sig_";
+        treeNamePostfixSB = "ctrl_";
+    }
 
-                    fillTree(outTreeSig,
-                             outTreeSdBnd,
-                             event,
-                             outSample + syst,
-                             channel,
-                             false);
+    outFile->cd();
+    std::vector<TTree*> outTreesSig;
+    std::vector<TTree*> outTreesSdBnd;
+    for (const auto& syst : systs)
+    {
+        outTreesSig.emplace_back(new TTree{
+            ("Ttree_" + treeNamePostfixSig + outSample + syst).c_str(),
+            ("Ttree_" + treeNamePostfixSig + outSample + syst).c_str()});
+        setupBranches(outTreesSig.back());
+
+        outTreesSdBnd.emplace_back(nullptr);
+        if (useSidebandRegion)
+        {
+            outTreesSdBnd.back() = new TTree{
+                ("Ttree_" + treeNamePostfixSB + outSample + syst).c_str(),
+                ("Ttree_" + treeNamePostfixSB + outSample + syst).c_str()};
+            setupBranches(outTreesSdBnd.back());
+        }
+    }
+
+    // The MET systematics are made from the nominal tree, so they are filled
+    // in the same pass over it. Every other systematic has its own tree.
+    std::vector<size_t> nominalPass;
+    std::vector<size_t> ownTree;
+    for (size_t syst{0}; syst < systs.size(); syst++)
+    {
+        if (systs[syst].empty() || systs[syst] == "__met__plus"
+            || systs[syst] == "__met__minus")
+        {
+            nominalPass.emplace_back(syst);
+        }
+        else
+        {
+            ownTree.emplace_back(syst);
+        }
+    }
+
+    for (const auto& channel : channels)
+    {
+        for (const auto& syst : systs)
+        {
+            bookTemplates(outSample + syst, channel);
+        }
+    }
 
-                    nEvents += event->eventWeight;
-                } // end event loop
+    // loop over channels
+    std::vector<std::vector<long double>> yields(
+        systs.size(), std::vector<long double>(channels.size()));
+    for (size_t chan{0}; chan < channels.size(); chan++)
+    {
+        const std::string& channel{channels[chan]};
+        TFile inFile{(inputDir + sample + channel + "mvaOut.root").c_str(),
+                     "READ"};
+        if (inFile.IsZombie())
+        {
+            throw std::runtime_error("Could not open " + inputDir + sample
+                                     + channel + "mvaOut.root");
+        }
+
+        // The branch addresses are set up once, on the nominal tree, and
+        // copied to each systematic tree in turn; they all share its layout.
+        TTree* const nominalTree{dynamic_cast<TTree*>(inFile.Get("tree"))};
+        if (!nominalTree)
+        {
+            throw std::runtime_error(std::string{"No tree in "}
+                                     + inFile.GetName());
+        }
+        MvaEvent event{true, nominalTree, is2016};
 
-                if (syst.empty())
+        if (!nominalPass.empty())
+        {
+            const auto entries{selectEntries(nominalTree)};
+            const long long numberOfEvents{entries ? entries->GetN()
+                                                   : nominalTree->GetEntries()};
+            for (long long i{0}; i < numberOfEvents; i++)
+            {
+                event.GetEntry(entries ? entries->GetEntry(i) : i);
+                // The nominal and unclustered MET are read from one
+                // propagation
+                const MetPropagation metPropagation{
+                    propagateMet(&event, channel)};
+                for (const size_t syst : nominalPass)
                 {
-                    nominalEvents.emplace(channel, nEvents);
+                    fillTree(outTreesSig[syst],
+                             outTreesSdBnd[syst],
+                             &event,
+                             outSample + systs[syst],
+                             channel,
+                             metPropagation);
+                    yields[syst][chan] += event.eventWeight;
                 }
-                std::cout << systFormat % channel % syst % nEvents
-                                 % (nEvents - nominalEvents[channel])
-                                 % (((nEvents - nominalEvents[channel])
-                                     / nominalEvents[channel])
-                                    * 100)
-                          << std::endl;
+            } // end event loop
+        }
 
-                inFile->Close();
-            } // end channel loop
-            outFile->cd();
-            outTreeSig->SetDirectory(outFile);
-            outTreeSig->FlushBaskets();
-            if (useSidebandRegion)
+        for (const size_t syst : ownTree)
+        {
+            TTree* const tree{dynamic_cast<TTree*>(
+                inFile.Get(("tree" + systs[syst]).c_str()))};
+            if (!tree)
             {
-                outTreeSdBnd->SetDirectory(outFile);
-                outTreeSdBnd->FlushBaskets();
+                throw std::runtime_error("No tree" + systs[syst] + " in "
+                                         + inFile.GetName());
             }
-        } // end systematic loop
-        outFile->Write();
-        outFile->Close();
-    } // end sample loop
+            event.setTree(tree);
+
+            const auto entries{selectEntries(tree)};
+            const long long numberOfEvents{entries ? entries->GetN()
+                                                   : tree->GetEntries()};
+            for (long long i{0}; i < numberOfEvents; i++)
+            {
+                event.GetEntry(entries ? entries->GetEntry(i) : i);
+                fillTree(outTreesSig[syst],
+                         outTreesSdBnd[syst],
+                         &event,
+                         outSample + systs[syst],
+                         channel,
+                         propagateMet(&event, channel));
+                yields[syst][chan] += event.eventWeight;
+            } // end event loop
+        }
+        event.setTree(nominalTree);
+    } // end channel loop
+
+    outFile->cd();
+    for (size_t syst{0}; syst < systs.size(); syst++)
+    {
+        writeTree(outTreesSig[syst], outFile);
+        if (useSidebandRegion)
+        {
+            writeTree(outTreesSdBnd[syst], outFile);
+        }
+    }
+    closeOutputs(outFile, outSample);
+    return yields;
+}
+
+std::unique_ptr<TEntryList> MakeMvaInputs::selectEntries(TTree* tree) const
+{
+    // Without sidebands every entry is written out
+    if (!useSidebandRegion)
+    {
+        return nullptr;
+    }
+    TBranch* const flagsBranch{tree->GetBranch("regionFlags")};
+    if (!flagsBranch)
+    {
+        return nullptr; // Made before the flags were stored
+    }
+
+    // Only the flags are read here; the full event is only read for the
+    // entries in the list
+    Int_t flags;
+    TLeaf* const flagsLeaf{flagsBranch->GetLeaf("regionFlags")};
+    void* const previousAddress{flagsLeaf->GetValuePointer()};
+    flagsBranch->SetAddress(&flags);
+
+    auto entries{std::make_unique<TEntryList>(tree)};
+    const long long numberOfEvents{tree->GetEntries()};
+    for (long long i{0}; i < numberOfEvents; i++)
+    {
+        flagsBranch->GetEntry(i);
+        if (flags & (MvaRegion::signal | MvaRegion::sideband))
+        {
+            entries->Enter(i);
+        }
+    }
+    flagsBranch->SetAddress(previousAddress);
+    return entries;
 }
 
 void MakeMvaInputs::dataAnalysis(const std::vector<std::string>& channels,
@@ -416,12 +802,14 @@ void MakeMvaInputs::dataAnalysis(const std::vector<std::string>& channels,
         }
         TFile outFile{(outputDir + "histofile_" + outChan + ".root").c_str(),
                       "RECREATE"};
+        setupOutputFile(&outFile);
         TChain dataChain{"tree"};
         dataChain.Add(
             (inputDir + channel + "Run" + era + channel + "mvaOut.root")
                 .c_str());
 
         MvaEvent event{false, &dataChain, is2016};
+        bookTemplates(outChan, channel);
         const long long numberOfEvents{dataChain.GetEntries()};
         TMVA::Timer lEventTimer{boost::numeric_cast<int>(numberOfEvents),
                                 "Running over dataset ...",
@@ -430,16 +818,20 @@ void MakeMvaInputs::dataAnalysis(const std::vector<std::string>& channels,
         {
             lEventTimer.DrawProgressBar(i);
             event.GetEntry(i);
-            fillTree(outTreeSig, outTreeSdBnd, &event, outChan, channel, false);
+            fillTree(outTreeSig,
+                     outTreeSdBnd,
+                     &event,
+                     outChan,
+                     channel,
+                     propagateMet(&event, channel));
         }
         outFile.cd();
-        outTreeSig->SetDirectory(&outFile);
-        outTreeSig->FlushBaskets();
+        writeTree(outTreeSig, &outFile);
         if (useSidebandRegion)
         {
-            outTreeSdBnd->SetDirectory(&outFile);
-            outTreeSdBnd->FlushBaskets();
+            writeTree(outTreeSdBnd, &outFile);
         }
+        closeOutputs(&outFile, outChan);
         outFile.Write();
         outFile.Close();
     }
@@ -465,23 +857,46 @@ void MakeMvaInputs::sameSignAnalysis(
         treeNamePostfixSB = "ctrl_";
     }
 
+    // The opposite sign MC is read in background threads while the same sign
+    // samples are read here
+    ROOT::EnableThreadSafety();
+
     for (const auto& outChan : outFakeChannels)
     {
-        // Get same sign data
         const std::string chan{outFakeChanToData.at(outChan)};
 
-        TChain dataChain{"tree"};
-        // Get expected real SS events from MC
+        // Only the non-prompt yield of the opposite sign MC is needed, for
+        // the transfer factor, which is measured in a subset of the samples
+        const auto& transferFactorSamples{Npl::transferFactorSamples(is2016)};
+        std::vector<std::string> oppositeSignPaths;
+        // Whether each file of the SS MC chain counts towards the factor
+        std::vector<bool> sameSignCounted;
+        TChain mcChain{"tree"};
         for (const auto& mc : listOfMCs)
         {
             const std::string sample{mc.first};
-
-            // std::cout << "Doing SS fakes " << sample << std::endl;
-            if (!dataChain.Add(
-                    (inputDir + sample + chan + "invLepmvaOut.root").c_str()))
+            const bool counted{
+                std::find(transferFactorSamples.begin(),
+                          transferFactorSamples.end(),
+                          sample)
+                != transferFactorSamples.end()};
+            if (counted)
+            {
+                oppositeSignPaths.emplace_back(inputDir + sample + chan
+                                               + "mvaOut.root");
+            }
+            // Expected real SS events from MC, weighted negatively in the
+            // skims so they are subtracted from the data
+            const int files{mcChain.Add(
+                (inputDir + sample + chan + "invLepmvaOut.root").c_str())};
+            if (!files)
                 abort();
+            sameSignCounted.insert(sameSignCounted.end(), files, counted);
         }
+        Npl::FileCounter oppositeSign{oppositeSignPaths, chan, jobs};
 
+        // Get same sign data
+        TChain dataChain{"tree"};
         if (!dataChain.AddFile(
                 (inputDir + chanMap.at(chan) + chan + "invLepmvaOut.root")
                     .c_str()))
@@ -490,6 +905,7 @@ void MakeMvaInputs::sameSignAnalysis(
         auto outFile{
             new TFile{(outputDir + "histofile_" + outChan + ".root").c_str(),
                       "RECREATE"}};
+        setupOutputFile(outFile);
         auto outTreeSig{
             new TTree{("Ttree_" + treeNamePostfixSig + outChan).c_str(),
                       ("Ttree_" + treeNamePostfixSig + outChan).c_str()}};
@@ -502,27 +918,78 @@ void MakeMvaInputs::sameSignAnalysis(
                           ("Ttree_" + treeNamePostfixSB + outChan).c_str()};
             setupBranches(outTreeSdBnd);
         }
-        MvaEvent event{false, &dataChain, is2016};
+        bookTemplates(outChan, chan);
+
+        // The transfer factor needs the SS MC counted first, so the events
+        // are held until it is known rather than read a second time
+        bufferOutput = true;
+        Npl::Counts sameSign;
+        const auto runOver{[&](TChain& chain, const bool isMC) {
+            MvaEvent event{isMC, &chain, is2016};
+            const long long numberOfEvents{chain.GetEntries()};
+            TMVA::Timer lEventTimer{boost::numeric_cast<int>(numberOfEvents),
+                                    "Running over dataset ...",
+                                    false};
+            for (long long i{0}; i < numberOfEvents; i++)
+            {
+                lEventTimer.DrawProgressBar(i);
+                event.GetEntry(i);
+                if (isMC && sameSignCounted.at(chain.GetTreeNumber()))
+                {
+                    sameSign.add(Npl::isPrompt(event, chan), event.eventWeight);
+                }
+                fillTree(outTreeSig,
+                         outTreeSdBnd,
+                         &event,
+                         outChan,
+                         chan,
+                         propagateMet(&event, chan));
+            } // end event loop
+        }};
+        runOver(mcChain, true);
+        runOver(dataChain, false);
+        bufferOutput = false;
 
-        const long long numberOfEvents{dataChain.GetEntries()};
-        TMVA::Timer lEventTimer{boost::numeric_cast<int>(numberOfEvents),
-                                "Running over dataset ...",
-                                false};
-        for (long long i{0}; i < numberOfEvents; i++)
+        Npl::Counts oppositeSignCounts;
+        try
         {
-            lEventTimer.DrawProgressBar(i);
-            event.GetEntry(i);
-            fillTree(outTreeSig, outTreeSdBnd, &event, outChan, chan, true);
-        } // end event loop
+            oppositeSignCounts = oppositeSign.get();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "ERROR: Could not count the opposite sign MC for the "
+                      << outChan << " transfer factor: " << e.what()
+                      << std::endl;
+            std::exit(1);
+        }
+        const Npl::TransferFactor transferFactor{
+            Npl::transferFactor(oppositeSignCounts, sameSign)};
+        std::cout << outChan << " OS/SS non-prompt transfer factor: "
+                  << transferFactor.value << " +- " << transferFactor.error
+                  << std::endl;
+        for (const auto& row : bufferedRows)
+        {
+            inputVars = row.values;
+            inputVars[MvaInput::eventWeight] *= transferFactor.value;
+            fillOutput(row.tree, row.category);
+        }
+        bufferedRows.clear();
 
         outFile->cd();
-        outTreeSig->SetDirectory(outFile);
-        outTreeSig->FlushBaskets();
+        TH1D transferFactorHist{"nplTransferFactor",
+                                "OS/SS non-prompt transfer factor",
+                                1,
+                                0,
+                                1};
+        transferFactorHist.SetBinContent(1, transferFactor.value);
+        transferFactorHist.SetBinError(1, transferFactor.error);
+        transferFactorHist.Write();
+        writeTree(outTreeSig, outFile);
         if (useSidebandRegion)
         {
-            outTreeSdBnd->SetDirectory(outFile);
-            outTreeSdBnd->FlushBaskets();
+            writeTree(outTreeSdBnd, outFile);
         }
+        closeOutputs(outFile, outChan);
         outFile->Write();
         outFile->Close();
     }
@@ -599,27 +1066,22 @@ std::pair<TLorentzVector, TLorentzVector>
 std::pair<TLorentzVector, TLorentzVector>
     MakeMvaInputs::sortOutHadronicW(const MvaEvent* tree,
                                     const int syst,
-                                    TLorentzVector met,
                                     const std::vector<int>& jets) const
 {
     const auto wQuark1{getJetVec(tree,
                                  jets.at(tree->wQuark1Index),
                                  tree->jetSmearValue[tree->wQuark1Index],
-                                 met,
-                                 syst,
-                                 false)};
+                                 syst)};
     const auto wQuark2{getJetVec(tree,
                                  jets.at(tree->wQuark2Index),
                                  tree->jetSmearValue[tree->wQuark2Index],
-                                 met,
-                                 syst,
-                                 false)};
+                                 syst)};
 
     return {wQuark1, wQuark2};
 }
 
-std::pair<std::vector<int>, std::vector<TLorentzVector>> MakeMvaInputs::getJets(
-    const MvaEvent* tree, const int syst, TLorentzVector met) const
+std::pair<std::vector<int>, std::vector<TLorentzVector>>
+    MakeMvaInputs::getJets(const MvaEvent* tree, const int syst) const
 {
     std::vector<int> jetList{};
     std::vector<TLorentzVector> jetVecList{};
@@ -629,12 +1091,8 @@ std::pair<std::vector<int>, std::vector<TLorentzVector>> MakeMvaInputs::getJets(
         if (tree->jetInd[i] > -1)
         {
             jetList.emplace_back(tree->jetInd[i]);
-            jetVecList.emplace_back(getJetVec(tree,
-                                              tree->jetInd[i],
-                                              tree->jetSmearValue[i],
-                                              met,
-                                              syst,
-                                              true));
+            jetVecList.emplace_back(getJetVec(
+                tree, tree->jetInd[i], tree->jetSmearValue[i], syst));
         }
         else
         {
@@ -648,7 +1106,6 @@ std::pair<std::vector<int>, std::vector<TLorentzVector>> MakeMvaInputs::getJets(
 std::pair<std::vector<int>, std::vector<TLorentzVector>>
     MakeMvaInputs::getBjets(const MvaEvent* tree,
                             const int syst,
-                            TLorentzVector met,
                             const std::vector<int>& jets) const
 {
     std::vector<int> bJetList{};
@@ -663,9 +1120,7 @@ std::pair<std::vector<int>, std::vector<TLorentzVector>>
                 getJetVec(tree,
                           jets.at(tree->bJetInd[i]),
                           tree->jetSmearValue[tree->bJetInd[i]],
-                          met,
-                          syst,
-                          false));
+                          syst));
         }
         else
         {
@@ -679,9 +1134,7 @@ std::pair<std::vector<int>, std::vector<TLorentzVector>>
 TLorentzVector MakeMvaInputs::getJetVec(const MvaEvent* tree,
                                         const int index,
                                         const float smearValue,
-                                        TLorentzVector& metVec,
-                                        const int syst,
-                                        const bool doMetSmear) const
+                                        const int syst) const
 {
     TLorentzVector returnJet;
     returnJet.SetPxPyPzE(tree->jetPF2PATPx[index],
@@ -690,11 +1143,7 @@ TLorentzVector MakeMvaInputs::getJetVec(const MvaEvent* tree,
                          tree->jetPF2PATE[index]);
     returnJet *= smearValue;
 
-    const static JetCorrectionUncertainty jetUnc{
-        is2016 ? "scaleFactors/2016/"
-                 "Summer16_23Sep2016V4_MC_Uncertainty_AK4PFchs.txt"
-               : "scaleFactors/2017/"
-                 "Fall17_17Nov2017_V32_MC_Uncertainty_AK4PFchs.txt"};
+    const JetCorrectionUncertainty& jetUnc{jetUncertainty(is2016)};
 
     if (syst == 16)
     {
@@ -707,189 +1156,228 @@ TLorentzVector MakeMvaInputs::getJetVec(const MvaEvent* tree,
             1 + jetUnc.getUncertainty(returnJet.Pt(), returnJet.Eta(), 2);
     }
 
-    if (doMetSmear && smearValue > 0.01)
+    return returnJet;
+}
+
+MetPropagation MakeMvaInputs::propagateMet(const MvaEvent* tree,
+                                           const std::string& channel) const
+{
+    MetPropagation metPropagation{
+        tree->metPF2PATEt * std::cos(tree->metPF2PATPhi),
+        tree->metPF2PATEt * std::sin(tree->metPF2PATPhi)};
+
+    const auto [zLep1, zLep2] = sortOutLeptons(tree, channel);
+    metPropagation.addLepton(zLep1);
+    metPropagation.addLepton(zLep2);
+
+    // The selected jets, for the old unclustered recipe
+    for (size_t i{0}; i < MvaEvent::NJETS && tree->jetInd[i] > -1; i++)
+    {
+        const int index{tree->jetInd[i]};
+        TLorentzVector jet;
+        jet.SetPxPyPzE(tree->jetPF2PATPx[index],
+                       tree->jetPF2PATPy[index],
+                       tree->jetPF2PATPz[index],
+                       tree->jetPF2PATE[index]);
+        metPropagation.addJet(jet, tree->jetSmearValue[i]);
+    }
+
+    // The JES and JER MET as Cuts propagated it from every jet, so that they
+    // match the skims. Without them they are the nominal MET.
+    if (tree->hasMetJetVariations)
     {
-        metVec.SetPx(metVec.Px() + tree->jetPF2PATPx[index]);
-        metVec.SetPy(metVec.Py() + tree->jetPF2PATPy[index]);
+        for (size_t i{0}; i < MetPropagation::jetVariations.size(); i++)
+        {
+            TLorentzVector met;
+            met.SetPtEtaPhiE(tree->metJetVariationEt[i],
+                             0,
+                             tree->metJetVariationPhi[i],
+                             tree->metJetVariationEt[i]);
+            metPropagation.setJetVariation(MetPropagation::jetVariations[i],
+                                           met);
+        }
+    }
 
-        metVec.SetPx(metVec.Px() - returnJet.Px());
-        metVec.SetPy(metVec.Py() - returnJet.Py());
+    if (!oldMetFlag)
+    {
+        metPropagation.setUnclusteredEt(tree->metPF2PATUnclusteredEnUp,
+                                        tree->metPF2PATUnclusteredEnDown);
     }
 
-    return returnJet;
+    return metPropagation;
 }
 
-TLorentzVector
-    MakeMvaInputs::doUncMet(TLorentzVector met,
-                            const TLorentzVector& zLep1,
-                            const TLorentzVector& zLep2,
-                            const std::vector<TLorentzVector>& jetVecs,
-                            const unsigned syst) const
+void MakeMvaInputs::setupBranches(TTree* tree)
 {
-    double uncMetX{met.Px() + zLep1.Px() + zLep2.Px()};
-    double uncMetY{met.Py() + zLep1.Py() + zLep2.Py()};
+    for (const unsigned var : outputVars)
+    {
+        if (basketSize > 0)
+        {
+            tree->Branch(MvaInput::branches[var].name.c_str(),
+                         &inputVars[var],
+                         MvaInput::branches[var].leaf.c_str(),
+                         basketSize);
+        }
+        else
+        {
+            tree->Branch(MvaInput::branches[var].name.c_str(),
+                         &inputVars[var],
+                         MvaInput::branches[var].leaf.c_str());
+        }
+    }
+    if (scorer)
+    {
+        const auto& methods{scorer->methods()};
+        auto& histograms{scoreHistograms[tree->GetName()]};
+        for (size_t i{0}; i < methods.size(); i++)
+        {
+            tree->Branch(methods[i].branch.c_str(),
+                         &scorer->scores()[i],
+                         (methods[i].branch + "/F").c_str());
+            const std::string name{methods[i].branch + '_' + tree->GetName()};
+            histograms.emplace_back(std::make_unique<TH1D>(name.c_str(),
+                                                           name.c_str(),
+                                                           methods[i].nBins,
+                                                           methods[i].xMin,
+                                                           methods[i].xMax));
+            histograms.back()->SetDirectory(nullptr);
+            histograms.back()->Sumw2();
+        }
+    }
+    if (autoFlush != 0)
+    {
+        tree->SetAutoFlush(autoFlush);
+    }
 
-    for (const auto& jetVec : jetVecs)
+    if (writeColumnar)
     {
-        uncMetX += jetVec.Px();
-        uncMetY += jetVec.Py();
+        std::vector<std::string> columns;
+        for (const unsigned var : outputVars)
+        {
+            columns.emplace_back(MvaInput::branches[var].name);
+        }
+        if (scorer)
+        {
+            for (const auto& method : scorer->methods())
+            {
+                columns.emplace_back(method.branch);
+            }
+        }
+        columnarOutputs[tree->GetName()] = std::make_unique<ColumnarWriter>(
+            outputDir + tree->GetName() + ".tqzcol", columns);
     }
+}
 
-    if (syst == 1024)
+void MakeMvaInputs::setupOutputFile(TFile* file) const
+{
+    if (compressionSettings >= 0)
     {
-        met.SetPx(met.Px() + 0.1 * uncMetX);
-        met.SetPy(met.Py() + 0.1 * uncMetY);
+        file->SetCompressionSettings(compressionSettings);
     }
+}
 
-    else if (syst == 2048)
+std::string MakeMvaInputs::templateCategory(const std::string& label,
+                                           const std::string& channel)
+{
+    return channel + "__" + label;
+}
+
+void MakeMvaInputs::bookTemplates(const std::string& label,
+                                  const std::string& channel)
+{
+    if (!templates)
     {
-        met.SetPx(met.Px() - 0.1 * uncMetX);
-        met.SetPy(met.Py() - 0.1 * uncMetY);
+        return;
     }
+    const std::string category{templateCategory(label, channel)};
+    if (useSidebandRegion)
+    {
+        templates->book("sig_" + category);
+        templates->book("ctrl_" + category);
+    }
+    else
+    {
+        templates->book(category);
+    }
+}
 
-    return met;
+void MakeMvaInputs::writeTree(TTree* tree, TFile* file) const
+{
+    // Columnar output goes without the ROOT trees, rather than leaving empty
+    // ones that would read as no events
+    if (!writeRoot)
+    {
+        delete tree;
+        return;
+    }
+    tree->SetDirectory(file);
+    tree->FlushBaskets();
 }
 
-void MakeMvaInputs::setupBranches(TTree* tree)
+void MakeMvaInputs::fillOutput(TTree* tree, const std::string& category)
+{
+    if (bufferOutput)
+    {
+        bufferedRows.push_back({tree, category, inputVars});
+        return;
+    }
+    // Only events that are written out are scored
+    if (scorer)
+    {
+        scorer->evaluate();
+        const auto& histograms{
+            scoreHistograms.find(tree->GetName())->second};
+        for (size_t i{0}; i < histograms.size(); i++)
+        {
+            histograms[i]->Fill(scorer->scores()[i],
+                                inputVars[MvaInput::eventWeight]);
+        }
+    }
+    if (templates)
+    {
+        templates->fill(category, inputVars[MvaInput::eventWeight]);
+    }
+    if (writeRoot)
+    {
+        tree->Fill();
+    }
+    const auto columnar{columnarOutputs.find(tree->GetName())};
+    if (columnar != columnarOutputs.end())
+    {
+        columnarRow.clear();
+        for (const unsigned var : outputVars)
+        {
+            columnarRow.emplace_back(inputVars[var]);
+        }
+        if (scorer)
+        {
+            columnarRow.insert(columnarRow.end(),
+                               scorer->scores().begin(),
+                               scorer->scores().end());
+        }
+        columnar->second->fill(columnarRow.data());
+    }
+}
+
+void MakeMvaInputs::closeOutputs(TFile* outFile, const std::string& outName)
 {
-    tree->Branch("Channel", &inputVars["chan"], "Channel/F");
-    tree->Branch("EvtNumber", &inputVars["eventNumber"], "EvtNumber/F");
-    tree->Branch("EvtWeight", &inputVars["eventWeight"], "EvtWeight/F");
-    tree->Branch("bEta", &inputVars["bEta"], "bEta/F");
-    tree->Branch("bPhi", &inputVars["bPhi"], "bPhi/F");
-    tree->Branch("bPt", &inputVars["bPt"], "bPt/F");
-    tree->Branch("bbTag", &inputVars["bbTag"], "bbTag/F");
-    tree->Branch("chi2", &inputVars["chi2"], "chi2/F");
-    tree->Branch("j1Eta", &inputVars["j1Eta"], "j1Eta/F");
-    tree->Branch("j1Phi", &inputVars["j1Phi"], "j1Phi/F");
-    tree->Branch("j1Pt", &inputVars["j1Pt"], "j1Pt/F");
-    tree->Branch("j1bDelR", &inputVars["j1bDelR"], "j1bDelR/F");
-    tree->Branch("j1bTag", &inputVars["j1bTag"], "j1bTag/F");
-    tree->Branch("j1j2DelR", &inputVars["j1j2DelR"], "j1j2DelR/F");
-    tree->Branch("j1j3DelR", &inputVars["j1j3DelR"], "j1j3DelR/F");
-    tree->Branch("j1j4DelR", &inputVars["j1j4DelR"], "j1j4DelR/F");
-    tree->Branch("j1l1DelR", &inputVars["j1l1DelR"], "j1l1DelR/F");
-    tree->Branch("j1l2DelR", &inputVars["j1l2DelR"], "j1l2DelR/F");
-    tree->Branch("j1tDelR", &inputVars["j1tDelR"], "j1tDelR/F");
-    tree->Branch("j1wDelR", &inputVars["j1wDelR"], "j1wDelR/F");
-    tree->Branch("j1wj1DelR", &inputVars["j1wj1DelR"], "j1wj1DelR/F");
-    tree->Branch("j1wj2DelR", &inputVars["j1wj2DelR"], "j1wj2DelR/F");
-    tree->Branch("j1zDelR", &inputVars["j1zDelR"], "j1zDelR/F");
-    tree->Branch("j2Eta", &inputVars["j2Eta"], "j2Eta/F");
-    tree->Branch("j2Phi", &inputVars["j2Phi"], "j2Phi/F");
-    tree->Branch("j2Pt", &inputVars["j2Pt"], "j2Pt/F");
-    tree->Branch("j2bDelR", &inputVars["j2bDelR"], "j2bDelR/F");
-    tree->Branch("j2bTag", &inputVars["j2bTag"], "j2bTag/F");
-    tree->Branch("j2j3DelR", &inputVars["j2j3DelR"], "j2j3DelR/F");
-    tree->Branch("j2j4DelR", &inputVars["j2j4DelR"], "j2j4DelR/F");
-    tree->Branch("j2l1DelR", &inputVars["j2l1DelR"], "j2l1DelR/F");
-    tree->Branch("j2l2DelR", &inputVars["j2l2DelR"], "j2l2DelR/F");
-    tree->Branch("j2tDelR", &inputVars["j2tDelR"], "j2tDelR/F");
-    tree->Branch("j2wDelR", &inputVars["j2wDelR"], "j2wDelR/F");
-    tree->Branch("j2wj1DelR", &inputVars["j2wj1DelR"], "j2wj1DelR/F");
-    tree->Branch("j2wj2DelR", &inputVars["j2wj2DelR"], "j2wj2DelR/F");
-    tree->Branch("j2zDelR", &inputVars["j2zDelR"], "j2zDelR/F");
-    tree->Branch("j3Eta", &inputVars["j3Eta"], "j3Eta/F");
-    tree->Branch("j3Phi", &inputVars["j3Phi"], "j3Phi/F");
-    tree->Branch("j3Pt", &inputVars["j3Pt"], "j3Pt/F");
-    tree->Branch("j3bDelR", &inputVars["j3bDelR"], "j3bDelR/F");
-    tree->Branch("j3bTag", &inputVars["j3bTag"], "j3bTag/F");
-    tree->Branch("j3j4DelR", &inputVars["j3j4DelR"], "j3j4DelR/F");
-    tree->Branch("j3l1DelR", &inputVars["j3l1DelR"], "j3l1DelR/F");
-    tree->Branch("j3l2DelR", &inputVars["j3l2DelR"], "j3l2DelR/F");
-    tree->Branch("j3tDelR", &inputVars["j3tDelR"], "j3tDelR/F");
-    tree->Branch("j3wDelR", &inputVars["j3wDelR"], "j3wDelR/F");
-    tree->Branch("j3wj1DelR", &inputVars["j3wj1DelR"], "j3wj1DelR/F");
-    tree->Branch("j3wj2DelR", &inputVars["j3wj2DelR"], "j3wj2DelR/F");
-    tree->Branch("j3zDelR", &inputVars["j3zDelR"], "j3zDelR/F");
-    tree->Branch("j4Eta", &inputVars["j4Eta"], "j4Eta/F");
-    tree->Branch("j4Phi", &inputVars["j4Phi"], "j4Phi/F");
-    tree->Branch("j4Pt", &inputVars["j4Pt"], "j4Pt/F");
-    tree->Branch("j4bDelR", &inputVars["j4bDelR"], "j4bDelR/F");
-    tree->Branch("j4bTag", &inputVars["j4bTag"], "j4bTag/F");
-    tree->Branch("j4l1DelR", &inputVars["j4l1DelR"], "j4l1DelR/F");
-    tree->Branch("j4l2DelR", &inputVars["j4l2DelR"], "j4l2DelR/F");
-    tree->Branch("j4tDelR", &inputVars["j4tDelR"], "j4tDelR/F");
-    tree->Branch("j4wDelR", &inputVars["j4wDelR"], "j4wDelR/F");
-    tree->Branch("j4wj1DelR", &inputVars["j4wj1DelR"], "j4wj1DelR/F");
-    tree->Branch("j4wj2DelR", &inputVars["j4wj2DelR"], "j4wj2DelR/F");
-    tree->Branch("j4zDelR", &inputVars["j4zDelR"], "j4zDelR/F");
-    tree->Branch("j5Eta", &inputVars["j5Eta"], "j5Eta/F");
-    tree->Branch("j5Phi", &inputVars["j5Phi"], "j5Phi/F");
-    tree->Branch("j5Pt", &inputVars["j5Pt"], "j5Pt/F");
-    tree->Branch("j5bTag", &inputVars["j5bTag"], "j5bTag/F");
-    tree->Branch("j6Eta", &inputVars["j6Eta"], "j6Eta/F");
-    tree->Branch("j6Phi", &inputVars["j6Phi"], "j6Phi/F");
-    tree->Branch("j6Pt", &inputVars["j6Pt"], "j6Pt/F");
-    tree->Branch("j6bTag", &inputVars["j6bTag"], "j6bTag/F");
-    tree->Branch("jetMass", &inputVars["jetMass"], "jetMass/F");
-    tree->Branch("jetMass3", &inputVars["jetMass3"], "jetMass3/F");
-    tree->Branch("jetMt", &inputVars["jetMt"], "jetMt/F");
-    tree->Branch("jetPt", &inputVars["jetPt"], "jetPt/F");
-    tree->Branch("l1D0", &inputVars["l1D0"], "l1D0/F");
-    tree->Branch("l1Eta", &inputVars["l1Eta"], "l1Eta/F");
-    tree->Branch("l1Phi", &inputVars["l1Phi"], "l1Phi/F");
-    tree->Branch("l1Pt", &inputVars["l1Pt"], "l1Pt/F");
-    tree->Branch("l1RelIso", &inputVars["l1RelIso"], "l1RelIso/F");
-    tree->Branch("l1bDelR", &inputVars["l1bDelR"], "l1bDelR/F");
-    tree->Branch("l1tDelR", &inputVars["l1tDelR"], "l1tDelR/F");
-    tree->Branch("l1wj1DelR", &inputVars["l1wj1DelR"], "l1wj1DelR/F");
-    tree->Branch("l1wj2DelR", &inputVars["l1wj2DelR"], "l1wj2DelR/F");
-    tree->Branch("l2D0", &inputVars["l2D0"], "l2D0/F");
-    tree->Branch("l2DelR", &inputVars["l2DelR"], "l2DelR/F");
-    tree->Branch("l2Eta", &inputVars["l2Eta"], "l2Eta/F");
-    tree->Branch("l2Phi", &inputVars["l2Phi"], "l2Phi/F");
-    tree->Branch("l2Pt", &inputVars["l2Pt"], "l2Pt/F");
-    tree->Branch("l2RelIso", &inputVars["l2RelIso"], "l2RelIso/F");
-    tree->Branch("l2bDelR", &inputVars["l2bDelR"], "l2bDelR/F");
-    tree->Branch("l2tDelR", &inputVars["l2tDelR"], "l2tDelR/F");
-    tree->Branch("l2wj1DelR", &inputVars["l2wj1DelR"], "l2wj1DelR/F");
-    tree->Branch("l2wj2DelR", &inputVars["l2wj2DelR"], "l2wj2DelR/F");
-    tree->Branch("met", &inputVars["met"], "met/F");
-    tree->Branch("nBjets", &inputVars["nBjets"], "nBjets/F");
-    tree->Branch("nJets", &inputVars["nJets"], "nJets/F");
-    tree->Branch("tEta", &inputVars["tEta"], "tEta/F");
-    tree->Branch("tMass", &inputVars["tMass"], "tMass/F");
-    tree->Branch("tMt", &inputVars["tMt"], "tMt/F");
-    tree->Branch("tPhi", &inputVars["tPhi"], "tPhi/F");
-    tree->Branch("tPt", &inputVars["tPt"], "tPt/F");
-    tree->Branch("tbDelR", &inputVars["tbDelR"], "tbDelR/F");
-    tree->Branch("totMass", &inputVars["totMass"], "toMass/F");
-    tree->Branch("totMt", &inputVars["totMt"], "totMt/F");
-    tree->Branch("totPt", &inputVars["totPt"], "totPt/F");
-    tree->Branch("wEta", &inputVars["wEta"], "wEta/F");
-    tree->Branch("wMass", &inputVars["wMass"], "wMass/F");
-    tree->Branch("wMt", &inputVars["wMt"], "wMt/F");
-    tree->Branch("wPhi", &inputVars["wPhi"], "wPhi/F");
-    tree->Branch("wPt", &inputVars["wPt"], "wPt/F");
-    tree->Branch("wbDelR", &inputVars["wbDelR"], "wbDelR/F");
-    tree->Branch("wj1DelR", &inputVars["wj1DelR"], "wj1DelR/F");
-    tree->Branch("wj1Eta", &inputVars["wj1Eta"], "wj1Eta/F");
-    tree->Branch("wj1Phi", &inputVars["wj1Phi"], "wj1Phi/F");
-    tree->Branch("wj1Pt", &inputVars["wj1Pt"], "wj1Pt/F");
-    tree->Branch("wj1bDelR", &inputVars["wj1bDelR"], "wj1bDelR/F");
-    tree->Branch("wj1tDelR", &inputVars["wj1tDelR"], "wj1tDelR/F");
-    tree->Branch("wj2DelR", &inputVars["wj2DelR"], "wj2DelR/F");
-    tree->Branch("wj2Eta", &inputVars["wj2Eta"], "wj2Eta/F");
-    tree->Branch("wj2Phi", &inputVars["wj2Phi"], "wj2Phi/F");
-    tree->Branch("wj2Pt", &inputVars["wj2Pt"], "wj2Pt/F");
-    tree->Branch("wj2bDelR", &inputVars["wj2bDelR"], "wj2bDelR/F");
-    tree->Branch("wj2tDelR", &inputVars["wj2tDelR"], "wj2tDelR/F");
-    tree->Branch("wtDelR", &inputVars["wtDelR"], "wtDelR/F");
-    tree->Branch("wwDelR", &inputVars["w1w2DelR"], "wwDelR/F");
-    tree->Branch("wzDelR", &inputVars["wZDelR"], "wzDelR/F");
-    tree->Branch("zEta", &inputVars["zEta"], "zEta/F");
-    tree->Branch("zMass", &inputVars["zMass"], "zMass/F");
-    tree->Branch("zMt", &inputVars["zMt"], "zMt/F");
-    tree->Branch("zPhi", &inputVars["zPhi"], "zPhi/F");
-    tree->Branch("zPt", &inputVars["zPt"], "zPt/F");
-    tree->Branch("zbDelR", &inputVars["zbDelR"], "zbDelR/F");
-    tree->Branch("zjMaxR", &inputVars["zjMaxR"], "zjMaxR/F");
-    tree->Branch("zjMinR", &inputVars["zjMinR"], "zjMinR/F");
-    tree->Branch("ztDelR", &inputVars["ztDelR"], "ztDelR/F");
-    tree->Branch("zwj1DelR", &inputVars["zwj1DelR"], "zwj1DelR/F");
-    tree->Branch("zwj2DelR", &inputVars["zwj2DelR"], "zwj2DelR/F");
-    tree->Branch("zzDelR", &inputVars["zzDelR"], "zzDelR/F");
+    for (auto& columnar : columnarOutputs)
+    {
+        columnar.second->close();
+    }
+    for (const auto& histograms : scoreHistograms)
+    {
+        for (const auto& histogram : histograms.second)
+        {
+            outFile->WriteTObject(histogram.get());
+        }
+    }
+    if (templates)
+    {
+        templates->write(outputDir + "templates_" + outName + ".root");
+    }
+    columnarOutputs.clear();
+    scoreHistograms.clear();
 }
 
 void MakeMvaInputs::fillTree(TTree* outTreeSig,
@@ -897,181 +1385,151 @@ void MakeMvaInputs::fillTree(TTree* outTreeSig,
                              MvaEvent* tree,
                              const std::string& label,
                              const std::string& channel,
-                             const bool SameSignMC)
+                             const MetPropagation& metPropagation)
 {
     unsigned syst{0};
     const double NaN{std::numeric_limits<double>::quiet_NaN()};
 
+    // The MET variation of the systematic being filled
+    MetPropagation::Variation metVariation{MetPropagation::Variation::nominal};
     if (label.find("__met__plus") != std::string::npos)
     {
         syst = 1024;
+        metVariation = MetPropagation::Variation::unclusteredUp;
     }
     if (label.find("__met__minus") != std::string::npos)
     {
         syst = 2048;
+        metVariation = MetPropagation::Variation::unclusteredDown;
+    }
+    if (label.find("__jes__plus") != std::string::npos)
+    {
+        metVariation = MetPropagation::Variation::jesUp;
+    }
+    if (label.find("__jes__minus") != std::string::npos)
+    {
+        metVariation = MetPropagation::Variation::jesDown;
+    }
+    if (label.find("__jer__plus") != std::string::npos)
+    {
+        metVariation = MetPropagation::Variation::jerUp;
+    }
+    if (label.find("__jer__minus") != std::string::npos)
+    {
+        metVariation = MetPropagation::Variation::jerDown;
     }
 
     if (channel == "emu")
     {
-        inputVars.at("chan") = 2.;
+        inputVars[MvaInput::chan] = 2.;
     }
     if (channel == "ee")
     {
-        inputVars.at("chan") = 1.;
+        inputVars[MvaInput::chan] = 1.;
     }
     if (channel == "mumu")
     {
-        inputVars.at("chan") = 0.;
+        inputVars[MvaInput::chan] = 0.;
     }
 
-    inputVars.at("eventNumber") = tree->eventNum;
+    inputVars[MvaInput::eventNumber] = tree->eventNum;
 
     const std::pair<TLorentzVector, TLorentzVector> zPairLeptons{
         sortOutLeptons(tree, channel)};
     const TLorentzVector zLep1{zPairLeptons.first};
     const TLorentzVector zLep2{zPairLeptons.second};
 
-    TLorentzVector metVec;
-
-    if (oldMetFlag)
-    {
-        metVec.SetPtEtaPhiE(
-            tree->metPF2PATEt, 0, tree->metPF2PATPhi, tree->metPF2PATEt);
-    }
-    else
-    {
-        if (syst == 1024)
-        {
-            metVec.SetPtEtaPhiE(tree->metPF2PATUnclusteredEnUp,
-                                0,
-                                tree->metPF2PATPhi,
-                                tree->metPF2PATUnclusteredEnUp);
-        }
-        else if (syst == 2048)
-        {
-            metVec.SetPtEtaPhiE(tree->metPF2PATUnclusteredEnDown,
-                                0,
-                                tree->metPF2PATPhi,
-                                tree->metPF2PATUnclusteredEnDown);
-        }
-        else
-        {
-            metVec.SetPtEtaPhiE(
-                tree->metPF2PATEt, 0, tree->metPF2PATPhi, tree->metPF2PATEt);
-        }
-    }
+    const TLorentzVector metVec{metPropagation.met(metVariation)};
 
     const std::pair<std::vector<int>, std::vector<TLorentzVector>> jetPair{
-        getJets(tree, syst, metVec)};
+        getJets(tree, syst)};
     const std::vector<int> jets{jetPair.first};
     const std::vector<TLorentzVector> jetVecs{jetPair.second};
 
     const std::pair<std::vector<int>, std::vector<TLorentzVector>> bJetPair{
-        getBjets(tree, syst, metVec, jets)};
+        getBjets(tree, syst, jets)};
     const std::vector<int> bJets{bJetPair.first};
     const std::vector<TLorentzVector> bJetVecs{bJetPair.second};
 
     const std::pair<TLorentzVector, TLorentzVector> wQuarkPair{
-        sortOutHadronicW(tree, syst, metVec, jets)};
+        sortOutHadronicW(tree, syst, jets)};
     const TLorentzVector wQuark1{wQuarkPair.first};
     const TLorentzVector wQuark2{wQuarkPair.second};
 
-    // Do unclustered met stuff here now that we have all of the objects, all
-    // corrected for their various SFs etc ...
-    if (oldMetFlag && (syst == 1024 || syst == 2048))
-    {
-        metVec = doUncMet(metVec, zLep1, zLep2, jetVecs, syst);
-    }
-
-    // SFs for NPL lepton estimation normilisation
-    // mz20 mw 20, ee = 1.06773225071; mumu = 1.02492608673;
-    const double SF_EE{is2016 ? 0.956296241886 : 1.57352187847};
-    const double SF_MUMU{is2016 ? 1.01737450337 : 1.15322585438};
-
-    if (SameSignMC == true && channel == "ee")
-    {
-        inputVars.at("eventWeight") = tree->eventWeight * SF_EE;
-    }
-    else if (SameSignMC == true && channel == "mumu")
-    {
-        inputVars.at("eventWeight") = tree->eventWeight * SF_MUMU;
-    }
-    else
-    {
-        inputVars.at("eventWeight") = tree->eventWeight;
-    }
+    // The NPL transfer factor is applied by sameSignAnalysis
+    inputVars[MvaInput::eventWeight] = tree->eventWeight;
 
-    inputVars.at("j1Pt") = jetVecs[0].Pt();
-    inputVars.at("j1Eta") = jetVecs[0].Eta();
-    inputVars.at("j1Phi") = jetVecs[0].Phi();
+    inputVars[MvaInput::j1Pt] = jetVecs[0].Pt();
+    inputVars[MvaInput::j1Eta] = jetVecs[0].Eta();
+    inputVars[MvaInput::j1Phi] = jetVecs[0].Phi();
 
-    inputVars.at("l1Pt") = zLep1.Pt();
-    inputVars.at("l1Eta") = zLep1.Eta();
-    inputVars.at("l1Phi") = zLep1.Phi();
-    inputVars.at("l2Pt") = zLep2.Pt();
-    inputVars.at("l2Eta") = zLep2.Eta();
-    inputVars.at("l2Phi") = zLep2.Phi();
+    inputVars[MvaInput::l1Pt] = zLep1.Pt();
+    inputVars[MvaInput::l1Eta] = zLep1.Eta();
+    inputVars[MvaInput::l1Phi] = zLep1.Phi();
+    inputVars[MvaInput::l2Pt] = zLep2.Pt();
+    inputVars[MvaInput::l2Eta] = zLep2.Eta();
+    inputVars[MvaInput::l2Phi] = zLep2.Phi();
 
     const TLorentzVector zVec{zLep1 + zLep2};
-    inputVars.at("zMass") = zVec.M();
+    inputVars[MvaInput::zMass] = zVec.M();
     // if (abs(zVec.M() - 91.1876) > 100)
     // {
     //     std::cout << tree->muonLeads << '\t' << zVec.M() << std::endl;;
     // }
-    inputVars.at("zPt") = zVec.Pt();
-    inputVars.at("zEta") = zVec.Eta();
-    inputVars.at("zPhi") = zVec.Phi();
-    inputVars.at("zMt") = zVec.Mt();
+    inputVars[MvaInput::zPt] = zVec.Pt();
+    inputVars[MvaInput::zEta] = zVec.Eta();
+    inputVars[MvaInput::zPhi] = zVec.Phi();
+    inputVars[MvaInput::zMt] = zVec.Mt();
 
     const TLorentzVector wVec{wQuark1 + wQuark2};
     const double wMass{(wQuark1 + wQuark2).M()};
-    inputVars.at("wMass") = wMass;
-    inputVars.at("wPt") = wVec.Pt();
-    inputVars.at("wEta") = wVec.Eta();
-    inputVars.at("wPhi") = wVec.Phi();
+    inputVars[MvaInput::wMass] = wMass;
+    inputVars[MvaInput::wPt] = wVec.Pt();
+    inputVars[MvaInput::wEta] = wVec.Eta();
+    inputVars[MvaInput::wPhi] = wVec.Phi();
 
     const TLorentzVector tVec{bJetVecs[0] + wVec};
     const double topMass{tVec.M()};
-    inputVars.at("tMass") = topMass;
-    inputVars.at("tMt") = tVec.Mt();
-    inputVars.at("tPt") = tVec.Pt();
-    inputVars.at("tEta") = tVec.Eta();
-    inputVars.at("tPhi") = tVec.Phi();
+    inputVars[MvaInput::tMass] = topMass;
+    inputVars[MvaInput::tMt] = tVec.Mt();
+    inputVars[MvaInput::tPt] = tVec.Pt();
+    inputVars[MvaInput::tEta] = tVec.Eta();
+    inputVars[MvaInput::tPhi] = tVec.Phi();
 
     if (channel == "ee")
     {
-        inputVars.at("l1RelIso") =
+        inputVars[MvaInput::l1RelIso] =
             tree->elePF2PATComRelIsoRho[tree->zLep1Index];
-        inputVars.at("l1D0") = tree->elePF2PATD0PV[tree->zLep1Index];
-        inputVars.at("l2RelIso") =
+        inputVars[MvaInput::l1D0] = tree->elePF2PATD0PV[tree->zLep1Index];
+        inputVars[MvaInput::l2RelIso] =
             tree->elePF2PATComRelIsoRho[tree->zLep2Index];
-        inputVars.at("l2D0") = tree->elePF2PATD0PV[tree->zLep2Index];
+        inputVars[MvaInput::l2D0] = tree->elePF2PATD0PV[tree->zLep2Index];
     }
     if (channel == "mumu")
     {
-        inputVars.at("l1RelIso") =
+        inputVars[MvaInput::l1RelIso] =
             tree->muonPF2PATComRelIsodBeta[tree->zLep1Index];
-        inputVars.at("l1D0") = tree->muonPF2PATDBPV[tree->zLep1Index];
-        inputVars.at("l2RelIso") =
+        inputVars[MvaInput::l1D0] = tree->muonPF2PATDBPV[tree->zLep1Index];
+        inputVars[MvaInput::l2RelIso] =
             tree->muonPF2PATComRelIsodBeta[tree->zLep2Index];
-        inputVars.at("l2D0") = tree->muonPF2PATDBPV[tree->zLep2Index];
+        inputVars[MvaInput::l2D0] = tree->muonPF2PATDBPV[tree->zLep2Index];
     }
     if (channel == "emu")
     {
-        inputVars.at("l1RelIso") =
+        inputVars[MvaInput::l1RelIso] =
             tree->elePF2PATComRelIsoRho[tree->zLep1Index];
-        inputVars.at("l1D0") = tree->elePF2PATD0PV[tree->zLep1Index];
-        inputVars.at("l2RelIso") =
+        inputVars[MvaInput::l1D0] = tree->elePF2PATD0PV[tree->zLep1Index];
+        inputVars[MvaInput::l2RelIso] =
             tree->muonPF2PATComRelIsodBeta[tree->zLep2Index];
-        inputVars.at("l2D0") = tree->muonPF2PATDBPV[tree->zLep2Index];
+        inputVars[MvaInput::l2D0] = tree->muonPF2PATDBPV[tree->zLep2Index];
     }
 
-    inputVars.at("wj1Pt") = wQuark1.Pt();
-    inputVars.at("wj1Eta") = wQuark1.Eta();
-    inputVars.at("wj1Phi") = wQuark1.Phi();
-    inputVars.at("wj2Pt") = wQuark2.Pt();
-    inputVars.at("wj2Eta") = wQuark2.Eta();
-    inputVars.at("wj2Phi") = wQuark2.Phi();
+    inputVars[MvaInput::wj1Pt] = wQuark1.Pt();
+    inputVars[MvaInput::wj1Eta] = wQuark1.Eta();
+    inputVars[MvaInput::wj1Phi] = wQuark1.Phi();
+    inputVars[MvaInput::wj2Pt] = wQuark2.Pt();
+    inputVars[MvaInput::wj2Eta] = wQuark2.Eta();
+    inputVars[MvaInput::wj2Phi] = wQuark2.Phi();
 
     TLorentzVector totVec{zVec};
     for (const auto& jetVec : jetVecs)
@@ -1079,192 +1537,173 @@ void MakeMvaInputs::fillTree(TTree* outTreeSig,
         totVec += jetVec;
     }
 
-    inputVars.at("totPt") = totVec.Pt();
-    inputVars.at("totMass") = totVec.M();
-    inputVars.at("totMt") = totVec.Mt();
-    inputVars.at("wMt") = wVec.Mt();
-    inputVars.at("nJets") = boost::numeric_cast<float>(jets.size());
-    inputVars.at("nBjets") = boost::numeric_cast<float>(bJets.size());
-    inputVars.at("met") = metVec.Et();
+    inputVars[MvaInput::totPt] = totVec.Pt();
+    inputVars[MvaInput::totMass] = totVec.M();
+    inputVars[MvaInput::totMt] = totVec.Mt();
+    inputVars[MvaInput::wMt] = wVec.Mt();
+    inputVars[MvaInput::nJets] = boost::numeric_cast<float>(jets.size());
+    inputVars[MvaInput::nBjets] = boost::numeric_cast<float>(bJets.size());
+    inputVars[MvaInput::met] = metVec.Et();
 
-    inputVars.at("bbTag") =
+    inputVars[MvaInput::bbTag] =
         tree->jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
             [jets[bJets[0]]];
-    inputVars.at("bPt") = bJetVecs[0].Pt();
-    inputVars.at("bEta") = bJetVecs[0].Eta();
-    inputVars.at("bPhi") = bJetVecs[0].Phi();
+    inputVars[MvaInput::bPt] = bJetVecs[0].Pt();
+    inputVars[MvaInput::bEta] = bJetVecs[0].Eta();
+    inputVars[MvaInput::bPhi] = bJetVecs[0].Phi();
 
-    inputVars.at("j1bTag") =
+    inputVars[MvaInput::j1bTag] =
         tree->jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags[jets[0]];
-    inputVars.at("j2bTag") = 0;
-    inputVars.at("j2Pt") = 0;
-    inputVars.at("j2Eta") = 0;
-    inputVars.at("j2Phi") = 0;
-    inputVars.at("j3bTag") = 0;
-    inputVars.at("j3Pt") = 0;
-    inputVars.at("j3Eta") = 0;
-    inputVars.at("j3Phi") = 0;
-    inputVars.at("j4bTag") = 0;
-    inputVars.at("j4Pt") = 0;
-    inputVars.at("j4Eta") = 0;
-    inputVars.at("j4Phi") = 0;
+    inputVars[MvaInput::j2bTag] = 0;
+    inputVars[MvaInput::j2Pt] = 0;
+    inputVars[MvaInput::j2Eta] = 0;
+    inputVars[MvaInput::j2Phi] = 0;
+    inputVars[MvaInput::j3bTag] = 0;
+    inputVars[MvaInput::j3Pt] = 0;
+    inputVars[MvaInput::j3Eta] = 0;
+    inputVars[MvaInput::j3Phi] = 0;
+    inputVars[MvaInput::j4bTag] = 0;
+    inputVars[MvaInput::j4Pt] = 0;
+    inputVars[MvaInput::j4Eta] = 0;
+    inputVars[MvaInput::j4Phi] = 0;
 
     if (jetVecs.size() > 1)
     {
-        inputVars.at("j2Pt") = jetVecs[1].Pt();
-        inputVars.at("j2Eta") = jetVecs[1].Eta();
-        inputVars.at("j2Phi") = jetVecs[1].Phi();
-        inputVars.at("j2bTag") =
+        inputVars[MvaInput::j2Pt] = jetVecs[1].Pt();
+        inputVars[MvaInput::j2Eta] = jetVecs[1].Eta();
+        inputVars[MvaInput::j2Phi] = jetVecs[1].Phi();
+        inputVars[MvaInput::j2bTag] =
             tree->jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
                 [jets[1]];
     }
     if (jetVecs.size() > 2)
     {
-        inputVars.at("j3Pt") = jetVecs[2].Pt();
-        inputVars.at("j3Eta") = jetVecs[2].Eta();
-        inputVars.at("j3Phi") = jetVecs[2].Phi();
-        inputVars.at("j3bTag") =
+        inputVars[MvaInput::j3Pt] = jetVecs[2].Pt();
+        inputVars[MvaInput::j3Eta] = jetVecs[2].Eta();
+        inputVars[MvaInput::j3Phi] = jetVecs[2].Phi();
+        inputVars[MvaInput::j3bTag] =
             tree->jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
                 [jets[2]];
     }
     if (jetVecs.size() > 3)
     {
-        inputVars.at("j4Pt") = jetVecs[3].Pt();
-        inputVars.at("j4Eta") = jetVecs[3].Eta();
-        inputVars.at("j4Phi") = jetVecs[3].Phi();
-        inputVars.at("j4bTag") =
+        inputVars[MvaInput::j4Pt] = jetVecs[3].Pt();
+        inputVars[MvaInput::j4Eta] = jetVecs[3].Eta();
+        inputVars[MvaInput::j4Phi] = jetVecs[3].Phi();
+        inputVars[MvaInput::j4bTag] =
             tree->jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
                 [jets[3]];
     }
     if (jetVecs.size() > 4)
     {
-        inputVars.at("j5Pt") = jetVecs[4].Pt();
-        inputVars.at("j5Eta") = jetVecs[4].Eta();
-        inputVars.at("j5Phi") = jetVecs[4].Phi();
-        inputVars.at("j5bTag") =
+        inputVars[MvaInput::j5Pt] = jetVecs[4].Pt();
+        inputVars[MvaInput::j5Eta] = jetVecs[4].Eta();
+        inputVars[MvaInput::j5Phi] = jetVecs[4].Phi();
+        inputVars[MvaInput::j5bTag] =
             tree->jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
                 [jets[4]];
     }
     if (jetVecs.size() > 5)
     {
-        inputVars.at("j6Pt") = jetVecs[5].Pt();
-        inputVars.at("j6Eta") = jetVecs[5].Eta();
-        inputVars.at("j6Phi") = jetVecs[5].Phi();
-        inputVars.at("j6bTag") =
+        inputVars[MvaInput::j6Pt] = jetVecs[5].Pt();
+        inputVars[MvaInput::j6Eta] = jetVecs[5].Eta();
+        inputVars[MvaInput::j6Phi] = jetVecs[5].Phi();
+        inputVars[MvaInput::j6bTag] =
             tree->jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
                 [jets[5]];
     }
 
-    inputVars.at("wZDelR") = zVec.DeltaR(wVec);
+    inputVars[MvaInput::wZDelR] = zVec.DeltaR(wVec);
 
-    inputVars.at("zwj1DelR") = zVec.DeltaR(wQuark1);
-    inputVars.at("zwj2DelR") = zVec.DeltaR(wQuark2);
+    inputVars[MvaInput::zwj1DelR] = zVec.DeltaR(wQuark1);
+    inputVars[MvaInput::zwj2DelR] = zVec.DeltaR(wQuark2);
 
-    inputVars.at("ztDelR") = zVec.DeltaR(tVec);
-    inputVars.at("l1tDelR") = zLep1.DeltaR(tVec);
-    inputVars.at("l2tDelR") = zLep2.DeltaR(tVec);
+    inputVars[MvaInput::ztDelR] = zVec.DeltaR(tVec);
+    inputVars[MvaInput::l1tDelR] = zLep1.DeltaR(tVec);
+    inputVars[MvaInput::l2tDelR] = zLep2.DeltaR(tVec);
 
-    inputVars.at("wtDelR") = wVec.DeltaR(tVec);
-    inputVars.at("wj1tDelR") = wQuark1.DeltaR(tVec);
-    inputVars.at("wj1tDelR") = wQuark1.DeltaPhi(tVec);
-    inputVars.at("wj2tDelR") = wQuark2.DeltaR(tVec);
+    inputVars[MvaInput::wtDelR] = wVec.DeltaR(tVec);
+    inputVars[MvaInput::wj1tDelR] = wQuark1.DeltaR(tVec);
+    inputVars[MvaInput::wj1tDelR] = wQuark1.DeltaPhi(tVec);
+    inputVars[MvaInput::wj2tDelR] = wQuark2.DeltaR(tVec);
 
-    inputVars.at("wtDelR") = wVec.DeltaR(tVec);
+    inputVars[MvaInput::wtDelR] = wVec.DeltaR(tVec);
 
-    inputVars.at("zbDelR") = zVec.DeltaR(bJetVecs[0]);
-    inputVars.at("tbDelR") = tVec.DeltaR(bJetVecs[0]);
-    inputVars.at("wbDelR") = wVec.DeltaR(bJetVecs[0]);
-    inputVars.at("wj1bDelR") = wQuark1.DeltaR(bJetVecs[0]);
-    inputVars.at("wj2bDelR") = wQuark2.DeltaR(bJetVecs[0]);
-    inputVars.at("l1bDelR") = zLep1.DeltaR(bJetVecs[0]);
-    inputVars.at("l2bDelR") = zLep2.DeltaR(bJetVecs[0]);
+    inputVars[MvaInput::zbDelR] = zVec.DeltaR(bJetVecs[0]);
+    inputVars[MvaInput::tbDelR] = tVec.DeltaR(bJetVecs[0]);
+    inputVars[MvaInput::wbDelR] = wVec.DeltaR(bJetVecs[0]);
+    inputVars[MvaInput::wj1bDelR] = wQuark1.DeltaR(bJetVecs[0]);
+    inputVars[MvaInput::wj2bDelR] = wQuark2.DeltaR(bJetVecs[0]);
+    inputVars[MvaInput::l1bDelR] = zLep1.DeltaR(bJetVecs[0]);
+    inputVars[MvaInput::l2bDelR] = zLep2.DeltaR(bJetVecs[0]);
 
     for (unsigned i{0}; i < 4; i++)
     {
         for (unsigned j{i + 1}; j < 4; j++)
         {
-            inputVars.at("j" + std::to_string(i + 1) + "j"
-                         + std::to_string(j + 1) + "DelR") =
+            inputVars[MvaInput::jetJetDelR[i][j]] =
                 jetVecs.at(i).DeltaR(jetVecs.at(j));
         }
-        inputVars.at("j" + std::to_string(i + 1) + "bDelR") =
-            jetVecs.at(i).DeltaR(bJetVecs.at(0));
-        inputVars.at("j" + std::to_string(i + 1) + "tDelR") =
-            jetVecs.at(i).DeltaR(tVec);
-
-        inputVars.at("j" + std::to_string(i + 1) + "l1DelR") =
-            jetVecs.at(i).DeltaR(zLep1);
-        inputVars.at("j" + std::to_string(i + 1) + "l2DelR") =
-            jetVecs.at(i).DeltaR(zLep2);
-        inputVars.at("j" + std::to_string(i + 1) + "zDelR") =
-            jetVecs.at(i).DeltaR(zVec);
-
-        inputVars.at("j" + std::to_string(i + 1) + "wj1DelR") =
-            jetVecs.at(i).DeltaR(wQuark1);
-        inputVars.at("j" + std::to_string(i + 1) + "wj2DelR") =
-            jetVecs.at(i).DeltaR(wQuark2);
-        inputVars.at("j" + std::to_string(i + 1) + "wDelR") =
-            jetVecs.at(i).DeltaR(wVec);
-    }
-
-    inputVars.at("w1w2DelR") = wQuark1.DeltaR(wQuark2);
-    inputVars.at("zzDelR") = zLep1.DeltaR(zLep2);
-    inputVars.at("l1wj1DelR") = zLep1.DeltaR(wQuark1);
-    inputVars.at("l1wj2DelR") = zLep1.DeltaR(wQuark2);
-    inputVars.at("l2wj1DelR") = zLep2.DeltaR(wQuark1);
-    inputVars.at("l2wj2DelR") = zLep2.DeltaR(wQuark2);
+        inputVars[MvaInput::jetBDelR[i]] = jetVecs.at(i).DeltaR(bJetVecs.at(0));
+        inputVars[MvaInput::jetTDelR[i]] = jetVecs.at(i).DeltaR(tVec);
+
+        inputVars[MvaInput::jetL1DelR[i]] = jetVecs.at(i).DeltaR(zLep1);
+        inputVars[MvaInput::jetL2DelR[i]] = jetVecs.at(i).DeltaR(zLep2);
+        inputVars[MvaInput::jetZDelR[i]] = jetVecs.at(i).DeltaR(zVec);
+
+        inputVars[MvaInput::jetWj1DelR[i]] = jetVecs.at(i).DeltaR(wQuark1);
+        inputVars[MvaInput::jetWj2DelR[i]] = jetVecs.at(i).DeltaR(wQuark2);
+        inputVars[MvaInput::jetWDelR[i]] = jetVecs.at(i).DeltaR(wVec);
+    }
+
+    inputVars[MvaInput::w1w2DelR] = wQuark1.DeltaR(wQuark2);
+    inputVars[MvaInput::zzDelR] = zLep1.DeltaR(zLep2);
+    inputVars[MvaInput::l1wj1DelR] = zLep1.DeltaR(wQuark1);
+    inputVars[MvaInput::l1wj2DelR] = zLep1.DeltaR(wQuark2);
+    inputVars[MvaInput::l2wj1DelR] = zLep2.DeltaR(wQuark1);
+    inputVars[MvaInput::l2wj2DelR] = zLep2.DeltaR(wQuark2);
 
     TLorentzVector jetVector;
-    inputVars.at("zjMinR") = std::numeric_limits<float>::infinity();
-    inputVars.at("zjMaxR") = -std::numeric_limits<float>::infinity();
+    inputVars[MvaInput::zjMinR] = std::numeric_limits<float>::infinity();
+    inputVars[MvaInput::zjMaxR] = -std::numeric_limits<float>::infinity();
 
     for (const auto& jetVec : jetVecs)
     {
         jetVector += jetVec;
-        if (jetVec.DeltaR(zVec) < inputVars.at("zjMinR"))
+        if (jetVec.DeltaR(zVec) < inputVars[MvaInput::zjMinR])
         {
-            inputVars.at("zjMinR") = jetVec.DeltaR(zVec);
+            inputVars[MvaInput::zjMinR] = jetVec.DeltaR(zVec);
         }
-        if (jetVec.DeltaR(zVec) > inputVars.at("zjMaxR"))
+        if (jetVec.DeltaR(zVec) > inputVars[MvaInput::zjMaxR])
         {
-            inputVars.at("zjMaxR") = jetVec.DeltaR(zVec);
+            inputVars[MvaInput::zjMaxR] = jetVec.DeltaR(zVec);
         }
     }
 
-    inputVars.at("jetMass") = jetVector.M();
-    inputVars.at("jetMt") = jetVector.Mt();
-    inputVars.at("jetPt") = jetVector.Pt();
-
-    inputVars.at("jetMass3") = (jetVecs[0] + jetVecs[1] + jetVecs[2]).M();
-
-    constexpr double W_MASS{80.385};
-    constexpr double TOP_MASS{173.1};
-
-    // from scripts/plotMassPeaks.py
-    constexpr double W_SIGMA{8};
-    constexpr double TOP_SIGMA{30};
+    inputVars[MvaInput::jetMass] = jetVector.M();
+    inputVars[MvaInput::jetMt] = jetVector.Mt();
+    inputVars[MvaInput::jetPt] = jetVector.Pt();
 
-    const double wChi2Term{(wMass - W_MASS) / W_SIGMA};
-    const double topChi2Term{(topMass - TOP_MASS) / TOP_SIGMA};
-    inputVars.at("chi2") = std::pow(wChi2Term, 2) + std::pow(topChi2Term, 2);
+    inputVars[MvaInput::jetMass3] = (jetVecs[0] + jetVecs[1] + jetVecs[2]).M();
 
-    constexpr double MIN_SIDEBAND_CHI2{40};
-    constexpr double MAX_SIDEBAND_CHI2{150};
+    inputVars[MvaInput::chi2] = MvaRegion::chi2(wMass, topMass);
 
+    // label is the process followed by any systematic, e.g. tZq__jes__plus
+    const std::string category{templateCategory(label, channel)};
     if (useSidebandRegion)
     {
-        if (inputVars.at("chi2") >= MIN_SIDEBAND_CHI2
-            and inputVars.at("chi2") < MAX_SIDEBAND_CHI2)
+        const unsigned region{MvaRegion::chi2Region(inputVars[MvaInput::chi2])};
+        if (region == MvaRegion::sideband)
         {
-            outTreeSdBnd->Fill();
+            fillOutput(outTreeSdBnd, "ctrl_" + category);
         }
-        if (inputVars.at("chi2") < MIN_SIDEBAND_CHI2)
+        if (region == MvaRegion::signal)
         {
-            outTreeSig->Fill();
+            fillOutput(outTreeSig, "sig_" + category);
         }
     }
     else
     {
-        outTreeSig->Fill();
+        fillOutput(outTreeSig, category);
     }
 }
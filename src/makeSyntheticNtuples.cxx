@@ -0,0 +1,177 @@
+#include "syntheticNtuple.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Writes synthetic MC and data ntuples in the 2016 and 2017 layouts, with the
+// dataset and ee channel configurations to run analysisMain.exe over them:
+//
+//   <outdir>/<year>/{mc,data}/synthetic_<n>.root
+//   <outdir>/<year>/datasets/synthetic{MC,Data}.yaml
+//   <outdir>/<year>/ee_synthetic.yaml
+//
+// analysisBenchmark.exe --synthetic <outdir> times analysisMain.exe on these.
+
+namespace
+{
+void writeDatasetConf(const boost::filesystem::path& conf,
+                      const std::string& year,
+                      const boost::filesystem::path& location,
+                      const bool isMC,
+                      const long totalEvents)
+{
+    std::ofstream out{conf.string()};
+    out << "name: \"synthetic" << (isMC ? "MC" : "Data") << year << "\"\n";
+    out << "locations:\n";
+    out << "    - \"" << location.string() << "/\"\n";
+    if (isMC)
+    {
+        out << "total_events: " << totalEvents << "\n";
+        out << "cross_section: 1.0\n";
+        out << "mc: true\n";
+        out << "histogram: \"synthetic\"\n";
+        out << "colour: \"#cc0000\"\n";
+        out << "label: \"Synthetic\"\n";
+        out << "plot_type: \"f\"\n";
+    }
+    else
+    {
+        out << "luminosity: " << (year == "2016" ? 35858.984 : 41528) << "\n";
+        out << "mc: false\n";
+        out << "histogram: \"data\"\n";
+        out << "label: \"Data\"\n";
+        out << "plot_type: \"p\"\n";
+        out << "colour: \"#ffffff\"\n";
+        out << "trigger_flag: \"eCt\"\n";
+    }
+    if (!out)
+    {
+        throw std::runtime_error("Could not write " + conf.string());
+    }
+}
+
+void writeChannelConf(const boost::filesystem::path& yearDir,
+                      const std::string& year)
+{
+    const boost::filesystem::path conf{yearDir / "ee_synthetic.yaml"};
+    std::ofstream out{conf.string()};
+    out << "cuts: \"configs/" << year << "/cuts/SRCuts.yaml\"\n";
+    out << "plots: \"configs/plots/plotDileptonConf.yaml\"\n";
+    out << "outputFolder: \"" << (yearDir / "plots").string() << "/\"\n";
+    out << "outputPostfix: \"ee\"\n";
+    out << "channelName: \"ee\"\n";
+    out << "datasets:\n";
+    out << "  - \"" << (yearDir / "datasets" / "syntheticMC.yaml").string()
+        << "\"\n";
+    out << "  - \"" << (yearDir / "datasets" / "syntheticData.yaml").string()
+        << "\"\n";
+    if (!out)
+    {
+        throw std::runtime_error("Could not write " + conf.string());
+    }
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string outDir;
+    long events;
+    unsigned files;
+    unsigned seed;
+    SyntheticRates rates;
+
+    namespace po = boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()("help,h", "Print this message.")(
+        "outdir,o",
+        po::value<std::string>(&outDir)->default_value("synthetic"),
+        "Directory to write the ntuples and configurations to.")(
+        "events,n",
+        po::value<long>(&events)->default_value(10000),
+        "Number of events in each file.")(
+        "files,f",
+        po::value<unsigned>(&files)->default_value(4),
+        "Number of files for each year and MC or data.")(
+        "seed",
+        po::value<unsigned>(&seed)->default_value(1),
+        "Random seed. The same seed gives the same files.")(
+        "triggerRate",
+        po::value<double>(&rates.triggerRate)
+            ->default_value(rates.triggerRate),
+        "Probability of each trigger path firing.")(
+        "zFraction",
+        po::value<double>(&rates.zFraction)->default_value(rates.zFraction),
+        "Fraction of events with a Z -> ee or mumu decay.")(
+        "jets",
+        po::value<double>(&rates.jets)->default_value(rates.jets),
+        "Mean number of jets per event.");
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        unsigned layout{0};
+        for (const std::string year : {"2016", "2017"})
+        {
+            const boost::filesystem::path yearDir{
+                boost::filesystem::path{outDir} / year};
+            boost::filesystem::create_directories(yearDir / "datasets");
+            for (const bool isMC : {true, false})
+            {
+                const boost::filesystem::path location{
+                    yearDir / (isMC ? "mc" : "data")};
+                boost::filesystem::create_directories(location);
+
+                // Each file has its own seed, so they don't repeat each other
+                for (unsigned file{0}; file < files; file++)
+                {
+                    SyntheticNtuple ntuple{isMC,
+                                           year == "2016",
+                                           seed * 1000 + layout * 100 + file,
+                                           rates};
+                    const boost::filesystem::path path{
+                        location
+                        / ("synthetic_" + std::to_string(file) + ".root")};
+                    ntuple.write(path.string(), events);
+                    std::cout << "Wrote " << events << " events to " << path
+                              << std::endl;
+                }
+                writeDatasetConf(
+                    yearDir / "datasets"
+                        / (isMC ? "syntheticMC.yaml" : "syntheticData.yaml"),
+                    year,
+                    location,
+                    isMC,
+                    events * files);
+                layout++;
+            }
+            writeChannelConf(yearDir, year);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,63 @@
+#include "histogramStore.hpp"
+
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Combines the histogram stores written by several analysisMain.exe
+// --makeHistos jobs (e.g. one per dataset or per batch of files) into a single
+// store that can be passed to --useHistos via --histoDir.
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> inputs;
+    std::string output;
+
+    namespace po = boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()("help,h", "Print this message.")(
+        "output,o",
+        po::value<std::string>(&output)->required(),
+        "Path of the merged store, e.g. histos/merged/histogramStore_ee.root.")(
+        "inputs,i",
+        po::value<std::vector<std::string>>(&inputs)->multitoken()->required(),
+        "Histogram stores to merge.");
+    po::positional_options_description positional;
+    positional.add("inputs", -1);
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::command_line_parser(argc, argv)
+                      .options(desc)
+                      .positional(positional)
+                      .run(),
+                  vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        HistogramStore::merge(inputs, output);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Merged " << inputs.size() << " histogram stores into "
+              << output << std::endl;
+}
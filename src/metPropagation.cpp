@@ -0,0 +1,138 @@
+#include "metPropagation.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+MetPropagation::MetPropagation(const double metPx, const double metPy)
+    : metPx_{metPx}
+    , metPy_{metPy}
+    , leptonPx_{0}
+    , leptonPy_{0}
+    , jetPx_{0}
+    , jetPy_{0}
+    , shiftPx_{}
+    , shiftPy_{}
+    , fixedUnclustered_{false}
+    , unclusteredUpEt_{0}
+    , unclusteredDownEt_{0}
+{
+}
+
+void MetPropagation::addLepton(const TLorentzVector& lepton)
+{
+    leptonPx_ += lepton.Px();
+    leptonPy_ += lepton.Py();
+}
+
+void MetPropagation::addJet(const TLorentzVector& jet,
+                            const double smear,
+                            const double smearUp,
+                            const double smearDown,
+                            const double jesUncUp,
+                            const double jesUncDown)
+{
+    const double px{jet.Px()};
+    const double py{jet.Py()};
+    // How much less of each jet the varied MET has than the nominal one
+    const std::array<double, numJetShifts> shift{{smear * jesUncUp,
+                                                  smear * jesUncDown,
+                                                  smearUp - smear,
+                                                  smearDown - smear}};
+
+    jetPx_ += smear * px;
+    jetPy_ += smear * py;
+    for (unsigned i{0}; i < numJetShifts; i++)
+    {
+        shiftPx_[i] -= shift[i] * px;
+        shiftPy_[i] -= shift[i] * py;
+    }
+}
+
+void MetPropagation::addJet(const TLorentzVector& jet, const double smear)
+{
+    addJet(jet, smear, smear, smear, 0., 0.);
+}
+
+void MetPropagation::setUnclusteredEt(const double up, const double down)
+{
+    fixedUnclustered_ = true;
+    unclusteredUpEt_ = up;
+    unclusteredDownEt_ = down;
+}
+
+void MetPropagation::setJetVariation(const Variation variation,
+                                     const TLorentzVector& met)
+{
+    const unsigned shift{jetShift(variation)};
+    shiftPx_[shift] = met.Px() - metPx_;
+    shiftPy_[shift] = met.Py() - metPy_;
+}
+
+unsigned MetPropagation::jetShift(const Variation variation)
+{
+    switch (variation)
+    {
+        case Variation::jesUp:
+            return jesUpShift;
+        case Variation::jesDown:
+            return jesDownShift;
+        case Variation::jerUp:
+            return jerUpShift;
+        case Variation::jerDown:
+            return jerDownShift;
+        case Variation::nominal:
+        case Variation::unclusteredUp:
+        case Variation::unclusteredDown:
+        default:
+            break;
+    }
+    throw std::invalid_argument("Not a jet MET variation");
+}
+
+TLorentzVector MetPropagation::met(const Variation variation) const
+{
+    std::pair<double, double> met;
+    switch (variation)
+    {
+        case Variation::nominal:
+        default:
+            met = {metPx_, metPy_};
+            break;
+        case Variation::jesUp:
+        case Variation::jesDown:
+        case Variation::jerUp:
+        case Variation::jerDown:
+        {
+            const unsigned shift{jetShift(variation)};
+            met = {metPx_ + shiftPx_[shift], metPy_ + shiftPy_[shift]};
+            break;
+        }
+        case Variation::unclusteredUp:
+        case Variation::unclusteredDown:
+        {
+            if (fixedUnclustered_)
+            {
+                const double et{variation == Variation::unclusteredUp
+                                    ? unclusteredUpEt_
+                                    : unclusteredDownEt_};
+                const double phi{std::atan2(metPy_, metPx_)};
+                met = {et * std::cos(phi), et * std::sin(phi)};
+                break;
+            }
+            const double sign{variation == Variation::unclusteredUp ? 1. : -1.};
+            met = {metPx_
+                       + sign * unclusteredShift
+                             * (metPx_ + leptonPx_ + jetPx_),
+                   metPy_
+                       + sign * unclusteredShift
+                             * (metPy_ + leptonPy_ + jetPy_)};
+            break;
+        }
+    }
+
+    TLorentzVector metVec;
+    const double et{std::hypot(met.first, met.second)};
+    metVec.SetPxPyPzE(met.first, met.second, 0, et);
+    return metVec;
+}
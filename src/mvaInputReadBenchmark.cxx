@@ -0,0 +1,174 @@
+#include "TFile.h"
+#include "TLeaf.h"
+#include "TTree.h"
+#include "columnarFile.hpp"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Times a full scan of every float column of an MVA input tree, as written by
+// makeMVAinputMain.exe --format both, from the ROOT file and from its
+// columnar (.tqzcol) copy. Each scan sums every value so neither can be
+// optimised away, and the sums are printed so the two can be checked against
+// each other.
+
+namespace
+{
+double scanRoot(const std::string& path, const std::string& treeName)
+{
+    const std::unique_ptr<TFile> inFile{TFile::Open(path.c_str(), "READ")};
+    if (!inFile || inFile->IsZombie())
+    {
+        throw std::runtime_error("Could not open " + path);
+    }
+    TTree* const tree{dynamic_cast<TTree*>(inFile->Get(treeName.c_str()))};
+    if (!tree)
+    {
+        throw std::runtime_error("No " + treeName + " in " + path);
+    }
+
+    std::vector<float> values(
+        static_cast<size_t>(tree->GetListOfLeaves()->GetEntries()));
+    size_t nValues{0};
+    for (const auto leafObject : *tree->GetListOfLeaves())
+    {
+        const auto leaf{static_cast<TLeaf*>(leafObject)};
+        if (std::string{leaf->GetTypeName()} == "Float_t")
+        {
+            tree->SetBranchAddress(leaf->GetBranch()->GetName(),
+                                   &values[nValues++]);
+        }
+    }
+
+    double sum{0};
+    const long long numberOfEvents{tree->GetEntries()};
+    for (long long i{0}; i < numberOfEvents; i++)
+    {
+        tree->GetEntry(i);
+        for (size_t j{0}; j < nValues; j++)
+        {
+            sum += values[j];
+        }
+    }
+    tree->ResetBranchAddresses();
+    return sum;
+}
+
+double scanColumnar(const std::string& path)
+{
+    const ColumnarReader reader{path};
+    double sum{0};
+    for (std::uint64_t group{0}; group < reader.groups(); group++)
+    {
+        const std::uint32_t rows{reader.groupRows(group)};
+        for (std::uint32_t col{0}; col < reader.columns().size(); col++)
+        {
+            const float* const values{reader.column(group, col)};
+            for (std::uint32_t row{0}; row < rows; row++)
+            {
+                sum += values[row];
+            }
+        }
+    }
+    return sum;
+}
+
+template <typename Scan>
+void timeScans(const std::string& label,
+               const std::string& path,
+               const unsigned repeats,
+               Scan scan)
+{
+    const double megabytes{
+        static_cast<double>(boost::filesystem::file_size(path)) / (1 << 20)};
+    double sum{0};
+    const auto start{std::chrono::steady_clock::now()};
+    for (unsigned i{0}; i < repeats; i++)
+    {
+        sum = scan();
+    }
+    const std::chrono::duration<double> elapsed{
+        std::chrono::steady_clock::now() - start};
+    const double perScan{elapsed.count() / repeats};
+    std::cout << boost::format("%-9s %10.1f MB %10.4f s/scan %10.1f MB/s "
+                               "(file size)  sum %.6g")
+                     % label % megabytes % perScan % (megabytes / perScan)
+                     % sum
+              << std::endl;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string rootPath;
+    std::string treeName;
+    std::string columnarPath;
+    unsigned repeats;
+
+    namespace po = boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()("help,h", "Print this message.")(
+        "root,r",
+        po::value<std::string>(&rootPath)->required(),
+        "MVA input ROOT file, e.g. mvaInputs/histofile_tZq.root.")(
+        "tree,t",
+        po::value<std::string>(&treeName)->required(),
+        "Tree to scan, e.g. Ttree_tZq.")(
+        "columnar,c",
+        po::value<std::string>(&columnarPath),
+        "Columnar copy of the tree (default <tree>.tqzcol next to the ROOT "
+        "file).")("repeats,n",
+                  po::value<unsigned>(&repeats)->default_value(5),
+                  "Number of times to scan each file.");
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (columnarPath.empty())
+    {
+        columnarPath =
+            (boost::filesystem::path{rootPath}.parent_path() / treeName)
+                .string()
+            + ".tqzcol";
+    }
+    repeats = std::max(repeats, 1u);
+
+    try
+    {
+        timeScans("ROOT", rootPath, repeats, [&] {
+            return scanRoot(rootPath, treeName);
+        });
+        timeScans("columnar", columnarPath, repeats, [&] {
+            return scanColumnar(columnarPath);
+        });
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+}
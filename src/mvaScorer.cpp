@@ -0,0 +1,60 @@
+#include "mvaScorer.hpp"
+
+#include "TMVA/Reader.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+float* slot(MvaInput::Values& inputVars, const std::string& name)
+{
+    const auto branch{std::find_if(
+        MvaInput::branches.begin(),
+        MvaInput::branches.end(),
+        [&name](const auto& b) { return b.name == name; })};
+    if (branch == MvaInput::branches.end())
+    {
+        throw std::runtime_error("Unknown MVA input variable " + name);
+    }
+    return &inputVars[static_cast<size_t>(branch - MvaInput::branches.begin())];
+}
+} // namespace
+
+MvaScorer::MvaScorer(MvaInput::Values& inputVars,
+                     const std::vector<std::string>& variables,
+                     const std::vector<std::string>& spectators,
+                     std::vector<MvaMethod> methods)
+    : methods_{std::move(methods)}
+    , scores_(methods_.size())
+    , reader_{std::make_unique<TMVA::Reader>("!Color:Silent")}
+{
+    for (const auto& variable : variables)
+    {
+        reader_->AddVariable(variable, slot(inputVars, variable));
+    }
+    for (const auto& spectator : spectators)
+    {
+        reader_->AddSpectator(spectator, slot(inputVars, spectator));
+    }
+    for (const auto& method : methods_)
+    {
+        if (!reader_->BookMVA(method.name, method.weights))
+        {
+            throw std::runtime_error("Could not book " + method.name + " from "
+                                     + method.weights);
+        }
+    }
+}
+
+MvaScorer::~MvaScorer()
+{
+}
+
+void MvaScorer::evaluate()
+{
+    for (size_t i{0}; i < methods_.size(); i++)
+    {
+        scores_[i] = static_cast<float>(reader_->EvaluateMVA(methods_[i].name));
+    }
+}
@@ -0,0 +1,232 @@
+#include "nplEstimator.hpp"
+
+#include "MvaEvent.hpp"
+#include "TFile.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+namespace
+{
+bool promptLepton(const Int_t decayed, const Int_t finalState)
+{
+    return decayed == 1 || finalState == 1;
+}
+} // namespace
+
+void Npl::Counts::add(const bool prompt, const double weight)
+{
+    if (prompt)
+    {
+        promptSumW += weight;
+        promptSumW2 += weight * weight;
+    }
+    else
+    {
+        nonPromptSumW += weight;
+        nonPromptSumW2 += weight * weight;
+    }
+}
+
+Npl::Counts& Npl::Counts::operator+=(const Counts& other)
+{
+    promptSumW += other.promptSumW;
+    promptSumW2 += other.promptSumW2;
+    nonPromptSumW += other.nonPromptSumW;
+    nonPromptSumW2 += other.nonPromptSumW2;
+    return *this;
+}
+
+const std::vector<std::string>& Npl::transferFactorSamples(const bool is2016)
+{
+    static const std::vector<std::string> samples2016{
+        "tZq", "tHq", "ttWlnu", "ttZ2l2nu", "wPlusJets", "WZjets"};
+    static const std::vector<std::string> samples2017{
+        "tZq", "tHq", "ttWTolnu", "ttZToll", "wPlusJets", "WZ_3lnu"};
+    return is2016 ? samples2016 : samples2017;
+}
+
+bool Npl::isPrompt(const MvaEvent& event, const std::string& channel)
+{
+    const int z1{event.zLep1Index};
+    const int z2{event.zLep2Index};
+    if (channel == "ee")
+    {
+        return promptLepton(event.genElePF2PATPromptDecayed[z1],
+                            event.genElePF2PATPromptFinalState[z1])
+               && promptLepton(event.genElePF2PATPromptDecayed[z2],
+                               event.genElePF2PATPromptFinalState[z2]);
+    }
+    if (channel == "mumu")
+    {
+        return promptLepton(event.genMuonPF2PATPromptDecayed[z1],
+                            event.genMuonPF2PATPromptFinalState[z1])
+               && promptLepton(event.genMuonPF2PATPromptDecayed[z2],
+                               event.genMuonPF2PATPromptFinalState[z2]);
+    }
+    // emu: the first Z lepton is the electron
+    return promptLepton(event.genElePF2PATPromptDecayed[z1],
+                        event.genElePF2PATPromptFinalState[z1])
+           && promptLepton(event.genMuonPF2PATPromptDecayed[z2],
+                           event.genMuonPF2PATPromptFinalState[z2]);
+}
+
+Npl::Counts Npl::countFile(const std::string& path, const std::string& channel)
+{
+    const std::unique_ptr<TFile> inFile{TFile::Open(path.c_str(), "READ")};
+    if (!inFile || inFile->IsZombie())
+    {
+        throw std::runtime_error("Could not open " + path);
+    }
+    TTree* const tree{dynamic_cast<TTree*>(inFile->Get("tree"))};
+    if (!tree)
+    {
+        throw std::runtime_error("No tree in " + path);
+    }
+
+    Double_t eventWeight;
+    Int_t zLep1Index;
+    Int_t zLep2Index;
+    Int_t eleDecayed[AnalysisEvent::NELECTRONSMAX];
+    Int_t eleFinalState[AnalysisEvent::NELECTRONSMAX];
+    Int_t muonDecayed[AnalysisEvent::NMUONSMAX];
+    Int_t muonFinalState[AnalysisEvent::NMUONSMAX];
+
+    tree->SetBranchStatus("*", false);
+    const auto read{[tree](const char* name, void* address) {
+        tree->SetBranchStatus(name, true);
+        tree->SetBranchAddress(name, address);
+    }};
+    read("eventWeight", &eventWeight);
+    read("zLep1Index", &zLep1Index);
+    read("zLep2Index", &zLep2Index);
+    const bool electrons{channel != "mumu"};
+    const bool muons{channel != "ee"};
+    if (electrons)
+    {
+        // The arrays are sized by the counts, which have to be read too
+        tree->SetBranchStatus("numElePF2PAT", true);
+        read("genElePF2PATPromptDecayed", eleDecayed);
+        read("genElePF2PATPromptFinalState", eleFinalState);
+    }
+    if (muons)
+    {
+        tree->SetBranchStatus("numMuonPF2PAT", true);
+        read("genMuonPF2PATPromptDecayed", muonDecayed);
+        read("genMuonPF2PATPromptFinalState", muonFinalState);
+    }
+
+    Counts counts;
+    const long long numberOfEvents{tree->GetEntries()};
+    for (long long i{0}; i < numberOfEvents; i++)
+    {
+        tree->GetEntry(i);
+        const int z1{zLep1Index};
+        const int z2{zLep2Index};
+        bool prompt;
+        if (channel == "ee")
+        {
+            prompt = promptLepton(eleDecayed[z1], eleFinalState[z1])
+                     && promptLepton(eleDecayed[z2], eleFinalState[z2]);
+        }
+        else if (channel == "mumu")
+        {
+            prompt = promptLepton(muonDecayed[z1], muonFinalState[z1])
+                     && promptLepton(muonDecayed[z2], muonFinalState[z2]);
+        }
+        else
+        {
+            prompt = promptLepton(eleDecayed[z1], eleFinalState[z1])
+                     && promptLepton(muonDecayed[z2], muonFinalState[z2]);
+        }
+        counts.add(prompt, eventWeight);
+    }
+    tree->ResetBranchAddresses();
+    return counts;
+}
+
+Npl::TransferFactor Npl::transferFactor(const Counts& oppositeSign,
+                                        const Counts& sameSign)
+{
+    const double os{std::abs(oppositeSign.nonPromptSumW)};
+    const double ss{std::abs(sameSign.nonPromptSumW)};
+    if (ss == 0.)
+    {
+        throw std::runtime_error(
+            "No non-prompt same sign MC events to take the NPL transfer "
+            "factor from");
+    }
+    const double value{os / ss};
+    const double error{
+        value
+        * std::sqrt(
+            (os > 0 ? oppositeSign.nonPromptSumW2 / (os * os) : 0)
+            + sameSign.nonPromptSumW2 / (ss * ss))};
+    return {value, error};
+}
+
+Npl::FileCounter::FileCounter(std::vector<std::string> paths,
+                              std::string channel,
+                              const unsigned nThreads)
+    : paths_{std::move(paths)}
+    , channel_{std::move(channel)}
+    , counts_(paths_.size())
+    , errors_(paths_.size())
+{
+    const auto next{std::make_shared<std::atomic<size_t>>(0)};
+    for (unsigned thread{0}; thread < std::max(nThreads, 1u); thread++)
+    {
+        threads_.emplace_back([this, next] {
+            for (size_t i{(*next)++}; i < paths_.size(); i = (*next)++)
+            {
+                try
+                {
+                    counts_[i] = countFile(paths_[i], channel_);
+                }
+                catch (const std::exception& e)
+                {
+                    errors_[i] = e.what();
+                }
+            }
+        });
+    }
+}
+
+Npl::FileCounter::~FileCounter()
+{
+    for (auto& thread : threads_)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+}
+
+Npl::Counts Npl::FileCounter::get()
+{
+    for (auto& thread : threads_)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+    for (const auto& error : errors_)
+    {
+        if (!error.empty())
+        {
+            throw std::runtime_error(error);
+        }
+    }
+    Counts total;
+    for (const auto& counts : counts_)
+    {
+        total += counts;
+    }
+    return total;
+}
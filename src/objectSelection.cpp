@@ -0,0 +1,337 @@
+#include "objectSelection.hpp"
+
+#include "AnalysisEvent.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <yaml-cpp/yaml.h>
+
+namespace
+{
+void readThresholds(const YAML::Node& node, LeptonThresholds& thresholds)
+{
+    if (!node)
+    {
+        return;
+    }
+    if (node["pt"])
+    {
+        thresholds.pt = node["pt"].as<double>();
+    }
+    if (node["ptLeading"])
+    {
+        thresholds.ptLeading = node["ptLeading"].as<double>();
+    }
+    if (node["eta"])
+    {
+        thresholds.eta = node["eta"].as<double>();
+    }
+    if (node["relIso"])
+    {
+        thresholds.relIso = node["relIso"].as<double>();
+    }
+}
+
+// The impact parameter cuts that are not part of the tuned electron IDs,
+// looser in the endcap
+bool passesElectronImpactParameter(const AnalysisEvent& event,
+                                   const int i,
+                                   const double absEta)
+{
+    if (absEta <= 1.479)
+    {
+        return std::abs(event.elePF2PATD0PV[i]) < 0.05
+               && std::abs(event.elePF2PATDZPV[i]) < 0.10;
+    }
+    if (absEta < 2.50)
+    {
+        return std::abs(event.elePF2PATD0PV[i]) < 0.10
+               && std::abs(event.elePF2PATDZPV[i]) < 0.20;
+    }
+    return true;
+}
+
+// Within eta, and out of the barrel/endcap gap and the max safe eta range
+bool inElectronAcceptance(const double absEta, const double eta)
+{
+    return absEta <= eta && !(absEta > 1.4442 && absEta < 1.566)
+           && absEta <= 2.50;
+}
+} // namespace
+
+ObjectSelection::ObjectSelection(const bool is2016)
+    : tightElectron{15., 35., 2.5, 0.107587}
+    , looseElectron{15., 35., 2.5, 0.15}
+    , tightMuon{12., 27., 2.4, 0.15}
+    , looseMuon{12., 27., 2.4, 0.25}
+    , jetId{is2016 ? JetId::loose : JetId::tightLepVeto}
+    , eeBadScFilter{false}
+    , is2016_{is2016}
+{
+}
+
+void ObjectSelection::configure(const YAML::Node& cuts)
+{
+    readThresholds(cuts["tightElectrons"], tightElectron);
+    readThresholds(cuts["looseElectrons"], looseElectron);
+    readThresholds(cuts["tightMuons"], tightMuon);
+    readThresholds(cuts["looseMuons"], looseMuon);
+
+    if (cuts["jets"] && cuts["jets"]["id"])
+    {
+        const auto id{cuts["jets"]["id"].as<std::string>()};
+        if (id == "loose")
+        {
+            jetId = JetId::loose;
+        }
+        else if (id == "tightLepVeto")
+        {
+            jetId = JetId::tightLepVeto;
+        }
+        else
+        {
+            throw std::runtime_error("Unknown jet ID " + id);
+        }
+    }
+    if (cuts["metFilters"] && cuts["metFilters"]["eeBadScFilter"])
+    {
+        eeBadScFilter = cuts["metFilters"]["eeBadScFilter"].as<bool>();
+    }
+}
+
+std::vector<int>
+    ObjectSelection::tightElectrons(const AnalysisEvent& event) const
+{
+    std::vector<int> electrons;
+    for (int i{0}; i < event.numElePF2PAT; i++)
+    {
+        // VID cut
+        if (!event.elePF2PATIsGsf[i] || event.elePF2PATCutIdTight[i] < 1)
+        {
+            continue;
+        }
+        if (event.elePF2PATPT[i] <= (electrons.empty()
+                                         ? tightElectron.ptLeading
+                                         : tightElectron.pt))
+        {
+            continue;
+        }
+        const double absEta{std::abs(event.elePF2PATSCEta[i])};
+        if (!inElectronAcceptance(absEta, tightElectron.eta)
+            || !passesElectronImpactParameter(event, i, absEta))
+        {
+            continue;
+        }
+        electrons.emplace_back(i);
+    }
+    return electrons;
+}
+
+std::vector<int>
+    ObjectSelection::looseElectrons(const AnalysisEvent& event) const
+{
+    std::vector<int> electrons;
+    for (int i{0}; i < event.numElePF2PAT; i++)
+    {
+        // VID cut
+        if (!event.elePF2PATCutIdVeto[i])
+        {
+            continue;
+        }
+        if (event.elePF2PATPT[i] <= (electrons.empty()
+                                         ? looseElectron.ptLeading
+                                         : looseElectron.pt))
+        {
+            continue;
+        }
+        const double absEta{std::abs(event.elePF2PATSCEta[i])};
+        if (!inElectronAcceptance(absEta, looseElectron.eta)
+            || !passesElectronImpactParameter(event, i, absEta))
+        {
+            continue;
+        }
+        electrons.emplace_back(i);
+    }
+    return electrons;
+}
+
+std::vector<int> ObjectSelection::tightMuons(const AnalysisEvent& event) const
+{
+    std::vector<int> muons;
+    for (int i{0}; i < event.numMuonPF2PAT; i++)
+    {
+        if (!event.muonPF2PATIsPFMuon[i])
+        {
+            continue;
+        }
+        const double ptCut{muons.empty() ? tightMuon.ptLeading : tightMuon.pt};
+        if (is2016_)
+        {
+            if (event.muonPF2PATPt[i] <= ptCut
+                || std::abs(event.muonPF2PATEta[i]) >= tightMuon.eta
+                || event.muonPF2PATComRelIsodBeta[i] >= tightMuon.relIso)
+            {
+                continue;
+            }
+
+            // Tight ID Cut
+            if (!event.muonPF2PATTrackID[i] || !event.muonPF2PATGlobalID[i]
+                || event.muonPF2PATGlbTkNormChi2[i] >= 10.
+                || event.muonPF2PATMatchedStations[i] < 2
+                || std::abs(event.muonPF2PATDBPV[i]) >= 0.2
+                || std::abs(event.muonPF2PATDZPV[i]) >= 0.5
+                || event.muonPF2PATMuonNHits[i] < 1
+                || event.muonPF2PATVldPixHits[i] < 1
+                || event.muonPF2PATTkLysWithMeasurements[i] <= 5)
+            {
+                continue;
+            }
+        }
+        else if (!event.muonPF2PATTightCutId[i]
+                 || !event.muonPF2PATPfIsoTight[i]
+                 || std::abs(event.muonPF2PATEta[i]) > tightMuon.eta
+                 || event.muonPF2PATPt[i] < ptCut)
+        {
+            continue;
+        }
+        muons.emplace_back(i);
+    }
+    return muons;
+}
+
+std::vector<int> ObjectSelection::looseMuons(const AnalysisEvent& event) const
+{
+    std::vector<int> muons;
+    for (int i{0}; i < event.numMuonPF2PAT; i++)
+    {
+        if (!event.muonPF2PATIsPFMuon[i])
+        {
+            continue;
+        }
+        const double ptCut{muons.empty() ? looseMuon.ptLeading : looseMuon.pt};
+        if (is2016_)
+        {
+            if (event.muonPF2PATPt[i] <= ptCut
+                || std::abs(event.muonPF2PATEta[i]) >= looseMuon.eta
+                || event.muonPF2PATComRelIsodBeta[i] >= looseMuon.relIso
+                || !(event.muonPF2PATGlobalID[i] || event.muonPF2PATTrackID[i]))
+            {
+                continue;
+            }
+        }
+        else if (!event.muonPF2PATLooseCutId[i]
+                 || !event.muonPF2PATPfIsoLoose[i]
+                 || std::abs(event.muonPF2PATEta[i]) >= looseMuon.eta
+                 || event.muonPF2PATPt[i] < ptCut)
+        {
+            continue;
+        }
+        muons.emplace_back(i);
+    }
+    return muons;
+}
+
+bool ObjectSelection::passesJetId(const AnalysisEvent& event,
+                                  const int i,
+                                  const double eta) const
+{
+    const double absEta{std::abs(eta)};
+    if (jetId == JetId::loose)
+    {
+        if (absEta <= 2.7)
+        {
+            if (event.jetPF2PATNeutralHadronEnergyFraction[i] >= 0.99
+                || event.jetPF2PATNeutralEmEnergyFraction[i] >= 0.99
+                || event.jetPF2PATChargedMultiplicity[i]
+                           + event.jetPF2PATNeutralMultiplicity[i]
+                       <= 1)
+            {
+                return false;
+            }
+            return absEta > 2.40
+                   || (event.jetPF2PATChargedHadronEnergyFraction[i] > 0.0
+                       && event.jetPF2PATChargedMultiplicity[i] > 0.0
+                       && event.jetPF2PATChargedEmEnergyFraction[i] < 0.99);
+        }
+        if (absEta <= 3.0)
+        {
+            return event.jetPF2PATNeutralHadronEnergyFraction[i] < 0.98
+                   && event.jetPF2PATNeutralEmEnergyFraction[i] > 0.01
+                   && event.jetPF2PATNeutralMultiplicity[i] > 2;
+        }
+        return event.jetPF2PATNeutralEmEnergyFraction[i] < 0.90
+               && event.jetPF2PATNeutralMultiplicity[i] > 10;
+    }
+
+    // https://twiki.cern.ch/twiki/bin/view/CMS/JetID13TeVRun2017
+    if (absEta <= 2.7)
+    {
+        if (event.jetPF2PATNeutralHadronEnergyFraction[i] >= 0.90
+            || event.jetPF2PATNeutralEmEnergyFraction[i] >= 0.90
+            || event.jetPF2PATNConstituents[i] <= 1
+            || event.jetPF2PATMuonFraction[i] >= 0.8)
+        {
+            return false;
+        }
+        return absEta > 2.40
+               || (event.jetPF2PATChargedHadronEnergyFraction[i] > 0.0
+                   && event.jetPF2PATChargedMultiplicity[i] > 0.0
+                   && event.jetPF2PATChargedEmEnergyFraction[i] < 0.8);
+    }
+    if (absEta <= 3.0)
+    {
+        return event.jetPF2PATNeutralEmEnergyFraction[i] > 0.02
+               && event.jetPF2PATNeutralEmEnergyFraction[i] < 0.99
+               && event.jetPF2PATNeutralMultiplicity[i] > 2;
+    }
+    return event.jetPF2PATNeutralEmEnergyFraction[i] < 0.90
+           && event.jetPF2PATNeutralHadronEnergyFraction[i] > 0.02
+           && event.jetPF2PATNeutralMultiplicity[i] > 10;
+}
+
+bool ObjectSelection::metFilters(const AnalysisEvent& event,
+                                 const bool isMC) const
+{
+    if (event.Flag_HBHENoiseFilter <= 0 || event.Flag_HBHENoiseIsoFilter <= 0
+        || event.Flag_globalTightHalo2016Filter <= 0
+        || event.Flag_EcalDeadCellTriggerPrimitiveFilter <= 0
+        || event.Flag_goodVertices <= 0
+        || (eeBadScFilter && !isMC && event.Flag_eeBadScFilter <= 0))
+    {
+        return false;
+    }
+
+    if (is2016_
+        && (event.Flag_ecalLaserCorrFilter <= 0
+            || event.Flag_chargedHadronTrackResolutionFilter <= 0
+            || event.Flag_muonBadTrackFilter <= 0
+            || (!isMC && event.Flag_noBadMuons <= 0)))
+    {
+        return false;
+    }
+
+    if (!is2016_
+        && (event.Flag_BadPFMuonFilter <= 0
+            || event.Flag_BadChargedCandidateFilter <= 0
+            || event.Flag_ecalBadCalibFilter <= 0))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+double ObjectSelection::deltaPhi(const double phi1, const double phi2)
+{
+    return std::atan2(std::sin(phi1 - phi2), std::cos(phi1 - phi2));
+}
+
+double ObjectSelection::deltaR(const double eta1,
+                               const double phi1,
+                               const double eta2,
+                               const double phi2)
+{
+    return std::sqrt(std::pow(eta1 - eta2, 2)
+                     + std::pow(deltaPhi(phi1, phi2), 2));
+}
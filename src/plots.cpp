@@ -39,6 +39,10 @@ Plots::Plots(const std::vector<std::string> titles,
                      xMaxs[i]};
         plotPoint[i].fillPlot =
             boost::numeric_cast<unsigned>(cutStage[i]) <= thisCutStage;
+        if (plotPoint[i].fillPlot)
+        {
+            fillIndices_.emplace_back(i);
+        }
     }
 }
 
@@ -1537,14 +1541,11 @@ std::unordered_map<std::string,
 
 void Plots::fillAllPlots(const AnalysisEvent& event, const double eventWeight)
 {
-    for (unsigned i{0}; i < plotPoint.size(); i++)
+    for (const unsigned i : fillIndices_)
     {
-        if (plotPoint[i].fillPlot)
+        for (const auto& val : plotPoint[i].fillExp(event))
         {
-            for (const auto& val : (this->plotPoint[i].fillExp)(event))
-            {
-                plotPoint[i].plotHist->Fill(val, eventWeight);
-            }
+            plotPoint[i].plotHist->Fill(val, eventWeight);
         }
     }
 }
@@ -1,39 +1,513 @@
 #include "AnalysisEvent.hpp"
+#include "cutClass.hpp"
+#include "eventIndex.hpp"
+#include "fnv1a.hpp"
+#include "forkWorkers.hpp"
+#include "resultCache.hpp"
 
 #include <TChain.h>
 #include <TFile.h>
+#include <TFileMerger.h>
+#include <TH2D.h>
+#include <TLeaf.h>
 #include <TTree.h>
-#include <array>
+#include <algorithm>
 #include <boost/filesystem.hpp>
-#include <boost/functional/hash.hpp>
-#include <boost/numeric/conversion/cast.hpp>
 #include <boost/program_options.hpp>
-#include <boost/progress.hpp>
 #include <boost/range/iterator_range.hpp>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
-#include <regex>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <string>
-#include <unordered_set>
+#include <unistd.h>
 #include <vector>
 
 using namespace std::string_literals;
 namespace fs = boost::filesystem;
 
+// Skims nTuples down to the events passing the channel's triggers. Events in
+// the single lepton datasets that also fired a dilepton trigger are dropped,
+// as they are already in the dilepton skim.
+//
+// Every input file gets its own output file, named after it, and is recorded
+// in <output dir>/manifest once done. A re-run picks up from the manifest,
+// skipping any input whose entry is done, unchanged (same size and mtime) and
+// whose output is still there. Files are shared out between --jobs forked
+// workers.
+//
+// Given --cuts, it makes the post lepton selection skims in the same pass
+// (a fused skim): each event passing the above is put through the cut
+// config's trigger, MET filter and lepton selection, as analysisMain.exe -g
+// does, and only those passing and only the branches analysisMain reads are
+// kept. The per-file outputs are then merged into
+// <outputDir>/<datasetName>SmallSkim.root, with the generator weights and
+// b-tagging efficiency maps for MC. --mc skims an MC dataset this way, from
+// the -d directories alone. With --invert the per-file outputs, manifest and
+// merged file all have invLep added, as analysisMain.exe -u expects, so the
+// two selections of a dataset can share its directory.
+
+namespace
+{
+const std::string manifestHeader{"# postTriggerSkimmer manifest v1"};
+
+struct ManifestEntry
+{
+    std::string kind; // dilepton or singleLepton
+    std::string input;
+    std::string fingerprint;
+    std::string output; // Relative to the output dir
+    std::string status; // done or failed
+    long long entriesIn{0};
+    long long entriesOut{0};
+    long long singleElectron{0};
+    long long dupElectron{0};
+    long long singleMuon{0};
+    long long dupMuon{0};
+};
+
+// The ntuples store event numbers as 32 bit ints, so those past 2^31 come out
+// negative; taken as unsigned they are right again.
+std::uint32_t eventNumber(const Int_t eventNum)
+{
+    return static_cast<std::uint32_t>(eventNum);
+}
+
+std::string manifestLine(const ManifestEntry& entry)
+{
+    std::ostringstream line;
+    line << entry.kind << ' ' << std::quoted(entry.input) << ' '
+         << entry.fingerprint << ' ' << entry.output << ' ' << entry.status
+         << ' ' << entry.entriesIn << ' ' << entry.entriesOut << ' '
+         << entry.singleElectron << ' ' << entry.dupElectron << ' '
+         << entry.singleMuon << ' ' << entry.dupMuon << '\n';
+    return line.str();
+}
+
+// The latest entry for each input, or nothing if the manifest is missing or
+// was made for another channel or kind of skim (tag).
+std::map<std::string, ManifestEntry> readManifest(const std::string& path,
+                                                  const std::string& tag)
+{
+    std::map<std::string, ManifestEntry> entries;
+    std::ifstream manifest{path};
+    std::string line;
+    if (!manifest || !std::getline(manifest, line)
+        || line != manifestHeader + ' ' + tag)
+    {
+        return entries;
+    }
+    while (std::getline(manifest, line))
+    {
+        std::istringstream lineStream{line};
+        ManifestEntry entry;
+        lineStream >> entry.kind >> std::quoted(entry.input)
+            >> entry.fingerprint >> entry.output >> entry.status
+            >> entry.entriesIn >> entry.entriesOut >> entry.singleElectron
+            >> entry.dupElectron >> entry.singleMuon >> entry.dupMuon;
+        // A line cut short by a killed job is just ignored
+        if (lineStream)
+        {
+            entries[entry.input] = entry;
+        }
+    }
+    return entries;
+}
+
+// Each line goes out in a single write to a file opened for appending, so
+// lines from several workers never interleave.
+void appendToManifest(const std::string& path, const ManifestEntry& entry)
+{
+    const std::string line{manifestLine(entry)};
+    const int fd{open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644)};
+    if (fd < 0
+        || write(fd, line.data(), line.size())
+               != static_cast<ssize_t>(line.size()))
+    {
+        throw std::runtime_error("Could not write to " + path);
+    }
+    close(fd);
+}
+
+// Stable however the directories are listed or ordered on the command line:
+// the input's name, plus a hash of its full path in case two directories
+// have files of the same name, then postfix.
+std::string outputName(const std::string& input, const std::string& postfix)
+{
+    Fnv1a hash;
+    hash.add(input);
+    return "triggerSkim_" + fs::path{input}.stem().string() + '_'
+           + hash.hex().substr(0, 8) + postfix + ".root";
+}
+
+std::vector<std::string> listRootFiles(const std::vector<std::string>& dirs)
+{
+    std::vector<std::string> files;
+    for (const auto& dir : dirs)
+    {
+        for (const auto& file :
+             boost::make_iterator_range(fs::directory_iterator{dir}, {}))
+        {
+            if (fs::is_regular_file(file.status())
+                && file.path().extension() == ".root")
+            {
+                files.emplace_back(file.path().string());
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// The b-tagging efficiency maps, in the order Cuts fills them. They are
+// binned as analysisMain.exe -g bins them.
+const std::vector<std::string> bTagEffNames{"bTagEff_Denom_b",
+                                            "bTagEff_Denom_c",
+                                            "bTagEff_Denom_uds",
+                                            "bTagEff_Denom_g",
+                                            "bTagEff_Num_b",
+                                            "bTagEff_Num_c",
+                                            "bTagEff_Num_uds",
+                                            "bTagEff_Num_g"};
+
+// Set for a fused skim, which applies the lepton preselection as well
+struct Preselection
+{
+    std::string cutConf;
+    bool isMC{false};
+    bool invertLepCut{false};
+};
+
+// Skims one file. dileptonEvents is null for a dilepton dataset, and
+// otherwise holds the events already taken from the dilepton datasets.
+//
+// With cuts set (a fused skim) each event passing the trigger and duplicate
+// removal also goes through Cuts::makeCuts, which fills outTree with those
+// passing the lepton selection, as analysisMain.exe -g does. Only the
+// branches AnalysisEvent reads are kept. For MC there is no trigger or
+// duplicate step here, and the file's generator weights and the b-tagging
+// efficiency maps are written alongside; for dilepton data the run and
+// event numbers of everything passing the trigger go into triggeredEvents,
+// for the single lepton duplicate removal.
+void skimFile(ManifestEntry& entry,
+              const std::string& outputPath,
+              const std::string& channel,
+              const bool is2016,
+              const EventIndex* const dileptonEvents,
+              Cuts* const cuts,
+              const bool isMC)
+{
+    TChain datasetChain{"tree"};
+    datasetChain.Add(entry.input.c_str());
+    AnalysisEvent event{isMC, &datasetChain, is2016};
+    if (cuts)
+    {
+        datasetChain.LoadTree(0);
+        TObjArray* const branches{datasetChain.GetListOfBranches()};
+        for (int i{0}; branches && i < branches->GetEntriesFast(); i++)
+        {
+            const auto branch{dynamic_cast<TBranch*>(branches->At(i))};
+            if (branch && !branch->GetAddress())
+            {
+                datasetChain.SetBranchStatus(branch->GetName(), false);
+            }
+        }
+    }
+    TTree* const outTree = datasetChain.CloneTree(0);
+
+    // Written under a temporary name so a killed job leaves no output
+    // behind that looks complete
+    TFile outFile{(outputPath + ".tmp").c_str(), "RECREATE"};
+    if (outFile.IsZombie())
+    {
+        throw std::runtime_error("Could not create " + outputPath + ".tmp");
+    }
+    outTree->SetDirectory(&outFile);
+
+    TTree* triggeredEvents{nullptr};
+    UInt_t triggeredRun;
+    ULong64_t triggeredEvent;
+    if (cuts && !isMC && !dileptonEvents)
+    {
+        triggeredEvents = new TTree{"triggeredEvents", "triggeredEvents"};
+        triggeredEvents->SetDirectory(&outFile);
+        triggeredEvents->Branch("eventRun", &triggeredRun, "eventRun/i");
+        triggeredEvents->Branch("eventNum", &triggeredEvent, "eventNum/l");
+    }
+
+    std::vector<std::unique_ptr<TH2D>> bTagEffPlots;
+    if (cuts)
+    {
+        cuts->setCloneTree(outTree);
+        if (isMC)
+        {
+            std::vector<TH2D*> plots;
+            for (const auto& name : bTagEffNames)
+            {
+                bTagEffPlots.emplace_back(std::make_unique<TH2D>(
+                    name.c_str(), name.c_str(), 4, 0., 200., 4, 0., 2.4));
+                bTagEffPlots.back()->SetDirectory(nullptr);
+                plots.emplace_back(bTagEffPlots.back().get());
+            }
+            cuts->setBTagPlots(plots, true);
+        }
+    }
+    TH1D cutFlow{"cutFlow", "cutFlow", 1, 0., 1.};
+    cutFlow.SetDirectory(nullptr);
+    const auto keep{[&] {
+        if (!cuts)
+        {
+            outTree->Fill();
+            return;
+        }
+        // makeCuts fills outTree itself, once the leptons are selected
+        double eventWeight{1.};
+        cuts->smearJets(event);
+        cuts->makeCuts(event, eventWeight, StagePlots{}, cutFlow, 0);
+    }};
+
+    entry.entriesIn = datasetChain.GetEntries();
+    for (long long i{0}; i < entry.entriesIn; i++)
+    {
+        event.GetEntry(i);
+
+        if (isMC)
+        {
+            keep();
+            continue;
+        }
+
+        if (!dileptonEvents)
+        {
+            if ((channel == "ee" && event.eeTrig())
+                || (channel == "mumu" && event.mumuTrig())
+                || (channel == "emu" && event.muEGTrig()))
+            {
+                if (triggeredEvents)
+                {
+                    triggeredRun = static_cast<UInt_t>(event.eventRun);
+                    triggeredEvent = eventNumber(event.eventNum);
+                    triggeredEvents->Fill();
+                }
+                keep();
+            }
+            continue;
+        }
+
+        const bool eTrig{channel != "mumu" && event.eTrig()};
+        const bool muTrig{channel != "ee" && event.muTrig()};
+        if (!eTrig && !muTrig)
+        {
+            continue;
+        }
+        entry.singleElectron += eTrig;
+        entry.singleMuon += muTrig;
+        // If event has already been found in the dilepton skim, skip it
+        if (dileptonEvents->contains(static_cast<std::uint32_t>(event.eventRun),
+                                     eventNumber(event.eventNum)))
+        {
+            entry.dupElectron += eTrig;
+            entry.dupMuon += muTrig;
+        }
+        else
+        {
+            keep();
+        }
+    }
+    entry.entriesOut = outTree->GetEntries();
+
+    outFile.cd();
+    outTree->Write();
+    if (triggeredEvents)
+    {
+        triggeredEvents->Write();
+    }
+    if (cuts)
+    {
+        cuts->setCloneTree(nullptr);
+    }
+    if (cuts && isMC)
+    {
+        TObject* const weights{
+            datasetChain.GetFile()->Get("sumNumPosMinusNegWeights")};
+        if (!weights)
+        {
+            throw std::runtime_error("No sumNumPosMinusNegWeights in "
+                                     + entry.input);
+        }
+        outFile.WriteTObject(weights);
+        for (const auto& plot : bTagEffPlots)
+        {
+            outFile.WriteTObject(plot.get());
+        }
+    }
+    outFile.Close();
+    fs::rename(outputPath + ".tmp", outputPath);
+}
+
+// Runs skimFile on each entry, shared out between nWorkers forked
+// processes: entry i goes to worker i % nWorkers. Each worker records its
+// entries in the manifest as it finishes them, and makes its own Cuts for a
+// fused skim, so no open scale factor files are shared between processes.
+void runWorkers(std::vector<ManifestEntry>& entries,
+                const unsigned nWorkers,
+                const std::string& outputDir,
+                const std::string& manifestPath,
+                const std::string& channel,
+                const bool is2016,
+                const EventIndex* const dileptonEvents,
+                const Preselection* const preselection)
+{
+    const auto work{[&](const unsigned worker, const unsigned workers) {
+        bool ok{true};
+        std::unique_ptr<Cuts> cuts;
+        if (preselection)
+        {
+            cuts = std::make_unique<Cuts>(
+                false, false, preselection->invertLepCut, is2016);
+            cuts->parse_config(preselection->cutConf);
+            cuts->setMC(preselection->isMC);
+        }
+        for (size_t i{worker}; i < entries.size(); i += workers)
+        {
+            ManifestEntry& entry{entries[i]};
+            try
+            {
+                skimFile(entry,
+                         outputDir + entry.output,
+                         channel,
+                         is2016,
+                         dileptonEvents,
+                         cuts.get(),
+                         preselection && preselection->isMC);
+                entry.status = "done";
+                std::cout << entry.input << " -> " << entry.output << ": "
+                          << entry.entriesOut << '/' << entry.entriesIn
+                          << " events" << std::endl;
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "ERROR: " << entry.input << ": " << e.what()
+                          << std::endl;
+                entry.status = "failed";
+                ok = false;
+            }
+            appendToManifest(manifestPath, entry);
+        }
+        return ok;
+    }};
+
+    if (nWorkers <= 1 || entries.size() <= 1)
+    {
+        if (!work(0, 1))
+        {
+            throw std::runtime_error("Some files failed, see above");
+        }
+        return;
+    }
+
+    if (!forkWorkers(
+            std::min<unsigned>(nWorkers, static_cast<unsigned>(entries.size())),
+            work,
+            "skim worker"))
+    {
+        throw std::runtime_error("Some files failed, see above");
+    }
+}
+
+// The events in the dilepton skims, read back from the skims themselves so
+// those done in earlier runs or by other workers are included. Fused skims
+// keep them in triggeredEvents, as their main tree holds fewer.
+EventIndex readDileptonEvents(const std::vector<ManifestEntry>& entries,
+                              const std::string& outputDir,
+                              const std::string& treeName)
+{
+    EventIndex events;
+    for (const auto& entry : entries)
+    {
+        const std::string path{outputDir + entry.output};
+        const std::unique_ptr<TFile> inFile{TFile::Open(path.c_str(), "READ")};
+        TTree* const tree{
+            inFile ? dynamic_cast<TTree*>(inFile->Get(treeName.c_str()))
+                   : nullptr};
+        if (!tree)
+        {
+            throw std::runtime_error("Could not read the skim " + path);
+        }
+        tree->SetBranchStatus("*", false);
+        tree->SetBranchStatus("eventRun", true);
+        tree->SetBranchStatus("eventNum", true);
+        TLeaf* const runLeaf{tree->GetLeaf("eventRun")};
+        TLeaf* const eventLeaf{tree->GetLeaf("eventNum")};
+        if (!runLeaf || !eventLeaf)
+        {
+            throw std::runtime_error("No event numbers in " + path);
+        }
+        // Read through the leaves, as the skims' own trees hold Int_t event
+        // numbers and triggeredEvents unsigned 64 bit ones. Either way only
+        // the low 32 bits are kept, as eventNumber does for the single lepton
+        // events they are compared with.
+        const long long numberOfEvents{tree->GetEntries()};
+        for (long long i{0}; i < numberOfEvents; i++)
+        {
+            tree->GetEntry(i);
+            events.add(
+                static_cast<std::uint32_t>(runLeaf->GetValueLong64()),
+                static_cast<std::uint32_t>(eventLeaf->GetValueLong64()));
+        }
+    }
+    events.finalise();
+    return events;
+}
+
+// Merges the per-file outputs of a fused skim into the single file
+// analysisMain.exe -u reads, adding up the generator weights and b-tagging
+// efficiency maps. This is quick next to the skim itself, so is redone every
+// run.
+void mergeSkims(const std::vector<ManifestEntry>& entries,
+                const std::string& outputDir,
+                const std::string& mergedPath)
+{
+    TFileMerger merger{false};
+    if (!merger.OutputFile((mergedPath + ".tmp").c_str(), "RECREATE"))
+    {
+        throw std::runtime_error("Could not create " + mergedPath + ".tmp");
+    }
+    for (const auto& entry : entries)
+    {
+        if (!merger.AddFile((outputDir + entry.output).c_str(), false))
+        {
+            throw std::runtime_error("Could not read the skim " + outputDir
+                                     + entry.output);
+        }
+    }
+    merger.AddObjectNames("triggeredEvents");
+    if (!merger.PartialMerge(TFileMerger::kAll | TFileMerger::kRegular
+                             | TFileMerger::kSkipListed))
+    {
+        throw std::runtime_error("Could not merge the skims into "
+                                 + mergedPath);
+    }
+    fs::rename(mergedPath + ".tmp", mergedPath);
+}
+} // namespace
+
 int main(int argc, char* argv[])
 {
     std::vector<std::string> dileptonDirs;
     std::vector<std::string> singleLeptonDirs;
     std::string datasetName;
     std::string channel;
+    std::string outputBaseDir;
     bool is2016;
-
-    int singleElectron{0};
-    int dupElectron{0};
-    int singleMuon{0};
-    int dupMuon{0};
-
-    const std::string postTriggerSkimDir{
-        "/data0/data/TopPhysics/postTriggerSkims201"s + (is2016 ? "6/" : "7/")};
+    unsigned jobs;
+    std::string cutConf;
+    bool isMC;
+    bool invertLepCut;
 
     // Define command-line flags
     namespace po = boost::program_options;
@@ -49,13 +523,32 @@ int main(int argc, char* argv[])
             ->required(),
         "Directories in which to look for double lepton datasets.")(
         "singleLeptonDirs,s",
-        po::value<std::vector<std::string>>(&singleLeptonDirs)
-            ->multitoken()
-            ->required(),
-        "Directories in which to look for single lepton datasets.")(
+        po::value<std::vector<std::string>>(&singleLeptonDirs)->multitoken(),
+        "Directories in which to look for single lepton datasets. Required "
+        "unless --mc is given.")(
         "datasetName,o",
         po::value<std::string>(&datasetName)->required(),
-        "Output dataset name.");
+        "Output dataset name.")(
+        "outputDir",
+        po::value<std::string>(&outputBaseDir),
+        "Directory to write the dataset to (default "
+        "/data0/data/TopPhysics/postTriggerSkims201<6|7>/, or "
+        "/scratch2/data/TopPhysics/postLepSelSkims201<6|7>/ with --cuts).")(
+        "jobs,j",
+        po::value<unsigned>(&jobs)->default_value(1),
+        "Number of files to skim at once.")(
+        "cuts",
+        po::value<std::string>(&cutConf),
+        "Cut configuration to apply the lepton selection of as well, making "
+        "the post lepton selection skim <outputDir>/<datasetName>"
+        "[invLep]SmallSkim.root in the same pass.")(
+        "mc",
+        po::bool_switch(&isMC),
+        "The -d directories hold an MC dataset. Requires --cuts.")(
+        "invert,i",
+        po::bool_switch(&invertLepCut),
+        "Inverts the different charge cut for leptons, adding invLep to the "
+        "output names. Requires --cuts.");
     po::variables_map vm;
 
     // Parse arguments
@@ -77,264 +570,203 @@ int main(int argc, char* argv[])
         return 1;
     }
 
-    const std::regex mask{".*\\.root"};
-    int fileNum{0};
-
-    std::unordered_set<std::pair<int, int>,
-                       boost::hash<std::pair<Int_t, Int_t>>>
-        triggerDoubleCountCheck;
-
-    for (const auto& dileptonDir : dileptonDirs)
-    { // for each dilepton input directory
-        for (const auto& file : boost::make_iterator_range(
-                 fs::directory_iterator{dileptonDir}, {}))
-        { // for each file in directory
-            const std::string path{file.path().string()};
-            std::cout << "path: " << path << std::endl;
-
-            if (!fs::is_regular_file(file.status())
-                || !std::regex_match(path, mask))
-            {
-                continue; // skip if not a root file
-            }
-
-            const std::string numName{std::to_string(fileNum)};
-            const std::string numNamePlus{std::to_string(fileNum + 2)};
-
-            if (fs::is_regular_file(postTriggerSkimDir + datasetName
-                                    + "/triggerSkim" + numNamePlus + ".root"))
-            {
-                // don't overwrite existing skim files, except for the last two
-                fileNum++;
-                continue;
-            }
-
-            TChain datasetChain{"tree"};
-            datasetChain.Add(path.c_str());
-
-            TTree* const outTree = datasetChain.CloneTree(0);
-
-            std::string outFilePath{postTriggerSkimDir + datasetName
-                                    + "/triggerSkim" + numName + ".root"};
-            TFile outFile{outFilePath.c_str(), "RECREATE"};
-
-            const long long int numberOfEvents{datasetChain.GetEntries()};
-
-            boost::progress_display progress{
-                boost::numeric_cast<unsigned long>(numberOfEvents),
-                std::cout,
-                outFilePath + "\n"};
-            AnalysisEvent event{false, &datasetChain, is2016};
+    if (channel != "ee" && channel != "mumu" && channel != "emu")
+    {
+        std::cerr << "ERROR: unknown channel " << channel << std::endl;
+        return 1;
+    }
+    if (cutConf.empty() && (isMC || invertLepCut))
+    {
+        std::cerr << "ERROR: --mc and --invert require --cuts" << std::endl;
+        return 1;
+    }
+    if (!isMC && singleLeptonDirs.empty())
+    {
+        std::cerr << "ERROR: --singleLeptonDirs is required for data"
+                  << std::endl;
+        return 1;
+    }
+    if (isMC)
+    {
+        singleLeptonDirs.clear();
+    }
+    if (outputBaseDir.empty())
+    {
+        outputBaseDir =
+            (cutConf.empty() ? "/data0/data/TopPhysics/postTriggerSkims201"s
+                             : "/scratch2/data/TopPhysics/postLepSelSkims201"s)
+            + (is2016 ? "6/" : "7/");
+    }
+    const std::string outputDir{
+        (fs::path{outputBaseDir} / datasetName).string() + '/'};
+    const std::string invPostFix{invertLepCut ? "invLep" : ""};
+    const std::string manifestPath{outputDir + "manifest" + invPostFix};
+
+    std::unique_ptr<Preselection> preselection;
+    // The manifest is only reused by a skim made the same way
+    std::string manifestTag{channel};
+    if (!cutConf.empty())
+    {
+        preselection = std::make_unique<Preselection>(
+            Preselection{cutConf, isMC, invertLepCut});
+        manifestTag += " fused "s + (isMC ? "mc " : "data ")
+                       + (invertLepCut ? "invLep " : "")
+                       + ResultCache::fileFingerprint(cutConf);
+    }
 
-            for (long long int i{0}; i < numberOfEvents; i++)
+    try
+    {
+        fs::create_directories(outputDir);
+        const auto previous{readManifest(manifestPath, manifestTag)};
+
+        // Works out what is left to do, and starts a fresh manifest holding
+        // only what is already done
+        std::vector<ManifestEntry> done;
+        const auto plan{[&](const std::vector<std::string>& inputs,
+                            const std::string& kind) {
+            std::vector<ManifestEntry> todo;
+            for (const auto& input : inputs)
             {
-                ++progress; // update progress bar (++ must be prefix)
-                event.GetEntry(i);
-
-                if (channel == "ee")
+                ManifestEntry entry;
+                entry.kind = kind;
+                entry.input = input;
+                entry.fingerprint = ResultCache::fileFingerprint(input);
+                entry.output = outputName(input, invPostFix);
+                const auto old{previous.find(input)};
+                if (old != previous.end() && old->second.kind == kind
+                    && old->second.status == "done"
+                    && old->second.fingerprint == entry.fingerprint
+                    && old->second.output == entry.output
+                    && fs::is_regular_file(outputDir + entry.output))
                 {
-                    // clang-format off
-                    const bool eeTrig{event.eeTrig()};
-                    // clang-format on
-
-                    if (eeTrig)
-                    {
-                        triggerDoubleCountCheck.emplace(event.eventRun,
-                                                        event.eventNum);
-                        outTree->Fill();
-                    }
+                    done.emplace_back(old->second);
                 }
-
-                if (channel == "mumu")
+                else
                 {
-                    const bool mumuTrig{event.mumuTrig()};
-
-                    if (mumuTrig)
-                    {
-                        triggerDoubleCountCheck.emplace(event.eventRun,
-                                                        event.eventNum);
-                        outTree->Fill();
-                    }
+                    todo.emplace_back(entry);
                 }
-
-                if (channel == "emu")
-                {
-                    const bool muEGTrig{event.muEGTrig()};
-
-                    if (muEGTrig)
-                    {
-                        triggerDoubleCountCheck.emplace(event.eventRun,
-                                                        event.eventNum);
-                        outTree->Fill();
-                    }
-                } // end emu
             }
-            outFile.cd();
-            outTree->Write();
-
-            outFile.Write();
-            outFile.Close();
-
-            fileNum++;
-            std::cout << std::endl;
-
-            delete outTree;
-        }
-    }
-
-    for (const auto& singleLeptonDir : singleLeptonDirs)
-    { // for each single lepton input directory
-        for (const auto& file : boost::make_iterator_range(
-                 fs::directory_iterator{singleLeptonDir}, {}))
-        { // for each file in directory
-            const std::string path{file.path().string()};
-            std::cout << "path: " << path << std::endl;
-
-            if (!fs::is_regular_file(file.status())
-                || !std::regex_match(path, mask))
+            return todo;
+        }};
+        const std::vector<std::string> dileptonInputs{
+            listRootFiles(dileptonDirs)};
+        const std::vector<std::string> singleLeptonInputs{
+            listRootFiles(singleLeptonDirs)};
+        std::vector<ManifestEntry> dileptonTodo{
+            plan(dileptonInputs, "dilepton")};
+        std::vector<ManifestEntry> singleLeptonTodo{
+            plan(singleLeptonInputs, "singleLepton")};
+        // The single lepton skims depend on every dilepton skim, so are all
+        // redone if any of those are
+        if (!dileptonTodo.empty())
+        {
+            singleLeptonTodo.clear();
+            for (const auto& input : singleLeptonInputs)
             {
-                continue; // skip if not a root file
+                ManifestEntry entry;
+                entry.kind = "singleLepton";
+                entry.input = input;
+                entry.fingerprint = ResultCache::fileFingerprint(input);
+                entry.output = outputName(input, invPostFix);
+                singleLeptonTodo.emplace_back(entry);
             }
-
-            const std::string numName{std::to_string(fileNum)};
-            const std::string numNamePlus{std::to_string(fileNum + 2)};
-
-            if (fs::is_regular_file(postTriggerSkimDir + datasetName
-                                    + "/triggerSkim" + numNamePlus + ".root"))
+            done.erase(std::remove_if(done.begin(),
+                                      done.end(),
+                                      [](const ManifestEntry& entry) {
+                                          return entry.kind == "singleLepton";
+                                      }),
+                       done.end());
+        }
+        {
+            std::ofstream manifest{manifestPath + ".tmp"};
+            manifest << manifestHeader << ' ' << manifestTag << '\n';
+            for (const auto& entry : done)
             {
-                // don't overwrite existing skim files, except for the last two
-                fileNum++;
-                continue;
+                manifest << manifestLine(entry);
             }
-
-            TChain datasetChain{"tree"};
-            datasetChain.Add(path.c_str());
-            TTree* const outTree = datasetChain.CloneTree(0);
-
-            std::string outFilePath{postTriggerSkimDir + datasetName
-                                    + "/triggerSkim" + numName + ".root"};
-            TFile outFile{outFilePath.c_str(), "RECREATE"};
-
-            const long long int numberOfEvents{datasetChain.GetEntries()};
-
-            boost::progress_display progress{
-                boost::numeric_cast<unsigned long>(numberOfEvents),
-                std::cout,
-                outFilePath + "\n"};
-            AnalysisEvent event{false, &datasetChain, is2016};
-
-            for (long long int i{0}; i < numberOfEvents; i++)
+        }
+        fs::rename(manifestPath + ".tmp", manifestPath);
+
+        std::cout << "Skimming " << dileptonTodo.size() << '/'
+                  << dileptonInputs.size() << " dilepton and "
+                  << singleLeptonTodo.size() << '/' << singleLeptonInputs.size()
+                  << " single lepton files" << std::endl;
+
+        runWorkers(dileptonTodo,
+                   jobs,
+                   outputDir,
+                   manifestPath,
+                   channel,
+                   is2016,
+                   nullptr,
+                   preselection.get());
+
+        if (!singleLeptonTodo.empty())
+        {
+            std::vector<ManifestEntry> dileptonDone;
+            for (const auto& entry : readManifest(manifestPath, manifestTag))
             {
-                ++progress; // update progress bar (++ must be prefix)
-                event.GetEntry(i);
-                if (channel == "ee")
+                if (entry.second.kind == "dilepton")
                 {
-                    const bool eTrig{event.eTrig()};
-                    if (eTrig)
-                    {
-                        auto it{triggerDoubleCountCheck.find(
-                            {event.eventRun, event.eventNum})};
-                        singleElectron++;
-                        // If event has already been found ... skip event
-                        if (it != triggerDoubleCountCheck.end())
-                        {
-                            dupElectron++;
-                        }
-                        // If event has not already been found, add to new skim
-                        else
-                        {
-                            // triggerDoubleCountCheck.emplace(
-                            // event.eventRun, event.eventNum);
-                            outTree->Fill();
-                        }
-                    }
-                } // end single electron check for ee
-
-                if (channel == "mumu")
-                {
-                    const bool muTrig{event.muTrig()};
-
-                    // If single Muon triggered fired, check to see if event
-                    // also fired a DoubleMuon trigger
-                    if (muTrig)
-                    {
-                        singleMuon++;
-                        auto it{triggerDoubleCountCheck.find(
-                            {event.eventRun, event.eventNum})};
-                        // If event has already been found ... skip event
-                        if (it != triggerDoubleCountCheck.end())
-                        {
-                            dupMuon++;
-                        }
-                        // If event has not already been found, add to new skim
-                        else
-                        {
-                            // triggerDoubleCountCheck.emplace(
-                            // event.eventRun, event.eventNum);
-                            outTree->Fill();
-                        }
-                    }
-
-                } // end single muon check for mumu
-
-                if (channel == "emu")
-                {
-                    // check eTrigger for emu first
-                    // clang-format off
-                    const bool eTrig{event.eTrig()};
-                    // then check muTrigger for emu
-                    const bool muTrig{event.muTrig()};
-                    // clang-format on
-
-                    // If either single lepton  triggered fired, check to see if
-                    // event also fired a MuonEG trigger
-                    if (eTrig || muTrig)
-                    {
-                        if (eTrig)
-                        {
-                            singleElectron++;
-                        }
-                        if (muTrig)
-                        {
-                            singleMuon++;
-                        }
-                        auto it{triggerDoubleCountCheck.find(
-                            {event.eventRun, event.eventNum})};
-                        // If event has already been found ... skip event
-                        if (it != triggerDoubleCountCheck.end())
-                        {
-                            if (eTrig)
-                            {
-                                dupElectron++;
-                            }
-                            if (muTrig)
-                            {
-                                dupMuon++;
-                            }
-                        }
-                        // If event has not already been found, add to new skim
-                        else
-                        {
-                            // triggerDoubleCountCheck.emplace(
-                            // event.eventRun, event.eventNum);
-                            outTree->Fill();
-                        }
-                    }
-                } // end single lepton check for emu
+                    dileptonDone.emplace_back(entry.second);
+                }
             }
-            outFile.cd();
-            outTree->Write();
-
-            outFile.Write();
-            outFile.Close();
-
-            fileNum++;
-            std::cout << std::endl;
+            const EventIndex dileptonEvents{readDileptonEvents(
+                dileptonDone,
+                outputDir,
+                preselection ? "triggeredEvents" : "tree")};
+            std::cout << dileptonEvents.size() << " dilepton events indexed in "
+                      << dileptonEvents.memoryUsage() / (1 << 20) << " MB"
+                      << std::endl;
+            runWorkers(singleLeptonTodo,
+                       jobs,
+                       outputDir,
+                       manifestPath,
+                       channel,
+                       is2016,
+                       &dileptonEvents,
+                       preselection.get());
+        }
 
-            delete outTree;
+        if (preselection)
+        {
+            std::vector<ManifestEntry> skims;
+            for (const auto& entry : readManifest(manifestPath, manifestTag))
+            {
+                skims.emplace_back(entry.second);
+            }
+            const std::string mergedPath{
+                (fs::path{outputBaseDir}
+                 / (datasetName + invPostFix + "SmallSkim.root"))
+                    .string()};
+            mergeSkims(skims, outputDir, mergedPath);
+            std::cout << "Merged " << skims.size() << " skims into "
+                      << mergedPath << std::endl;
         }
     }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (isMC)
+    {
+        return 0;
+    }
 
+    // Totals over every single lepton file, including those from earlier runs
+    long long singleElectron{0};
+    long long dupElectron{0};
+    long long singleMuon{0};
+    long long dupMuon{0};
+    for (const auto& entry : readManifest(manifestPath, manifestTag))
+    {
+        singleElectron += entry.second.singleElectron;
+        dupElectron += entry.second.dupElectron;
+        singleMuon += entry.second.singleMuon;
+        dupMuon += entry.second.dupMuon;
+    }
     if (channel == "ee" || channel == "emu")
     {
         std::cout << "Single electron trigger fired with double lepton "
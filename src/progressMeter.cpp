@@ -0,0 +1,44 @@
+#include "progressMeter.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+const std::chrono::milliseconds drawInterval{250};
+} // namespace
+
+ProgressMeter::ProgressMeter(std::string label, const long total)
+    : label_{std::move(label)}
+    , total_{total}
+    , start_{Clock::now()}
+    , nextDraw_{start_}
+{
+}
+
+void ProgressMeter::finish(const long done, const long found)
+{
+    draw(done, found);
+    std::cerr << std::endl;
+}
+
+void ProgressMeter::draw(const long done, const long found)
+{
+    const auto now{Clock::now()};
+    nextDraw_ = now + drawInterval;
+
+    const double seconds{std::chrono::duration<double>(now - start_).count()};
+    const double rate{seconds > 0 ? done / seconds : 0.};
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << '\r' << label_ << ' ' << done
+         << '/' << total_ << " ("
+         << (total_ > 0 ? 100. * done / total_ : 100.) << "%), "
+         << std::setprecision(0) << rate << " events/s";
+    if (rate > 0 && done < total_)
+    {
+        line << ", " << (total_ - done) / rate << " s left";
+    }
+    line << ". Found " << found << " events.   ";
+    std::cerr << line.str() << std::flush;
+}
@@ -0,0 +1,172 @@
+#include "resultCache.hpp"
+
+#include "fnv1a.hpp"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <dlfcn.h>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+const std::string outputTag{"output "};
+
+// Only here so dladdr has something in the library to look up.
+void buildHashAnchor()
+{
+}
+} // namespace
+
+ResultCache::ResultCache(std::string cacheDir)
+    : cacheDir_{cacheDir.back() == '/' ? cacheDir : cacheDir + '/'}
+{
+    fs::create_directories(cacheDir_);
+}
+
+bool ResultCache::isValid(const std::string& name,
+                          const std::string& key) const
+{
+    std::ifstream manifest{manifestPath(name)};
+    if (!manifest || !fs::is_regular_file(storePath(name)))
+    {
+        return false;
+    }
+
+    std::string storedKey;
+    std::string line;
+    while (std::getline(manifest, line))
+    {
+        if (line.compare(0, outputTag.size(), outputTag) == 0)
+        {
+            std::istringstream output{line.substr(outputTag.size())};
+            std::string fingerprint;
+            std::string path;
+            output >> fingerprint >> std::quoted(path);
+            if (!fs::is_regular_file(path)
+                || fileFingerprint(path) != fingerprint)
+            {
+                return false;
+            }
+            continue;
+        }
+        storedKey += line + '\n';
+    }
+    // commit always ends the key with a newline
+    return storedKey == (key.empty() || key.back() == '\n' ? key : key + '\n');
+}
+
+std::unique_ptr<HistogramStore>
+    ResultCache::readHistograms(const std::string& name) const
+{
+    return std::make_unique<HistogramStore>(storePath(name),
+                                            HistogramStore::Mode::Read);
+}
+
+std::unique_ptr<HistogramStore>
+    ResultCache::writeHistograms(const std::string& name) const
+{
+    // Invalidate any old entry until the new one is committed
+    fs::remove(manifestPath(name));
+    return std::make_unique<HistogramStore>(storePath(name),
+                                            HistogramStore::Mode::Write);
+}
+
+void ResultCache::commit(const std::string& name,
+                         const std::string& key,
+                         const std::vector<std::string>& outputs) const
+{
+    const std::string path{manifestPath(name)};
+    const std::string tmpPath{path + "." + std::to_string(getpid()) + ".tmp"};
+    {
+        std::ofstream manifest{tmpPath};
+        manifest << key;
+        if (!key.empty() && key.back() != '\n')
+        {
+            manifest << '\n';
+        }
+        for (const auto& output : outputs)
+        {
+            manifest << outputTag << fileFingerprint(output) << ' '
+                     << std::quoted(output) << '\n';
+        }
+    }
+    fs::rename(tmpPath, path);
+}
+
+std::string ResultCache::fileFingerprint(const std::string& path)
+{
+    std::ostringstream fingerprint;
+    fingerprint << fs::file_size(path) << ':' << fs::last_write_time(path);
+    return fingerprint.str();
+}
+
+std::string
+    ResultCache::fileSetFingerprint(const std::vector<std::string>& locations,
+                                    const std::string& extension)
+{
+    Fnv1a hash;
+    for (const auto& location : locations)
+    {
+        std::vector<std::string> entries;
+        for (const auto& file :
+             boost::make_iterator_range(fs::directory_iterator{location}, {}))
+        {
+            if (fs::is_regular_file(file.status())
+                && (extension.empty()
+                    || file.path().extension() == extension))
+            {
+                entries.emplace_back(file.path().string() + ' '
+                                     + fileFingerprint(file.path().string()));
+            }
+        }
+        // Directory order isn't stable
+        std::sort(entries.begin(), entries.end());
+        for (const auto& entry : entries)
+        {
+            hash.add(entry.data(), entry.size());
+        }
+    }
+    return hash.hex();
+}
+
+std::string ResultCache::contentFingerprint(const std::string& path)
+{
+    std::ifstream file{path, std::ios::binary};
+    std::vector<char> buffer(1 << 20);
+    Fnv1a hash;
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0)
+    {
+        hash.add(buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+    return hash.hex();
+}
+
+std::string ResultCache::buildHash()
+{
+    static const std::string hash{[] {
+        Dl_info info;
+        if (dladdr(reinterpret_cast<void*>(&buildHashAnchor), &info) == 0
+            || !info.dli_fname)
+        {
+            return std::string{"unknown"};
+        }
+        return contentFingerprint(info.dli_fname);
+    }()};
+    return hash;
+}
+
+std::string ResultCache::manifestPath(const std::string& name) const
+{
+    return cacheDir_ + name + ".manifest";
+}
+
+std::string ResultCache::storePath(const std::string& name) const
+{
+    return cacheDir_ + name + ".root";
+}
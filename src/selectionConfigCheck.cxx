@@ -0,0 +1,162 @@
+#include "objectSelection.hpp"
+#include "triggerScaleFactorsAlgo.hpp"
+
+#include <algorithm>
+#include <boost/program_options.hpp>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <yaml-cpp/yaml.h>
+
+// Checks that the lepton, jet ID and MET filter selections that Cuts (and so
+// postTriggerSkimmer.exe) and triggerScaleFactorsMain.exe build from the cuts
+// files in configs/ are the ones they used before ObjectSelection shared them:
+// the trigger study's hard coded thresholds, and for Cuts the values it read
+// straight from each file, the year's jet ID and no eeBadScFilter, with the
+// loose electrons taking the tight electrons' eta. Prints every difference and
+// exits with 1 if there are any.
+
+namespace
+{
+unsigned failures{0};
+
+void check(const std::string& what, const double value, const double expected)
+{
+    if (std::abs(value - expected) > 1e-9 * std::max(1., std::abs(expected)))
+    {
+        std::cerr << "FAIL: " << what << " is " << value << ", was "
+                  << expected << std::endl;
+        failures++;
+    }
+}
+
+void check(const std::string& what,
+           const LeptonThresholds& value,
+           const LeptonThresholds& expected)
+{
+    check(what + " pt", value.pt, expected.pt);
+    check(what + " ptLeading", value.ptLeading, expected.ptLeading);
+    check(what + " eta", value.eta, expected.eta);
+    check(what + " relIso", value.relIso, expected.relIso);
+}
+
+void check(const std::string& what,
+           const ObjectSelection& value,
+           const ObjectSelection::JetId jetId,
+           const bool eeBadScFilter)
+{
+    if (value.jetId != jetId)
+    {
+        std::cerr << "FAIL: " << what << " jet ID differs" << std::endl;
+        failures++;
+    }
+    if (value.eeBadScFilter != eeBadScFilter)
+    {
+        std::cerr << "FAIL: " << what << " eeBadScFilter is "
+                  << value.eeBadScFilter << ", was " << eeBadScFilter
+                  << std::endl;
+        failures++;
+    }
+}
+
+// What Cuts::parse_config read from a cuts block before ObjectSelection
+LeptonThresholds oldThresholds(const YAML::Node& node)
+{
+    return {node["pt"].as<double>(),
+            node["ptLeading"].as<double>(),
+            node["eta"].as<double>(),
+            node["relIso"].as<double>()};
+}
+
+void checkTriggerScaleFactors(const std::string& configDir, const bool is2016)
+{
+    const std::string file{configDir + "/cuts/triggerScaleFactorCuts.yaml"};
+    ObjectSelection selection{TriggerScaleFactors::defaultSelection(is2016)};
+    selection.configure(YAML::LoadFile(file)["cuts"]);
+
+    check(file + " tightElectrons", selection.tightElectron,
+          {15., 38., 2.5, 0.107587});
+    check(file + " tightMuons", selection.tightMuon,
+          {is2016 ? 20. : 29., 26., 2.4, 0.15});
+    check(file, selection, ObjectSelection::JetId::loose, true);
+}
+
+void checkCuts(const std::string& file, const bool is2016)
+{
+    const YAML::Node cuts{YAML::LoadFile(file)["cuts"]};
+    ObjectSelection selection{is2016};
+    selection.configure(cuts);
+
+    LeptonThresholds looseElectron{oldThresholds(cuts["looseElectrons"])};
+    looseElectron.eta = cuts["tightElectrons"]["eta"].as<double>();
+
+    check(file + " tightElectrons", selection.tightElectron,
+          oldThresholds(cuts["tightElectrons"]));
+    check(file + " looseElectrons", selection.looseElectron, looseElectron);
+    check(file + " tightMuons", selection.tightMuon,
+          oldThresholds(cuts["tightMuons"]));
+    check(file + " looseMuons", selection.looseMuon,
+          oldThresholds(cuts["looseMuons"]));
+    check(file,
+          selection,
+          is2016 ? ObjectSelection::JetId::loose
+                 : ObjectSelection::JetId::tightLepVeto,
+          false);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string configs;
+
+    namespace po = boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()("help,h", "Print this message.")(
+        "configs,c",
+        po::value<std::string>(&configs)->default_value("configs"),
+        "Directory holding the 2016 and 2017 configurations.");
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        for (const bool is2016 : {true, false})
+        {
+            const std::string configDir{configs + (is2016 ? "/2016" : "/2017")};
+            checkTriggerScaleFactors(configDir, is2016);
+            for (const std::string cuts : {"SRCuts", "ZplusCuts", "ttbarCuts"})
+            {
+                checkCuts(configDir + "/cuts/" + cuts + ".yaml", is2016);
+            }
+        }
+    }
+    catch (const YAML::Exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " threshold(s) differ" << std::endl;
+        return 1;
+    }
+    std::cout << "All selections match" << std::endl;
+}
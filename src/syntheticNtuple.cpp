@@ -0,0 +1,666 @@
+#include "syntheticNtuple.hpp"
+
+#include "AnalysisEvent.hpp"
+#include "TFile.h"
+#include "TLorentzVector.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+namespace
+{
+// The counter and capacity of each array collection. A few arrays are bound
+// by reference rather than by pointer, which hides their element type from
+// the recorder, so that is given here too.
+struct Collection
+{
+    const char* prefix;
+    const char* counter;
+    size_t capacity;
+    char type;
+};
+
+const std::array<Collection, 10> collections{{
+    {"elePF2PAT", "numElePF2PAT", AnalysisEvent::NELECTRONSMAX, 'F'},
+    {"genElePF2PAT", "numElePF2PAT", AnalysisEvent::NELECTRONSMAX, 'F'},
+    {"muonPF2PAT", "numMuonPF2PAT", AnalysisEvent::NMUONSMAX, 'F'},
+    {"genMuonPF2PAT", "numMuonPF2PAT", AnalysisEvent::NMUONSMAX, 'F'},
+    {"jetPF2PAT", "numJetPF2PAT", AnalysisEvent::NJETSMAX, 'F'},
+    {"genJetPF2PAT", "numJetPF2PAT", AnalysisEvent::NJETSMAX, 'F'},
+    {"tauPF2PAT", "numTauPF2PAT", AnalysisEvent::NTAUSMAX, 'F'},
+    {"generalTracks", "numGeneralTracks", AnalysisEvent::NTRACKSMAX, 'F'},
+    {"TriggerBits", "nTriggerBits", AnalysisEvent::NTRIGGERBITSMAX, 'I'},
+    {"genPar", "nGenPar", AnalysisEvent::NGENPARMAX, 'F'},
+}};
+
+// The leaf list type of a branch, or '\0' if unknown
+char leafType(const EDataType type)
+{
+    if (type == kInt_t)
+    {
+        return 'I';
+    }
+    if (type == kFloat_t)
+    {
+        return 'F';
+    }
+    if (type == kDouble_t)
+    {
+        return 'D';
+    }
+    return '\0';
+}
+
+bool startsWith(const std::string& name, const char* prefix)
+{
+    return name.compare(0, std::strlen(prefix), prefix) == 0;
+}
+
+bool isCounter(const std::string& name)
+{
+    return std::any_of(collections.begin(),
+                       collections.end(),
+                       [&](const Collection& collection) {
+                           return name == collection.counter;
+                       });
+}
+
+// Per-event weights and variations, which are left at one
+bool isUnitWeight(const std::string& name)
+{
+    return startsWith(name, "weight_") || startsWith(name, "isr")
+           || startsWith(name, "fsr") || name == "topPtReweight"
+           || name == "processMCWeight" || name == "origWeightForNorm";
+}
+} // namespace
+
+// Stands in for the tree the AnalysisEvent constructor binds its members to,
+// recording each binding instead
+class SyntheticNtuple::BranchRecorder final : public TTree
+{
+    public:
+    struct Binding
+    {
+        std::string name;
+        void* address;
+        EDataType type;
+    };
+
+    using TTree::SetBranchAddress;
+
+    Int_t SetBranchAddress(const char* name,
+                           void* address,
+                           TBranch** branch) override
+    {
+        return SetBranchAddress(
+            name, address, branch, nullptr, kOther_t, false);
+    }
+    Int_t SetBranchAddress(const char* name,
+                           void* address,
+                           TBranch** branch,
+                           TClass*,
+                           EDataType type,
+                           Bool_t) override
+    {
+        bindings.push_back({name, address, type});
+        if (branch)
+        {
+            *branch = nullptr;
+        }
+        return 0;
+    }
+
+    std::vector<Binding> bindings;
+};
+
+SyntheticNtuple::SyntheticNtuple(const bool isMC,
+                                 const bool is2016,
+                                 const unsigned seed,
+                                 const SyntheticRates& rates)
+    : isMC_{isMC}
+    , is2016_{is2016}
+    , rates_{rates}
+    , rng_{seed}
+    , recorder_{std::make_unique<BranchRecorder>()}
+    , event_{std::make_unique<AnalysisEvent>(isMC, recorder_.get(), is2016)}
+    , branches_{}
+    , triggers_{}
+    , metFilters_{}
+    , eventNumber_{0}
+{
+    std::map<std::string, std::vector<int*>> paths;
+    for (const auto& binding : recorder_->bindings)
+    {
+        // Some members are bound more than once
+        if (std::any_of(branches_.begin(),
+                        branches_.end(),
+                        [&](const Branch& branch) {
+                            return branch.name == binding.name;
+                        }))
+        {
+            continue;
+        }
+
+        Branch branch{
+            binding.name, binding.address, leafType(binding.type), "", 1};
+        for (const auto& collection : collections)
+        {
+            if (startsWith(branch.name, collection.prefix))
+            {
+                branch.counter = collection.counter;
+                branch.capacity = collection.capacity;
+                if (branch.type == '\0')
+                {
+                    branch.type = collection.type;
+                }
+                break;
+            }
+        }
+        if (branch.type == '\0')
+        {
+            throw std::runtime_error("Unknown type of branch " + branch.name);
+        }
+
+        // Anything not generated is zero, and the weights one
+        std::memset(branch.address,
+                    0,
+                    branch.capacity
+                        * (branch.type == 'D' ? sizeof(Double_t)
+                                              : sizeof(Float_t)));
+        if (isUnitWeight(branch.name))
+        {
+            if (branch.type == 'D')
+            {
+                *static_cast<Double_t*>(branch.address) = 1.;
+            }
+            else if (branch.type == 'F')
+            {
+                *static_cast<Float_t*>(branch.address) = 1.f;
+            }
+        }
+
+        if (branch.type == 'I' && startsWith(branch.name, "HLT_"))
+        {
+            // Every version of a path fires together
+            paths[branch.name.substr(0, branch.name.rfind("_v"))].emplace_back(
+                static_cast<int*>(branch.address));
+        }
+        else if (branch.type == 'I' && startsWith(branch.name, "Flag_"))
+        {
+            metFilters_.emplace_back(static_cast<int*>(branch.address));
+        }
+        branches_.emplace_back(branch);
+    }
+    for (auto& path : paths)
+    {
+        triggers_.emplace_back(std::move(path.second));
+    }
+}
+
+SyntheticNtuple::~SyntheticNtuple() = default;
+
+void SyntheticNtuple::next()
+{
+    AnalysisEvent& event{*event_};
+
+    eventNumber_++;
+    event.eventNum = static_cast<Int_t>(eventNumber_);
+    event.eventLumiblock = static_cast<Float_t>(eventNumber_ / 1000 + 1);
+    // Data runs are spread over 2016 B-H or 2017 B-F
+    event.eventRun =
+        isMC_ ? 1
+              : static_cast<Int_t>(is2016_ ? uniform(272007, 284045)
+                                           : uniform(297046, 306463));
+    event.numVert = std::max(poisson(rates_.vertices), 1);
+    event.fixedGridRhoFastjetAll = static_cast<Float_t>(
+        std::max(0.6 * event.numVert + gaus(0., 2.), 0.));
+    event.nGenPar = 0;
+
+    std::vector<Particle> electrons;
+    std::vector<Particle> muons;
+    std::vector<Particle> jets;
+    if (uniform() < rates_.zFraction)
+    {
+        addZ(electrons, muons);
+    }
+    // Half of the other leptons are prompt, from W decays
+    for (const int id : {11, 13})
+    {
+        auto& leptons{id == 11 ? electrons : muons};
+        for (int i{poisson(id == 11 ? rates_.electrons : rates_.muons)}; i > 0;
+             i--)
+        {
+            const Particle lepton{static_cast<float>(10. + exponential(25.)),
+                                  static_cast<float>(gaus(0., 1.2)),
+                                  static_cast<float>(uniform(-M_PI, M_PI)),
+                                  uniform() < 0.5 ? -1 : 1,
+                                  id,
+                                  uniform() < 0.5};
+            if (lepton.prompt)
+            {
+                addGenParticle(lepton, id == 11 ? 0.000511f : 0.10566f, 24);
+            }
+            leptons.emplace_back(lepton);
+        }
+    }
+    for (int i{poisson(rates_.jets)}; i > 0; i--)
+    {
+        const double flavour{uniform()};
+        jets.push_back({static_cast<float>(20. + exponential(40.)),
+                        static_cast<float>(gaus(0., 2.)),
+                        static_cast<float>(uniform(-M_PI, M_PI)),
+                        0,
+                        flavour < rates_.bFraction
+                            ? 5
+                            : flavour < rates_.bFraction + 0.1
+                                  ? 4
+                                  : flavour < 0.6 ? 21 : 1 + poisson(0.5) % 3,
+                        true});
+    }
+
+    // Each collection is in falling pT, and only so much fits
+    const auto fill{[](std::vector<Particle>& particles,
+                       const size_t capacity,
+                       const double maxEta) {
+        particles.erase(std::remove_if(particles.begin(),
+                                       particles.end(),
+                                       [&](const Particle& particle) {
+                                           return std::abs(particle.eta)
+                                                  > maxEta;
+                                       }),
+                        particles.end());
+        std::sort(particles.begin(),
+                  particles.end(),
+                  [](const Particle& a, const Particle& b) {
+                      return a.pt > b.pt;
+                  });
+        particles.resize(std::min(particles.size(), capacity));
+        return static_cast<int>(particles.size());
+    }};
+    event.numElePF2PAT = fill(electrons, AnalysisEvent::NELECTRONSMAX, 2.5);
+    event.numMuonPF2PAT = fill(muons, AnalysisEvent::NMUONSMAX, 2.4);
+    event.numJetPF2PAT = fill(jets, AnalysisEvent::NJETSMAX, 4.7);
+    for (int i{0}; i < event.numElePF2PAT; i++)
+    {
+        fillElectron(i, electrons[static_cast<size_t>(i)]);
+    }
+    for (int i{0}; i < event.numMuonPF2PAT; i++)
+    {
+        fillMuon(i, muons[static_cast<size_t>(i)]);
+    }
+    for (int i{0}; i < event.numJetPF2PAT; i++)
+    {
+        fillJet(i, jets[static_cast<size_t>(i)]);
+    }
+
+    const double met{exponential(40.)};
+    const double metPhi{uniform(-M_PI, M_PI)};
+    event.metPF2PATEt = met;
+    event.metPF2PATPt = met;
+    event.metPF2PATE = met;
+    event.metPF2PATEtRaw = met;
+    event.metPF2PATEtUncorrected = met;
+    event.metPF2PATPhi = metPhi;
+    event.metPF2PATPhiUncorrected = metPhi;
+    event.metPF2PATPx = met * std::cos(metPhi);
+    event.metPF2PATPy = met * std::sin(metPhi);
+    event.metPF2PATUnclusteredEnUp = met * 1.05;
+    event.metPF2PATUnclusteredEnDown = met * 0.95;
+    if (isMC_)
+    {
+        const double genMet{met * std::max(1. + gaus(0., 0.2), 0.)};
+        event.genMetPF2PATEt = genMet;
+        event.genMetPF2PATPt = genMet;
+        event.genMetPF2PATE = genMet;
+        event.genMetPF2PATPhi = metPhi;
+        event.genMetPF2PATPx = genMet * std::cos(metPhi);
+        event.genMetPF2PATPy = genMet * std::sin(metPhi);
+    }
+
+    for (const auto& versions : triggers_)
+    {
+        const int fired{uniform() < rates_.triggerRate};
+        for (int* const version : versions)
+        {
+            *version = fired;
+        }
+    }
+    for (int* const filter : metFilters_)
+    {
+        *filter = uniform() < rates_.metFilterRate;
+    }
+}
+
+void SyntheticNtuple::write(const std::string& path, const long numEvents)
+{
+    const std::unique_ptr<TFile> outFile{TFile::Open(path.c_str(), "RECREATE")};
+    if (!outFile || outFile->IsZombie())
+    {
+        throw std::runtime_error("Could not create " + path);
+    }
+
+    // Owned by outFile. The counters go first, as the array leaves refer to
+    // them by name.
+    TTree* const tree{new TTree{"tree", "tree"}};
+    for (const bool counters : {true, false})
+    {
+        for (const Branch& branch : branches_)
+        {
+            if (isCounter(branch.name) != counters)
+            {
+                continue;
+            }
+            const std::string leaves{
+                branch.name
+                + (branch.counter.empty() ? "" : "[" + branch.counter + "]")
+                + "/" + branch.type};
+            tree->Branch(branch.name.c_str(), branch.address, leaves.c_str());
+        }
+    }
+
+    for (long i{0}; i < numEvents; i++)
+    {
+        next();
+        tree->Fill();
+    }
+    outFile->Write();
+    outFile->Close();
+}
+
+void SyntheticNtuple::addZ(std::vector<Particle>& electrons,
+                           std::vector<Particle>& muons)
+{
+    // Breit-Wigner line shape, decaying isotropically in the Z rest frame
+    std::cauchy_distribution<double> lineShape{91.1876, 2.4952 / 2};
+    double mass;
+    do
+    {
+        mass = lineShape(rng_);
+    } while (mass < 50. || mass > 130.);
+
+    TLorentzVector z;
+    z.SetPtEtaPhiM(exponential(20.), gaus(0., 2.), uniform(-M_PI, M_PI), mass);
+    addGenParticle({static_cast<float>(z.Pt()),
+                    static_cast<float>(z.Eta()),
+                    static_cast<float>(z.Phi()),
+                    0,
+                    23,
+                    true},
+                   static_cast<float>(mass),
+                   0);
+
+    const double cosTheta{uniform(-1., 1.)};
+    const double sinTheta{std::sqrt(1. - cosTheta * cosTheta)};
+    const double phi{uniform(-M_PI, M_PI)};
+    const double p{mass / 2.};
+    TLorentzVector lepton{p * sinTheta * std::cos(phi),
+                          p * sinTheta * std::sin(phi),
+                          p * cosTheta,
+                          p};
+    TLorentzVector antiLepton{-lepton.Px(), -lepton.Py(), -lepton.Pz(), p};
+    lepton.Boost(z.BoostVector());
+    antiLepton.Boost(z.BoostVector());
+
+    const bool isElectron{uniform() < 0.5};
+    for (const auto& decay : {std::make_pair(lepton, -1),
+                              std::make_pair(antiLepton, 1)})
+    {
+        const Particle particle{static_cast<float>(decay.first.Pt()),
+                                static_cast<float>(decay.first.Eta()),
+                                static_cast<float>(decay.first.Phi()),
+                                decay.second,
+                                isElectron ? 11 : 13,
+                                true};
+        addGenParticle(particle, isElectron ? 0.000511f : 0.10566f, 23);
+        (isElectron ? electrons : muons).emplace_back(particle);
+    }
+}
+
+void SyntheticNtuple::addGenParticle(const Particle& particle,
+                                     const float mass,
+                                     const int motherId)
+{
+    AnalysisEvent& event{*event_};
+    if (!isMC_ || event.nGenPar >= static_cast<int>(AnalysisEvent::NGENPARMAX))
+    {
+        return;
+    }
+    TLorentzVector p;
+    p.SetPtEtaPhiM(particle.pt, particle.eta, particle.phi, mass);
+    const int i{event.nGenPar++};
+    event.genParPt[i] = particle.pt;
+    event.genParEta[i] = particle.eta;
+    event.genParPhi[i] = particle.phi;
+    event.genParE[i] = static_cast<Float_t>(p.E());
+    // Negative leptons have positive PDG IDs
+    event.genParId[i] = particle.charge > 0 ? -particle.id : particle.id;
+    event.genParMotherId[i] = motherId;
+    event.genParCharge[i] = particle.charge;
+}
+
+void SyntheticNtuple::fillElectron(const int i, const Particle& electron)
+{
+    AnalysisEvent& event{*event_};
+    TLorentzVector p;
+    p.SetPtEtaPhiM(electron.pt, electron.eta, electron.phi, 0.000511);
+    event.elePF2PATPT[i] = electron.pt;
+    event.elePF2PATEta[i] = electron.eta;
+    event.elePF2PATPhi[i] = electron.phi;
+    event.elePF2PATE[i] = static_cast<Float_t>(p.E());
+    event.elePF2PATET[i] = static_cast<Float_t>(p.Et());
+    event.elePF2PATPX[i] = static_cast<Float_t>(p.Px());
+    event.elePF2PATPY[i] = static_cast<Float_t>(p.Py());
+    event.elePF2PATPZ[i] = static_cast<Float_t>(p.Pz());
+    event.elePF2PATTheta[i] = static_cast<Float_t>(p.Theta());
+    event.elePF2PATCharge[i] = electron.charge;
+    event.elePF2PATIsGsf[i] = 1;
+    event.elePF2PATSCEta[i] = electron.eta;
+    event.elePF2PATSCPhi[i] = electron.phi;
+    event.elePF2PATSCE[i] = static_cast<Float_t>(p.E());
+
+    // The cut-based IDs are nested, and mostly passed by prompt electrons
+    const double id{uniform()};
+    const bool prompt{electron.prompt};
+    event.elePF2PATCutIdVeto[i] = id < (prompt ? 0.99 : 0.6);
+    event.elePF2PATCutIdLoose[i] = id < (prompt ? 0.97 : 0.45);
+    event.elePF2PATCutIdMedium[i] = id < (prompt ? 0.94 : 0.3);
+    event.elePF2PATCutIdTight[i] = id < (prompt ? 0.9 : 0.2);
+
+    const auto d0{static_cast<Float_t>(gaus(0., prompt ? 0.01 : 0.08))};
+    event.elePF2PATD0PV[i] = d0;
+    event.elePF2PATTrackDBD0[i] = d0;
+    event.elePF2PATBeamSpotCorrectedTrackD0[i] = d0;
+    event.elePF2PATDZPV[i] =
+        static_cast<Float_t>(gaus(0., prompt ? 0.02 : 0.15));
+    event.elePF2PATComRelIsoRho[i] =
+        static_cast<Float_t>(exponential(prompt ? 0.02 : 0.3));
+    event.elePF2PATRhoIso[i] = event.fixedGridRhoFastjetAll;
+
+    if (!isMC_)
+    {
+        return;
+    }
+    TLorentzVector gen;
+    gen.SetPtEtaPhiM(electron.pt * (1. + gaus(0., 0.02)),
+                     electron.eta,
+                     electron.phi,
+                     0.000511);
+    event.genElePF2PATPT[i] = static_cast<Float_t>(gen.Pt());
+    event.genElePF2PATET[i] = static_cast<Float_t>(gen.Et());
+    event.genElePF2PATPX[i] = static_cast<Float_t>(gen.Px());
+    event.genElePF2PATPY[i] = static_cast<Float_t>(gen.Py());
+    event.genElePF2PATPZ[i] = static_cast<Float_t>(gen.Pz());
+    event.genElePF2PATPhi[i] = electron.phi;
+    event.genElePF2PATTheta[i] = static_cast<Float_t>(gen.Theta());
+    event.genElePF2PATEta[i] = electron.eta;
+    event.genElePF2PATCharge[i] = electron.charge;
+    event.genElePF2PATPdgId[i] = -11 * electron.charge;
+    event.genElePF2PATMotherId[i] = prompt ? 23 : 511;
+    event.genElePF2PATPromptFinalState[i] = prompt;
+    event.genElePF2PATHardProcess[i] = prompt;
+}
+
+void SyntheticNtuple::fillMuon(const int i, const Particle& muon)
+{
+    AnalysisEvent& event{*event_};
+    TLorentzVector p;
+    p.SetPtEtaPhiM(muon.pt, muon.eta, muon.phi, 0.10566);
+    event.muonPF2PATPt[i] = muon.pt;
+    event.muonPF2PATEta[i] = muon.eta;
+    event.muonPF2PATPhi[i] = muon.phi;
+    event.muonPF2PATE[i] = static_cast<Float_t>(p.E());
+    event.muonPF2PATET[i] = static_cast<Float_t>(p.Et());
+    event.muonPF2PATPX[i] = static_cast<Float_t>(p.Px());
+    event.muonPF2PATPY[i] = static_cast<Float_t>(p.Py());
+    event.muonPF2PATPZ[i] = static_cast<Float_t>(p.Pz());
+    event.muonPF2PATTheta[i] = static_cast<Float_t>(p.Theta());
+    event.muonPF2PATCharge[i] = muon.charge;
+
+    const double id{uniform()};
+    const bool prompt{muon.prompt};
+    event.muonPF2PATIsPFMuon[i] = id < (prompt ? 0.995 : 0.8);
+    event.muonPF2PATGlobalID[i] = id < (prompt ? 0.99 : 0.7);
+    event.muonPF2PATTrackID[i] = id < (prompt ? 0.995 : 0.8);
+    event.muonPF2PATLooseCutId[i] = id < (prompt ? 0.99 : 0.6);
+    event.muonPF2PATMediumCutId[i] = id < (prompt ? 0.97 : 0.4);
+    event.muonPF2PATTightCutId[i] = id < (prompt ? 0.95 : 0.3);
+    event.muonPF2PATGlbTkNormChi2[i] = static_cast<Float_t>(exponential(1.5));
+    event.muonPF2PATMatchedStations[i] = 1 + poisson(prompt ? 2.5 : 1.);
+    event.muonPF2PATMuonNHits[i] = poisson(prompt ? 25. : 10.);
+    event.muonPF2PATVldPixHits[i] = poisson(prompt ? 3. : 1.5);
+    event.muonPF2PATTkLysWithMeasurements[i] = 4 + poisson(prompt ? 8. : 4.);
+
+    const auto d0{static_cast<Float_t>(gaus(0., prompt ? 0.005 : 0.05))};
+    event.muonPF2PATDBPV[i] = d0;
+    event.muonPF2PATD0[i] = d0;
+    event.muonPF2PATTrackDBD0[i] = d0;
+    event.muonPF2PATDBInnerTrackD0[i] = d0;
+    event.muonPF2PATBeamSpotCorrectedD0[i] = d0;
+    event.muonPF2PATDZPV[i] =
+        static_cast<Float_t>(gaus(0., prompt ? 0.02 : 0.2));
+
+    const auto iso{static_cast<Float_t>(exponential(prompt ? 0.03 : 0.3))};
+    event.muonPF2PATComRelIso[i] = iso;
+    event.muonPF2PATComRelIsodBeta[i] = iso;
+    event.muonPF2PATPfIsoVeryLoose[i] = iso < 0.40f;
+    event.muonPF2PATPfIsoLoose[i] = iso < 0.25f;
+    event.muonPF2PATPfIsoMedium[i] = iso < 0.20f;
+    event.muonPF2PATPfIsoTight[i] = iso < 0.15f;
+    event.muonPF2PATPfIsoVeryTight[i] = iso < 0.10f;
+
+    if (!isMC_)
+    {
+        return;
+    }
+    TLorentzVector gen;
+    gen.SetPtEtaPhiM(
+        muon.pt * (1. + gaus(0., 0.01)), muon.eta, muon.phi, 0.10566);
+    event.genMuonPF2PATPT[i] = static_cast<Float_t>(gen.Pt());
+    event.genMuonPF2PATET[i] = static_cast<Float_t>(gen.Et());
+    event.genMuonPF2PATPX[i] = static_cast<Float_t>(gen.Px());
+    event.genMuonPF2PATPY[i] = static_cast<Float_t>(gen.Py());
+    event.genMuonPF2PATPZ[i] = static_cast<Float_t>(gen.Pz());
+    event.genMuonPF2PATPhi[i] = muon.phi;
+    event.genMuonPF2PATTheta[i] = static_cast<Float_t>(gen.Theta());
+    event.genMuonPF2PATEta[i] = muon.eta;
+    event.genMuonPF2PATCharge[i] = muon.charge;
+    event.genMuonPF2PATPdgId[i] = -13 * muon.charge;
+    event.genMuonPF2PATMotherId[i] = prompt ? 23 : 511;
+    event.genMuonPF2PATPromptFinalState[i] = prompt;
+    event.genMuonPF2PATHardProcess[i] = prompt;
+}
+
+void SyntheticNtuple::fillJet(const int i, const Particle& jet)
+{
+    AnalysisEvent& event{*event_};
+    TLorentzVector p;
+    p.SetPtEtaPhiM(jet.pt, jet.eta, jet.phi, 0.1 * jet.pt);
+    const auto correction{static_cast<Float_t>(1.05 + gaus(0., 0.03))};
+    event.jetPF2PATPt[i] = jet.pt;
+    event.jetPF2PATPtRaw[i] = jet.pt / correction;
+    event.jetPF2PATUnCorPt[i] = jet.pt / correction;
+    event.jetPF2PATEt[i] = static_cast<Float_t>(p.Et());
+    event.jetPF2PATUnCorEt[i] = static_cast<Float_t>(p.Et()) / correction;
+    event.jetPF2PATCorrFactor[i] = correction;
+    event.jetPF2PATE[i] = static_cast<Float_t>(p.E());
+    event.jetPF2PATEta[i] = jet.eta;
+    event.jetPF2PATTheta[i] = static_cast<Float_t>(p.Theta());
+    event.jetPF2PATPhi[i] = jet.phi;
+    event.jetPF2PATPx[i] = static_cast<Float_t>(p.Px());
+    event.jetPF2PATPy[i] = static_cast<Float_t>(p.Py());
+    event.jetPF2PATPz[i] = static_cast<Float_t>(p.Pz());
+    event.jetPF2PATdRClosestLepton[i] = static_cast<Float_t>(uniform(0.3, 3.));
+    event.jetPF2PATPID[i] = jet.id;
+
+    const double bTag{jet.id == 5 ? 1. - exponential(0.08)
+                                  : jet.id == 4 ? uniform(0., 0.9)
+                                                : exponential(0.08)};
+    event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags[i] =
+        static_cast<Float_t>(std::min(std::max(bTag, 0.), 1.));
+
+    event.jetPF2PATChargedHadronEnergyFraction[i] =
+        static_cast<Float_t>(uniform(0.3, 0.7));
+    event.jetPF2PATNeutralHadronEnergyFraction[i] =
+        static_cast<Float_t>(uniform(0.02, 0.2));
+    event.jetPF2PATChargedEmEnergyFraction[i] =
+        static_cast<Float_t>(uniform(0., 0.2));
+    event.jetPF2PATNeutralEmEnergyFraction[i] =
+        static_cast<Float_t>(uniform(0.02, 0.3));
+    event.jetPF2PATMuonFraction[i] = static_cast<Float_t>(uniform(0., 0.05));
+    event.jetPF2PATChargedHadronEnergyFractionCorr[i] =
+        event.jetPF2PATChargedHadronEnergyFraction[i];
+    event.jetPF2PATNeutralHadronEnergyFractionCorr[i] =
+        event.jetPF2PATNeutralHadronEnergyFraction[i];
+    event.jetPF2PATChargedEmEnergyFractionCorr[i] =
+        event.jetPF2PATChargedEmEnergyFraction[i];
+    event.jetPF2PATNeutralEmEnergyFractionCorr[i] =
+        event.jetPF2PATNeutralEmEnergyFraction[i];
+    event.jetPF2PATMuonFractionCorr[i] = event.jetPF2PATMuonFraction[i];
+    event.jetPF2PATChargedMultiplicity[i] =
+        std::abs(jet.eta) < 2.5 ? 1 + poisson(10.) : 0;
+    event.jetPF2PATNeutralMultiplicity[i] = 3 + poisson(10.);
+    event.jetPF2PATNConstituents[i] = event.jetPF2PATChargedMultiplicity[i]
+                                      + event.jetPF2PATNeutralMultiplicity[i];
+
+    if (!isMC_)
+    {
+        return;
+    }
+    TLorentzVector gen;
+    gen.SetPtEtaPhiM(
+        jet.pt * (1. + gaus(0., 0.1)), jet.eta, jet.phi, 0.1 * jet.pt);
+    event.genJetPF2PATPT[i] = static_cast<Float_t>(gen.Pt());
+    event.genJetPF2PATET[i] = static_cast<Float_t>(gen.Et());
+    event.genJetPF2PATPX[i] = static_cast<Float_t>(gen.Px());
+    event.genJetPF2PATPY[i] = static_cast<Float_t>(gen.Py());
+    event.genJetPF2PATPZ[i] = static_cast<Float_t>(gen.Pz());
+    event.genJetPF2PATPhi[i] = jet.phi;
+    event.genJetPF2PATTheta[i] = static_cast<Float_t>(gen.Theta());
+    event.genJetPF2PATEta[i] = jet.eta;
+    event.genJetPF2PATPID[i] = jet.id;
+}
+
+double SyntheticNtuple::uniform(const double min, const double max)
+{
+    return std::uniform_real_distribution<double>{min, max}(rng_);
+}
+
+double SyntheticNtuple::gaus(const double mean, const double sigma)
+{
+    return std::normal_distribution<double>{mean, sigma}(rng_);
+}
+
+double SyntheticNtuple::exponential(const double mean)
+{
+    return std::exponential_distribution<double>{1. / mean}(rng_);
+}
+
+int SyntheticNtuple::poisson(const double mean)
+{
+    return std::poisson_distribution<int>{mean}(rng_);
+}
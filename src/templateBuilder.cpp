@@ -0,0 +1,74 @@
+#include "templateBuilder.hpp"
+
+#include "TFile.h"
+#include "TH1D.h"
+
+#include <stdexcept>
+
+TemplateBuilder::TemplateBuilder(std::vector<TemplateObservable> observables,
+                                 std::vector<const float*> values)
+    : observables_{std::move(observables)}
+    , values_{std::move(values)}
+{
+    if (observables_.size() != values_.size())
+    {
+        throw std::runtime_error(
+            "TemplateBuilder needs one value per observable");
+    }
+}
+
+TemplateBuilder::~TemplateBuilder()
+{
+}
+
+std::vector<std::unique_ptr<TH1D>>&
+    TemplateBuilder::book(const std::string& category)
+{
+    auto& templates{templates_[category]};
+    if (templates.empty())
+    {
+        for (const auto& observable : observables_)
+        {
+            const std::string name{observable.name + '_' + category};
+            templates.emplace_back(std::make_unique<TH1D>(name.c_str(),
+                                                          name.c_str(),
+                                                          observable.nBins,
+                                                          observable.xMin,
+                                                          observable.xMax));
+            templates.back()->SetDirectory(nullptr);
+            templates.back()->Sumw2();
+        }
+    }
+    return templates;
+}
+
+void TemplateBuilder::fill(const std::string& category, const double weight)
+{
+    auto& templates{book(category)};
+    for (size_t i{0}; i < templates.size(); i++)
+    {
+        templates[i]->Fill(*values_[i], weight);
+    }
+}
+
+void TemplateBuilder::write(const std::string& path)
+{
+    if (templates_.empty())
+    {
+        return;
+    }
+    TFile outFile{path.c_str(), "RECREATE"};
+    if (outFile.IsZombie())
+    {
+        throw std::runtime_error("Could not create " + path);
+    }
+    for (const auto& templates : templates_)
+    {
+        for (const auto& hist : templates.second)
+        {
+            outFile.WriteTObject(hist.get());
+        }
+    }
+    outFile.Close();
+    templates_.clear();
+}
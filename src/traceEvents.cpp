@@ -0,0 +1,265 @@
+#include "traceEvents.hpp"
+
+#ifdef TQZ_TRACE
+
+#include <algorithm>
+#include <boost/format.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Trace timestamps count from the library being loaded
+const int64_t origin{now()};
+
+struct Totals
+{
+    long calls{0};
+    int64_t inclusive{0};
+    int64_t self{0};
+};
+
+struct Event
+{
+    const char* name;
+    int64_t start;
+    int64_t duration;
+};
+
+// Everything one thread has recorded. Only that thread touches it until the
+// registry writes it out at exit.
+struct ThreadRecord
+{
+    ThreadRecord(const unsigned id, const size_t maxEvents)
+        : tid{id}
+        , limit{maxEvents}
+    {
+    }
+
+    const unsigned tid;
+    const size_t limit;
+    std::vector<Event> events;
+    long dropped{0};
+    // The time spent in the children of each open scope, which isn't its own
+    std::vector<int64_t> childTime;
+    // Keyed by the name's address, so it costs no string compares. Scopes
+    // with the same name in different files are added together at exit.
+    std::unordered_map<const char*, Totals> totals;
+};
+
+// Owns the records of every thread, so those of threads that have finished
+// are still there at exit, when they are written out
+class Registry
+{
+    public:
+    Registry();
+    ~Registry();
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    ThreadRecord& add();
+
+    private:
+    void writeTrace(const std::string& path) const;
+    void printProfile(const std::string& path) const;
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadRecord>> threads_;
+    const pid_t pid_;
+    size_t limit_;
+};
+
+Registry::Registry()
+    : mutex_{}
+    , threads_{}
+    , pid_{getpid()}
+    , limit_{1000000}
+{
+    if (const char* const limit{std::getenv("TQZ_TRACE_LIMIT")})
+    {
+        limit_ = std::strtoul(limit, nullptr, 10);
+    }
+}
+
+Registry::~Registry()
+{
+    // A forked child that returns from main rather than calling _exit would
+    // otherwise write its copy of the parent's records over the parent's file
+    if (getpid() != pid_)
+    {
+        return;
+    }
+
+    const char* const file{std::getenv("TQZ_TRACE_FILE")};
+    const std::string path{file ? file
+                                : "trace_" + std::to_string(pid_) + ".json"};
+    try
+    {
+        writeTrace(path);
+        printProfile(path);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+    }
+}
+
+ThreadRecord& Registry::add()
+{
+    const std::lock_guard<std::mutex> lock{mutex_};
+    threads_.emplace_back(std::make_unique<ThreadRecord>(
+        static_cast<unsigned>(threads_.size() + 1), limit_));
+    threads_.back()->events.reserve(std::min<size_t>(limit_, 65536));
+    return *threads_.back();
+}
+
+void Registry::writeTrace(const std::string& path) const
+{
+    std::ofstream out{path};
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first{true};
+    for (const auto& thread : threads_)
+    {
+        out << (first ? "\n" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid_
+            << ",\"tid\":" << thread->tid
+            << ",\"args\":{\"name\":\"thread " << thread->tid << "\"}}";
+        first = false;
+        // Chrome traces are in microseconds
+        for (const Event& event : thread->events)
+        {
+            out << ",\n{\"name\":\"" << event.name
+                << "\",\"ph\":\"X\",\"ts\":" << (event.start - origin) * 1e-3
+                << ",\"dur\":" << event.duration * 1e-3 << ",\"pid\":" << pid_
+                << ",\"tid\":" << thread->tid << "}";
+        }
+    }
+    out << "\n]}\n";
+    if (!out)
+    {
+        throw std::runtime_error("Could not write trace to " + path);
+    }
+}
+
+void Registry::printProfile(const std::string& path) const
+{
+    std::map<std::string, Totals> profile;
+    int64_t traced{0};
+    size_t events{0};
+    long dropped{0};
+    for (const auto& thread : threads_)
+    {
+        for (const auto& [name, totals] : thread->totals)
+        {
+            Totals& summed{profile[name]};
+            summed.calls += totals.calls;
+            summed.inclusive += totals.inclusive;
+            summed.self += totals.self;
+            traced += totals.self;
+        }
+        events += thread->events.size();
+        dropped += thread->dropped;
+    }
+
+    std::vector<std::pair<std::string, Totals>> sorted{profile.begin(),
+                                                       profile.end()};
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second.self > b.second.self;
+    });
+
+    std::cerr << "Flat profile of " << threads_.size() << " thread(s), "
+              << events << " scopes written to " << path;
+    if (dropped > 0)
+    {
+        std::cerr << " (" << dropped << " more over TQZ_TRACE_LIMIT)";
+    }
+    std::cerr << "\n"
+              << boost::format("%-20s %12s %12s %12s %7s %12s") % "scope"
+                     % "calls" % "total/ms" % "self/ms" % "self/%" % "self/call"
+              << std::endl;
+    for (const auto& [name, totals] : sorted)
+    {
+        std::cerr << boost::format("%-20s %12d %12.1f %12.1f %7.1f %10.0fns")
+                         % name % totals.calls % (totals.inclusive * 1e-6)
+                         % (totals.self * 1e-6)
+                         % (traced > 0 ? 100. * totals.self / traced : 0.)
+                         % (static_cast<double>(totals.self) / totals.calls)
+                  << std::endl;
+    }
+}
+
+Registry& registry()
+{
+    static Registry registry;
+    return registry;
+}
+
+ThreadRecord& threadRecord()
+{
+    thread_local ThreadRecord* record{nullptr};
+    if (!record)
+    {
+        record = &registry().add();
+    }
+    return *record;
+}
+} // namespace
+
+namespace trace
+{
+Scope::Scope(const char* name)
+    : name_{name}
+    , start_{now()}
+{
+    threadRecord().childTime.emplace_back(0);
+}
+
+Scope::~Scope()
+{
+    const int64_t duration{now() - start_};
+    ThreadRecord& record{threadRecord()};
+
+    const int64_t children{record.childTime.back()};
+    record.childTime.pop_back();
+    if (!record.childTime.empty())
+    {
+        record.childTime.back() += duration;
+    }
+
+    Totals& totals{record.totals[name_]};
+    totals.calls++;
+    totals.inclusive += duration;
+    totals.self += duration - children;
+
+    if (record.events.size() < record.limit)
+    {
+        record.events.push_back({name_, start_, duration});
+    }
+    else
+    {
+        record.dropped++;
+    }
+}
+} // namespace trace
+
+#endif
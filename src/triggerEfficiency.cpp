@@ -0,0 +1,379 @@
+#include "triggerEfficiency.hpp"
+
+#include "TArrayD.h"
+#include "TEfficiency.h"
+#include "TH1D.h"
+#include "TH2D.h"
+#include "TLorentzVector.h"
+#include "TProfile.h"
+#include "TProfile2D.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+const std::vector<double> ptBins{15, 20, 25, 30, 40, 120, 200};
+const std::vector<double> etaBins{-2.4, -1.2, 0.0, 1.2, 2.4};
+
+const std::array<std::string, TriggerEfficiencies::numChannels> labels{
+    "electron", "#mu", "lep e#mu"};
+
+const std::array<std::string, EfficiencyVariables::numVariables>
+    variableNames{"lepton1Pt",
+                  "lepton1Eta",
+                  "lepton2Pt",
+                  "lepton2Eta",
+                  "nVtx",
+                  "nJets",
+                  "run"};
+
+// ROOT's bin number, 0 for underflow and edges.size() for overflow. The same
+// as TAxis::FindBin: bin i holds [edges[i - 1], edges[i]).
+int findBin(const std::vector<double>& edges, const double value)
+{
+    return static_cast<int>(std::upper_bound(edges.begin(), edges.end(), value)
+                            - edges.begin());
+}
+
+// Copies per-bin sums into a freshly booked profile
+template <typename Profile, typename Bins>
+void setContents(Profile& profile, const Bins& bins)
+{
+    profile.SetDirectory(nullptr);
+    TArrayD& sumw2{*profile.GetSumw2()};
+    TArrayD& binSumw2{*profile.GetBinSumw2()};
+    double entries{0};
+    for (size_t bin{0}; bin < bins.size(); bin++)
+    {
+        const int rootBin{static_cast<int>(bin)};
+        profile.SetBinEntries(rootBin, bins[bin].entries);
+        profile.SetBinContent(rootBin, bins[bin].sum);
+        if (sumw2.GetSize() > 0)
+        {
+            sumw2[rootBin] = bins[bin].sum2;
+        }
+        // Every fill has unit weight, so the sum of squared weights is the
+        // number of entries too
+        if (binSumw2.GetSize() > 0)
+        {
+            binSumw2[rootBin] = bins[bin].entries;
+        }
+        entries += bins[bin].entries;
+    }
+    profile.SetEntries(entries);
+    profile.ResetStats();
+}
+} // namespace
+
+EfficiencyProfile::EfficiencyProfile(std::string name,
+                                     std::string title,
+                                     std::vector<double> xEdges,
+                                     std::vector<double> yEdges)
+    : name_{std::move(name)}
+    , title_{std::move(title)}
+    , xEdges_{std::move(xEdges)}
+    , yEdges_{std::move(yEdges)}
+    , bins_((xEdges_.size() + 1) * (yEdges_.empty() ? 1 : yEdges_.size() + 1))
+{
+}
+
+void EfficiencyProfile::fillBin(const int bin, const double passed)
+{
+    Bin& contents{bins_[static_cast<size_t>(bin)]};
+    contents.entries += 1;
+    contents.sum += passed;
+    contents.sum2 += passed * passed;
+}
+
+void EfficiencyProfile::fill(const double x, const double passed)
+{
+    fillBin(findBin(xEdges_, x), passed);
+}
+
+void EfficiencyProfile::fill(const double x,
+                             const double y,
+                             const double passed)
+{
+    const int nX{static_cast<int>(xEdges_.size()) + 1};
+    fillBin(findBin(xEdges_, x) + nX * findBin(yEdges_, y), passed);
+}
+
+void EfficiencyProfile::merge(const EfficiencyProfile& other)
+{
+    if (other.bins_.size() != bins_.size())
+    {
+        throw std::logic_error("Merging " + name_ + " with " + other.name_
+                               + ", which is binned differently");
+    }
+    for (size_t bin{0}; bin < bins_.size(); bin++)
+    {
+        bins_[bin].entries += other.bins_[bin].entries;
+        bins_[bin].sum += other.bins_[bin].sum;
+        bins_[bin].sum2 += other.bins_[bin].sum2;
+    }
+}
+
+std::unique_ptr<TProfile> EfficiencyProfile::profile(const double level) const
+{
+    auto profile{std::make_unique<TProfile>(name_.c_str(),
+                                            title_.c_str(),
+                                            static_cast<int>(xEdges_.size())
+                                                - 1,
+                                            xEdges_.data())};
+    setContents(*profile, bins_);
+
+    if (level > 0)
+    {
+        for (int bin{1}; bin < static_cast<int>(xEdges_.size()); bin++)
+        {
+            const Bin& contents{bins_[static_cast<size_t>(bin)]};
+            const double mean{profile->GetBinContent(bin)};
+            const double errUp{
+                mean
+                - TEfficiency::ClopperPearson(
+                    contents.entries, contents.sum, level, true)};
+            const double errDown{
+                mean
+                - TEfficiency::ClopperPearson(
+                    contents.entries, contents.sum, level, false)};
+            profile->SetBinError(bin, std::max(errUp, errDown));
+        }
+    }
+    return profile;
+}
+
+std::unique_ptr<TProfile2D> EfficiencyProfile::profile2D() const
+{
+    auto profile{std::make_unique<TProfile2D>(
+        name_.c_str(),
+        title_.c_str(),
+        static_cast<int>(xEdges_.size()) - 1,
+        xEdges_.data(),
+        static_cast<int>(yEdges_.size()) - 1,
+        yEdges_.data())};
+    setContents(*profile, bins_);
+    return profile;
+}
+
+EfficiencyVariables::Variable
+    EfficiencyVariables::find(const std::string& name)
+{
+    const auto it{
+        std::find(variableNames.begin(), variableNames.end(), name)};
+    if (it == variableNames.end())
+    {
+        throw std::runtime_error("Unknown efficiency binning variable "
+                                 + name);
+    }
+    return static_cast<Variable>(it - variableNames.begin());
+}
+
+BinnedEfficiency::BinnedEfficiency(std::string name,
+                                   const EfficiencyBinning& binning)
+    : name_{std::move(name)}
+    , title_{";" + binning.xVariable + ";" + binning.yVariable}
+    , xVariable_{EfficiencyVariables::find(binning.xVariable)}
+    , xEdges_{binning.xEdges}
+    , yVariable_{binning.yVariable.empty()
+                     ? EfficiencyVariables::numVariables
+                     : EfficiencyVariables::find(binning.yVariable)}
+    , yEdges_{binning.yVariable.empty() ? std::vector<double>{}
+                                        : binning.yEdges}
+    , bins_((xEdges_.size() + 1) * (yEdges_.empty() ? 1 : yEdges_.size() + 1))
+{
+    if (xEdges_.size() < 2
+        || (yVariable_ != EfficiencyVariables::numVariables
+            && yEdges_.size() < 2))
+    {
+        throw std::runtime_error("Efficiency binning " + binning.name
+                                 + " needs at least two edges per axis");
+    }
+}
+
+void BinnedEfficiency::fill(const EfficiencyVariables& variables,
+                            const double weight,
+                            const double passed)
+{
+    int bin{findBin(xEdges_, variables.values[xVariable_])};
+    if (yVariable_ != EfficiencyVariables::numVariables)
+    {
+        bin += static_cast<int>(xEdges_.size() + 1)
+               * findBin(yEdges_, variables.values[yVariable_]);
+    }
+    const double passedWeight{weight * std::min(passed, 1.)};
+    Bin& contents{bins_[static_cast<size_t>(bin)]};
+    contents.total += weight;
+    contents.total2 += weight * weight;
+    contents.passed += passedWeight;
+    contents.passed2 += passedWeight * passedWeight;
+}
+
+void BinnedEfficiency::merge(const BinnedEfficiency& other)
+{
+    if (other.bins_.size() != bins_.size())
+    {
+        throw std::logic_error("Merging " + name_ + " with " + other.name_
+                               + ", which is binned differently");
+    }
+    for (size_t bin{0}; bin < bins_.size(); bin++)
+    {
+        bins_[bin].total += other.bins_[bin].total;
+        bins_[bin].total2 += other.bins_[bin].total2;
+        bins_[bin].passed += other.bins_[bin].passed;
+        bins_[bin].passed2 += other.bins_[bin].passed2;
+    }
+}
+
+std::unique_ptr<TEfficiency>
+    BinnedEfficiency::efficiency(const double level) const
+{
+    const int nX{static_cast<int>(xEdges_.size()) - 1};
+    std::unique_ptr<TH1> total;
+    if (yEdges_.empty())
+    {
+        total = std::make_unique<TH1D>(
+            (name_ + "_total").c_str(), title_.c_str(), nX, xEdges_.data());
+    }
+    else
+    {
+        total = std::make_unique<TH2D>((name_ + "_total").c_str(),
+                                       title_.c_str(),
+                                       nX,
+                                       xEdges_.data(),
+                                       static_cast<int>(yEdges_.size()) - 1,
+                                       yEdges_.data());
+    }
+    total->SetDirectory(nullptr);
+    total->Sumw2();
+    std::unique_ptr<TH1> passed{
+        dynamic_cast<TH1*>(total->Clone((name_ + "_passed").c_str()))};
+    passed->SetDirectory(nullptr);
+
+    double entries{0};
+    for (size_t bin{0}; bin < bins_.size(); bin++)
+    {
+        const int rootBin{static_cast<int>(bin)};
+        total->SetBinContent(rootBin, bins_[bin].total);
+        total->SetBinError(rootBin, std::sqrt(bins_[bin].total2));
+        passed->SetBinContent(rootBin, bins_[bin].passed);
+        passed->SetBinError(rootBin, std::sqrt(bins_[bin].passed2));
+        entries += bins_[bin].total;
+    }
+    total->SetEntries(entries);
+    passed->SetEntries(entries);
+
+    auto efficiency{std::make_unique<TEfficiency>(*passed, *total)};
+    efficiency->SetDirectory(nullptr);
+    efficiency->SetName(name_.c_str());
+    efficiency->SetConfidenceLevel(level);
+    return efficiency;
+}
+
+TriggerCounts& TriggerCounts::operator+=(const TriggerCounts& other)
+{
+    passed += other.passed;
+    triggered += other.triggered;
+    selected += other.selected;
+    selectedTriggered += other.selectedTriggered;
+    return *this;
+}
+
+ChannelEfficiency::ChannelEfficiency(
+    const std::string& name,
+    const std::string& label,
+    const std::string& sample,
+    const std::vector<EfficiencyBinning>& binnings)
+    : lepton1Pt{name + "1_pT_" + sample,
+                "p_{T} turn-on curve for leading " + label,
+                ptBins}
+    , lepton1Eta{name + "1_eta_" + sample,
+                 "#eta turn-on curve for leading " + label,
+                 etaBins}
+    , lepton2Pt{name + "2_pT_" + sample,
+                "p_{T} turn-on curve for subleading " + label,
+                ptBins}
+    , lepton2Eta{name + "2_eta_" + sample,
+                 "#eta turn-on curve for subleading " + label,
+                 etaBins}
+    , leptonsPt{"p_" + name + "s_pT_" + sample, "", ptBins, ptBins}
+    , leptonsEta{"p_" + name + "s_eta_" + sample, "", etaBins, etaBins}
+{
+    binned.reserve(binnings.size());
+    for (const auto& binning : binnings)
+    {
+        binned.emplace_back("eff_" + name + "_" + binning.name + "_" + sample,
+                            binning);
+    }
+}
+
+void ChannelEfficiency::fill(const TLorentzVector& lepton1,
+                             const TLorentzVector& lepton2,
+                             const double passed,
+                             const double etaMinPt,
+                             const EfficiencyVariables& variables,
+                             const double weight)
+{
+    lepton1Pt.fill(lepton1.Pt(), passed);
+    if (lepton1.Pt() > etaMinPt)
+    {
+        lepton1Eta.fill(lepton1.Eta(), passed);
+    }
+    lepton2Pt.fill(lepton2.Pt(), passed);
+    if (lepton2.Pt() > etaMinPt)
+    {
+        lepton2Eta.fill(lepton2.Eta(), passed);
+    }
+    leptonsPt.fill(lepton1.Pt(), lepton2.Pt(), passed);
+    leptonsEta.fill(lepton1.Eta(), lepton2.Eta(), passed);
+    for (auto& efficiency : binned)
+    {
+        efficiency.fill(variables, weight, passed);
+    }
+}
+
+void ChannelEfficiency::merge(const ChannelEfficiency& other)
+{
+    counts += other.counts;
+    lepton1Pt.merge(other.lepton1Pt);
+    lepton1Eta.merge(other.lepton1Eta);
+    lepton2Pt.merge(other.lepton2Pt);
+    lepton2Eta.merge(other.lepton2Eta);
+    leptonsPt.merge(other.leptonsPt);
+    leptonsEta.merge(other.leptonsEta);
+    if (other.binned.size() != binned.size())
+    {
+        throw std::logic_error("Merging efficiencies with different binnings");
+    }
+    for (size_t i{0}; i < binned.size(); i++)
+    {
+        binned[i].merge(other.binned[i]);
+    }
+}
+
+const std::array<std::string, TriggerEfficiencies::numChannels>
+    TriggerEfficiencies::names{"electron", "muon", "muonElectron"};
+
+TriggerEfficiencies::TriggerEfficiencies(
+    const std::vector<EfficiencyBinning>& binnings)
+{
+    for (int channel{0}; channel < numChannels; channel++)
+    {
+        channels_[0].emplace_back(
+            names[channel], labels[channel], "MC", binnings);
+        channels_[1].emplace_back(
+            names[channel], labels[channel], "data", binnings);
+    }
+}
+
+void TriggerEfficiencies::merge(const TriggerEfficiencies& other)
+{
+    for (size_t sample{0}; sample < channels_.size(); sample++)
+    {
+        for (int channel{0}; channel < numChannels; channel++)
+        {
+            channels_[sample][channel].merge(other.channels_[sample][channel]);
+        }
+    }
+}
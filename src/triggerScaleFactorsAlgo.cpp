@@ -3,227 +3,46 @@
 #include "TEfficiency.h"
 #include "TFile.h"
 #include "TH1.h"
-#include "TMVA/Config.h"
-#include "TMVA/Timer.h"
 #include "TProfile.h"
 #include "TProfile2D.h"
-#include "TRandom.h"
+#include "TROOT.h"
 #include "TTree.h"
 #include "config_parser.hpp"
 #include "triggerScaleFactorsAlgo.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <boost/functional/hash.hpp>
 #include <boost/program_options.hpp>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <random>
 #include <sstream>
 #include <string>
 #include <sys/stat.h>
-
-// Double_t ptBins[] = { 0, 10, 15, 18, 22, 24, 26, 30, 40, 50, 60, 80, 120, 500
-// }; Int_t numPt_bins = {13}; Double_t etaBins[] = { -2.4, -2.1, -1.6, -1.2,
-// -0.9, -0.3, -0.2, 0.2, 0.3, 0.9, 1.2, 1.6, 2.1, 2.4 }; Int_t numEta_bins =
-// {13};
-
-Double_t ptBins[]{15, 20, 25, 30, 40, 120, 200};
-Int_t numPt_bins{6};
-Double_t etaBins[]{-2.4, -1.2, 0.0, 1.2, 2.4};
-Int_t numEta_bins{4};
+#include <thread>
+#include <utility>
+#include <yaml-cpp/yaml.h>
 
 TriggerScaleFactors::TriggerScaleFactors()
-    :
-
-    is2016_{false}
+    : is2016_{false}
     , zCuts_{false}
     , jetCuts_{false}
     , bCuts_{false}
     , applyHltSf_{false}
+    , HIP_ERA{false}
+    , DO_HIPS{false}
     , isPart1_{false}
     , isPart2_{false}
     , customElectronCuts_{false}
     , customMuonCuts_{false}
-    ,
-
-    // For efficiencies
-    numberPassedElectrons()
-    , numberTriggeredDoubleElectrons()
-    ,
-
-    numberPassedMuons()
-    , numberTriggeredDoubleMuons()
-    ,
-
-    numberPassedMuonElectrons()
-    , numberTriggeredMuonElectrons()
-    ,
-
-    // alpha systematics
-
-    numberSelectedElectrons()
-    , numberSelectedMuons()
-    , numberSelectedMuonElectrons()
-    ,
-
-    numberSelectedDoubleElectronsTriggered()
-    , numberSelectedDoubleMuonsTriggered()
-    , numberSelectedMuonElectronsTriggered()
+    , selection_{false}
+    , binnedInNJets_{false}
 {
-    //// Plots for turn on curve studies
-
-    // MC histos
-
-    p_electron1_pT_MC = new TProfile("electron1_pT_MC",
-                                     "p_{T} turn-on curve for leading electron",
-                                     numPt_bins,
-                                     ptBins);
-    p_electron1_eta_MC = new TProfile("electron1_eta_MC",
-                                      "#eta turn-on curve for leading",
-                                      numEta_bins,
-                                      etaBins);
-    p_electron2_pT_MC =
-        new TProfile("electron2_pT_MC",
-                     "p_{T} turn-on curve for subleading electron",
-                     numPt_bins,
-                     ptBins);
-    p_electron2_eta_MC = new TProfile("electron2_eta_MC",
-                                      "#eta turn-on curve for subleading",
-                                      numEta_bins,
-                                      etaBins);
-
-    p_muon1_pT_MC = new TProfile("muon1_pT_MC",
-                                 "p_{T} turn-on curve for leading #mu",
-                                 numPt_bins,
-                                 ptBins);
-    p_muon1_eta_MC = new TProfile("muon1_eta_MC",
-                                  "#eta turn-on curve for leading #mu",
-                                  numEta_bins,
-                                  etaBins);
-    p_muon2_pT_MC = new TProfile("muon2_pT_MC",
-                                 "p_{T} turn-on curve for subleading #mu",
-                                 numPt_bins,
-                                 ptBins);
-    p_muon2_eta_MC = new TProfile("muon2_eta_MC",
-                                  "#eta turn-on curve for subleading #mu",
-                                  numEta_bins,
-                                  etaBins);
-
-    p_muonElectron1_pT_MC =
-        new TProfile("muonElectron1_pT_MC",
-                     "p_{T} turn-on curve for leading lep e#mu",
-                     numPt_bins,
-                     ptBins);
-    p_muonElectron1_eta_MC =
-        new TProfile("muonElectron1_eta_MC",
-                     "#eta turn-on curve for leading lep e#mu",
-                     numEta_bins,
-                     etaBins);
-    p_muonElectron2_pT_MC =
-        new TProfile("muonElectron2_pT_MC",
-                     "p_{T} turn-on curve for subleading lep e#mu",
-                     numPt_bins,
-                     ptBins);
-    p_muonElectron2_eta_MC =
-        new TProfile("muonElectron2_eta_MC",
-                     "#eta turn-on curve for subleading lep e#mu",
-                     numEta_bins,
-                     etaBins);
-
-    p_electrons_pT_MC = new TProfile2D(
-        "p_electrons_pT_MC", "", numPt_bins, ptBins, numPt_bins, ptBins);
-    p_electrons_eta_MC = new TProfile2D(
-        "p_electrons_eta_MC", "", numEta_bins, etaBins, numEta_bins, etaBins);
-    p_muons_pT_MC = new TProfile2D(
-        "p_muons_pT_MC", "", numPt_bins, ptBins, numPt_bins, ptBins);
-    p_muons_eta_MC = new TProfile2D(
-        "p_muons_eta_MC", "", numEta_bins, etaBins, numEta_bins, etaBins);
-    p_muonElectrons_pT_MC = new TProfile2D(
-        "p_muonElectrons_pT_MC", "", numPt_bins, ptBins, numPt_bins, ptBins);
-    p_muonElectrons_eta_MC = new TProfile2D("p_muonElectrons_eta_MC",
-                                            "",
-                                            numEta_bins,
-                                            etaBins,
-                                            numEta_bins,
-                                            etaBins);
-
-    // Data histos
-
-    p_electron1_pT_data =
-        new TProfile("electron1_pT_data",
-                     "p_{T} turn-on curve for leading electron",
-                     numPt_bins,
-                     ptBins);
-    p_electron1_eta_data =
-        new TProfile("electron1_eta_data",
-                     "#eta turn-on curve for leading electron",
-                     numEta_bins,
-                     etaBins);
-    p_electron2_pT_data =
-        new TProfile("electron2_pT_data",
-                     "p_{T} turn-on curve for subleading electron",
-                     numPt_bins,
-                     ptBins);
-    p_electron2_eta_data =
-        new TProfile("electron2_eta_data",
-                     "#eta turn-on curve for subleading electron",
-                     numEta_bins,
-                     etaBins);
-
-    p_muon1_pT_data = new TProfile("muon1_pT_data",
-                                   "p_{T} turn-on curve for leading #mu",
-                                   numPt_bins,
-                                   ptBins);
-    p_muon1_eta_data = new TProfile("muon1_eta_data",
-                                    "#eta turn-on curve for leading #mu",
-                                    numEta_bins,
-                                    etaBins);
-    p_muon2_pT_data = new TProfile("muon2_pT_data",
-                                   "p_{T} turn-on curve for subleading #mu",
-                                   numPt_bins,
-                                   ptBins);
-    p_muon2_eta_data = new TProfile("muon2_eta_data",
-                                    "#eta turn-on curve for subleading #mu",
-                                    numEta_bins,
-                                    etaBins);
-
-    p_muonElectron1_pT_data =
-        new TProfile("muonElectron1_pT_data",
-                     "p_{T} turn-on curve for leading lep e#mu",
-                     numPt_bins,
-                     ptBins);
-    p_muonElectron1_eta_data =
-        new TProfile("muonElectron1_eta_data",
-                     "#eta turn-on curve for leading lep e#mu",
-                     numEta_bins,
-                     etaBins);
-    p_muonElectron2_pT_data =
-        new TProfile("muonElectron2_pT_data",
-                     "p_{T} turn-on curve for subleading lep e#mu",
-                     numPt_bins,
-                     ptBins);
-    p_muonElectron2_eta_data =
-        new TProfile("muonElectron2_eta_data",
-                     "#eta turn-on curve for subleading lep e#mu",
-                     numEta_bins,
-                     etaBins);
-
-    p_electrons_pT_data = new TProfile2D(
-        "p_electrons_pT_data", "", numPt_bins, ptBins, numPt_bins, ptBins);
-    p_electrons_eta_data = new TProfile2D(
-        "p_electrons_eta_data", "", numEta_bins, etaBins, numEta_bins, etaBins);
-    p_muons_pT_data = new TProfile2D(
-        "p_muons_pT_data", "", numPt_bins, ptBins, numPt_bins, ptBins);
-    p_muons_eta_data = new TProfile2D(
-        "p_muons_eta_data", "", numEta_bins, etaBins, numEta_bins, etaBins);
-    p_muonElectrons_pT_data = new TProfile2D(
-        "p_muonElectrons_pT_data", "", numPt_bins, ptBins, numPt_bins, ptBins);
-    p_muonElectrons_eta_data = new TProfile2D("p_muonElectrons_eta_data",
-                                              "",
-                                              numEta_bins,
-                                              etaBins,
-                                              numEta_bins,
-                                              etaBins);
-
     if (is2016_)
     {
         muonHltFile1 = new TFile{
@@ -252,6 +71,16 @@ TriggerScaleFactors::~TriggerScaleFactors()
 {
 }
 
+ObjectSelection TriggerScaleFactors::defaultSelection(const bool is2016)
+{
+    ObjectSelection selection{is2016};
+    selection.tightElectron = {15., 38., 2.5, 0.107587};
+    selection.tightMuon = {is2016 ? 20. : 29., 26., 2.4, 0.15};
+    selection.jetId = ObjectSelection::JetId::loose;
+    selection.eeBadScFilter = true;
+    return selection;
+}
+
 void TriggerScaleFactors::parseCommandLineArguements(int argc, char* argv[])
 {
     namespace po = boost::program_options;
@@ -295,7 +124,11 @@ void TriggerScaleFactors::parseCommandLineArguements(int argc, char* argv[])
         "bCuts", po::bool_switch(&bCuts_), "Use btag cuts")(
         "nFiles,f",
         po::value<int>(&numFiles)->default_value(-1),
-        "Number of files to run over. All if set to -1.");
+        "Number of files to run over. All if set to -1.")(
+        "jobs,j",
+        po::value<unsigned>(&jobs)->default_value(
+            std::thread::hardware_concurrency()),
+        "Number of threads to run over the datasets with.");
     po::variables_map vm;
 
     try
@@ -398,12 +231,30 @@ void TriggerScaleFactors::parseCommandLineArguements(int argc, char* argv[])
                   << std::endl;
         throw;
     }
+
+    selection_ = defaultSelection(is2016_);
+    const YAML::Node root{YAML::LoadFile(config)};
+    if (root["cuts"])
+    {
+        selection_.configure(
+            YAML::LoadFile(root["cuts"].as<std::string>())["cuts"]);
+    }
+
+    // Any further binnings of the efficiencies, all filled in the same pass
+    if (root["binnings"])
+    {
+        Parser::parse_efficiency_binnings(root["binnings"].as<std::string>(),
+                                          binnings_);
+    }
+    for (const auto& binning : binnings_)
+    {
+        binnedInNJets_ = binnedInNJets_ || binning.xVariable == "nJets"
+                         || binning.yVariable == "nJets";
+    }
 }
 
 void TriggerScaleFactors::runMainAnalysis()
 {
-    TMVA::gConfig().SetDrawProgressBar(true);
-
     // PU reweighting
     if (!is2016_)
     {
@@ -457,613 +308,355 @@ void TriggerScaleFactors::runMainAnalysis()
     systUpFile->Close();
     systDownFile->Close();
 
-    bool datasetFilled = false;
-
     if (totalLumi == 0.)
         totalLumi = usePreLumi;
     std::cout << "Using lumi: " << totalLumi << std::endl;
-    for (auto dataset = datasets.begin(); dataset != datasets.end(); ++dataset)
-    {
-        const std::hash<std::string> hasher;
-        srand(hasher(dataset->name()));
-
-        datasetFilled = false;
-        TChain* datasetChain = new TChain(dataset->treeName().c_str());
 
-        std::cerr << "Processing dataset " << dataset->name() << std::endl;
-        if (!datasetFilled)
-        {
-            if (!dataset->fillChain(datasetChain, numFiles))
-            {
-                std::cerr << "There was a problem constructing the chain for "
-                          << dataset->name()
-                          << ". Continuing with next dataset.\n";
-                continue;
-            }
-            datasetFilled = true;
-        }
+    // Split every dataset into runs of whole files of about an equal number of
+    // entries each, so that the datasets and the files within them are all
+    // processed at once
+    struct Task
+    {
+        Dataset* dataset;
+        std::vector<std::string> files;
+        Long64_t entries;
+    };
+    std::vector<Task> tasks;
+    for (auto& dataset : datasets)
+    {
+        std::cerr << "Processing dataset " << dataset.name() << std::endl;
+        std::cout << "Trigger flag: " << dataset.getTriggerFlag() << std::endl;
 
-        else
+        TChain datasetChain{dataset.treeName().c_str()};
+        if (!dataset.fillChain(&datasetChain, numFiles))
         {
-            std::string inputPostfix{};
-            inputPostfix += postfix;
-            std::cout << "/scratch/data/TopPhysics/miniSkims2017/"
-                             + dataset->name() + inputPostfix + "SmallSkim.root"
-                      << std::endl;
-            datasetChain->Add(("/scratch/data/TopPhysics/miniSkims2017/"
-                               + dataset->name() + inputPostfix
-                               + "SmallSkim.root")
-                                  .c_str());
-            std::ifstream secondTree{"/scratch/data/TopPhysics/miniSkims2017/"
-                                     + dataset->name() + inputPostfix
-                                     + "SmallSkim1.root"};
-            if (secondTree.good())
-            {
-                datasetChain->Add(("/scratch/data/TopPhysics/miniSkims2017/"
-                                   + dataset->name() + inputPostfix
-                                   + "SmallSkim1.root")
-                                      .c_str());
-            }
-            std::ifstream thirdTree{"/scratch/data/TopPhysics/miniSkims2017/"
-                                    + dataset->name() + inputPostfix
-                                    + "SmallSkim2.root"};
-            if (thirdTree.good())
-            {
-                datasetChain->Add(("/scratch/data/TopPhysics/miniSkims2017/"
-                                   + dataset->name() + inputPostfix
-                                   + "SmallSkim2.root")
-                                      .c_str());
-            }
+            std::cerr << "There was a problem constructing the chain for "
+                      << dataset.name() << ". Continuing with next dataset.\n";
+            continue;
         }
 
-        std::cout << "Trigger flag: " << dataset->getTriggerFlag() << std::endl;
-
-        AnalysisEvent event{dataset->isMC(), datasetChain, is2016_};
-
-        int numberOfEvents = datasetChain->GetEntries();
+        Long64_t numberOfEvents{datasetChain.GetEntries()};
         if (nEvents && nEvents < numberOfEvents)
         {
             numberOfEvents = nEvents;
         }
-        auto lEventTimer =
-            new TMVA::Timer(numberOfEvents, "Running over dataset ...", false);
-        lEventTimer->DrawProgressBar(0, "");
-        for (int i = 0; i < numberOfEvents; i++)
+        const Long64_t taskEntries{numberOfEvents / std::max(jobs, 1u) + 1};
+        const Long64_t* offsets{datasetChain.GetTreeOffset()};
+        const TObjArray* files{datasetChain.GetListOfFiles()};
+        for (int file{0}; file < datasetChain.GetNtrees(); file++)
         {
-            lEventTimer->DrawProgressBar(i);
-            event.GetEntry(i);
-
-            double pileupWeight = puReweight->GetBinContent(
-                puReweight->GetXaxis()->FindBin(event.numVert));
-            double eventWeight = 1.0;
-            if (dataset->isMC())
-            {
-                eventWeight *= pileupWeight;
-            }
-
-            //      std::cout << __LINE__ << " : " << __FILE__ << std::endl;
-
-            if (is2016_)
-            {
-                if (HIP_ERA && event.eventRun >= 278820 && !(dataset->isMC())
-                    && DO_HIPS)
-                {
-                    continue;
-                }
-                if (!HIP_ERA && event.eventRun < 278820 && !(dataset->isMC())
-                    && DO_HIPS)
-                {
-                    continue;
-                }
-            }
-            if (!metFilters(event, dataset->isMC()))
+            if (offsets[file] >= numberOfEvents)
             {
-                continue;
+                break;
             }
-
-            // If checking impact of jet and bjet cuts add this bool ...
-            bool passJetSelection = true;
-            if (jetCuts_)
+            if (tasks.empty() || tasks.back().dataset != &dataset
+                || tasks.back().entries >= taskEntries)
             {
-                passJetSelection = makeJetCuts(event, (dataset->isMC()));
+                tasks.push_back({&dataset, {}, 0});
             }
+            tasks.back().files.emplace_back(files->At(file)->GetTitle());
+            tasks.back().entries +=
+                std::min(offsets[file + 1], numberOfEvents) - offsets[file];
+        }
+    }
 
-            // Does this event pass tight electron cut?
-            // Create electron index
-            event.electronIndexTight = getTightElectrons(event);
-            bool passDoubleElectronSelection(passDileptonSelection(event, 2)
-                                             && passJetSelection);
-            // Does this event pass tight muon cut?
-            // Create muon index
-            event.muonIndexTight = getTightMuons(event);
-            bool passDoubleMuonSelection(passDileptonSelection(event, 0)
-                                         && passJetSelection);
-
-            bool passMuonElectronSelection(passDileptonSelection(event, 1)
-                                           && passJetSelection);
-
-            // Triggering stuff
-            int triggerDoubleEG(0), triggerDoubleMuon(0),
-                triggerMuonElectron(0); // Passes Double Lepton Trigger
-            int triggerMetDoubleEG(0), triggerMetDoubleMuon(0),
-                triggerMetMuonElectron(
-                    0); // Passes Double Lepton and MET triggers
-
-            // Passes event selection and MET triggers
-            int triggerMetElectronSelection(0), triggerMetMuonSelection(0),
-                triggerMetMuonElectronSelection(
-                    0); // Passes lepton selection and MET triggers
-
-            // Does event pass Single/Double EG trigger and the electron
-            // selection?
-            if (passDoubleElectronSelection)
-            {
-                triggerDoubleEG = event.eTrig() && event.eeTrig();
-                triggerMetDoubleEG = triggerDoubleEG && metTriggerCut(event);
-            }
-            // Does event pass Single/Double Muon trigger and the muon
-            // selection?
-            if (passDoubleMuonSelection)
-            {
-                triggerDoubleMuon = event.muTrig() || event.mumuTrig();
-                triggerMetDoubleMuon =
-                    triggerDoubleMuon && metTriggerCut(event);
-            }
-            // Does event pass Single Electron/Single Muon/MuonEG trigger and
-            // the muon selection?
-            if (passMuonElectronSelection)
-            {
-                triggerMuonElectron = event.muEGTrig();
-                triggerMetMuonElectron =
-                    triggerMuonElectron && metTriggerCut(event);
-            }
-            //
-            // Does event pass either double lepton seletion and the MET
-            // triggers?
-            if (passDoubleElectronSelection)
-            {
-                triggerMetElectronSelection = (metTriggerCut(event));
-            }
-            if (passDoubleMuonSelection)
-            {
-                triggerMetMuonSelection = (metTriggerCut(event));
-            }
-            if (passMuonElectronSelection)
+    // Each thread fills its own efficiencies, merged once all have finished
+    ROOT::EnableThreadSafety();
+    efficiencies_ = TriggerEfficiencies{binnings_};
+    std::vector<TriggerEfficiencies> taskEfficiencies(tasks.size(),
+                                                      efficiencies_);
+    std::vector<std::string> errors(tasks.size());
+    std::atomic<size_t> next{0};
+    std::mutex printMutex;
+    std::vector<std::thread> workers;
+    for (unsigned worker{0}; worker < std::max(jobs, 1u); worker++)
+    {
+        workers.emplace_back([&] {
+            for (size_t i{next++}; i < tasks.size(); i = next++)
             {
-                triggerMetMuonElectronSelection = (metTriggerCut(event));
-            }
-
-            if (dataset->isMC())
-            { // If is MC
-                // SFs bit
-
-                double SF = 1.0;
-                if (applyHltSf_)
+                try
                 {
-                    double maxSfPt = h_muonHlt1->GetYaxis()->GetXmax() - 0.1;
-                    double minSfPt = h_muonHlt1->GetYaxis()->GetXmin() + 0.1;
-                    unsigned binSf1{0};
-
-                    double pt = event.zPairLeptons.first.Pt();
-                    double eta = event.zPairLeptons.first.Eta();
-
-                    if (pt > maxSfPt)
-                    {
-                        binSf1 = h_muonHlt1->FindBin(std::abs(eta), maxSfPt);
-                    }
-                    else if (pt < minSfPt)
-                    {
-                        binSf1 = h_muonHlt1->FindBin(std::abs(eta), minSfPt);
-                    }
-                    else
-                    {
-                        binSf1 = h_muonHlt1->FindBin(std::abs(eta), pt);
-                    }
-
-                    if (is2016_)
-                    {
-                        unsigned binSf2{0};
-                        if (pt > maxSfPt)
-                        {
-                            binSf2 =
-                                h_muonHlt2->FindBin(std::abs(eta), maxSfPt);
-                        }
-                        else if (pt < minSfPt)
-                        {
-                            binSf2 =
-                                h_muonHlt2->FindBin(std::abs(eta), minSfPt);
-                        }
-                        else
-                        {
-                            binSf2 = h_muonHlt2->FindBin(std::abs(eta), pt);
-                        }
-
-                        if (!DO_HIPS)
-                        {
-                            SF = (h_muonHlt1->GetBinContent(binSf1) * 19648.534
-                                  + h_muonHlt2->GetBinContent(binSf2)
-                                        * 16144.444)
-                                 / (19648.534 + 16144.444 + 1.0e-06);
-                        }
-                        if (DO_HIPS && HIP_ERA)
-                        {
-                            SF = h_muonHlt1->GetBinContent(binSf1);
-                        }
-                        if (DO_HIPS && !HIP_ERA)
-                        {
-                            SF = h_muonHlt2->GetBinContent(binSf2);
-                        }
-                    }
-                }
-
-                numberPassedElectrons[0] +=
-                    triggerMetElectronSelection
-                    * eventWeight; // Number of electrons passing the cross
-                                   // trigger and electron selection
-                numberTriggeredDoubleElectrons[0] +=
-                    triggerMetDoubleEG
-                    * eventWeight; // Number of electrons passing both cross
-                                   // trigger+electron selection AND double EG
-                                   // trigger
-                numberPassedMuons[0] +=
-                    triggerMetMuonSelection
-                    * eventWeight; // Number of muons passing the cross trigger
-                                   // and muon selection
-                numberTriggeredDoubleMuons[0] +=
-                    triggerMetDoubleMuon * eventWeight
-                    * SF; // Number of muons passing both cross trigger+muon
-                          // selection AND double muon trigger
-                numberPassedMuonElectrons[0] +=
-                    triggerMetMuonElectronSelection
-                    * eventWeight; // Number of muonEGs passing cross trigger
-                                   // and muonEG selection
-                numberTriggeredMuonElectrons[0] +=
-                    triggerMetMuonElectron
-                    * eventWeight; // Number muonEGs passing both cross
-                                   // trigger+muonEG selection AND muonEG
-                                   // trigger
-
-                // Systematic stuff
-                numberSelectedElectrons[0] +=
-                    passDoubleElectronSelection * eventWeight;
-                numberSelectedMuons[0] += passDoubleMuonSelection * eventWeight;
-                numberSelectedMuonElectrons[0] +=
-                    passMuonElectronSelection * eventWeight;
-
-                numberSelectedDoubleElectronsTriggered[0] +=
-                    triggerDoubleEG * eventWeight;
-                ;
-                numberSelectedDoubleMuonsTriggered[0] +=
-                    triggerDoubleMuon * eventWeight * SF;
-                numberSelectedMuonElectronsTriggered[0] +=
-                    triggerMuonElectron * eventWeight;
-
-                // Histos bit
-                if (triggerMetElectronSelection > 0)
-                { // If passed event selection, then will want to add to
-                  // denominator
-                    p_electron1_pT_MC->Fill(event.zPairLeptons.first.Pt(),
-                                            triggerMetDoubleEG
-                                                / triggerMetElectronSelection);
-                    p_electron1_eta_MC->Fill(event.zPairLeptons.first.Eta(),
-                                             triggerMetDoubleEG
-                                                 / triggerMetElectronSelection);
-                    p_electron2_pT_MC->Fill(event.zPairLeptons.second.Pt(),
-                                            triggerMetDoubleEG
-                                                / triggerMetElectronSelection);
-                    p_electron2_eta_MC->Fill(event.zPairLeptons.second.Eta(),
-                                             triggerMetDoubleEG
-                                                 / triggerMetElectronSelection);
-
-                    p_electrons_pT_MC->Fill(event.zPairLeptons.first.Pt(),
-                                            event.zPairLeptons.second.Pt(),
-                                            triggerMetDoubleEG
-                                                / triggerMetElectronSelection);
-                    p_electrons_eta_MC->Fill(event.zPairLeptons.first.Eta(),
-                                             event.zPairLeptons.second.Eta(),
-                                             triggerMetDoubleEG
-                                                 / triggerMetElectronSelection);
-                }
-                if (triggerMetMuonSelection > 0)
-                { // If passed event selection, then will want to add to
-                  // denominator
-                    p_muon1_pT_MC->Fill(event.zPairLeptons.first.Pt(),
-                                        triggerMetDoubleMuon * SF
-                                            / triggerMetMuonSelection);
-                    if (event.zPairLeptons.first.Pt() > 30.)
-                    {
-                        p_muon1_eta_MC->Fill(event.zPairLeptons.first.Eta(),
-                                             triggerMetDoubleMuon * SF
-                                                 / triggerMetMuonSelection);
-                    }
-                    p_muon2_pT_MC->Fill(event.zPairLeptons.second.Pt(),
-                                        triggerMetDoubleMuon * SF
-                                            / triggerMetMuonSelection);
-                    if (event.zPairLeptons.second.Pt() > 30.)
-                    {
-                        p_muon2_eta_MC->Fill(event.zPairLeptons.second.Eta(),
-                                             triggerMetDoubleMuon * SF
-                                                 / triggerMetMuonSelection);
-                    }
-
-                    p_muons_pT_MC->Fill(event.zPairLeptons.first.Pt(),
-                                        event.zPairLeptons.second.Pt(),
-                                        triggerMetDoubleMuon * SF
-                                            / triggerMetMuonSelection);
-                    p_muons_eta_MC->Fill(event.zPairLeptons.first.Eta(),
-                                         event.zPairLeptons.second.Eta(),
-                                         triggerMetDoubleMuon * SF
-                                             / triggerMetMuonSelection);
-                }
-                if (triggerMetMuonElectronSelection > 0)
-                { // If passed event selection, then will want to add to
-                  // denominator
-                    p_muonElectron1_pT_MC->Fill(
-                        event.zPairLeptons.first.Pt(),
-                        triggerMetMuonElectron
-                            / triggerMetMuonElectronSelection);
-                    p_muonElectron1_eta_MC->Fill(
-                        event.zPairLeptons.first.Eta(),
-                        triggerMetMuonElectron
-                            / triggerMetMuonElectronSelection);
-                    p_muonElectron2_pT_MC->Fill(
-                        event.zPairLeptons.second.Pt(),
-                        triggerMetMuonElectron
-                            / triggerMetMuonElectronSelection);
-                    p_muonElectron2_eta_MC->Fill(
-                        event.zPairLeptons.second.Eta(),
-                        triggerMetMuonElectron
-                            / triggerMetMuonElectronSelection);
-
-                    p_muonElectrons_pT_MC->Fill(
-                        event.zPairLeptons.first.Pt(),
-                        event.zPairLeptons.second.Pt(),
-                        triggerMetMuonElectron
-                            / triggerMetMuonElectronSelection);
-                    p_muonElectrons_eta_MC->Fill(
-                        event.zPairLeptons.first.Eta(),
-                        event.zPairLeptons.second.Eta(),
-                        triggerMetMuonElectron
-                            / triggerMetMuonElectronSelection);
-                }
-            }
-            else
-            { // Else is data
-                // SFs bit
-                numberPassedElectrons[1] +=
-                    triggerMetElectronSelection
-                    * eventWeight; // Number of electrons passing the cross
-                                   // trigger and electron selection
-                numberTriggeredDoubleElectrons[1] +=
-                    triggerMetDoubleEG
-                    * eventWeight; // Number of electrons passing both cross
-                                   // trigger+electron selection AND double EG
-                                   // trigger
-                numberPassedMuons[1] +=
-                    triggerMetMuonSelection
-                    * eventWeight; // Number of muons passing the cross trigger
-                                   // and muon selection
-                numberTriggeredDoubleMuons[1] +=
-                    triggerMetDoubleMuon
-                    * eventWeight; // Number of muons passing both cross
-                                   // trigger+muon selection AND double muon
-                                   // trigger
-                numberPassedMuonElectrons[1] +=
-                    triggerMetMuonElectronSelection
-                    * eventWeight; // Number of muonEGs passing cross trigger
-                                   // and muonEG selection
-                numberTriggeredMuonElectrons[1] +=
-                    triggerMetMuonElectron
-                    * eventWeight; // Number muonEGs passing both cross
-                                   // trigger+muonEG selection AND muonEG
-                                   // trigger
-
-                // NB No systematic stuff required for data
-
-                // Histos bit
-                if (triggerMetElectronSelection > 0)
-                { // If passed event selection, then will want to add to
-                  // denominator
-                    p_electron1_pT_data->Fill(
-                        event.zPairLeptons.first.Pt(),
-                        triggerMetDoubleEG / triggerMetElectronSelection);
-                    p_electron1_eta_data->Fill(
-                        event.zPairLeptons.first.Eta(),
-                        triggerMetDoubleEG / triggerMetElectronSelection);
-                    p_electron2_pT_data->Fill(
-                        event.zPairLeptons.second.Pt(),
-                        triggerMetDoubleEG / triggerMetElectronSelection);
-                    p_electron2_eta_data->Fill(
-                        event.zPairLeptons.second.Eta(),
-                        triggerMetDoubleEG / triggerMetElectronSelection);
-
-                    p_electrons_pT_data->Fill(
-                        event.zPairLeptons.first.Pt(),
-                        event.zPairLeptons.second.Pt(),
-                        triggerMetDoubleEG / triggerMetElectronSelection);
-                    p_electrons_eta_data->Fill(
-                        event.zPairLeptons.first.Eta(),
-                        event.zPairLeptons.second.Eta(),
-                        triggerMetDoubleEG / triggerMetElectronSelection);
-                }
-                if (triggerMetMuonSelection > 0)
-                { // If passed event selection, then will want to add to
-                  // denominator
-                    p_muon1_pT_data->Fill(event.zPairLeptons.first.Pt(),
-                                          triggerMetDoubleMuon
-                                              / triggerMetMuonSelection);
-                    if (event.zPairLeptons.first.Pt() > 30.)
+                    const Task& task{tasks[i]};
+                    const bool isMC{task.dataset->isMC()};
+                    TChain chain{task.dataset->treeName().c_str()};
+                    for (const auto& file : task.files)
                     {
-                        p_muon1_eta_data->Fill(event.zPairLeptons.first.Eta(),
-                                               triggerMetDoubleMuon
-                                                   / triggerMetMuonSelection);
+                        chain.Add(file.c_str());
                     }
-                    p_muon2_pT_data->Fill(event.zPairLeptons.second.Pt(),
-                                          triggerMetDoubleMuon
-                                              / triggerMetMuonSelection);
-                    if (event.zPairLeptons.second.Pt() > 30.)
+                    AnalysisEvent event{isMC, &chain, is2016_};
+                    for (Long64_t entry{0}; entry < task.entries; entry++)
                     {
-                        p_muon2_eta_data->Fill(event.zPairLeptons.second.Eta(),
-                                               triggerMetDoubleMuon
-                                                   / triggerMetMuonSelection);
+                        event.GetEntry(entry);
+                        processEvent(event, isMC, taskEfficiencies[i]);
                     }
 
-                    p_muons_pT_data->Fill(event.zPairLeptons.first.Pt(),
-                                          event.zPairLeptons.second.Pt(),
-                                          triggerMetDoubleMuon
-                                              / triggerMetMuonSelection);
-                    p_muons_eta_data->Fill(event.zPairLeptons.first.Eta(),
-                                           event.zPairLeptons.second.Eta(),
-                                           triggerMetDoubleMuon
-                                               / triggerMetMuonSelection);
+                    const std::lock_guard<std::mutex> lock{printMutex};
+                    std::cout << "Finished " << task.entries << " events of "
+                              << task.dataset->name() << " (" << i + 1 << "/"
+                              << tasks.size() << ")" << std::endl;
                 }
-                if (triggerMetMuonElectronSelection > 0)
-                { // If passed event selection, then will want to add to
-                  // denominator
-                    p_muonElectron1_pT_data->Fill(
-                        event.zPairLeptons.first.Pt(),
-                        triggerMetMuonElectron
-                            / triggerMetMuonElectronSelection);
-                    p_muonElectron1_eta_data->Fill(
-                        event.zPairLeptons.first.Eta(),
-                        triggerMetMuonElectron
-                            / triggerMetMuonElectronSelection);
-                    p_muonElectron2_pT_data->Fill(
-                        event.zPairLeptons.second.Pt(),
-                        triggerMetMuonElectron
-                            / triggerMetMuonElectronSelection);
-                    p_muonElectron2_eta_data->Fill(
-                        event.zPairLeptons.second.Eta(),
-                        triggerMetMuonElectron
-                            / triggerMetMuonElectronSelection);
-
-                    p_muonElectrons_pT_data->Fill(
-                        event.zPairLeptons.first.Pt(),
-                        event.zPairLeptons.second.Pt(),
-                        triggerMetMuonElectron
-                            / triggerMetMuonElectronSelection);
-                    p_muonElectrons_eta_data->Fill(
-                        event.zPairLeptons.first.Eta(),
-                        event.zPairLeptons.second.Eta(),
-                        triggerMetMuonElectron
-                            / triggerMetMuonElectronSelection);
+                catch (const std::exception& e)
+                {
+                    errors[i] = e.what();
                 }
             }
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    for (const auto& error : errors)
+    {
+        if (!error.empty())
+        {
+            throw std::runtime_error(error);
         }
-
-        delete datasetChain;
-    } // end dataset loop
+    }
+    for (const auto& efficiencies : taskEfficiencies)
+    {
+        efficiencies_.merge(efficiencies);
+    }
 }
 
-std::vector<int>
-    TriggerScaleFactors::getTightElectrons(const AnalysisEvent& event) const
+void TriggerScaleFactors::processEvent(AnalysisEvent& event,
+                                       const bool isMC,
+                                       TriggerEfficiencies& efficiencies) const
 {
-    std::vector<int> electrons;
-
-    for (int i{0}; i < event.numElePF2PAT; i++)
+    double pileupWeight = puReweight->GetBinContent(
+        puReweight->GetXaxis()->FindBin(event.numVert));
+    double eventWeight = 1.0;
+    if (isMC)
     {
-        if (!event.elePF2PATIsGsf[i])
-            continue;
-
-        if (electrons.size() < 1 && event.elePF2PATPT[i] <= 38)
-            continue;
-        else if (electrons.size() >= 1 && event.elePF2PATPT[i] <= 15)
-            continue;
-
-        if (std::abs(event.elePF2PATSCEta[i]) > 2.5)
-            continue;
-
-        // Ensure we aren't in the barrel/endcap gap and below the max safe eta
-        // range
-        if ((std::abs(event.elePF2PATSCEta[i]) > 1.4442
-             && std::abs(event.elePF2PATSCEta[i]) < 1.566)
-            || std::abs(event.elePF2PATSCEta[i]) > 2.50)
-            continue;
-
-        // VID cut
-        if (event.elePF2PATCutIdTight[i] < 1)
-            continue;
+        eventWeight *= pileupWeight;
+    }
 
-        // Cuts not part of the tuned ID
-        if (std::abs(event.elePF2PATSCEta[i]) <= 1.479)
+    if (is2016_)
+    {
+        if (HIP_ERA && event.eventRun >= 278820 && !isMC && DO_HIPS)
         {
-            if (std::abs(event.elePF2PATD0PV[i]) >= 0.05)
-                continue;
-            if (std::abs(event.elePF2PATDZPV[i]) >= 0.10)
-                continue;
+            return;
         }
-        else if (std::abs(event.elePF2PATSCEta[i]) > 1.479
-                 && std::abs(event.elePF2PATSCEta[i]) < 2.50)
+        if (!HIP_ERA && event.eventRun < 278820 && !isMC && DO_HIPS)
         {
-            if (std::abs(event.elePF2PATD0PV[i]) >= 0.10)
-                continue;
-            if (std::abs(event.elePF2PATDZPV[i]) >= 0.20)
-                continue;
+            return;
         }
-        electrons.emplace_back(i);
     }
-    return electrons;
-}
+    if (!selection_.metFilters(event, isMC))
+    {
+        return;
+    }
 
-std::vector<int>
-    TriggerScaleFactors::getTightMuons(const AnalysisEvent& event) const
-{
-    std::vector<int> muons;
-    if (is2016_)
+    // Does this event pass tight electron cut?
+    // Create electron index
+    event.electronIndexTight = selection_.tightElectrons(event);
+    bool passDoubleElectronSelection(passDileptonSelection(event, 2));
+    // Does this event pass tight muon cut?
+    // Create muon index
+    event.muonIndexTight = selection_.tightMuons(event);
+    bool passDoubleMuonSelection(passDileptonSelection(event, 0));
+
+    bool passMuonElectronSelection(passDileptonSelection(event, 1));
+
+    // The jets are cleaned against the Z pair leptons, so are selected once
+    // those are known, and only once for both the jet cuts and the binnings
+    std::vector<Jet> jets;
+    if ((jetCuts_ || binnedInNJets_)
+        && (passDoubleElectronSelection || passDoubleMuonSelection
+            || passMuonElectronSelection))
     {
-        for (int i{0}; i < event.numMuonPF2PAT; i++)
-        {
-            if (!event.muonPF2PATIsPFMuon[i])
-                continue;
+        jets = getJets(event, isMC);
+    }
+    // If checking impact of jet and bjet cuts ...
+    if (jetCuts_ && !makeJetCuts(event, jets))
+    {
+        passDoubleElectronSelection = false;
+        passDoubleMuonSelection = false;
+        passMuonElectronSelection = false;
+    }
 
-            if (muons.size() < 1 && event.muonPF2PATPt[i] <= 26)
-                continue;
-            else if (muons.size() >= 1 && event.muonPF2PATPt[i] <= 20)
-                continue;
+    // Triggering stuff
+    int triggerDoubleEG(0), triggerDoubleMuon(0),
+        triggerMuonElectron(0); // Passes Double Lepton Trigger
+    int triggerMetDoubleEG(0), triggerMetDoubleMuon(0),
+        triggerMetMuonElectron(0); // Passes Double Lepton and MET triggers
 
-            if (std::abs(event.muonPF2PATEta[i]) >= 2.4)
-                continue;
-            if (event.muonPF2PATComRelIsodBeta[i] >= 0.15)
-                continue;
+    // Passes event selection and MET triggers
+    int triggerMetElectronSelection(0), triggerMetMuonSelection(0),
+        triggerMetMuonElectronSelection(
+            0); // Passes lepton selection and MET triggers
 
-            // Tight ID Cut
-            if (!event.muonPF2PATTrackID[i])
-                continue;
-            if (!event.muonPF2PATGlobalID[i])
-                continue;
-            if (event.muonPF2PATGlbTkNormChi2[i] >= 10.)
-                continue;
-            if (event.muonPF2PATMatchedStations[i] < 2)
-                continue; //
-            if (std::abs(event.muonPF2PATDBPV[i]) >= 0.2)
-                continue;
-            if (std::abs(event.muonPF2PATDZPV[i]) >= 0.5)
-                continue;
-            if (event.muonPF2PATMuonNHits[i] < 1)
-                continue;
-            if (event.muonPF2PATVldPixHits[i] < 1)
-                continue;
-            if (event.muonPF2PATTkLysWithMeasurements[i] <= 5)
-                continue;
-            muons.emplace_back(i);
-        }
+    // Does event pass Single/Double EG trigger and the electron
+    // selection?
+    if (passDoubleElectronSelection)
+    {
+        triggerDoubleEG = event.eTrig() && event.eeTrig();
+        triggerMetDoubleEG = triggerDoubleEG && metTriggerCut(event);
     }
-    else
+    // Does event pass Single/Double Muon trigger and the muon
+    // selection?
+    if (passDoubleMuonSelection)
+    {
+        triggerDoubleMuon = event.muTrig() || event.mumuTrig();
+        triggerMetDoubleMuon = triggerDoubleMuon && metTriggerCut(event);
+    }
+    // Does event pass Single Electron/Single Muon/MuonEG trigger and
+    // the muon selection?
+    if (passMuonElectronSelection)
+    {
+        triggerMuonElectron = event.muEGTrig();
+        triggerMetMuonElectron = triggerMuonElectron && metTriggerCut(event);
+    }
+    //
+    // Does event pass either double lepton seletion and the MET
+    // triggers?
+    if (passDoubleElectronSelection)
+    {
+        triggerMetElectronSelection = (metTriggerCut(event));
+    }
+    if (passDoubleMuonSelection)
+    {
+        triggerMetMuonSelection = (metTriggerCut(event));
+    }
+    if (passMuonElectronSelection)
     {
-        for (int i{0}; i < event.numMuonPF2PAT; i++)
+        triggerMetMuonElectronSelection = (metTriggerCut(event));
+    }
+
+    // SFs bit, MC only
+    double SF = 1.0;
+    if (isMC && applyHltSf_)
+    {
+        double maxSfPt = h_muonHlt1->GetYaxis()->GetXmax() - 0.1;
+        double minSfPt = h_muonHlt1->GetYaxis()->GetXmin() + 0.1;
+        unsigned binSf1{0};
+
+        double pt = event.zPairLeptons.first.Pt();
+        double eta = event.zPairLeptons.first.Eta();
+
+        if (pt > maxSfPt)
+        {
+            binSf1 = h_muonHlt1->FindBin(std::abs(eta), maxSfPt);
+        }
+        else if (pt < minSfPt)
+        {
+            binSf1 = h_muonHlt1->FindBin(std::abs(eta), minSfPt);
+        }
+        else
         {
-            if (event.muonPF2PATIsPFMuon[i] && event.muonPF2PATTightCutId[i]
-                && event.muonPF2PATPfIsoTight[i]
-                && std::abs(event.muonPF2PATEta[i]) <= 2.4)
+            binSf1 = h_muonHlt1->FindBin(std::abs(eta), pt);
+        }
+
+        if (is2016_)
+        {
+            unsigned binSf2{0};
+            if (pt > maxSfPt)
             {
-                if (event.muonPF2PATPt[i] >= (muons.empty() ? 26 : 29))
-                {
-                    muons.emplace_back(i);
-                }
+                binSf2 = h_muonHlt2->FindBin(std::abs(eta), maxSfPt);
+            }
+            else if (pt < minSfPt)
+            {
+                binSf2 = h_muonHlt2->FindBin(std::abs(eta), minSfPt);
+            }
+            else
+            {
+                binSf2 = h_muonHlt2->FindBin(std::abs(eta), pt);
+            }
+
+            if (!DO_HIPS)
+            {
+                SF = (h_muonHlt1->GetBinContent(binSf1) * 19648.534
+                      + h_muonHlt2->GetBinContent(binSf2) * 16144.444)
+                     / (19648.534 + 16144.444 + 1.0e-06);
+            }
+            if (DO_HIPS && HIP_ERA)
+            {
+                SF = h_muonHlt1->GetBinContent(binSf1);
+            }
+            if (DO_HIPS && !HIP_ERA)
+            {
+                SF = h_muonHlt2->GetBinContent(binSf2);
             }
         }
     }
-    return muons;
+
+    ChannelEfficiency& electrons{
+        efficiencies.get(isMC, TriggerEfficiencies::electrons)};
+    ChannelEfficiency& muons{
+        efficiencies.get(isMC, TriggerEfficiencies::muons)};
+    ChannelEfficiency& muonElectrons{
+        efficiencies.get(isMC, TriggerEfficiencies::muonElectrons)};
+
+    // Events passing the cross trigger and lepton selection, and those also
+    // passing the dilepton triggers
+    electrons.counts.passed += triggerMetElectronSelection * eventWeight;
+    electrons.counts.triggered += triggerMetDoubleEG * eventWeight;
+    muons.counts.passed += triggerMetMuonSelection * eventWeight;
+    muons.counts.triggered += triggerMetDoubleMuon * eventWeight * SF;
+    muonElectrons.counts.passed +=
+        triggerMetMuonElectronSelection * eventWeight;
+    muonElectrons.counts.triggered += triggerMetMuonElectron * eventWeight;
+
+    // Systematic stuff, NB not required for data
+    if (isMC)
+    {
+        electrons.counts.selected += passDoubleElectronSelection * eventWeight;
+        muons.counts.selected += passDoubleMuonSelection * eventWeight;
+        muonElectrons.counts.selected +=
+            passMuonElectronSelection * eventWeight;
+
+        electrons.counts.selectedTriggered += triggerDoubleEG * eventWeight;
+        muons.counts.selectedTriggered += triggerDoubleMuon * eventWeight * SF;
+        muonElectrons.counts.selectedTriggered +=
+            triggerMuonElectron * eventWeight;
+    }
+
+    // Histos bit. If passed event selection, then will want to add to
+    // denominator. The muon eta curves only take muons above 30 GeV.
+    if (triggerMetElectronSelection <= 0 && triggerMetMuonSelection <= 0
+        && triggerMetMuonElectronSelection <= 0)
+    {
+        return;
+    }
+    const TLorentzVector& lepton1{event.zPairLeptons.first};
+    const TLorentzVector& lepton2{event.zPairLeptons.second};
+    const EfficiencyVariables variables{
+        {lepton1.Pt(),
+         lepton1.Eta(),
+         lepton2.Pt(),
+         lepton2.Eta(),
+         static_cast<double>(event.numVert),
+         static_cast<double>(jets.size()),
+         static_cast<double>(event.eventRun)}};
+    const double allPt{-std::numeric_limits<double>::infinity()};
+    if (triggerMetElectronSelection > 0)
+    {
+        electrons.fill(lepton1,
+                       lepton2,
+                       triggerMetDoubleEG / triggerMetElectronSelection,
+                       allPt,
+                       variables,
+                       eventWeight);
+    }
+    if (triggerMetMuonSelection > 0)
+    {
+        muons.fill(lepton1,
+                   lepton2,
+                   triggerMetDoubleMuon * SF / triggerMetMuonSelection,
+                   30.,
+                   variables,
+                   eventWeight);
+    }
+    if (triggerMetMuonElectronSelection > 0)
+    {
+        muonElectrons.fill(
+            lepton1,
+            lepton2,
+            triggerMetMuonElectron / triggerMetMuonElectronSelection,
+            allPt,
+            variables,
+            eventWeight);
+    }
 }
 
 bool TriggerScaleFactors::passDileptonSelection(AnalysisEvent& event,
@@ -1443,42 +1036,10 @@ bool TriggerScaleFactors::metTriggerCut(const AnalysisEvent& event) const
     // clang-format on
 }
 
-bool TriggerScaleFactors::metFilters(const AnalysisEvent& event,
-                                     const bool isMC) const
+std::vector<TriggerScaleFactors::Jet>
+    TriggerScaleFactors::getJets(AnalysisEvent& event, const bool isMC) const
 {
-    if (event.Flag_HBHENoiseFilter <= 0 || event.Flag_HBHENoiseIsoFilter <= 0
-        || event.Flag_globalTightHalo2016Filter <= 0
-        || event.Flag_EcalDeadCellTriggerPrimitiveFilter <= 0
-        || event.Flag_goodVertices <= 0
-        || (!isMC && event.Flag_eeBadScFilter <= 0))
-    {
-        return false;
-    }
-
-    if (is2016_
-        && (event.Flag_ecalLaserCorrFilter <= 0
-            || event.Flag_chargedHadronTrackResolutionFilter <= 0
-            || event.Flag_muonBadTrackFilter <= 0
-            || (!isMC && event.Flag_noBadMuons <= 0)))
-    {
-        return false;
-    }
-
-    if (!is2016_
-        && (event.Flag_BadPFMuonFilter <= 0
-            || event.Flag_BadChargedCandidateFilter <= 0
-            || event.Flag_ecalBadCalibFilter <= 0))
-    {
-        return false;
-    }
-
-    return true;
-}
-
-bool TriggerScaleFactors::makeJetCuts(AnalysisEvent& event,
-                                      const bool isMC) const
-{
-    std::vector<int> jets;
+    std::vector<Jet> jets;
     for (int i{0}; i < event.numJetPF2PAT; i++)
     {
         // if (std::sqrt(event.jetPF2PATPx[i] * event.jetPF2PATPx[i] +
@@ -1493,105 +1054,34 @@ bool TriggerScaleFactors::makeJetCuts(AnalysisEvent& event,
             continue;
         }
 
-        bool jetId{true};
-
-        // Jet ID == loose
-        if (std::abs(jetVec.Eta()) <= 2.7)
-        { // for cases where jet eta <= 2.7
-            // for all jets with eta <= 2.7
-            if (event.jetPF2PATNeutralHadronEnergyFraction[i] >= 0.99)
-            {
-                jetId = false;
-            }
-            if (event.jetPF2PATNeutralEmEnergyFraction[i] >= 0.99)
-            {
-                jetId = false;
-            }
-            if ((event.jetPF2PATChargedMultiplicity[i]
-                 + event.jetPF2PATNeutralMultiplicity[i])
-                <= 1)
-            {
-                jetId = false;
-            }
-        }
-        // for jets with eta <= 2.40
-        if (std::abs(jetVec.Eta()) <= 2.40)
-        {
-            if (event.jetPF2PATChargedHadronEnergyFraction[i] <= 0.0)
-            {
-                jetId = false;
-            }
-            if (event.jetPF2PATChargedMultiplicity[i] <= 0.0)
-            {
-                jetId = false;
-            }
-            if (event.jetPF2PATChargedEmEnergyFraction[i] >= 0.99)
-            {
-                jetId = false;
-            }
-        }
-        else if (std::abs(jetVec.Eta()) <= 3.0 && std::abs(jetVec.Eta()) > 2.70)
-        {
-            if (event.jetPF2PATNeutralHadronEnergyFraction[i] >= 0.98)
-            {
-                jetId = false;
-            }
-            if (event.jetPF2PATNeutralEmEnergyFraction[i] <= 0.01)
-            {
-                jetId = false;
-            }
-            if (event.jetPF2PATNeutralMultiplicity[i] <= 2)
-            {
-                jetId = false;
-            }
-        }
-        else if (std::abs(jetVec.Eta()) > 3.0)
-        { // for cases where jet eta > 3.0 and less than 5.0 (or max).
-            if (event.jetPF2PATNeutralEmEnergyFraction[i] >= 0.90)
-            {
-                jetId = false;
-            }
-            if (event.jetPF2PATNeutralMultiplicity[i] <= 10)
-            {
-                jetId = false;
-            }
-        }
-
-        if (!jetId)
+        if (!selection_.passesJetId(event, i, jetVec.Eta()))
         {
             continue;
         }
-        double deltaLep{10000};
 
-        if (deltaLep > deltaR(event.zPairLeptons.first.Eta(),
-                              event.zPairLeptons.first.Phi(),
-                              jetVec.Eta(),
-                              jetVec.Phi()))
-        {
-            deltaLep = deltaR(event.zPairLeptons.first.Eta(),
-                              event.zPairLeptons.first.Phi(),
-                              jetVec.Eta(),
-                              jetVec.Phi());
-        }
-        if (deltaLep > deltaR(event.zPairLeptons.second.Eta(),
-                              event.zPairLeptons.second.Phi(),
-                              jetVec.Eta(),
-                              jetVec.Phi()))
-        {
-            deltaLep = deltaR(event.zPairLeptons.second.Eta(),
-                              event.zPairLeptons.second.Phi(),
-                              jetVec.Eta(),
-                              jetVec.Phi());
-        }
+        const double deltaLep{
+            std::min(ObjectSelection::deltaR(event.zPairLeptons.first.Eta(),
+                                             event.zPairLeptons.first.Phi(),
+                                             jetVec.Eta(),
+                                             jetVec.Phi()),
+                     ObjectSelection::deltaR(event.zPairLeptons.second.Eta(),
+                                             event.zPairLeptons.second.Phi(),
+                                             jetVec.Eta(),
+                                             jetVec.Phi()))};
         if (deltaLep < 0.4)
         {
             continue; // Only start rejecting things when actually making the
                       // jet cuts!
         }
 
-        jets.emplace_back(i);
+        jets.push_back({i, jetVec});
     }
+    return jets;
+}
 
+bool TriggerScaleFactors::makeJetCuts(const AnalysisEvent& event,
+                                      const std::vector<Jet>& jets) const
+{
     if (jets.size() > 6)
     {
         return false;
@@ -1605,20 +1095,19 @@ bool TriggerScaleFactors::makeJetCuts(AnalysisEvent& event,
     if (bCuts_)
     {
         std::vector<int> bJets;
-        for (unsigned int i = 0; i != jets.size(); i++)
+        for (const Jet& jet : jets)
         {
-            TLorentzVector jetVec{getJetLVec(event, i, isMC)};
             if (event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
-                    [jets[i]]
+                    [jet.index]
                 <= 0.8484)
             {
                 continue;
             }
-            if (jetVec.Eta() >= 2.40)
+            if (jet.vec.Eta() >= 2.40)
             {
                 continue;
             }
-            bJets.emplace_back(i);
+            bJets.emplace_back(jet.index);
         }
         if (bJets.size() > 2)
         {
@@ -1641,7 +1130,6 @@ TLorentzVector TriggerScaleFactors::getJetLVec(AnalysisEvent& event,
     float newSmearValue{1.0};
     if (!isMC_)
     {
-        event.jetSmearValue.emplace_back(newSmearValue);
         returnJet.SetPxPyPzE(event.jetPF2PATPx[index],
                              event.jetPF2PATPy[index],
                              event.jetPF2PATPz[index],
@@ -1719,10 +1207,10 @@ TLorentzVector TriggerScaleFactors::getJetLVec(AnalysisEvent& event,
         jerSigma = 0.029;
     }
 
-    double dR = deltaR(event.genJetPF2PATEta[index],
-                       event.genJetPF2PATPhi[index],
-                       event.jetPF2PATEta[index],
-                       event.jetPF2PATPhi[index]);
+    double dR = ObjectSelection::deltaR(event.genJetPF2PATEta[index],
+                                        event.genJetPF2PATPhi[index],
+                                        event.jetPF2PATEta[index],
+                                        event.jetPF2PATPhi[index]);
     double min_dR = std::numeric_limits<double>::infinity();
     double dPt = event.jetPF2PATPtRaw[index] - event.genJetPF2PATPT[index];
 
@@ -1754,7 +1242,14 @@ TLorentzVector TriggerScaleFactors::getJetLVec(AnalysisEvent& event,
         { // If not matched to a gen jet, randomly smear
             double sigma = jerSigma * std::sqrt(jerSF * jerSF - 1.0);
             std::normal_distribution<> d(0, sigma);
-            std::mt19937 gen(rand());
+            // Seed with the jet properties, as in Cuts, so that each jet is
+            // smeared the same way whichever thread processes it
+            size_t seed{0};
+            boost::hash_combine(seed, event.jetPF2PATPtRaw[index]);
+            boost::hash_combine(seed, event.jetPF2PATEta[index]);
+            boost::hash_combine(seed, event.jetPF2PATPhi[index]);
+            boost::hash_combine(seed, event.eventNum);
+            std::mt19937 gen(seed);
             newSmearValue = 1.0 + d(gen);
             returnJet.SetPxPyPzE(event.jetPF2PATPx[index],
                                  event.jetPF2PATPy[index],
@@ -1785,23 +1280,6 @@ TLorentzVector TriggerScaleFactors::getJetLVec(AnalysisEvent& event,
     return returnJet;
 }
 
-double TriggerScaleFactors::deltaR(const float eta1,
-                                   const float phi1,
-                                   const float eta2,
-                                   const float phi2) const
-{
-    double dEta{eta1 - eta2};
-    double dPhi{phi1 - phi2};
-    while (std::abs(dPhi) > M_PI)
-    {
-        dPhi += (dPhi > 0. ? -2 * M_PI : 2 * M_PI);
-    }
-    //  if(singleEventInfoDump_)  std::cout << eta1 << " " << eta2 << " phi " <<
-    //  phi1 << " " << phi2 << " ds: " << eta1-eta2 << " " << phi1-phi2 << " dR:
-    //  " << std::sqrt((dEta*dEta)+(dPhi*dPhi)) << std::endl;
-    return std::sqrt((dEta * dEta) + (dPhi * dPhi));
-}
-
 void TriggerScaleFactors::savePlots()
 {
     double level = 0.60; // ClopperPearson interval level
@@ -1810,699 +1288,182 @@ void TriggerScaleFactors::savePlots()
     TFile* outFile{
         new TFile{(outFolder + "triggerPlots.root").c_str(), "RECREATE"}};
 
-    // Do pT errors
-    for (Int_t bin = 1; bin != numPt_bins + 1; bin++)
-    {
-        double errUp, errDown, error;
-
-        // electrons MC
-        // ele 1 pT MC
-        errUp = (p_electron1_pT_MC->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_electron1_pT_MC->GetBinEntries(bin),
-                       p_electron1_pT_MC->GetBinEntries(bin)
-                           * p_electron1_pT_MC->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_electron1_pT_MC->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_electron1_pT_MC->GetBinEntries(bin),
-                         p_electron1_pT_MC->GetBinEntries(bin)
-                             * p_electron1_pT_MC->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_electron1_pT_MC->SetBinError(bin, error);
-        // ele 2 pT MC
-        errUp = (p_electron2_pT_MC->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_electron2_pT_MC->GetBinEntries(bin),
-                       p_electron2_pT_MC->GetBinEntries(bin)
-                           * p_electron2_pT_MC->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_electron2_pT_MC->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_electron2_pT_MC->GetBinEntries(bin),
-                         p_electron2_pT_MC->GetBinEntries(bin)
-                             * p_electron2_pT_MC->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_electron2_pT_MC->SetBinError(bin, error);
-
-        // muons MC
-        // muon 1 pT MC
-        errUp = (p_muon1_pT_MC->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muon1_pT_MC->GetBinEntries(bin),
-                       p_muon1_pT_MC->GetBinEntries(bin)
-                           * p_muon1_pT_MC->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muon1_pT_MC->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muon1_pT_MC->GetBinEntries(bin),
-                         p_muon1_pT_MC->GetBinEntries(bin)
-                             * p_muon1_pT_MC->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muon1_pT_MC->SetBinError(bin, error);
-        // muon 2 pT MC
-        errUp = (p_muon2_pT_MC->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muon2_pT_MC->GetBinEntries(bin),
-                       p_muon2_pT_MC->GetBinEntries(bin)
-                           * p_muon2_pT_MC->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muon2_pT_MC->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muon2_pT_MC->GetBinEntries(bin),
-                         p_muon2_pT_MC->GetBinEntries(bin)
-                             * p_muon2_pT_MC->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muon2_pT_MC->SetBinError(bin, error);
-
-        // muonEG MC
-        // muonEG 1 pT MC
-        errUp = (p_muonElectron1_pT_MC->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muonElectron1_pT_MC->GetBinEntries(bin),
-                       p_muonElectron1_pT_MC->GetBinEntries(bin)
-                           * p_muonElectron1_pT_MC->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muonElectron1_pT_MC->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muonElectron1_pT_MC->GetBinEntries(bin),
-                         p_muonElectron1_pT_MC->GetBinEntries(bin)
-                             * p_muonElectron1_pT_MC->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muonElectron1_pT_MC->SetBinError(bin, error);
-        // muonEG 2 pT MC
-        errUp = (p_muonElectron2_pT_MC->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muonElectron2_pT_MC->GetBinEntries(bin),
-                       p_muonElectron2_pT_MC->GetBinEntries(bin)
-                           * p_muonElectron2_pT_MC->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muonElectron2_pT_MC->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muonElectron2_pT_MC->GetBinEntries(bin),
-                         p_muonElectron2_pT_MC->GetBinEntries(bin)
-                             * p_muonElectron2_pT_MC->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muonElectron2_pT_MC->SetBinError(bin, error);
-
-        // electrons data
-        // ele 1 pT data
-        errUp = (p_electron1_pT_data->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_electron1_pT_data->GetBinEntries(bin),
-                       p_electron1_pT_data->GetBinEntries(bin)
-                           * p_electron1_pT_data->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_electron1_pT_data->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_electron1_pT_data->GetBinEntries(bin),
-                         p_electron1_pT_data->GetBinEntries(bin)
-                             * p_electron1_pT_data->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_electron1_pT_data->SetBinError(bin, error);
-        // ele 2 pT data
-        errUp = (p_electron2_pT_data->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_electron2_pT_data->GetBinEntries(bin),
-                       p_electron2_pT_data->GetBinEntries(bin)
-                           * p_electron2_pT_data->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_electron2_pT_data->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_electron2_pT_data->GetBinEntries(bin),
-                         p_electron2_pT_data->GetBinEntries(bin)
-                             * p_electron2_pT_data->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_electron2_pT_data->SetBinError(bin, error);
-
-        // muons data
-        // muon 1 pT data
-        errUp = (p_muon1_pT_data->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muon1_pT_data->GetBinEntries(bin),
-                       p_muon1_pT_data->GetBinEntries(bin)
-                           * p_muon1_pT_data->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muon1_pT_data->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muon1_pT_data->GetBinEntries(bin),
-                         p_muon1_pT_data->GetBinEntries(bin)
-                             * p_muon1_pT_data->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muon1_pT_data->SetBinError(bin, error);
-        // muon 2 pT data
-        errUp = (p_muon2_pT_data->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muon2_pT_data->GetBinEntries(bin),
-                       p_muon2_pT_data->GetBinEntries(bin)
-                           * p_muon2_pT_data->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muon2_pT_data->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muon2_pT_data->GetBinEntries(bin),
-                         p_muon2_pT_data->GetBinEntries(bin)
-                             * p_muon2_pT_data->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muon2_pT_data->SetBinError(bin, error);
-
-        // muonEG data
-        // muonEG 1 pT data
-        errUp = (p_muonElectron1_pT_data->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muonElectron1_pT_data->GetBinEntries(bin),
-                       p_muonElectron1_pT_data->GetBinEntries(bin)
-                           * p_muonElectron1_pT_data->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muonElectron1_pT_data->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muonElectron1_pT_data->GetBinEntries(bin),
-                         p_muonElectron1_pT_data->GetBinEntries(bin)
-                             * p_muonElectron1_pT_data->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muonElectron1_pT_data->SetBinError(bin, error);
-        // muonEG 2 pT data
-        errUp = (p_muonElectron2_pT_data->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muonElectron2_pT_data->GetBinEntries(bin),
-                       p_muonElectron2_pT_data->GetBinEntries(bin)
-                           * p_muonElectron2_pT_data->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muonElectron2_pT_data->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muonElectron2_pT_data->GetBinEntries(bin),
-                         p_muonElectron2_pT_data->GetBinEntries(bin)
-                             * p_muonElectron2_pT_data->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muonElectron2_pT_data->SetBinError(bin, error);
-    }
-
-    // Do eta errors
-    for (Int_t bin = 1; bin != numEta_bins + 1; bin++)
-    {
-        double errUp, errDown, error;
-
-        // electrons MC
-        // ele 1 eta MC
-        errUp = (p_electron1_eta_MC->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_electron1_eta_MC->GetBinEntries(bin),
-                       p_electron1_eta_MC->GetBinEntries(bin)
-                           * p_electron1_eta_MC->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_electron1_eta_MC->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_electron1_eta_MC->GetBinEntries(bin),
-                         p_electron1_eta_MC->GetBinEntries(bin)
-                             * p_electron1_eta_MC->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_electron1_eta_MC->SetBinError(bin, error);
-        // ele 2 eta MC
-        errUp = (p_electron2_eta_MC->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_electron2_eta_MC->GetBinEntries(bin),
-                       p_electron2_eta_MC->GetBinEntries(bin)
-                           * p_electron2_eta_MC->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_electron2_eta_MC->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_electron2_eta_MC->GetBinEntries(bin),
-                         p_electron2_eta_MC->GetBinEntries(bin)
-                             * p_electron2_eta_MC->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_electron2_eta_MC->SetBinError(bin, error);
-
-        // muons MC
-        // muon 1 eta MC
-        errUp = (p_muon1_eta_MC->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muon1_eta_MC->GetBinEntries(bin),
-                       p_muon1_eta_MC->GetBinEntries(bin)
-                           * p_muon1_eta_MC->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muon1_eta_MC->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muon1_eta_MC->GetBinEntries(bin),
-                         p_muon1_eta_MC->GetBinEntries(bin)
-                             * p_muon1_eta_MC->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muon1_eta_MC->SetBinError(bin, error);
-        // muon 2 eta MC
-        errUp = (p_muon2_eta_MC->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muon2_eta_MC->GetBinEntries(bin),
-                       p_muon2_eta_MC->GetBinEntries(bin)
-                           * p_muon2_eta_MC->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muon2_eta_MC->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muon2_eta_MC->GetBinEntries(bin),
-                         p_muon2_eta_MC->GetBinEntries(bin)
-                             * p_muon2_eta_MC->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muon2_eta_MC->SetBinError(bin, error);
-
-        // muonEG MC
-        // muonEG 1 eta MC
-        errUp = (p_muonElectron1_eta_MC->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muonElectron1_eta_MC->GetBinEntries(bin),
-                       p_muonElectron1_eta_MC->GetBinEntries(bin)
-                           * p_muonElectron1_eta_MC->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muonElectron1_eta_MC->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muonElectron1_eta_MC->GetBinEntries(bin),
-                         p_muonElectron1_eta_MC->GetBinEntries(bin)
-                             * p_muonElectron1_eta_MC->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muonElectron1_eta_MC->SetBinError(bin, error);
-        // muonEG 2 eta MC
-        errUp = (p_muonElectron2_eta_MC->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muonElectron2_eta_MC->GetBinEntries(bin),
-                       p_muonElectron2_eta_MC->GetBinEntries(bin)
-                           * p_muonElectron2_eta_MC->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muonElectron2_eta_MC->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muonElectron2_eta_MC->GetBinEntries(bin),
-                         p_muonElectron2_eta_MC->GetBinEntries(bin)
-                             * p_muonElectron2_eta_MC->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muonElectron2_eta_MC->SetBinError(bin, error);
-
-        // electrons data
-        // ele 1 eta data
-        errUp = (p_electron1_eta_data->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_electron1_eta_data->GetBinEntries(bin),
-                       p_electron1_eta_data->GetBinEntries(bin)
-                           * p_electron1_eta_data->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_electron1_eta_data->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_electron1_eta_data->GetBinEntries(bin),
-                         p_electron1_eta_data->GetBinEntries(bin)
-                             * p_electron1_eta_data->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_electron1_eta_data->SetBinError(bin, error);
-        // ele 2 eta data
-        errUp = (p_electron2_eta_data->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_electron2_eta_data->GetBinEntries(bin),
-                       p_electron2_eta_data->GetBinEntries(bin)
-                           * p_electron2_eta_data->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_electron2_eta_data->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_electron2_eta_data->GetBinEntries(bin),
-                         p_electron2_eta_data->GetBinEntries(bin)
-                             * p_electron2_eta_data->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_electron2_eta_data->SetBinError(bin, error);
-
-        // muons data
-        // muon 1 eta data
-        errUp = (p_muon1_eta_data->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muon1_eta_data->GetBinEntries(bin),
-                       p_muon1_eta_data->GetBinEntries(bin)
-                           * p_muon1_eta_data->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muon1_eta_data->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muon1_eta_data->GetBinEntries(bin),
-                         p_muon1_eta_data->GetBinEntries(bin)
-                             * p_muon1_eta_data->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muon1_eta_data->SetBinError(bin, error);
-        // muon 2 eta data
-        errUp = (p_muon2_eta_data->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muon2_eta_data->GetBinEntries(bin),
-                       p_muon2_eta_data->GetBinEntries(bin)
-                           * p_muon2_eta_data->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muon2_eta_data->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muon2_eta_data->GetBinEntries(bin),
-                         p_muon2_eta_data->GetBinEntries(bin)
-                             * p_muon2_eta_data->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muon2_eta_data->SetBinError(bin, error);
-
-        // muonEG data
-        // muonEG 1 eta data
-        errUp = (p_muonElectron1_eta_data->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muonElectron1_eta_data->GetBinEntries(bin),
-                       p_muonElectron1_eta_data->GetBinEntries(bin)
-                           * p_muonElectron1_eta_data->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muonElectron1_eta_data->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muonElectron1_eta_data->GetBinEntries(bin),
-                         p_muonElectron1_eta_data->GetBinEntries(bin)
-                             * p_muonElectron1_eta_data->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muonElectron1_eta_data->SetBinError(bin, error);
-        // muonEG 2 eta data
-        errUp = (p_muonElectron2_eta_data->GetBinContent(bin)
-                 - TEfficiency::ClopperPearson(
-                       p_muonElectron2_eta_data->GetBinEntries(bin),
-                       p_muonElectron2_eta_data->GetBinEntries(bin)
-                           * p_muonElectron2_eta_data->GetBinContent(bin),
-                       level,
-                       true));
-        errDown = (p_muonElectron2_eta_data->GetBinContent(bin)
-                   - TEfficiency::ClopperPearson(
-                         p_muonElectron2_eta_data->GetBinEntries(bin),
-                         p_muonElectron2_eta_data->GetBinEntries(bin)
-                             * p_muonElectron2_eta_data->GetBinContent(bin),
-                         level,
-                         false));
-        error = errUp > errDown ? errUp : errDown;
-        p_muonElectron2_eta_data->SetBinError(bin, error);
+    // Turn on curves, leading pT, leading eta, subleading pT and subleading
+    // eta, with Clopper-Pearson errors. MC first, then data.
+    const bool samples[]{true, false};
+    std::vector<std::unique_ptr<TProfile>> turnOns[2][3];
+    std::vector<std::unique_ptr<TProfile2D>> sfInputs[2][3];
+    for (int sample{0}; sample < 2; sample++)
+    {
+        for (int channel{0}; channel < TriggerEfficiencies::numChannels;
+             channel++)
+        {
+            const ChannelEfficiency& efficiency{efficiencies_.get(
+                samples[sample],
+                static_cast<TriggerEfficiencies::Channel>(channel))};
+            turnOns[sample][channel].emplace_back(
+                efficiency.lepton1Pt.profile(level));
+            turnOns[sample][channel].emplace_back(
+                efficiency.lepton1Eta.profile(level));
+            turnOns[sample][channel].emplace_back(
+                efficiency.lepton2Pt.profile(level));
+            turnOns[sample][channel].emplace_back(
+                efficiency.lepton2Eta.profile(level));
+            sfInputs[sample][channel].emplace_back(
+                efficiency.leptonsPt.profile2D());
+            sfInputs[sample][channel].emplace_back(
+                efficiency.leptonsEta.profile2D());
+        }
     }
 
     // Turn on curves ratio histos
-    TProfile* p_electron1_pT_data_MC = dynamic_cast<TProfile*>(
-        p_electron1_pT_data->Clone("p_electron1_pT_data_MC"));
-    p_electron1_pT_data_MC->Divide(p_electron1_pT_MC);
-
-    TProfile* p_electron1_eta_data_MC = dynamic_cast<TProfile*>(
-        p_electron1_eta_data->Clone("p_electron1_eta_data_MC"));
-    p_electron1_eta_data_MC->Divide(p_electron1_eta_MC);
-
-    TProfile* p_electron2_pT_data_MC = dynamic_cast<TProfile*>(
-        p_electron2_pT_data->Clone("p_electron2_pT_data_MC"));
-    p_electron2_pT_data_MC->Divide(p_electron2_pT_MC);
-
-    TProfile* p_electron2_eta_data_MC = dynamic_cast<TProfile*>(
-        p_electron2_eta_data->Clone("p_electron2_eta_data_MC"));
-    p_electron2_eta_data_MC->Divide(p_electron2_eta_MC);
-
-    TProfile* p_muon1_pT_data_MC =
-        dynamic_cast<TProfile*>(p_muon1_pT_data->Clone("p_muon1_pT_data_MC"));
-    p_muon1_pT_data_MC->Divide(p_muon1_pT_MC);
-
-    TProfile* p_muon1_eta_data_MC =
-        dynamic_cast<TProfile*>(p_muon1_eta_data->Clone("p_muon1_eta_data_MC"));
-    p_muon1_eta_data_MC->Divide(p_muon1_eta_MC);
-
-    TProfile* p_muon2_pT_data_MC =
-        dynamic_cast<TProfile*>(p_muon2_pT_data->Clone("p_muon2_pT_data_MC"));
-    p_muon2_pT_data_MC->Divide(p_muon2_pT_MC);
-
-    TProfile* p_muon2_eta_data_MC =
-        dynamic_cast<TProfile*>(p_muon2_eta_data->Clone("p_muon2_eta_data_MC"));
-    p_muon2_eta_data_MC->Divide(p_muon2_eta_MC);
-
-    TProfile* p_muonElectron1_pT_data_MC = dynamic_cast<TProfile*>(
-        p_muonElectron1_pT_data->Clone("p_muonElectron1_pT_data_MC"));
-    p_muonElectron1_pT_data_MC->Divide(p_muonElectron1_pT_MC);
-
-    TProfile* p_muonElectron1_eta_data_MC = dynamic_cast<TProfile*>(
-        p_muonElectron1_eta_data->Clone("p_muonElectron1_eta_data_MC"));
-    p_muonElectron1_eta_data_MC->Divide(p_muonElectron1_eta_MC);
-
-    TProfile* p_muonElectron2_pT_data_MC = dynamic_cast<TProfile*>(
-        p_muonElectron2_pT_data->Clone("p_muonElectron2_pt_data_MC"));
-    p_muonElectron2_pT_data_MC->Divide(p_muonElectron2_pT_MC);
-
-    TProfile* p_muonElectron2_eta_data_MC = dynamic_cast<TProfile*>(
-        p_muonElectron2_eta_data->Clone("p_muonElectron2_eta_data_MC"));
-    p_muonElectron2_eta_data_MC->Divide(p_muonElectron2_eta_MC);
+    const std::string variables[]{"1_pT", "1_eta", "2_pT", "2_eta"};
+    std::vector<std::unique_ptr<TProfile>> ratios;
+    for (int channel{0}; channel < TriggerEfficiencies::numChannels; channel++)
+    {
+        for (size_t variable{0}; variable < 4; variable++)
+        {
+            std::string name{"p_" + TriggerEfficiencies::names[channel]
+                             + variables[variable] + "_data_MC"};
+            // Kept for compatibility with anything reading the old output
+            if (name == "p_muonElectron2_pT_data_MC")
+            {
+                name = "p_muonElectron2_pt_data_MC";
+            }
+            ratios.emplace_back(dynamic_cast<TProfile*>(
+                turnOns[1][channel][variable]->Clone(name.c_str())));
+            ratios.back()->SetDirectory(nullptr);
+            ratios.back()->Divide(turnOns[0][channel][variable].get());
+        }
+    }
 
     // SF histos
+    std::vector<std::unique_ptr<TProfile2D>> sfs;
+    for (int channel{0}; channel < TriggerEfficiencies::numChannels; channel++)
+    {
+        for (size_t index{0}; index < 2; index++)
+        {
+            const std::string name{TriggerEfficiencies::names[channel]
+                                   + (index == 0 ? "PtSF" : "EtaSF")};
+            sfs.emplace_back(dynamic_cast<TProfile2D*>(
+                sfInputs[1][channel][index]->Clone(name.c_str())));
+            sfs.back()->SetDirectory(nullptr);
+            sfs.back()->Divide(sfInputs[0][channel][index].get());
+        }
+    }
 
-    TProfile2D* electronPtSF =
-        dynamic_cast<TProfile2D*>(p_electrons_pT_data->Clone("electronPtSF"));
-    electronPtSF->Divide(p_electrons_pT_MC);
-
-    TProfile2D* electronEtaSF =
-        dynamic_cast<TProfile2D*>(p_electrons_eta_data->Clone("electronEtaSF"));
-    electronEtaSF->Divide(p_electrons_eta_MC);
-
-    TProfile2D* muonPtSF =
-        dynamic_cast<TProfile2D*>(p_muons_pT_data->Clone("muonPtSF"));
-    muonPtSF->Divide(p_muons_pT_MC);
-
-    TProfile2D* muonEtaSF =
-        dynamic_cast<TProfile2D*>(p_muons_eta_data->Clone("muonEtaSF"));
-    muonEtaSF->Divide(p_muons_eta_MC);
-
-    TProfile2D* muonElectronPtSF = dynamic_cast<TProfile2D*>(
-        p_muonElectrons_pT_data->Clone("muonElectronPtSF"));
-    muonElectronPtSF->Divide(p_muonElectrons_pT_MC);
+    // Write Histos
 
-    TProfile2D* muonElectronEtaSF = dynamic_cast<TProfile2D*>(
-        p_muonElectrons_eta_data->Clone("muonElectronEtaSF"));
-    muonElectronEtaSF->Divide(p_muonElectrons_eta_MC);
+    for (int sample{0}; sample < 2; sample++)
+    {
+        for (const auto& channel : turnOns[sample])
+        {
+            for (const auto& profile : channel)
+            {
+                profile->Write();
+            }
+        }
+    }
+    for (int sample{0}; sample < 2; sample++)
+    {
+        for (const auto& channel : sfInputs[sample])
+        {
+            for (const auto& profile : channel)
+            {
+                profile->Write();
+            }
+        }
+    }
+    for (const auto& ratio : ratios)
+    {
+        ratio->Write();
+    }
+    for (const auto& sf : sfs)
+    {
+        sf->Write();
+    }
 
-    // Write Histos
+    // The efficiencies in each binning from the binnings file
+    if (!binnings_.empty())
+    {
+        outFile->mkdir("efficiencies")->cd();
+        for (const bool isMC : samples)
+        {
+            for (int channel{0}; channel < TriggerEfficiencies::numChannels;
+                 channel++)
+            {
+                const ChannelEfficiency& efficiency{efficiencies_.get(
+                    isMC, static_cast<TriggerEfficiencies::Channel>(channel))};
+                for (const auto& binned : efficiency.binned)
+                {
+                    binned.efficiency(level)->Write();
+                }
+            }
+        }
+        outFile->cd();
+    }
 
-    p_electron1_pT_MC->Write();
-    p_electron1_eta_MC->Write();
-    p_electron2_pT_MC->Write();
-    p_electron2_eta_MC->Write();
-    p_muon1_pT_MC->Write();
-    p_muon1_eta_MC->Write();
-    p_muon2_pT_MC->Write();
-    p_muon2_eta_MC->Write();
-    p_muonElectron1_pT_MC->Write();
-    p_muonElectron1_eta_MC->Write();
-    p_muonElectron2_pT_MC->Write();
-    p_muonElectron2_eta_MC->Write();
-
-    p_electron1_pT_data->Write();
-    p_electron1_eta_data->Write();
-    p_electron2_pT_data->Write();
-    p_electron2_eta_data->Write();
-    p_muon1_pT_data->Write();
-    p_muon1_eta_data->Write();
-    p_muon2_pT_data->Write();
-    p_muon2_eta_data->Write();
-    p_muonElectron1_pT_data->Write();
-    p_muonElectron1_eta_data->Write();
-    p_muonElectron2_pT_data->Write();
-    p_muonElectron2_eta_data->Write();
-
-    p_electrons_pT_MC->Write();
-    p_electrons_eta_MC->Write();
-    p_muons_pT_MC->Write();
-    p_muons_eta_MC->Write();
-    p_muonElectrons_pT_MC->Write();
-    p_muonElectrons_eta_MC->Write();
-
-    p_electrons_pT_data->Write();
-    p_electrons_eta_data->Write();
-    p_muons_pT_data->Write();
-    p_muons_eta_data->Write();
-    p_muonElectrons_pT_data->Write();
-    p_muonElectrons_eta_data->Write();
-
-    p_electron1_pT_data_MC->Write();
-    p_electron1_eta_data_MC->Write();
-    p_electron2_pT_data_MC->Write();
-    p_electron2_eta_data_MC->Write();
-
-    p_muon1_pT_data_MC->Write();
-    p_muon1_eta_data_MC->Write();
-    p_muon2_pT_data_MC->Write();
-    p_muon2_eta_data_MC->Write();
-
-    p_muonElectron1_pT_data_MC->Write();
-    p_muonElectron1_eta_data_MC->Write();
-    p_muonElectron2_pT_data_MC->Write();
-    p_muonElectron2_eta_data_MC->Write();
-
-    electronPtSF->Write();
-    electronEtaSF->Write();
-    muonPtSF->Write();
-    muonEtaSF->Write();
-    muonElectronPtSF->Write();
-    muonElectronEtaSF->Write();
-
-    TCanvas* lCanvasEle1PtEff =
-        new TCanvas("lCanvasEle1PtEff", "lCanvasEle1PtEff");
-    lCanvasEle1PtEff->cd(1);
-    p_electron1_pT_data->SetStats(false);
-    p_electron1_pT_data->Draw();
-    p_electron1_pT_data->SetLineColor(kBlue);
-    p_electron1_pT_MC->SetStats(false);
-    p_electron1_pT_MC->Draw("same");
-    p_electron1_pT_MC->SetLineColor(kRed);
-    lCanvasEle1PtEff->Write();
-
-    TCanvas* lCanvasEle2PtEff =
-        new TCanvas("lCanvasEle2PtEff", "lCanvasEle2PtEff");
-    lCanvasEle2PtEff->cd(1);
-    p_electron2_pT_data->SetStats(false);
-    p_electron2_pT_data->Draw();
-    p_electron2_pT_data->SetLineColor(kBlue);
-    p_electron2_pT_MC->SetStats(false);
-    p_electron2_pT_MC->Draw("same");
-    p_electron2_pT_MC->SetLineColor(kRed);
-    lCanvasEle2PtEff->Write();
-
-    TCanvas* lCanvasEle1EtaEff =
-        new TCanvas("lCanvasEle1EtaEff", "lCanvasEle1EtaEff");
-    lCanvasEle1EtaEff->cd(1);
-    p_electron1_eta_data->SetStats(false);
-    p_electron1_eta_data->Draw();
-    p_electron1_eta_data->SetLineColor(kBlue);
-    p_electron1_eta_MC->SetStats(false);
-    p_electron1_eta_MC->Draw("same");
-    p_electron1_eta_MC->SetLineColor(kRed);
-    lCanvasEle1EtaEff->Write();
-
-    TCanvas* lCanvasEle2EtaEff =
-        new TCanvas("lCanvasEle2EtaEff", "lCanvasEle2EtaEff");
-    lCanvasEle2EtaEff->cd(1);
-    p_electron2_eta_data->SetStats(false);
-    p_electron2_eta_data->Draw();
-    p_electron2_eta_data->SetLineColor(kBlue);
-    p_electron2_eta_MC->SetStats(false);
-    p_electron2_eta_MC->Draw("same");
-    p_electron2_eta_MC->SetLineColor(kRed);
-    lCanvasEle2EtaEff->Write();
-
-    TCanvas* lCanvasMuon1PtEff =
-        new TCanvas("lCanvasMuon1PtEff", "lCanvasMuon1PtEff");
-    lCanvasMuon1PtEff->cd(1);
-    p_muon1_pT_data->SetStats(false);
-    p_muon1_pT_data->Draw();
-    p_muon1_pT_data->SetLineColor(kBlue);
-    p_muon1_pT_MC->SetStats(false);
-    p_muon1_pT_MC->Draw("same");
-    p_muon1_pT_MC->SetLineColor(kRed);
-    lCanvasMuon1PtEff->Write();
-
-    TCanvas* lCanvasMuon2PtEff =
-        new TCanvas("lCanvasMuon2PtEff", "lCanvasMuon2PtEff");
-    lCanvasMuon2PtEff->cd(1);
-    p_muon2_pT_data->SetStats(false);
-    p_muon2_pT_data->Draw();
-    p_muon2_pT_data->SetLineColor(kBlue);
-    p_muon2_pT_MC->SetStats(false);
-    p_muon2_pT_MC->Draw("same");
-    p_muon2_pT_MC->SetLineColor(kRed);
-    lCanvasMuon2PtEff->Write();
-
-    TCanvas* lCanvasMuon1EtaEff =
-        new TCanvas("lCanvasMuon1EtaEff", "lCanvasMuon1EtaEff");
-    lCanvasMuon1EtaEff->cd(1);
-    p_muon1_eta_data->SetStats(false);
-    p_muon1_eta_data->Draw();
-    p_muon1_eta_data->SetLineColor(kBlue);
-    p_muon1_eta_MC->SetStats(false);
-    p_muon1_eta_MC->Draw("same");
-    p_muon1_eta_MC->SetLineColor(kRed);
-    lCanvasMuon1EtaEff->Write();
-
-    TCanvas* lCanvasMuon2EtaEff =
-        new TCanvas("lCanvasMuon2EtaEff", "lCanvasMuon2EtaEff");
-    lCanvasMuon2EtaEff->cd(1);
-    p_muon2_eta_data->SetStats(false);
-    p_muon2_eta_data->Draw();
-    p_muon2_eta_data->SetLineColor(kBlue);
-    p_muon1_eta_MC->SetStats(false);
-    p_muon2_eta_MC->Draw("same");
-    p_muon2_eta_MC->SetLineColor(kRed);
-    lCanvasMuon2EtaEff->Write();
+    // Data in blue over MC in red, for the electron and muon channels
+    const std::pair<TriggerEfficiencies::Channel, std::string> canvasChannels[]{
+        {TriggerEfficiencies::electrons, "Ele"},
+        {TriggerEfficiencies::muons, "Muon"}};
+    for (const auto& [channel, label] : canvasChannels)
+    {
+        for (const size_t variable : {0, 2, 1, 3})
+        {
+            const std::string name{"lCanvas" + label
+                                   + std::to_string(variable / 2 + 1)
+                                   + (variable % 2 == 0 ? "Pt" : "Eta")
+                                   + "Eff"};
+            TCanvas canvas{name.c_str(), name.c_str()};
+            canvas.cd(1);
+            TProfile* data{turnOns[1][channel][variable].get()};
+            TProfile* mc{turnOns[0][channel][variable].get()};
+            data->SetStats(false);
+            data->Draw();
+            data->SetLineColor(kBlue);
+            mc->SetStats(false);
+            mc->Draw("same");
+            mc->SetLineColor(kRed);
+            canvas.Write();
+        }
+    }
 
     outFile->Close();
 
+    const TriggerCounts& electronsMC{
+        efficiencies_.get(true, TriggerEfficiencies::electrons).counts};
+    const TriggerCounts& muonsMC{
+        efficiencies_.get(true, TriggerEfficiencies::muons).counts};
+    const TriggerCounts& muonElectronsMC{
+        efficiencies_.get(true, TriggerEfficiencies::muonElectrons).counts};
+    const TriggerCounts& electronsData{
+        efficiencies_.get(false, TriggerEfficiencies::electrons).counts};
+    const TriggerCounts& muonsData{
+        efficiencies_.get(false, TriggerEfficiencies::muons).counts};
+    const TriggerCounts& muonElectronsData{
+        efficiencies_.get(false, TriggerEfficiencies::muonElectrons).counts};
+
     // Calculate MC efficiency
 
     //// LeptonTriggers
     double doubleElectronEfficiencyMC =
-        numberTriggeredDoubleElectrons[0] / (numberPassedElectrons[0] + 1.0e-6);
+        electronsMC.triggered / (electronsMC.passed + 1.0e-6);
     double doubleMuonEfficiencyMC =
-        numberTriggeredDoubleMuons[0] / (numberPassedMuons[0] + 1.0e-6);
-    double muonElectronEfficiencyMC = numberTriggeredMuonElectrons[0]
-                                      / (numberPassedMuonElectrons[0] + 1.0e-6);
+        muonsMC.triggered / (muonsMC.passed + 1.0e-6);
+    double muonElectronEfficiencyMC = muonElectronsMC.triggered
+                                      / (muonElectronsMC.passed + 1.0e-6);
 
     // Calculate Data efficiency
 
     //// DoubleLeptonTriggers
     double doubleElectronEfficiencyData =
-        numberTriggeredDoubleElectrons[1] / (numberPassedElectrons[1] + 1.0e-6);
+        electronsData.triggered / (electronsData.passed + 1.0e-6);
     double doubleMuonEfficiencyData =
-        numberTriggeredDoubleMuons[1] / (numberPassedMuons[1] + 1.0e-6);
+        muonsData.triggered / (muonsData.passed + 1.0e-6);
     double muonElectronEfficiencyData =
-        numberTriggeredMuonElectrons[1]
-        / (numberPassedMuonElectrons[1] + 1.0e-6);
+        muonElectronsData.triggered
+        / (muonElectronsData.passed + 1.0e-6);
 
     // Calculate SF
 
@@ -2516,20 +1477,20 @@ void TriggerScaleFactors::savePlots()
 
     // Calculate alphas
     double alphaDoubleElectron =
-        ((numberSelectedDoubleElectronsTriggered[0]
-          / numberSelectedElectrons[0])
-         * (numberPassedElectrons[0] / numberSelectedElectrons[0]))
-        / (numberTriggeredDoubleElectrons[0] / numberSelectedElectrons[0]
+        ((electronsMC.selectedTriggered
+          / electronsMC.selected)
+         * (electronsMC.passed / electronsMC.selected))
+        / (electronsMC.triggered / electronsMC.selected
            + 1.0e-6);
     double alphaDoubleMuon =
-        ((numberSelectedDoubleMuonsTriggered[0] / numberSelectedMuons[0])
-         * (numberPassedMuons[0] / numberSelectedMuons[0]))
-        / (numberTriggeredDoubleMuons[0] / numberSelectedMuons[0] + 1.0e-6);
+        ((muonsMC.selectedTriggered / muonsMC.selected)
+         * (muonsMC.passed / muonsMC.selected))
+        / (muonsMC.triggered / muonsMC.selected + 1.0e-6);
     double alphaMuonElectron =
-        ((numberSelectedMuonElectronsTriggered[0]
-          / numberSelectedMuonElectrons[0])
-         * (numberPassedMuonElectrons[0] / numberSelectedMuonElectrons[0]))
-        / (numberTriggeredMuonElectrons[0] / numberSelectedMuonElectrons[0]
+        ((muonElectronsMC.selectedTriggered
+          / muonElectronsMC.selected)
+         * (muonElectronsMC.passed / muonElectronsMC.selected))
+        / (muonElectronsMC.triggered / muonElectronsMC.selected
            + 1.0e-6);
 
     // Calculate uncertainities
@@ -2538,72 +1499,72 @@ void TriggerScaleFactors::savePlots()
 
     double doubleElectronDataUpperUncert =
         doubleElectronEfficiencyData
-        - TEfficiency::ClopperPearson(numberPassedElectrons[1],
-                                      numberTriggeredDoubleElectrons[1],
+        - TEfficiency::ClopperPearson(electronsData.passed,
+                                      electronsData.triggered,
                                       level,
                                       true);
     double doubleElectronMcUpperUncert =
         doubleElectronEfficiencyMC
-        - TEfficiency::ClopperPearson(numberPassedElectrons[0],
-                                      numberTriggeredDoubleElectrons[0],
+        - TEfficiency::ClopperPearson(electronsMC.passed,
+                                      electronsMC.triggered,
                                       level,
                                       true);
     double doubleElectronDataLowerUncert =
         doubleElectronEfficiencyData
-        - TEfficiency::ClopperPearson(numberPassedElectrons[1],
-                                      numberTriggeredDoubleElectrons[1],
+        - TEfficiency::ClopperPearson(electronsData.passed,
+                                      electronsData.triggered,
                                       level,
                                       false);
     double doubleElectronMcLowerUncert =
         doubleElectronEfficiencyMC
-        - TEfficiency::ClopperPearson(numberPassedElectrons[0],
-                                      numberTriggeredDoubleElectrons[0],
+        - TEfficiency::ClopperPearson(electronsMC.passed,
+                                      electronsMC.triggered,
                                       level,
                                       false);
 
     double doubleMuonDataUpperUncert =
         doubleMuonEfficiencyData
         - TEfficiency::ClopperPearson(
-              numberPassedMuons[1], numberTriggeredDoubleMuons[1], level, true);
+              muonsData.passed, muonsData.triggered, level, true);
     double doubleMuonMcUpperUncert =
         doubleMuonEfficiencyMC
         - TEfficiency::ClopperPearson(
-              numberPassedMuons[0], numberTriggeredDoubleMuons[0], level, true);
+              muonsMC.passed, muonsMC.triggered, level, true);
     double doubleMuonDataLowerUncert =
         doubleMuonEfficiencyData
-        - TEfficiency::ClopperPearson(numberPassedMuons[1],
-                                      numberTriggeredDoubleMuons[1],
+        - TEfficiency::ClopperPearson(muonsData.passed,
+                                      muonsData.triggered,
                                       level,
                                       false);
     double doubleMuonMcLowerUncert =
         doubleMuonEfficiencyMC
-        - TEfficiency::ClopperPearson(numberPassedMuons[0],
-                                      numberTriggeredDoubleMuons[0],
+        - TEfficiency::ClopperPearson(muonsMC.passed,
+                                      muonsMC.triggered,
                                       level,
                                       false);
 
     double muonElectronDataUpperUncert =
         muonElectronEfficiencyData
-        - TEfficiency::ClopperPearson(numberPassedMuonElectrons[1],
-                                      numberTriggeredMuonElectrons[1],
+        - TEfficiency::ClopperPearson(muonElectronsData.passed,
+                                      muonElectronsData.triggered,
                                       level,
                                       true);
     double muonElectronMcUpperUncert =
         muonElectronEfficiencyMC
-        - TEfficiency::ClopperPearson(numberPassedMuonElectrons[0],
-                                      numberTriggeredMuonElectrons[0],
+        - TEfficiency::ClopperPearson(muonElectronsMC.passed,
+                                      muonElectronsMC.triggered,
                                       level,
                                       true);
     double muonElectronDataLowerUncert =
         muonElectronEfficiencyData
-        - TEfficiency::ClopperPearson(numberPassedMuonElectrons[1],
-                                      numberTriggeredMuonElectrons[1],
+        - TEfficiency::ClopperPearson(muonElectronsData.passed,
+                                      muonElectronsData.triggered,
                                       level,
                                       false);
     double muonElectronMcLowerUncert =
         muonElectronEfficiencyMC
-        - TEfficiency::ClopperPearson(numberPassedMuonElectrons[0],
-                                      numberTriggeredMuonElectrons[0],
+        - TEfficiency::ClopperPearson(muonElectronsMC.passed,
+                                      muonElectronsMC.triggered,
                                       level,
                                       false);
 
@@ -2669,21 +1630,21 @@ void TriggerScaleFactors::savePlots()
               << std::endl;
     std::cout << "Events passing lepton triggers, MET triggers, and lepton "
                  "selection:\n"
-              << "ee: " << numberTriggeredDoubleElectrons[0] << " (MC) / "
-              << numberTriggeredDoubleElectrons[1] << " (Data)" << '\n'
-              << "μμ: " << numberTriggeredDoubleMuons[0] << " (MC) / "
-              << numberTriggeredDoubleMuons[1] << " (Data)" << '\n'
-              << "eμ: " << numberTriggeredMuonElectrons[0] << " (MC) / "
-              << numberTriggeredMuonElectrons[1] << " (Data)" << '\n';
+              << "ee: " << electronsMC.triggered << " (MC) / "
+              << electronsData.triggered << " (Data)" << '\n'
+              << "μμ: " << muonsMC.triggered << " (MC) / "
+              << muonsData.triggered << " (Data)" << '\n'
+              << "eμ: " << muonElectronsMC.triggered << " (MC) / "
+              << muonElectronsData.triggered << " (Data)" << '\n';
     std::cout
         << "-----------------------------------------------------------\n";
     std::cout << "Events passing MET triggers and lepton selection:\n"
-              << "ee: " << numberPassedElectrons[0] << " (MC) / "
-              << numberPassedElectrons[1] << " (Data)" << '\n'
-              << "μμ: " << numberPassedMuons[0] << " (MC) / "
-              << numberPassedMuons[1] << " (Data)" << '\n'
-              << "eμ: " << numberPassedMuonElectrons[0] << " (MC) / "
-              << numberPassedMuonElectrons[1] << " (Data)" << '\n';
+              << "ee: " << electronsMC.passed << " (MC) / "
+              << electronsData.passed << " (Data)" << '\n'
+              << "μμ: " << muonsMC.passed << " (MC) / "
+              << muonsData.passed << " (Data)" << '\n'
+              << "eμ: " << muonElectronsMC.passed << " (MC) / "
+              << muonElectronsData.passed << " (Data)" << '\n';
     std::cout << "-----------------------------------------------------------"
               << std::endl;
     std::cout << "Double Electron data efficiency: "
@@ -0,0 +1,404 @@
+#include "TFile.h"
+#include "TROOT.h"
+#include "TTree.h"
+#include "columnarFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Sums the event weights in the MVA input trees (histofile_<sample>.root, as
+// written by makeMVAinputMain.exe, or <tree>.tqzcol beside it when written
+// with --format columnar) per channel, for the nominal tree and each
+// systematic, and prints the yields, their statistical errors and the shift
+// from each systematic. Replaces scripts/yieldCalculator.py.
+
+namespace
+{
+// Channel values written by MakeMvaInputs::fillTree, stored as whole floats
+const std::map<std::string, int> channelIds{{"mumu", 0}, {"ee", 1}, {"emu", 2}};
+
+const std::vector<std::string> defaultSysts{
+    "__trig__plus", "__trig__minus", "__jer__plus",    "__jer__minus",
+    "__jes__plus",  "__jes__minus",  "__pileup__plus", "__pileup__minus",
+    "__bTag__plus", "__bTag__minus", "__met__plus",    "__met__minus",
+    "__pdf__plus",  "__pdf__minus",  "__ME__plus",     "__ME__minus",
+    "__isr__plus",  "__isr__minus",  "__fsr__plus",    "__fsr__minus"};
+
+struct Yield
+{
+    bool found{false}; // Whether the tree exists
+    double sumW{0};
+    double sumW2{0};
+};
+
+// yields[syst][channel] for one sample
+typedef std::vector<std::vector<Yield>> SampleYields;
+
+SampleYields readSample(const std::string& path,
+                        const std::string& treePrefix,
+                        const std::vector<std::string>& systs,
+                        const std::vector<std::string>& channels)
+{
+    SampleYields yields(systs.size(), std::vector<Yield>(channels.size()));
+    std::vector<int> ids;
+    for (const auto& channel : channels)
+    {
+        ids.emplace_back(channelIds.at(channel));
+    }
+
+    const std::unique_ptr<TFile> inFile{TFile::Open(path.c_str(), "READ")};
+    if (!inFile || inFile->IsZombie())
+    {
+        throw std::runtime_error("Could not open " + path);
+    }
+    const std::string inputDir{
+        boost::filesystem::path{path}.parent_path().string() + '/'};
+
+    for (size_t syst{0}; syst < systs.size(); syst++)
+    {
+        const auto add{[&](const float channel, const float weight) {
+            const int channelId{static_cast<int>(channel)};
+            for (size_t chan{0}; chan < ids.size(); chan++)
+            {
+                if (channelId == ids[chan])
+                {
+                    yields[syst][chan].sumW += weight;
+                    yields[syst][chan].sumW2 += weight * weight;
+                }
+            }
+        }};
+
+        const std::string treeName{treePrefix + systs[syst]};
+        TTree* const tree{dynamic_cast<TTree*>(inFile->Get(treeName.c_str()))};
+        if (!tree)
+        {
+            const std::string columnarPath{inputDir + treeName + ".tqzcol"};
+            if (!boost::filesystem::exists(columnarPath))
+            {
+                continue; // e.g. data, which has no systematic trees
+            }
+
+            const ColumnarReader columnar{columnarPath};
+            const std::uint32_t channelColumn{columnar.columnIndex("Channel")};
+            const std::uint32_t weightColumn{
+                columnar.columnIndex("EvtWeight")};
+            for (auto& yield : yields[syst])
+            {
+                yield.found = true;
+            }
+            for (std::uint64_t group{0}; group < columnar.groups(); group++)
+            {
+                const float* const channel{
+                    columnar.column(group, channelColumn)};
+                const float* const weight{columnar.column(group, weightColumn)};
+                for (std::uint32_t i{0}; i < columnar.groupRows(group); i++)
+                {
+                    add(channel[i], weight[i]);
+                }
+            }
+            continue;
+        }
+
+        // Only the two columns needed are read
+        float channel;
+        float weight;
+        tree->SetBranchStatus("*", false);
+        tree->SetBranchStatus("Channel", true);
+        tree->SetBranchStatus("EvtWeight", true);
+        tree->SetBranchAddress("Channel", &channel);
+        tree->SetBranchAddress("EvtWeight", &weight);
+
+        for (auto& yield : yields[syst])
+        {
+            yield.found = true;
+        }
+        const long long numberOfEvents{tree->GetEntries()};
+        for (long long i{0}; i < numberOfEvents; i++)
+        {
+            tree->GetEntry(i);
+            add(channel, weight);
+        }
+        tree->ResetBranchAddresses();
+    }
+    return yields;
+}
+
+std::string latexEscape(const std::string& text)
+{
+    std::string escaped;
+    for (const char c : text)
+    {
+        if (c == '_' || c == '&' || c == '%' || c == '#')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string inputDir;
+    std::vector<std::string> samples;
+    std::vector<std::string> channels;
+    std::vector<std::string> systs;
+    std::string region;
+    unsigned jobs;
+    std::string csvPath;
+    std::string latexPath;
+
+    namespace po = boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()("help,h", "Print this message.")(
+        "inputDir,i",
+        po::value<std::string>(&inputDir)->required(),
+        "MVA inputs directory, containing the histofile_<sample>.root files.")(
+        "samples,s",
+        po::value<std::vector<std::string>>(&samples)->multitoken(),
+        "Samples to run over, e.g. TZQ (default all in the input directory).")(
+        "channels,c",
+        po::value<std::vector<std::string>>(&channels)
+            ->multitoken()
+            ->default_value({"ee", "mumu"}, "ee mumu"),
+        "Channels: any of ee, mumu and emu.")(
+        "systs",
+        po::value<std::vector<std::string>>(&systs)->multitoken()->default_value(
+            defaultSysts, "all"),
+        "Systematics to compare to the nominal yield. Those without a tree "
+        "in a sample are skipped.")(
+        "region,r",
+        po::value<std::string>(&region),
+        "Tree region prefix when made with --sideband: sig or ctrl.")(
+        "jobs,j",
+        po::value<unsigned>(&jobs)->default_value(
+            std::thread::hardware_concurrency()),
+        "Number of samples to read at once.")(
+        "csv",
+        po::value<std::string>(&csvPath),
+        "Also write the yields and shifts to this CSV file.")(
+        "latex",
+        po::value<std::string>(&latexPath),
+        "Also write the yields and shifts as LaTeX tables to this file.");
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    for (const auto& channel : channels)
+    {
+        if (channelIds.count(channel) == 0)
+        {
+            std::cerr << "ERROR: unknown channel " << channel << std::endl;
+            return 1;
+        }
+    }
+    if (inputDir.back() != '/')
+    {
+        inputDir += '/';
+    }
+    const std::string treePrefix{"Ttree_"
+                                 + (region.empty() ? "" : region + "_")};
+
+    if (samples.empty())
+    {
+        const std::string prefix{"histofile_"};
+        for (const auto& file : boost::make_iterator_range(
+                 boost::filesystem::directory_iterator{inputDir}, {}))
+        {
+            const std::string name{file.path().filename().string()};
+            if (name.compare(0, prefix.size(), prefix) == 0
+                && file.path().extension() == ".root")
+            {
+                samples.emplace_back(file.path().stem().string().substr(
+                    prefix.size()));
+            }
+        }
+        std::sort(samples.begin(), samples.end());
+    }
+
+    // The nominal tree is systematic 0
+    systs.insert(systs.begin(), "");
+
+    // Each sample is read in its own thread, with its own TFile
+    ROOT::EnableThreadSafety();
+    std::vector<SampleYields> yields(samples.size());
+    std::vector<std::string> errors(samples.size());
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> workers;
+    for (unsigned worker{0}; worker < std::max(jobs, 1u); worker++)
+    {
+        workers.emplace_back([&] {
+            for (size_t i{next++}; i < samples.size(); i = next++)
+            {
+                try
+                {
+                    yields[i] = readSample(
+                        inputDir + "histofile_" + samples[i] + ".root",
+                        treePrefix + samples[i],
+                        systs,
+                        channels);
+                }
+                catch (const std::exception& e)
+                {
+                    errors[i] = e.what();
+                }
+            }
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    for (const auto& error : errors)
+    {
+        if (!error.empty())
+        {
+            std::cerr << "ERROR: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream csv;
+    if (!csvPath.empty())
+    {
+        csv.open(csvPath);
+        csv << "sample,channel,syst,yield,statError,absShift,relShift\n";
+    }
+
+    boost::format yieldFormat{"%-6s %14.4f +- %10.4f (%6.2f%%)"};
+    boost::format systFormat{"%-6s %-18s %14.4f %+12.4f %+10.2f%%"};
+    for (size_t sample{0}; sample < samples.size(); sample++)
+    {
+        std::cout << samples[sample] << ":" << std::endl;
+        for (size_t chan{0}; chan < channels.size(); chan++)
+        {
+            const Yield& nominal{yields[sample][0][chan]};
+            if (!nominal.found)
+            {
+                std::cout << "No " << treePrefix << samples[sample] << " tree"
+                          << std::endl;
+                break;
+            }
+            const double statError{std::sqrt(nominal.sumW2)};
+            std::cout << yieldFormat % channels[chan] % nominal.sumW % statError
+                             % (statError / nominal.sumW * 100)
+                      << std::endl;
+            if (csv.is_open())
+            {
+                csv << samples[sample] << ',' << channels[chan] << ",,"
+                    << nominal.sumW << ',' << statError << ",0,0\n";
+            }
+
+            for (size_t syst{1}; syst < systs.size(); syst++)
+            {
+                const Yield& shifted{yields[sample][syst][chan]};
+                if (!shifted.found)
+                {
+                    continue;
+                }
+                const double absShift{shifted.sumW - nominal.sumW};
+                const double relShift{absShift / nominal.sumW * 100};
+                std::cout << systFormat % channels[chan] % systs[syst]
+                                 % shifted.sumW % absShift % relShift
+                          << std::endl;
+                if (csv.is_open())
+                {
+                    csv << samples[sample] << ',' << channels[chan] << ','
+                        << systs[syst] << ',' << shifted.sumW << ','
+                        << std::sqrt(shifted.sumW2) << ',' << absShift << ','
+                        << relShift << '\n';
+                }
+            }
+        }
+    }
+
+    if (!latexPath.empty())
+    {
+        std::ofstream latex{latexPath};
+        boost::format cell{"$%.2f \\pm %.2f$"};
+
+        // Nominal yields, one row per sample and one column per channel
+        latex << "\\begin{tabular}{l" << std::string(channels.size(), 'r')
+              << "}\n\\hline\nSample";
+        for (const auto& channel : channels)
+        {
+            latex << " & " << channel;
+        }
+        latex << " \\\\\n\\hline\n";
+        for (size_t sample{0}; sample < samples.size(); sample++)
+        {
+            latex << latexEscape(samples[sample]);
+            for (size_t chan{0}; chan < channels.size(); chan++)
+            {
+                const Yield& nominal{yields[sample][0][chan]};
+                latex << " & "
+                      << (nominal.found ? (cell % nominal.sumW
+                                           % std::sqrt(nominal.sumW2))
+                                              .str()
+                                        : "--");
+            }
+            latex << " \\\\\n";
+        }
+        latex << "\\hline\n\\end{tabular}\n\n";
+
+        // Relative systematic shifts in %, one table per sample
+        for (size_t sample{0}; sample < samples.size(); sample++)
+        {
+            latex << "% " << samples[sample] << "\n\\begin{tabular}{l"
+                  << std::string(channels.size(), 'r')
+                  << "}\n\\hline\nSystematic";
+            for (const auto& channel : channels)
+            {
+                latex << " & " << channel;
+            }
+            latex << " \\\\\n\\hline\n";
+            for (size_t syst{1}; syst < systs.size(); syst++)
+            {
+                if (!yields[sample][syst][0].found)
+                {
+                    continue;
+                }
+                latex << latexEscape(systs[syst]);
+                for (size_t chan{0}; chan < channels.size(); chan++)
+                {
+                    const double nominal{yields[sample][0][chan].sumW};
+                    latex << boost::format(" & $%+.2f\\%%$")
+                                 % ((yields[sample][syst][chan].sumW - nominal)
+                                    / nominal * 100);
+                }
+                latex << " \\\\\n";
+            }
+            latex << "\\hline\n\\end{tabular}\n\n";
+        }
+    }
+}